@@ -0,0 +1,66 @@
+// BootTimeline.h
+// Timestamps of subsystems becoming ready after power-on
+
+#ifndef BOOT_TIMELINE_H
+#define BOOT_TIMELINE_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include "Constants.h"
+
+/**
+ * @brief Records when each subsystem became ready, in millis() since power-on.
+ *
+ * Stages are logged to serial as they are marked and kept for the stats
+ * page. Stage names are stored by pointer, pass string literals. Marks may
+ * come from any task; at most BOOT_TIMELINE_MAX_STAGES are kept.
+ */
+class BootTimeline {
+public:
+    BootTimeline();
+
+    /**
+     * @brief Record that a stage is ready now
+     * @param stage Stage name (string literal)
+     */
+    void mark(const char *stage);
+
+    /**
+     * @brief Record a stage only the first time it is reached
+     * @param stage Stage name (string literal)
+     */
+    void markOnce(const char *stage);
+
+    /**
+     * @brief Get the number of recorded stages
+     * @return Stage count
+     */
+    uint8_t count() const { return stageCount; }
+
+    /**
+     * @brief Get the name of a recorded stage
+     * @param index Stage index in recording order
+     * @return Stage name, nullptr if out of range
+     */
+    const char *stageAt(uint8_t index) const;
+
+    /**
+     * @brief Get the time a stage was recorded
+     * @param index Stage index in recording order
+     * @return millis() of the mark, 0 if out of range
+     */
+    unsigned long millisAt(uint8_t index) const;
+
+private:
+    bool contains(const char *stage) const;
+
+    const char *stages[BOOT_TIMELINE_MAX_STAGES];
+    unsigned long marks[BOOT_TIMELINE_MAX_STAGES];
+    volatile uint8_t stageCount;
+    portMUX_TYPE lock;
+};
+
+// Global boot timeline
+extern BootTimeline bootTimeline;
+
+#endif // BOOT_TIMELINE_H
@@ -0,0 +1,139 @@
+// BrokerList.h
+// Ordered MQTT broker list with failover and return to the first broker
+
+#ifndef BROKER_LIST_H
+#define BROKER_LIST_H
+
+#include <Arduino.h>
+#include "Constants.h"
+#include "WiFiSetup.h"
+
+#define MQTT_BROKER_MAX (1 + MQTT_FALLBACK_COUNT)
+
+/**
+ * @brief Ordered list of brokers from Config: mqtt_server first, then the
+ * configured backups.
+ *
+ * Tracks consecutive connect failures of the active broker and moves to the
+ * next one after MQTT_FAILOVER_ATTEMPTS. While a backup is active, the first
+ * broker is probed every MQTT_PRIMARY_PROBE_INTERVAL_MS so the device goes
+ * back to it once it recovers; if the first connect after going back fails,
+ * the backup it came from is used again right away. The time from losing the
+ * connection to being connected to another broker is recorded as the
+ * switchover time.
+ *
+ * Host strings point into Config, which must outlive the list. Used by the
+ * network task only.
+ */
+class BrokerList {
+public:
+    BrokerList();
+
+    /**
+     * @brief Build the list from the config
+     * @param config Loaded configuration
+     */
+    void begin(const Config &config);
+
+    /**
+     * @brief Get the number of configured brokers
+     * @return Broker count (at least 1)
+     */
+    uint8_t count() const { return brokerCount; }
+
+    /**
+     * @brief Get the index of the broker in use
+     * @return Index, 0 is the first broker
+     */
+    uint8_t active() const { return current; }
+
+    /**
+     * @brief Get the host of a broker
+     * @param index Broker index
+     * @return Host name or address, "" if out of range
+     */
+    const char *host(uint8_t index) const;
+
+    /**
+     * @brief Get the port of a broker
+     * @param index Broker index
+     * @return Port number, 0 if out of range
+     */
+    int port(uint8_t index) const;
+
+    /**
+     * @brief Record a failed connect to the active broker
+     * @return true if the next broker should be used now
+     */
+    bool recordFailure();
+
+    /**
+     * @brief Record a successful connect to the active broker
+     * @param now Current millis()
+     * @return true if this completed a switchover
+     */
+    bool recordConnected(unsigned long now);
+
+    /**
+     * @brief Make a broker active
+     * @param index Broker index
+     * @param outageStart millis() when the connection was lost, for the switchover time
+     */
+    void select(uint8_t index, unsigned long outageStart);
+
+    /**
+     * @brief Go back to the first broker after it accepted a probe session
+     * @param now Current millis(), the switchover time is measured from it
+     */
+    void returnToFirst(unsigned long now);
+
+    /**
+     * @brief Get the broker to use after the active one
+     * @return Next index, wrapping to the first; the backup left by
+     *         returnToFirst() until the first broker connected
+     */
+    uint8_t next() const { return returning ? returnedFrom : (current + 1) % brokerCount; }
+
+    /**
+     * @brief Check if it is time to probe the first broker
+     * @param now Current millis()
+     * @return true if a backup is active and the probe interval elapsed
+     */
+    bool primaryProbeDue(unsigned long now);
+
+    /**
+     * @brief Get the number of broker switches
+     * @return Switch count
+     */
+    uint32_t switchCount() const { return switches; }
+
+    /**
+     * @brief Get the last measured switchover time
+     * @return Milliseconds from losing the connection to being connected to the new broker
+     */
+    uint32_t lastSwitchoverMs() const { return switchoverMs; }
+
+    /**
+     * @brief Get the number of failed connects of a broker
+     * @param index Broker index
+     * @return Failure count since boot
+     */
+    uint32_t failureCount(uint8_t index) const { return index < brokerCount ? failures[index] : 0; }
+
+private:
+    const char *hosts[MQTT_BROKER_MAX];
+    int ports[MQTT_BROKER_MAX];
+    uint32_t failures[MQTT_BROKER_MAX];
+    uint8_t brokerCount;
+    uint8_t current;
+    uint8_t consecutiveFailures;
+    bool switching;                    // Switched, not connected yet
+    bool returning;                    // Back on the first broker, not connected yet
+    uint8_t returnedFrom;              // Backup in use before returnToFirst()
+    unsigned long switchOutageStart;   // Outage start of the pending switchover
+    unsigned long lastProbeMillis;
+    uint32_t switches;
+    uint32_t switchoverMs;
+};
+
+#endif // BROKER_LIST_H
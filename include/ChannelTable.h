@@ -0,0 +1,164 @@
+// ChannelTable.h
+// Latest-value table for all ECU and GPS channels
+
+#ifndef CHANNEL_TABLE_H
+#define CHANNEL_TABLE_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "Constants.h"
+#include "TimerWheel.h"
+
+// Channel sets (see the mapping comment in Menu.cpp)
+#define ECU_CHANNEL_COUNT 18
+#define GPS_CHANNEL_COUNT 8
+#define CHANNEL_COUNT (ECU_CHANNEL_COUNT + GPS_CHANNEL_COUNT)
+
+extern const char* const ecuDataStrings[ECU_CHANNEL_COUNT];
+extern const char* const gpsDataStrings[GPS_CHANNEL_COUNT];
+
+/**
+ * @brief Latest received value of a single channel
+ */
+struct ChannelEntry {
+    const char *code;                 // Three letter channel code
+    bool isGps;                       // GPS channel (false = ECU)
+    char text[CHANNEL_TEXT_SIZE];     // Formatted display text
+    float value;                      // Parsed numeric value
+    uint32_t seq;                     // Incremented on every update
+    unsigned long updatedMillis;      // millis() of the last update
+    uint16_t staleTimeoutMs;          // No update for this long marks the channel stale
+    bool stale;                       // Shown as notAvailableMsg until the next update
+    uint8_t subscribers;              // Number of display users of this channel
+};
+
+/**
+ * @brief Thread-safe table of the latest value of every channel.
+ *
+ * Each channel is stored once, keyed by its three letter code. Display
+ * consumers compare the sequence number with the one they last rendered, so
+ * switching what is shown never needs a new MQTT round trip.
+ *
+ * The table also reference-counts display users of a channel so that a topic
+ * shared by several zones/modes is subscribed once and only unsubscribed when
+ * the last user releases it.
+ *
+ * A channel that receives no update for its stale timeout reads as
+ * notAvailableMsg. Deadlines are kept in a timer wheel, armed on the first
+ * update and re-checked only when their slot comes up, so update() never
+ * touches a list and checkStale() does not scan the table.
+ */
+class ChannelTable {
+private:
+    ChannelEntry entries[CHANNEL_COUNT];
+    SemaphoreHandle_t mutex;
+    TimerWheel staleWheel;
+    volatile uint32_t staleEvents;
+
+    static void onStaleDeadline(uint8_t id, unsigned long now, void *context);
+
+public:
+    ChannelTable();
+    ~ChannelTable();
+
+    /**
+     * @brief Find a channel by its code
+     * @param code Three letter channel code
+     * @return Channel index, or -1 if unknown
+     */
+    int indexOf(const char *code) const;
+
+    /**
+     * @brief Get the code of a channel
+     * @param index Channel index
+     * @return Channel code, or nullptr if out of range
+     */
+    const char *codeAt(int index) const;
+
+    /**
+     * @brief Check if a channel belongs to the GPS set
+     * @param index Channel index
+     * @return true for GPS channels, false for ECU channels or invalid index
+     */
+    bool isGps(int index) const;
+
+    /**
+     * @brief Store a new value for a channel
+     * @param code Three letter channel code
+     * @param text Formatted display text
+     * @param value Parsed numeric value
+     * @return true if stored, false if unknown code or mutex timeout
+     */
+    bool update(const char *code, const char *text, float value);
+
+    /**
+     * @brief Read the latest text of a channel
+     * @param index Channel index
+     * @param buffer Buffer to copy the text into
+     * @param bufferSize Size of the buffer
+     * @param seq Optional output for the sequence number of the copied value
+     * @return true if the channel has received at least one value
+     */
+    bool read(int index, char *buffer, size_t bufferSize, uint32_t *seq = nullptr);
+
+    /**
+     * @brief Get the sequence number of a channel without copying its value
+     * @param index Channel index
+     * @return Sequence number, 0 if never updated or invalid index
+     */
+    uint32_t sequence(int index) const;
+
+    /**
+     * @brief Register a display user of a channel
+     * @param index Channel index
+     * @return true if this is the first user (topic must be subscribed)
+     */
+    bool acquire(int index);
+
+    /**
+     * @brief Unregister a display user of a channel
+     * @param index Channel index
+     * @return true if this was the last user (topic may be unsubscribed)
+     */
+    bool release(int index);
+
+    /**
+     * @brief Get the number of display users of a channel
+     * @param index Channel index
+     * @return Number of users, 0 for invalid index
+     */
+    uint8_t subscribers(int index) const;
+
+    /**
+     * @brief Mark channels stale whose timeout passed without an update
+     * @param now Current millis()
+     * @return Number of channels that became stale
+     */
+    uint8_t checkStale(unsigned long now);
+
+    /**
+     * @brief Check if a channel is stale
+     * @param index Channel index
+     * @return true if stale, false if fresh, never updated or invalid index
+     */
+    bool isStale(int index) const;
+
+    /**
+     * @brief Change the stale timeout of a channel
+     * @param index Channel index
+     * @param timeoutMs Timeout in ms
+     */
+    void setStaleTimeout(int index, uint16_t timeoutMs);
+
+    /**
+     * @brief Get the number of times any channel went stale
+     * @return Stale event count
+     */
+    uint32_t staleEventCount() const { return staleEvents; }
+};
+
+// Global channel table
+extern ChannelTable g_channels;
+
+#endif // CHANNEL_TABLE_H
@@ -10,7 +10,9 @@
 
 // DOT Matrix Display (MD_Parola)
 #define DOT_MATRIX_CS_PIN 21
-#define DOT_MATRIX_MAX_DEVICES 4
+#define DOT_MATRIX_MAX_DEVICES 4         // Modules in the chain (4, 8, 12, ...)
+#define DOT_MATRIX_ZONE_COUNT 1          // Channels shown side by side (1..MAX_DISPLAY_ZONES)
+#define MAX_DISPLAY_ZONES 4
 #define DOT_MATRIX_CHAR_SPACING 1
 #define DOT_MATRIX_DEFAULT_BRIGHTNESS 5
 #define DOT_MATRIX_MAX_BRIGHTNESS 15
@@ -23,6 +25,38 @@
 #define SEVEN_SEG_DEFAULT_INTENSITY 8
 #define SEVEN_SEG_SCROLL_DELAY_MS 250
 
+// Main display render modes (persisted in Config::renderMode)
+#define RENDER_MODE_TEXT 0               // Formatted text through MD_Parola
+#define RENDER_MODE_BAR 1                // RPM bar graph written as raw columns
+#define RENDER_MODE_SPARK 2              // Sparkline of the selected channel
+#define RENDER_MODE_COUNT 3
+
+// Graph render modes
+#define RPM_BAR_MAX 7000                 // RPM at full bar length
+#define RPM_SHIFT_WARN 5500              // First shift marker
+#define RPM_SHIFT_POINT 6300             // Second shift marker, bar blinks above this
+#define RPM_SHIFT_BLINK_MS 100           // Blink period above the shift point
+#define SPARKLINE_HISTORY_SIZE 32        // Samples kept (one per column on 4 modules)
+#define GRAPH_MIN_REDRAW_INTERVAL_MS 20  // Cap column redraws at 50 Hz
+
+// Text refresh-rate caps, messages arriving faster are coalesced (latest wins)
+#define MAIN_DISPLAY_MAX_RATE_HZ 25      // Main DOT matrix text and zones
+#define SECONDARY_DISPLAY_MAX_RATE_HZ 10 // 7-segment MQTT messages
+
+// Stale channel detection (per channel timeouts are in ChannelTable.cpp)
+#define TIMER_WHEEL_TICK_MS 250          // Stale check resolution
+#define TIMER_WHEEL_SLOTS 64             // One revolution = 16 s, longer timeouts are re-armed
+#define TIMER_WHEEL_MAX_IDS 32           // Ids per wheel (>= number of channels)
+#define SECONDARY_STALE_TIMEOUT_MS 5000  // 7-segment MQTT message shown as N/A after this
+
+// Page rotation of the primary channel
+#define MAX_PAGES 6                      // Pages in the rotation list
+#define PAGE_INTERVAL_MAX_S 60           // Longest timed rotation interval (0 = click only)
+
+// Main display compositor
+#define OVERLAY_TTL_MS 3000              // How long transient overlays (lap time) stay
+#define ALERT_MQTT_LOST_MSG "NO MQTT"    // Alert shown while the primary client is down
+
 // ============================================================================
 // NETWORK CONFIGURATION
 // ============================================================================
@@ -32,14 +66,29 @@
 #define WIFI_AP_PASSWORD "golf1986"
 #define WIFI_CONNECTION_TIMEOUT_MS 30000  // 30 seconds
 #define WIFI_MANAGER_TIMEOUT_S 180        // 3 minutes for config portal
+#define WIFI_CONNECT_ATTEMPT_MS 8000      // One background reconnect attempt
+#define WIFI_RECONNECT_BACKOFF_MIN_MS 1000
+#define WIFI_RECONNECT_BACKOFF_MAX_MS 30000
+#define WIFI_FAST_CONNECT_TIMEOUT_MS 3000 // Directed connect (with DHCP) to the cached access point before the full path
 
 // MQTT Configuration
 #define MQTT_CLIENT_PRIMARY "G86-INFO"
 #define MQTT_CLIENT_SECONDARY "G86-INFO2"
+#define MQTT_CLIENT_PROBE "G86-INFO-PROBE"  // Short session that checks whether the first broker is back
 #define MQTT_TOPIC_BASE "GOLF86"
 #define MQTT_MAX_CONNECT_ATTEMPTS 20
 #define MQTT_CONNECT_RETRY_DELAY_MS 1000
 #define MQTT_RECONNECT_INTERVAL_MS 5000
+#define MQTT_BOOT_GRACE_MS 10000          // No "NO MQTT" alert before the first connect had a chance
+#define MQTT_BACKOFF_MIN_MS 500           // First retry delay after a failed connect
+#define MQTT_BACKOFF_MAX_MS 30000         // Retry delay cap
+#define MQTT_BACKOFF_JITTER_PERCENT 25    // Random +/- spread of each retry delay
+#define SUBSCRIPTION_SET_CAPACITY 16      // Topics remembered per client for resubscription
+#define MQTT_KEEPALIVE_S 5                // Dead broker noticed after ~1.5 keepalives
+#define MQTT_COMMAND_TIMEOUT_MS 1000      // CONNACK/SUBACK wait per command
+#define MQTT_FAILOVER_ATTEMPTS 2          // Failed connects before trying the next broker
+#define MQTT_PRIMARY_PROBE_INTERVAL_MS 30000 // Check whether the first broker is back
+#define MQTT_BROKER_PROBE_TIMEOUT_MS 500  // CONNACK wait of that check
 #define MQTT_DEFAULT_PORT 1883
 #define MQTT_USERNAME "public"
 #define MQTT_PASSWORD "public"
@@ -79,6 +128,15 @@
 #define TIMER_MAX_VALUE_MS 40000000UL     // ~11.1 hours in centiseconds
 #define TIMER_MQTT_UPDATE_INTERVAL_MS 100 // Update MQTT every 100ms
 
+// Timer MQTT topics (persisted in Config::timerPublish)
+#define TIMER_PUBLISH_LEGACY 0            // started, paused and value topics
+#define TIMER_PUBLISH_STATE 1             // One combined state topic per timer
+#define TIMER_PUBLISH_BOTH 2
+#define TIMER_PUBLISH_COUNT 3
+#define TIMER_STATE_DEFAULT_RATE_HZ 5     // State publishes per second while running
+#define TIMER_STATE_MAX_RATE_HZ 10        // 0 = on change only
+#define TIMER_STATE_PAYLOAD_SIZE 24       // "1,0,40000000,65535"
+
 // ============================================================================
 // TASK CONFIGURATION
 // ============================================================================
@@ -93,6 +151,101 @@
 #define SECONDARY_DISPLAY_TASK_PRIORITY 1
 #define TIMER_TASK_PRIORITY 2
 
+// Network task (MQTT I/O), runs next to the WiFi stack on core 0
+#define NETWORK_TASK_ENABLED 1              // 0 = MQTT and UDP inline in loop(), the display latency baseline
+#define NETWORK_TASK_CORE 0
+#define NETWORK_TASK_PRIORITY 2             // Above the secondary display task
+#define NETWORK_TASK_STACK_SIZE 8192
+#define NETWORK_TASK_INTERVAL_MS 2          // Pause between MQTT polls
+#define NETWORK_COMMAND_QUEUE_LENGTH 32     // Publish/subscribe requests to the network task
+#define NETWORK_COMMAND_OVERFLOW_LENGTH 16  // Requests held while the command queue is full
+#define NETWORK_PERIODIC_SLOT_COUNT 4       // Latest-wins periodic topics (value and state of both timers)
+
+// Ingest classes (display channel values use one latest-wins slot per channel)
+#define INGEST_CRITICAL_QUEUE_LENGTH 16     // Timer values and alerts
+#define INGEST_CRITICAL_WAIT_MS 500         // Longest wait for room before a critical message is dropped
+#define INGEST_DIAGNOSTIC_QUEUE_LENGTH 8    // Diagnostics, dropped when full
+#define INGEST_DIAGNOSTIC_BUDGET 4          // Diagnostics handled per main loop pass
+#define CRITICAL_PAYLOAD_SIZE 32
+#define DIAGNOSTIC_NAME_SIZE 16
+#define DIAGNOSTIC_PAYLOAD_SIZE 48
+#define MQTT_COMMAND_PAYLOAD_SIZE 24        // Largest queued publish payload
+#define PUBLISH_BUFFER_LENGTH 32            // Publishes held while the primary client is offline
+#define PUBLISH_FLUSH_BATCH 8               // Held publishes sent per network task pass
+#define LATENCY_HISTOGRAM_BUCKETS 100       // 1 ms buckets, last one collects >= 99 ms
+#define METRIC_HISTOGRAM_BUCKETS 10         // Bounds in METRIC_DURATION_BUCKETS_US (Metrics.cpp)
+#define TRACE_RING_SIZE 1024                // Spans kept for /trace.json, 12 bytes each
+#define TRACE_EXPORT_CHUNK 1024             // /trace.json is streamed in chunks of this size
+#define TASK_REGISTRY_SIZE 10               // Loop, network, UDP, secondary display, log, 2 timers, 2 UARTs + spare
+#define TASK_SAMPLE_INTERVAL_MS 1000        // Stack and CPU sampling of the registered tasks
+#define TASK_IDLE_GAP_US 10                 // Longer gaps between idle hook calls are not idle
+#ifndef CONFIG_ARDUINO_LOOP_STACK_SIZE
+#define CONFIG_ARDUINO_LOOP_STACK_SIZE 8192 // Arduino core default
+#endif
+
+// Deferred log (lines are printed by a low-priority task, tail on /log)
+#define LOG_RING_SIZE 32                    // Lines waiting for the log task, power of two
+#define LOG_LINE_SIZE 96                    // Longer lines are cut
+#define LOG_TAIL_SIZE 4096                  // Bytes of printed output kept for /log
+#define LOG_TAIL_CHUNK 512                  // /log is streamed in chunks of this size
+#define LOG_DRAIN_INTERVAL_MS 20
+#define LOG_SITE_WINDOW_MS 1000             // Rate limit per call site:
+#define LOG_SITE_BURST 5                    // at most this many lines per window
+#define LOG_DEFAULT_LEVEL 2                 // LOG_LEVEL_INFO
+#define LOG_TASK_CORE 0
+#define LOG_TASK_PRIORITY 1                 // Below the network and UART tasks
+#define LOG_TASK_STACK_SIZE 3072
+
+// Main loop profiler (/loop), budgets can be changed at runtime
+#define LOOP_BUDGET_WIFI_US 500
+#define LOOP_BUDGET_SAMPLES_US 2000
+#define LOOP_BUDGET_DISPLAY_US 4000
+#define LOOP_BUDGET_SWITCHES_US 500
+#define LOOP_BUDGET_WEB_US 5000             // Serving the stats page takes longer
+#define LOOP_BUDGET_TASKS_US 500
+#define LOOP_BUDGET_TOTAL_US 10000          // Work per iteration, the 2 ms pause excluded
+#define LOOP_HISTOGRAM_BUCKETS 12           // log2 buckets from < 64 us to >= 65.5 ms
+#define LOOP_SLOWEST_COUNT 8                // Slowest iterations kept with their stages
+#define LOOP_RESPONSE_RESERVE 2048          // /loop text is built in one String
+
+// Direct Speeduino UART ingest (bypasses the MQTT bridge)
+#define SPEEDUINO_SERIAL_ENABLED 0          // 1 = poll the ECU on the pins below
+#define SPEEDUINO_RX_PIN 16
+#define SPEEDUINO_TX_PIN 17
+#define SPEEDUINO_BAUD 115200
+#define SPEEDUINO_COMMAND 'A'               // 'A' (fixed size) or 'n' (length prefixed)
+#define SPEEDUINO_POLL_INTERVAL_MS 50       // 20 Hz
+#define SPEEDUINO_RESPONSE_TIMEOUT_MS 40    // ~7 ms of data at 115200 baud
+#define SPEEDUINO_A_PAYLOAD_SIZE 75         // Bytes after the 'A' echo
+#define SPEEDUINO_MIN_PAYLOAD_SIZE 43       // Up to the baro byte
+#define SPEEDUINO_MAX_PAYLOAD_SIZE 128
+#define SPEEDUINO_LIVE_TIMEOUT_MS 500       // MQTT ECU values ignored while serial data is fresher
+#define SPEEDUINO_REPUBLISH_INTERVAL_MS 100 // Republish as /GOLF86/ECU/frame (0 = off)
+#define SPEEDUINO_TASK_CORE 0
+#define SPEEDUINO_TASK_PRIORITY 2
+#define SPEEDUINO_TASK_STACK_SIZE 4096
+
+// Direct NMEA GPS UART ingest (bypasses the gps-to-mqtt bridge)
+#define GPS_SERIAL_ENABLED 0                // 1 = read the receiver on the pin below
+#define GPS_RX_PIN 22                       // Receive only; 18, 19 and 23 are the VSPI pins of the matrix
+#define GPS_BAUD 115200                     // Needed for RMC+GGA+VTG at 10-25 Hz
+#define NMEA_MAX_SENTENCE 96                // 82 per the standard, some receivers send more
+#define GPS_READ_INTERVAL_MS 5              // UART buffer drained at this interval
+#define GPS_LIVE_TIMEOUT_MS 1000            // MQTT GPS values ignored while serial data is fresher
+#define GPS_TASK_CORE 0
+#define GPS_TASK_PRIORITY 2
+#define GPS_TASK_STACK_SIZE 4096
+
+// UDP telemetry ingest (port in Config::udpPort, 0 = off)
+#define UDP_DEFAULT_PORT 0
+#define UDP_MAX_DATAGRAM 512                // Larger datagrams are rejected
+#define UDP_POLL_BUDGET 8                   // Datagrams handled per UDP task pass
+#define UDP_TASK_INTERVAL_MS 2              // Pause between socket polls
+#define UDP_TASK_CORE 0
+#define UDP_TASK_PRIORITY 2
+#define UDP_TASK_STACK_SIZE 4096
+#define UDP_SEQ_RESTART_WINDOW 256          // Larger jumps back mean a restarted sender
+
 // Task Update Intervals
 #define DISPLAY_UPDATE_INTERVAL_MS 10     // Poll display mode every 10ms
 #define BUTTON_POLL_INTERVAL_MS 50        // Poll buttons every 50ms
@@ -104,6 +257,7 @@
 #define MESSAGE_BUFFER_SIZE 128     // Message buffers for display text
 #define MODE_BUFFER_SIZE 16         // Display mode string buffer
 #define DATA_INDEX_SIZE 4           // ECU/GPS data index (3 chars + null)
+#define CHANNEL_TEXT_SIZE 16        // Formatted value of a single channel
 #define MQTT_SERVER_SIZE 40         // MQTT server hostname
 #define MQTT_PORT_SIZE 6            // MQTT port string
 
@@ -118,8 +272,12 @@
 // Watchdog Configuration
 #define WATCHDOG_TIMEOUT_S 10      // 10 second watchdog timeout
 
+// Boot timeline
+#define BOOT_TIMELINE_MAX_STAGES 16  // Subsystem ready marks kept from power-on
+
 // Web Server
 #define WEB_SERVER_PORT 80         // HTTP server port
+#define METRICS_RESPONSE_RESERVE 8192 // /metrics text is built in one String
 
 // ============================================================================
 // WELCOME MESSAGES
@@ -141,6 +299,6 @@
 // CONFIG VERSION
 // ============================================================================
 
-#define CONFIG_VERSION 1  // Increment when Config struct changes
+#define CONFIG_VERSION 7  // Increment when Config struct changes
 
 #endif // CONSTANTS_H
@@ -0,0 +1,170 @@
+// DeferredLog.h
+// Leveled logging formatted into a lock-free ring, printed by a low-priority task
+
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include "Constants.h"
+
+// Log levels, most severe first; lines above the current level are skipped
+#define LOG_LEVEL_ERROR 0
+#define LOG_LEVEL_WARN 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_DEBUG 3
+#define LOG_LEVEL_COUNT 4
+
+/**
+ * @brief Rate limit of one log call site.
+ *
+ * Allows LOG_SITE_BURST lines per LOG_SITE_WINDOW_MS, the rest are counted and
+ * reported with the next line that gets through. Constant-initialized, so the
+ * static instance in each LOG_* call site needs no guard.
+ */
+class LogSite {
+public:
+    constexpr LogSite() : windowStart(0), lines(0), skipped(0) {}
+
+    /**
+     * @brief Check if a line may be written
+     * @param now Current millis()
+     * @param suppressed Set to the lines skipped before this one
+     * @return true if the line is written
+     */
+    bool allow(uint32_t now, uint32_t &suppressed);
+
+private:
+    std::atomic<uint32_t> windowStart;
+    std::atomic<uint32_t> lines;     // Lines in the current window
+    std::atomic<uint32_t> skipped;   // Lines skipped since the last one written
+};
+
+/**
+ * @brief One formatted line waiting for the log task
+ */
+struct LogSlot {
+    std::atomic<uint32_t> sequence;  // Slot state, see DeferredLog::write()
+    uint32_t millis;
+    uint8_t level;                   // LOG_LEVEL_*
+    uint16_t suppressed;             // Lines of the same call site skipped before this one
+    char text[LOG_LINE_SIZE];
+};
+
+/**
+ * @brief Deferred logger: callers format into a ring, a task prints it.
+ *
+ * Any task on either core may write. A writer claims a slot with one
+ * compare-and-swap (bounded MPMC ring with per-slot sequence numbers), formats
+ * the line into it and publishes it; no lock is taken and nothing waits for the
+ * UART. When the ring is full the line is dropped and counted. The log task
+ * prints the lines every LOG_DRAIN_INTERVAL_MS and keeps the last LOG_TAIL_SIZE
+ * bytes of output for /log.
+ *
+ * Not for ISRs. Lines written before begin() are printed once the task runs.
+ */
+class DeferredLog {
+public:
+    DeferredLog();
+
+    /**
+     * @brief Start the log task
+     * @return true if the task is running
+     */
+    bool begin();
+
+    /**
+     * @brief Get the current level (inline, checked before formatting)
+     * @return LOG_LEVEL_*
+     */
+    uint8_t level() const { return threshold.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Set the current level
+     * @param value LOG_LEVEL_*, larger values are capped to LOG_LEVEL_DEBUG
+     */
+    void setLevel(uint8_t value);
+
+    /**
+     * @brief Format a line into the ring, use the LOG_* macros instead
+     * @param site Rate limit of the call site
+     * @param level LOG_LEVEL_*
+     * @param format printf format, without the trailing newline
+     */
+    void write(LogSite &site, uint8_t level, const char *format, ...) __attribute__((format(printf, 4, 5)));
+
+    /**
+     * @brief Print the waiting lines and append them to the tail (log task)
+     */
+    void drain();
+
+    /**
+     * @brief Copy tail output, oldest first
+     * @param position Total output offset to read from, advanced by the bytes copied;
+     *                 moved up to the oldest byte kept if it was overwritten
+     * @param buffer Destination
+     * @param size Destination size
+     * @return Bytes copied, 0 at the end of the output
+     */
+    size_t readTail(uint32_t &position, char *buffer, size_t size);
+
+    /**
+     * @brief Get the total output offset of the oldest byte kept
+     * @return Offset to start readTail() from
+     */
+    uint32_t tailStart() const;
+
+    /**
+     * @brief Get the name of a level
+     * @param level LOG_LEVEL_*
+     * @return Lower case name
+     */
+    static const char *levelName(uint8_t level);
+
+    uint32_t writtenCount() const { return written.load(std::memory_order_relaxed); }
+    uint32_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+    uint32_t suppressedCount() const { return suppressedTotal.load(std::memory_order_relaxed); }
+
+private:
+    static void taskLoop(void *parameter);
+
+    /**
+     * @brief Append output to the tail ring (log task)
+     */
+    void appendTail(const char *text, size_t length);
+
+    LogSlot slots[LOG_RING_SIZE];
+    std::atomic<uint32_t> enqueuePosition;
+    uint32_t dequeuePosition;        // Log task only
+    std::atomic<uint8_t> threshold;
+    std::atomic<uint32_t> written;
+    std::atomic<uint32_t> dropped;   // Ring full
+    std::atomic<uint32_t> suppressedTotal; // Rate limited
+
+    char tail[LOG_TAIL_SIZE];
+    uint32_t tailWritten;            // Bytes appended since boot
+    SemaphoreHandle_t tailMutex;
+    TaskHandle_t taskHandle;
+};
+
+// Global instance
+extern DeferredLog deferredLog;
+
+// Writes a line if the level is enabled and the call site is within its rate
+#define LOG_AT(severity, ...)                                       \
+    do {                                                            \
+        if ((severity) <= deferredLog.level()) {                    \
+            static LogSite __log_site;                              \
+            deferredLog.write(__log_site, (severity), __VA_ARGS__); \
+        }                                                           \
+    } while (0)
+
+#define LOG_ERROR(...) LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT(LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_DEBUG(...) LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+
+#endif // DEFERRED_LOG_H
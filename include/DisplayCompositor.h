@@ -0,0 +1,116 @@
+// DisplayCompositor.h
+// Prioritised message layers for the main DOT matrix display
+
+#ifndef DISPLAY_COMPOSITOR_H
+#define DISPLAY_COMPOSITOR_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "Constants.h"
+
+/**
+ * @brief Display layers, higher value wins
+ */
+enum DisplayLayer : uint8_t {
+    LAYER_BASE = 0,       // Primary channel value
+    LAYER_OVERLAY,        // Transient message with a TTL (lap time, ...)
+    LAYER_ALERT,          // Critical message from /GOLF86/ALERT, stays until cleared
+    LAYER_LINK,           // Connection loss, kept apart so it never replaces a broker alert
+    LAYER_COUNT,
+    LAYER_NONE = 0xFF
+};
+
+/**
+ * @brief Picks which message the main display shows.
+ *
+ * Every source posts to its own layer instead of overwriting the shared
+ * newMessage buffer. compose() selects the highest active layer in
+ * O(LAYER_COUNT) and only reports a change when that layer, or its content,
+ * differs from what was last rendered. Posts to a layer below the visible one
+ * are stored but absorbed without a redraw, and become visible again as soon
+ * as the higher layer expires or is cleared.
+ */
+class DisplayCompositor {
+public:
+    DisplayCompositor();
+    ~DisplayCompositor();
+
+    /**
+     * @brief Set the text of a layer
+     * @param layer Target layer
+     * @param text Message text
+     * @param ttlMs Time to live in ms, 0 to keep until cleared or replaced
+     * @return true if stored, false if invalid layer or mutex timeout
+     */
+    bool post(uint8_t layer, const char *text, uint32_t ttlMs = 0);
+
+    /**
+     * @brief Remove the message of a layer
+     * @param layer Target layer
+     */
+    void clear(uint8_t layer);
+
+    /**
+     * @brief Get the highest active layer, expiring layers whose TTL passed
+     * @param now Current millis()
+     * @return Visible layer, or LAYER_NONE if nothing was posted yet
+     */
+    uint8_t top(unsigned long now);
+
+    /**
+     * @brief Copy the visible message if it changed since the last call
+     * @param now Current millis()
+     * @param buffer Buffer to copy the text into
+     * @param bufferSize Size of the buffer
+     * @return true if the buffer was filled and must be rendered
+     */
+    bool compose(unsigned long now, char *buffer, size_t bufferSize);
+
+    /**
+     * @brief Force the next compose() call to report a change
+     */
+    void invalidate();
+
+    /**
+     * @brief Get the number of post() calls, used as the update sequence number
+     * @return Post count
+     */
+    uint32_t postedCount() const { return posted; }
+
+    /**
+     * @brief Get the number of posts absorbed under a higher layer
+     * @return Absorbed post count
+     */
+    uint32_t absorbedCount() const { return absorbed; }
+
+    /**
+     * @brief Get the number of messages handed to the display
+     * @return Composed message count
+     */
+    uint32_t composedCount() const { return composed; }
+
+private:
+    struct Layer {
+        char text[MESSAGE_BUFFER_SIZE];
+        bool active;
+        bool timed;                    // Expires at expiresMillis
+        unsigned long expiresMillis;
+        uint32_t seq;                  // Bumped when the text changes
+    };
+
+    uint8_t topLocked(unsigned long now);
+
+    Layer layers[LAYER_COUNT];
+    uint8_t renderedLayer;
+    uint32_t renderedSeq;
+    uint32_t posted;
+    uint32_t absorbed;
+    uint32_t composed;
+    SemaphoreHandle_t mutex;
+};
+
+// Global compositor for the main display
+extern DisplayCompositor mainCompositor;
+
+#endif // DISPLAY_COMPOSITOR_H
@@ -0,0 +1,99 @@
+// DisplayModes.h
+// Graphical render modes for the main DOT matrix display
+
+#ifndef DISPLAY_MODES_H
+#define DISPLAY_MODES_H
+
+#include <Arduino.h>
+#include <MD_MAX72xx.h>
+#include "Constants.h"
+
+/**
+ * @brief Column-based renderer for the non-text main display modes.
+ *
+ * Both modes bypass MD_Parola text rendering and write raw columns through
+ * the MD_MAX72XX instance that backs the main display:
+ * - RENDER_MODE_BAR: RPM bar graph with shift-point markers.
+ * - RENDER_MODE_SPARK: Scrolling sparkline of the selected primary channel.
+ *
+ * Samples are pushed from the MQTT callback and only mark the graph dirty;
+ * drawing happens from the main loop, at most once per
+ * GRAPH_MIN_REDRAW_INTERVAL_MS, so a fast publisher cannot stall the loop.
+ */
+class MainDisplayGraph {
+public:
+    MainDisplayGraph();
+
+    /**
+     * @brief Attach the graph to the display driver
+     * @param graphics MD_MAX72XX instance from MD_Parola::getGraphicObject()
+     */
+    void begin(MD_MAX72XX *graphics);
+
+    /**
+     * @brief Select the render mode
+     * @param newMode One of RENDER_MODE_*
+     */
+    void setMode(uint8_t newMode);
+
+    /**
+     * @brief Get the current render mode
+     * @return One of RENDER_MODE_*
+     */
+    uint8_t getMode() const { return mode; }
+
+    /**
+     * @brief Check if a graphical mode is active
+     * @return true if the display is driven by this class instead of MD_Parola
+     */
+    bool isActive() const { return mode != RENDER_MODE_TEXT; }
+
+    /**
+     * @brief Get the channel drawn by the current mode
+     * @return "RPM" for the bar graph, the primary channel otherwise
+     */
+    const char *channelCode() const;
+
+    /**
+     * @brief Feed a numeric channel value
+     * @param code Three letter channel code (e.g. "RPM")
+     * @param value Parsed numeric value
+     */
+    void pushSample(const char *code, float value);
+
+    /**
+     * @brief Force a full redraw on the next render() call
+     */
+    void invalidate() { dirty = true; }
+
+    /**
+     * @brief Redraw the display if there is new data and the redraw interval elapsed
+     * @return true if the columns were rewritten
+     */
+    bool render();
+
+private:
+    void drawRpmBar(uint16_t columns);
+    void drawSparkline(uint16_t columns);
+
+    MD_MAX72XX *mx;
+    uint8_t mode;
+    volatile bool dirty;
+    unsigned long lastDrawMillis;
+
+    // RPM bar state
+    float rpm;
+    bool shiftBlinkOn;
+    unsigned long lastBlinkMillis;
+
+    // Sparkline ring buffer for the selected channel
+    char sparkCode[DATA_INDEX_SIZE];
+    float history[SPARKLINE_HISTORY_SIZE];
+    uint8_t historyHead;
+    uint8_t historyCount;
+};
+
+// Global graph renderer for the main display
+extern MainDisplayGraph mainGraph;
+
+#endif // DISPLAY_MODES_H
@@ -0,0 +1,73 @@
+// DisplayZones.h
+// Multi-zone channel layout for the main DOT matrix display
+
+#ifndef DISPLAY_ZONES_H
+#define DISPLAY_ZONES_H
+
+#include <Arduino.h>
+#include <MD_Parola.h>
+#include "ChannelTable.h"
+#include "Constants.h"
+
+/**
+ * @brief Splits the main display chain into MD_Parola zones, one channel each.
+ *
+ * Zone 0 is the leftmost zone and follows the primary channel selected in the
+ * menu; the remaining zones are bound to channels stored in Config. A zone is
+ * only re-rendered when the sequence number of its channel in the channel
+ * table changed, so the cost of an update does not depend on the chain length.
+ */
+class DisplayZones {
+public:
+    DisplayZones();
+
+    /**
+     * @brief Configure the MD_Parola zones
+     * @param display Main display, already started with begin(DOT_MATRIX_ZONE_COUNT)
+     */
+    void begin(MD_Parola *display);
+
+    /**
+     * @brief Get the number of zones
+     * @return Number of zones on the main display
+     */
+    uint8_t count() const { return DOT_MATRIX_ZONE_COUNT; }
+
+    /**
+     * @brief Bind a zone to a channel, updating the MQTT subscriptions
+     * @param zone Zone number
+     * @param code Three letter channel code
+     * @return true if the binding changed
+     */
+    bool bind(uint8_t zone, const char *code);
+
+    /**
+     * @brief Get the channel code bound to a zone
+     * @param zone Zone number
+     * @return Channel code, or nullptr if the zone is unbound
+     */
+    const char *boundCode(uint8_t zone) const;
+
+    /**
+     * @brief Force every zone to be re-rendered on the next render() call
+     */
+    void invalidate();
+
+    /**
+     * @brief Re-render zones whose channel received a new value
+     * @param primary false to leave zone 0 to an overlay message
+     * @return Number of zones that were re-rendered
+     */
+    uint8_t render(bool primary = true);
+
+private:
+    MD_Parola *parola;
+    int channel[MAX_DISPLAY_ZONES];                      // Channel table index, -1 if unbound
+    uint32_t renderedSeq[MAX_DISPLAY_ZONES];             // Last rendered sequence number
+    char text[MAX_DISPLAY_ZONES][CHANNEL_TEXT_SIZE];     // Text buffers owned by MD_Parola
+};
+
+// Global zone layout for the main display
+extern DisplayZones mainZones;
+
+#endif // DISPLAY_ZONES_H
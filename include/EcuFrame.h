@@ -0,0 +1,84 @@
+// EcuFrame.h
+// Packed binary ECU snapshot, an alternative to one text topic per channel
+
+#ifndef ECU_FRAME_H
+#define ECU_FRAME_H
+
+#include <Arduino.h>
+#include "Constants.h"
+#include "ChannelTable.h"
+#include "IngestQueues.h"
+
+#define ECU_FRAME_MAGIC 0x86
+#define ECU_FRAME_VERSION 1
+
+/**
+ * @brief Layout of the /GOLF86/ECU/frame payload (40 bytes, little-endian).
+ *
+ * | Offset | Size | Field                                             |
+ * |--------|------|---------------------------------------------------|
+ * | 0      | 1    | magic, ECU_FRAME_MAGIC                            |
+ * | 1      | 1    | version, ECU_FRAME_VERSION                        |
+ * | 2      | 2    | seq, incremented per frame (wraps)                |
+ * | 4      | 36   | values, int16 per channel in ecuDataStrings order |
+ *
+ * Values with one decimal (O2P, AFT, BAT, PW1, DWL) are sent multiplied by
+ * 10, the others as they are shown.
+ */
+struct __attribute__((packed)) EcuFrame {
+    uint8_t magic;
+    uint8_t version;
+    uint16_t seq;
+    int16_t values[ECU_CHANNEL_COUNT];
+};
+
+static_assert(sizeof(EcuFrame) == 4 + 2 * ECU_CHANNEL_COUNT, "EcuFrame must stay packed");
+
+/**
+ * @brief Decodes ECU frames into display samples and counts lost frames.
+ *
+ * Used by the network task only.
+ */
+class EcuFrameDecoder {
+public:
+    EcuFrameDecoder();
+
+    /**
+     * @brief Decode a frame payload
+     * @param bytes Payload
+     * @param length Payload length
+     * @param samples Output, ECU_CHANNEL_COUNT entries in ecuDataStrings order
+     * @param receivedMicros micros() when the message was received
+     * @return true if the payload is a valid frame, false if rejected
+     */
+    bool decode(const char *bytes, int length, DisplaySample *samples, uint32_t receivedMicros);
+
+    /**
+     * @brief Format one channel value as display text, with its unit
+     * @param index ECU channel index (ecuDataStrings order)
+     * @param raw Value as sent in the frame
+     * @param text Output buffer
+     * @param size Size of the output buffer
+     * @return Numeric value
+     */
+    static float format(uint8_t index, int16_t raw, char *text, size_t size);
+
+    /**
+     * @brief Get the display unit of an ECU channel
+     * @param code Three letter channel code
+     * @return Unit suffix, "" if none
+     */
+    static const char *unit(const char *code);
+
+    uint32_t receivedCount() const { return received; }
+    uint32_t rejectedCount() const { return rejected; }
+    uint32_t lostCount() const { return lost; }
+
+private:
+    uint32_t received;
+    uint32_t rejected;
+    uint32_t lost;       // Sequence numbers skipped between accepted frames
+    uint16_t lastSeq;
+};
+
+#endif // ECU_FRAME_H
@@ -0,0 +1,51 @@
+// EcuJson.h
+// Non-allocating parser for the /GOLF86/ECU/json batch topic
+
+#ifndef ECU_JSON_H
+#define ECU_JSON_H
+
+#include <Arduino.h>
+#include "Constants.h"
+#include "ChannelTable.h"
+#include "IngestQueues.h"
+
+/**
+ * @brief Parses one flat JSON object of ECU channels per message.
+ *
+ * Example: {"RPM":6250,"TPS":12.5,"BAT":"13.8"}
+ *
+ * Keys are the three letter codes of ecuDataStrings; values are numbers or
+ * strings and are shown as sent, with the same units as the per-channel text
+ * topics. Unknown keys and true/false/null values are skipped; nested objects,
+ * arrays, unquoted values that are not numbers or other malformed input
+ * reject the whole message, so a half-parsed snapshot never reaches the
+ * display.
+ *
+ * The tokenizer reads the payload where it is: no copies, no allocation, one
+ * pass, bounded by the payload length. Used by the network task only.
+ */
+class EcuJsonParser {
+public:
+    EcuJsonParser();
+
+    /**
+     * @brief Parse a payload into display samples
+     * @param bytes Payload (need not be terminated)
+     * @param length Payload length
+     * @param samples Output, room for ECU_CHANNEL_COUNT entries
+     * @param receivedMicros micros() when the message was received
+     * @return Number of samples, 0 if the message was rejected or had no known keys
+     */
+    uint8_t parse(const char *bytes, int length, DisplaySample *samples, uint32_t receivedMicros);
+
+    uint32_t receivedCount() const { return received; }
+    uint32_t rejectedCount() const { return rejected; }
+    uint32_t unknownKeyCount() const { return unknownKeys; }
+
+private:
+    uint32_t received;
+    uint32_t rejected;
+    uint32_t unknownKeys;
+};
+
+#endif // ECU_JSON_H
@@ -0,0 +1,70 @@
+// GpsSerial.h
+// Direct UART ingest from an NMEA GPS receiver, bypassing the MQTT bridge
+
+#ifndef GPS_SERIAL_H
+#define GPS_SERIAL_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "Constants.h"
+#include "NmeaParser.h"
+
+/**
+ * @brief Reads NMEA sentences over UART and feeds the GPS channels.
+ *
+ * A task drains the UART every GPS_READ_INTERVAL_MS through the streaming
+ * parser and hands the channels each RMC, GGA or VTG sentence updated to the
+ * main loop in one batch, formatted like the /GOLF86/GPS/ topics. While
+ * serial data is live, GPS values arriving over MQTT are ignored.
+ */
+class GpsSerial {
+public:
+    GpsSerial();
+
+    /**
+     * @brief Open the UART and start the reading task
+     *
+     * Must be called after networkTask.begin().
+     *
+     * @return true if the task is running
+     */
+    bool begin();
+
+    /**
+     * @brief Check if recent data came from the serial link
+     * @return true if a sentence was parsed within GPS_LIVE_TIMEOUT_MS
+     */
+    bool isLive() const;
+
+    uint32_t sentenceCount() const { return parser.sentenceCount(); }
+    uint32_t checksumErrorCount() const { return parser.checksumErrorCount(); }
+    uint32_t ignoredCount() const { return parser.ignoredCount(); }
+    uint32_t byteCount() const { return bytes; }
+
+    /**
+     * @brief Get the parse and hand-off time of the last sentence
+     * @return Microseconds from the final checksum byte to the queued samples
+     */
+    uint32_t lastSentenceMicros() const { return sentenceMicros; }
+
+private:
+    static void taskLoop(void *parameter);
+
+    /**
+     * @brief Hand the channels updated by the last sentence to the displays
+     * @param completedMicros micros() when the sentence was complete
+     */
+    void deliver(uint32_t completedMicros);
+
+    TaskHandle_t taskHandle;
+    NmeaParser parser;
+    volatile unsigned long lastSentenceMillis;
+    volatile uint32_t bytes;
+    volatile uint32_t sentenceMicros;
+};
+
+// Global instance
+extern GpsSerial gpsSerial;
+
+#endif // GPS_SERIAL_H
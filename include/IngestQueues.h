@@ -0,0 +1,160 @@
+// IngestQueues.h
+// Bounded queues between the network producers and the main loop, one overload policy per class
+
+#ifndef INGEST_QUEUES_H
+#define INGEST_QUEUES_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include "Constants.h"
+#include "ChannelTable.h"
+
+/**
+ * @brief Parsed and formatted channel value on its way to the main display
+ */
+struct DisplaySample {
+    char code[DATA_INDEX_SIZE];       // Three letter channel code
+    char text[CHANNEL_TEXT_SIZE];     // Formatted display text
+    float value;                      // Parsed numeric value
+    uint32_t receivedMicros;          // micros() in the MQTT callback
+};
+
+/**
+ * @brief Message that must reach the main loop (timer values, alerts)
+ */
+struct CriticalMessage {
+    uint8_t kind;                                 // CRITICAL_*
+    char payload[CRITICAL_PAYLOAD_SIZE];
+};
+
+#define CRITICAL_TIMER1_VALUE 0
+#define CRITICAL_TIMER2_VALUE 1
+#define CRITICAL_ALERT 2
+
+/**
+ * @brief Low priority message, shed first under load
+ */
+struct DiagnosticMessage {
+    char name[DIAGNOSTIC_NAME_SIZE];              // Topic below MQTT_DIAG_TOPIC
+    char payload[DIAGNOSTIC_PAYLOAD_SIZE];
+};
+
+/**
+ * @brief Ingest classes, each with its own overload policy
+ */
+enum IngestClass : uint8_t {
+    INGEST_CRITICAL = 0,     // Timer values, alerts: the sender waits, dropped only if the main loop stalls
+    INGEST_DISPLAY,          // Channel values: latest wins per channel
+    INGEST_DIAGNOSTIC,       // Diagnostics: dropped first
+    INGEST_CLASS_COUNT
+};
+
+/**
+ * @brief Counters of one ingest class
+ */
+struct IngestStats {
+    uint32_t received;       // Messages handed to the pipeline
+    uint32_t dropped;        // Lost (diagnostic) or overwritten before use (display)
+    uint16_t highWater;      // Largest backlog seen
+};
+
+/**
+ * @brief Hands incoming messages to the main loop with a policy per class.
+ *
+ * A replayed batch or retained topic storm stays bounded in memory and time:
+ * - critical: FIFO queue; when full the producer waits up to
+ *   INGEST_CRITICAL_WAIT_MS, which also throttles the broker, and only then
+ *   drops and counts the message.
+ * - display: one slot per channel; a newer value overwrites the pending one,
+ *   so the backlog never exceeds CHANNEL_COUNT.
+ * - diagnostic: small FIFO queue, new messages are dropped when it is full or
+ *   when the critical queue is more than half full.
+ *
+ * Producers are the network task and the serial ingest tasks, the consumer is
+ * the main loop. Free of MQTT, so the policies can be load tested on the host.
+ */
+class IngestQueues {
+public:
+    IngestQueues();
+
+    /**
+     * @brief Create the queues and the slot mutex
+     * @return true if all were created
+     */
+    bool beginQueues();
+
+    /**
+     * @brief Store the latest value of a channel for the main display (producer)
+     * @param sample Formatted channel value
+     * @return true if stored without overwriting an unread value
+     */
+    bool pushSample(const DisplaySample &sample);
+
+    /**
+     * @brief Store the latest values of several channels under one lock (producer)
+     * @param samples Formatted channel values
+     * @param count Number of samples
+     * @return Number stored without overwriting an unread value
+     */
+    uint8_t pushSamples(const DisplaySample *samples, uint8_t count);
+
+    /**
+     * @brief Take one pending channel value (main loop)
+     * @param sample Output sample
+     * @return true if a sample was taken
+     */
+    bool popSample(DisplaySample &sample);
+
+    /**
+     * @brief Queue a critical message, waiting a bounded time while the queue is full (producer)
+     * @param message Message to deliver
+     * @return true if queued, false if dropped after the wait
+     */
+    bool pushCritical(const CriticalMessage &message);
+
+    /**
+     * @brief Take the oldest critical message (main loop)
+     * @param message Output message
+     * @return true if a message was taken
+     */
+    bool popCritical(CriticalMessage &message);
+
+    /**
+     * @brief Queue a diagnostic message if there is room (producer)
+     * @param message Message to deliver
+     * @return true if queued, false if shed
+     */
+    bool pushDiagnostic(const DiagnosticMessage &message);
+
+    /**
+     * @brief Take the oldest diagnostic message (main loop)
+     * @param message Output message
+     * @return true if a message was taken
+     */
+    bool popDiagnostic(DiagnosticMessage &message);
+
+    /**
+     * @brief Get the counters of an ingest class
+     * @param ingestClass One of INGEST_*
+     * @return Counters, zero for an invalid class
+     */
+    IngestStats stats(uint8_t ingestClass) const;
+
+private:
+    void noteBacklog(uint8_t ingestClass, uint16_t backlog);
+
+    QueueHandle_t criticalQueue;
+    QueueHandle_t diagnosticQueue;
+
+    // Latest-wins slots of the display class, one per channel table entry
+    SemaphoreHandle_t slotMutex;
+    DisplaySample slots[CHANNEL_COUNT];
+    uint32_t pendingMask;
+    uint8_t pendingCount;
+
+    IngestStats classStats[INGEST_CLASS_COUNT];
+};
+
+#endif // INGEST_QUEUES_H
@@ -0,0 +1,80 @@
+// LatencyStats.h
+// Fixed-size latency histogram with percentile readout
+
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+#include <Arduino.h>
+#include "Constants.h"
+
+/**
+ * @brief Latency histogram with 1 ms buckets.
+ *
+ * Samples above LATENCY_HISTOGRAM_BUCKETS - 1 ms land in the last bucket.
+ * Percentiles are read from the bucket counts, so recording is O(1) and no
+ * sample history is kept.
+ *
+ * start()/finish() measure one in-flight event at a time: a start() before
+ * the previous event finished replaces it (latest wins, like the display it
+ * measures).
+ *
+ * Not thread-safe, record from one task only.
+ */
+class LatencyStats {
+public:
+    LatencyStats();
+
+    /**
+     * @brief Record one latency sample
+     * @param latencyUs Latency in microseconds
+     */
+    void record(uint32_t latencyUs);
+
+    /**
+     * @brief Remember the start time of the event being measured
+     * @param startMicros micros() when the event entered the pipeline
+     */
+    void start(uint32_t startMicros);
+
+    /**
+     * @brief Record the latency of the pending event, if any
+     * @param nowMicros Current micros()
+     */
+    void finish(uint32_t nowMicros);
+
+    /**
+     * @brief Get a percentile of the recorded latencies
+     * @param percent Percentile (1..100)
+     * @return Upper bound of the bucket in ms, 0 if nothing was recorded
+     */
+    uint16_t percentileMs(uint8_t percent) const;
+
+    /**
+     * @brief Get the largest recorded latency
+     * @return Latency in microseconds
+     */
+    uint32_t maxUs() const { return maxLatencyUs; }
+
+    /**
+     * @brief Get the number of recorded samples
+     * @return Sample count
+     */
+    uint32_t count() const { return total; }
+
+    /**
+     * @brief Clear all samples
+     */
+    void reset();
+
+private:
+    uint32_t buckets[LATENCY_HISTOGRAM_BUCKETS];
+    uint32_t total;
+    uint32_t maxLatencyUs;
+    uint32_t pendingMicros;
+    bool pending;
+};
+
+// Latency from MQTT receive to the primary value being drawn on the main display
+extern LatencyStats displayLatency;
+
+#endif // LATENCY_STATS_H
@@ -0,0 +1,149 @@
+// LoopProfiler.h
+// Per-stage timing of the main loop against a budget, with the slowest iterations kept
+
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+#include <Arduino.h>
+#include "Constants.h"
+
+// Stages of one loop() iteration, in order; names in LOOP_STAGE_NAMES (LoopProfiler.cpp)
+#define LOOP_STAGE_WIFI 0        // wifiSetup.update()
+#define LOOP_STAGE_SAMPLES 1     // mqttSetup.processSamples()
+#define LOOP_STAGE_DISPLAY 2     // updateMainDisplay()
+#define LOOP_STAGE_SWITCHES 3    // monitorTimerSwitches()
+#define LOOP_STAGE_WEB 4         // server.handleClient()
+#define LOOP_STAGE_TASKS 5       // taskRegistry.sample()
+#define LOOP_STAGE_COUNT 6
+#define LOOP_STAGE_TOTAL LOOP_STAGE_COUNT // Budget index of the whole iteration
+
+/**
+ * @brief One slow iteration
+ */
+struct LoopIteration {
+    uint32_t millis;                         // When it ended
+    uint32_t totalMicros;                    // Work time, without the pause
+    uint32_t stageMicros[LOOP_STAGE_COUNT];
+    uint8_t worstStage;                      // Largest overrun, or longest stage if none overran
+    uint32_t overrunMicros;                  // How far worstStage was over its budget, 0 = within
+};
+
+/**
+ * @brief Times each stage of the main loop against its budget.
+ *
+ * loop() calls start(), then mark() after each stage and finish() at the end;
+ * each call is one micros() read and a subtraction. finish() counts stages
+ * over their budget, adds the work time to a log2 histogram (LOOP_HISTOGRAM_BUCKETS,
+ * 64 us to 65.5 ms) and keeps the LOOP_SLOWEST_COUNT slowest iterations with
+ * their stage breakdown, so a display stutter can be traced to the stage that
+ * overran.
+ *
+ * Not thread-safe: written and read (through /loop) by the loop task only.
+ */
+class LoopProfiler {
+public:
+    LoopProfiler();
+
+    /**
+     * @brief Start an iteration
+     * @param now Current micros()
+     */
+    void start(uint32_t now) {
+        iterationStart = now;
+        stageStart = now;
+    }
+
+    /**
+     * @brief End a stage, the next one starts now
+     * @param stage LOOP_STAGE_*
+     * @param now Current micros()
+     * @return Stage duration in microseconds
+     */
+    uint32_t mark(uint8_t stage, uint32_t now) {
+        uint32_t duration = now - stageStart;
+        current[stage] = duration;
+        stageStart = now;
+        return duration;
+    }
+
+    /**
+     * @brief End the iteration and check it against the budgets
+     * @param now Current micros()
+     * @return Work time of the iteration in microseconds
+     */
+    uint32_t finish(uint32_t now);
+
+    /**
+     * @brief Set the budget of a stage
+     * @param stage LOOP_STAGE_* or LOOP_STAGE_TOTAL
+     * @param micros Budget in microseconds
+     */
+    void setBudget(uint8_t stage, uint32_t micros);
+
+    /**
+     * @brief Get the budget of a stage
+     * @param stage LOOP_STAGE_* or LOOP_STAGE_TOTAL
+     * @return Budget in microseconds
+     */
+    uint32_t budget(uint8_t stage) const { return budgets[stage]; }
+
+    /**
+     * @brief Clear the counters, maxima, histogram and slowest iterations
+     */
+    void reset();
+
+    /**
+     * @brief Get the name of a stage
+     * @param stage LOOP_STAGE_* or LOOP_STAGE_TOTAL
+     * @return Name for /loop and /metrics
+     */
+    static const char *stageName(uint8_t stage);
+
+    /**
+     * @brief Find a stage by name
+     * @param name Stage name, "total" for the whole iteration
+     * @return LOOP_STAGE_* or LOOP_STAGE_TOTAL, -1 if unknown
+     */
+    static int findStage(const char *name);
+
+    /**
+     * @brief Get a kept slow iteration, slowest first
+     * @param index 0..slowestCount()-1
+     * @return Iteration
+     */
+    const LoopIteration &slowest(uint8_t index) const { return slow[order[index]]; }
+
+    uint8_t slowestCount() const { return slowUsed; }
+    uint32_t iterationCount() const { return iterations; }
+    uint32_t lastMicros(uint8_t stage) const { return last[stage]; }
+    uint32_t maxMicros(uint8_t stage) const { return maxima[stage]; }
+    uint32_t overrunCount(uint8_t stage) const { return overruns[stage]; }
+    uint32_t histogramCount(uint8_t bucket) const { return histogram[bucket]; }
+
+    /**
+     * @brief Get the upper bound of a histogram bucket
+     * @param bucket 0..LOOP_HISTOGRAM_BUCKETS-1
+     * @return Microseconds, 0 for the last (open) bucket
+     */
+    static uint32_t bucketLimit(uint8_t bucket);
+
+private:
+    uint32_t iterationStart;
+    uint32_t stageStart;
+    uint32_t current[LOOP_STAGE_COUNT];      // Stages of the running iteration
+    uint32_t budgets[LOOP_STAGE_COUNT + 1];  // Per stage, then the total
+    uint32_t last[LOOP_STAGE_COUNT + 1];
+    uint32_t maxima[LOOP_STAGE_COUNT + 1];
+    uint32_t overruns[LOOP_STAGE_COUNT + 1];
+    uint32_t histogram[LOOP_HISTOGRAM_BUCKETS];
+    uint32_t iterations;
+
+    LoopIteration slow[LOOP_SLOWEST_COUNT];
+    uint8_t order[LOOP_SLOWEST_COUNT];       // Indexes into slow, slowest first
+    uint8_t slowUsed;
+};
+
+// Global instance
+extern LoopProfiler loopProfiler;
+
+#endif // LOOP_PROFILER_H
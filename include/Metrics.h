@@ -0,0 +1,180 @@
+// Metrics.h
+// Live metrics registry, served as Prometheus text on /metrics
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "Constants.h"
+#include "ChannelTable.h"
+
+// Metric types, as named in the exposition format
+#define METRIC_COUNTER 0
+#define METRIC_GAUGE 1
+#define METRIC_HISTOGRAM 2
+
+/**
+ * @brief Label value of one sample of a labelled metric
+ * @param index Sample index
+ * @return Label value
+ */
+typedef const char *(*MetricLabelFn)(uint8_t index);
+
+/**
+ * @brief Value read when the metrics are scraped
+ * @param index Sample index (0 for an unlabelled metric)
+ * @param value Set to the value
+ * @return false to leave the sample out
+ */
+typedef bool (*MetricReadFn)(uint8_t index, uint32_t &value);
+
+/**
+ * @brief Base of all metrics, linked into the registry on construction.
+ *
+ * Metrics are static objects, registered before setup() runs and never
+ * removed, so the registry needs no lock. Values are 32-bit atomics updated
+ * with relaxed ordering from any task; a scrape may see one metric a few
+ * updates ahead of another, which is fine for rates.
+ */
+class Metric {
+public:
+    Metric(const char *name, const char *help, uint8_t type);
+    virtual ~Metric() {}
+
+    /**
+     * @brief Append all registered metrics in the text exposition format
+     * @param out Response text
+     */
+    static void writeAll(String &out);
+
+protected:
+    /**
+     * @brief Append the samples of this metric
+     * @param out Response text
+     */
+    virtual void writeSamples(String &out) const = 0;
+
+    /**
+     * @brief Append one sample line
+     * @param out Response text
+     * @param suffix Appended to the name ("" for none)
+     * @param label Label name, nullptr for none
+     * @param labelValue Label value
+     * @param value Sample value
+     */
+    void writeSample(String &out, const char *suffix, const char *label, const char *labelValue,
+                     uint32_t value) const;
+
+    const char *name;
+    const char *help;
+    uint8_t type;
+
+private:
+    Metric *next;
+    static Metric *head;
+};
+
+/**
+ * @brief Monotonic counter
+ */
+class MetricCounter : public Metric {
+public:
+    MetricCounter(const char *name, const char *help) : Metric(name, help, METRIC_COUNTER), value(0) {}
+
+    void add(uint32_t amount = 1) { value.fetch_add(amount, std::memory_order_relaxed); }
+
+protected:
+    void writeSamples(String &out) const override;
+
+private:
+    std::atomic<uint32_t> value;
+};
+
+/**
+ * @brief One counter per channel of the channel table, labelled with the channel code
+ */
+class MetricChannelCounter : public Metric {
+public:
+    MetricChannelCounter(const char *name, const char *help);
+
+    /**
+     * @brief Count for a channel
+     * @param index Channel table index, ignored if out of range
+     * @param amount Increment
+     */
+    void add(int index, uint32_t amount = 1) {
+        if (index >= 0 && index < CHANNEL_COUNT) {
+            values[index].fetch_add(amount, std::memory_order_relaxed);
+        }
+    }
+
+protected:
+    void writeSamples(String &out) const override;
+
+private:
+    std::atomic<uint32_t> values[CHANNEL_COUNT];
+};
+
+/**
+ * @brief Counter or gauge read from existing state when scraped.
+ *
+ * Used for values other modules already keep (reconnects, heap, stacks), so
+ * nothing is updated twice.
+ */
+class MetricCallback : public Metric {
+public:
+    /**
+     * @param name Metric name
+     * @param help Help text
+     * @param type METRIC_COUNTER or METRIC_GAUGE
+     * @param read Reads sample index 0..count-1
+     * @param label Label name, nullptr for a single unlabelled sample
+     * @param labelAt Label value of a sample
+     * @param count Number of samples
+     */
+    MetricCallback(const char *name, const char *help, uint8_t type, MetricReadFn read,
+                   const char *label = nullptr, MetricLabelFn labelAt = nullptr, uint8_t count = 1)
+        : Metric(name, help, type), read(read), label(label), labelAt(labelAt), count(count) {}
+
+protected:
+    void writeSamples(String &out) const override;
+
+private:
+    MetricReadFn read;
+    const char *label;
+    MetricLabelFn labelAt;
+    uint8_t count;
+};
+
+/**
+ * @brief Histogram with fixed microsecond buckets (METRIC_DURATION_BUCKETS_US).
+ *
+ * _sum is kept in 32 bits and wraps after ~71 minutes of accumulated time,
+ * which rate() reads as a counter reset.
+ */
+class MetricHistogram : public Metric {
+public:
+    MetricHistogram(const char *name, const char *help);
+
+    /**
+     * @brief Record one duration
+     * @param micros Duration in microseconds
+     */
+    void record(uint32_t micros);
+
+protected:
+    void writeSamples(String &out) const override;
+
+private:
+    std::atomic<uint32_t> buckets[METRIC_HISTOGRAM_BUCKETS + 1]; // Last one is +Inf
+    std::atomic<uint32_t> sum;
+};
+
+// Instruments updated across modules
+extern MetricChannelCounter channelMessages;     // Network task, per received channel value
+extern MetricHistogram callbackDuration;         // Network and UDP tasks, primary message handlers
+extern MetricHistogram displayUpdateDuration;    // Main loop, updateMainDisplay()
+extern MetricHistogram loopDuration;             // Main loop, one iteration without the pause
+
+#endif // METRICS_H
@@ -4,23 +4,53 @@
 #include <Arduino.h>
 #include <MQTT.h>
 #include <WiFiClient.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include "WiFiSetup.h"
+#include "SubscriptionSet.h"
+#include "BrokerList.h"
+#include "PublishBuffer.h"
+#include "EcuFrame.h"
+#include "EcuJson.h"
 
 /**
  * @brief Global constants for MQTT client names and topics.
  */
 extern const char *PRIMARY_MQTT_CLIENT_NAME;
 extern const char *SECONDARY_MQTT_CLIENT_NAME;
-extern const char *MQTT_TOPIC_BASE;
+extern const char MQTT_ECU_TOPIC[];
+extern const char MQTT_ECU_FRAME_TOPIC[];
+extern const char MQTT_ECU_JSON_TOPIC[];
+extern const char MQTT_GPS_TOPIC[];
+extern const char MQTT_ALERT_TOPIC[];
+extern const char MQTT_DIAG_TOPIC[];
 
 /**
  * @brief Global instances of WiFiSetup, message flags, and message buffers.
  */
 extern WiFiSetup wifiSetup;
 extern bool newMessageAvailable;
+extern uint32_t newMessageSeq;
 extern char newMessage[128];
 extern volatile bool newMessageAvailable2;
 extern volatile char newMessage2[128];
+extern char dataIndex[];
+
+/**
+ * @brief Connection state of one MQTT client, owned by the network task.
+ */
+struct MqttLinkState
+{
+    unsigned long nextAttemptMillis = 0; // Earliest next connect attempt
+    unsigned long backoffMs = MQTT_BACKOFF_MIN_MS; // Delay after the next failure
+    unsigned long lostMillis = 0;        // When the connection was lost (0 = boot)
+    unsigned long connectedMillis = 0;   // When the connection was established
+    bool wasConnected = false;
+    bool awaitingData = false;           // Connected, no message received yet
+    uint32_t reconnects = 0;             // Successful connects after a loss
+    uint32_t timeToDataMs = 0;           // Last outage: loss to first message
+    uint32_t connectToDataMs = 0;        // Last outage: connect to first message
+};
 
 /**
  * @brief Class for setting up and managing MQTT communication.
@@ -35,6 +65,23 @@ public:
      */
     static void MqttMessageReceivedPrimary(String &topic, String &payload);
 
+    /**
+     * @brief Raw callback of the primary channel, decodes ECU batches and passes text topics on.
+     * @param client The receiving client.
+     * @param topic The MQTT topic.
+     * @param bytes The message payload.
+     * @param length Payload length.
+     */
+    static void MqttMessageReceivedPrimaryRaw(MQTTClient *client, char topic[], char bytes[], int length);
+
+    /**
+     * @brief Feeds a message to the primary channel handlers (MQTT from the network task, UDP from its own).
+     * @param topic The MQTT topic.
+     * @param bytes The message payload, followed by a zero byte.
+     * @param length Payload length.
+     */
+    static void handlePrimaryMessage(const char *topic, const char *bytes, int length);
+
     /**
      * @brief Callback function for receiving MQTT messages on the secondary channel.
      * @param topic The MQTT topic.
@@ -69,6 +116,118 @@ public:
      */
     void connect();
 
+    /**
+     * @brief Registers a display user of a channel, subscribing the primary client on the first one.
+     * @param code Three letter channel code.
+     */
+    void subscribeChannel(const char *code);
+
+    /**
+     * @brief Unregisters a display user of a channel, unsubscribing the primary client after the last one.
+     * @param code Three letter channel code.
+     */
+    void unsubscribeChannel(const char *code);
+
+    /**
+     * @brief Publishes on the primary client from any task.
+     *
+     * Queued for the network task once it runs, so callers never touch the
+     * MQTTClient from another task.
+     * @param topic The MQTT topic.
+     * @param payload The message payload.
+     * @param periodic True if a newer publish on the topic supersedes this one
+     *                 (collapsed while the broker is unreachable).
+     */
+    void publish(const char *topic, const char *payload, bool periodic = false);
+
+    /**
+     * @brief Publishes an ECU snapshot on MQTT_ECU_FRAME_TOPIC from any task.
+     *
+     * Latest wins: a frame not sent yet is replaced. Dropped while the
+     * primary client is disconnected.
+     * @param frame Packed ECU frame.
+     */
+    void publishEcuFrame(const EcuFrame &frame);
+
+    /**
+     * @brief Subscribes a client to a topic from any task.
+     * @param client mqtt or mqtt2.
+     * @param topic The MQTT topic.
+     */
+    void subscribe(MQTTClient &client, const char *topic);
+
+    /**
+     * @brief Unsubscribes a client from a topic from any task.
+     * @param client mqtt or mqtt2.
+     * @param topic The MQTT topic.
+     */
+    void unsubscribe(MQTTClient &client, const char *topic);
+
+    /**
+     * @brief Runs the publish/subscribe requests queued by other tasks (network task).
+     */
+    void processCommands();
+
+    /**
+     * @brief Applies the messages queued by the network task (main loop).
+     *
+     * Critical messages first, then the pending channel values, then at most
+     * INGEST_DIAGNOSTIC_BUDGET diagnostics.
+     */
+    void processSamples();
+
+    /**
+     * @brief Gets the connection state of the primary client.
+     * @return Link state, updated by the network task.
+     */
+    const MqttLinkState &primaryLinkState() const { return primaryLink; }
+
+    /**
+     * @brief Gets the connection state of the secondary client.
+     * @return Link state, updated by the network task.
+     */
+    const MqttLinkState &secondaryLinkState() const { return secondaryLink; }
+
+    /**
+     * @brief Gets the broker failover list.
+     * @return Broker list, updated by the network task.
+     */
+    const BrokerList &brokerList() const { return brokers; }
+
+    /**
+     * @brief Gets the store-and-forward buffer of the primary client.
+     * @return Publish buffer, updated by the network task.
+     */
+    const PublishBuffer &publishBuffer() const { return outbox; }
+
+    /**
+     * @brief Gets the ECU frame decoder of the primary client.
+     * @return Decoder with the frame counters, updated by the network task.
+     */
+    const EcuFrameDecoder &ecuFrameDecoder() const { return ecuFrames; }
+
+    /**
+     * @brief Gets the ECU JSON parser of the primary client.
+     * @return Parser with the message counters, updated by the network task.
+     */
+    const EcuJsonParser &ecuJsonParser() const { return ecuJson; }
+
+    /**
+     * @brief Runs a publish/subscribe/unsubscribe on a client, recording subscriptions.
+     *
+     * Called by the task that owns the clients. Subscriptions are recorded even
+     * while disconnected and sent on the next connect; publishes on the primary
+     * client are held until it is back.
+     * @param client mqtt or mqtt2.
+     * @param type NET_CMD_*.
+     * @param topic The MQTT topic.
+     * @param payload Payload for NET_CMD_PUBLISH.
+     * @param createdMillis millis() when the publish was requested.
+     * @param periodic True if a newer publish on the topic supersedes this one.
+     */
+    void runCommand(MQTTClient &client, uint8_t type, const char *topic, const char *payload,
+                    unsigned long createdMillis, bool periodic = false);
+
     /**
      * @brief Gets the MQTT client for primary channel.
      * @return Reference to the MQTT client.
@@ -86,6 +245,27 @@ private:
     WiFiClient net;
     WiFiClient net2;
 
+    // Short sessions that check whether the first broker is back (probeBroker)
+    MQTTClient probeClient;
+    WiFiClient probeNet;
+
+    SubscriptionSet primarySubscriptions;
+    SubscriptionSet secondarySubscriptions;
+    MqttLinkState primaryLink;
+    MqttLinkState secondaryLink;
+    BrokerList brokers;
+    PublishBuffer outbox;
+    EcuFrameDecoder ecuFrames;
+    EcuJsonParser ecuJson;
+
+    // Held while a primary message is handled, the network and UDP tasks share the handlers
+    SemaphoreHandle_t handlerMutex = NULL;
+
+    // ECU frame waiting for the network task (publishEcuFrame)
+    portMUX_TYPE frameLock = portMUX_INITIALIZER_UNLOCKED;
+    EcuFrame pendingFrame;
+    bool framePending = false;
+
     /**
      * @brief Static variables for managing LED blinking.
      */
@@ -106,6 +286,89 @@ private:
      */
     static void handleEcuPayload(const String &lastSegment, String &payload);
 
+    /**
+     * @brief Decodes a packed ECU frame and hands all channels to the display in one batch.
+     * @param bytes The message payload.
+     * @param length Payload length.
+     */
+    static void handleEcuFrame(const char *bytes, int length);
+
+    /**
+     * @brief Parses an ECU JSON batch and hands its channels to the display in one batch.
+     * @param bytes The message payload.
+     * @param length Payload length.
+     */
+    static void handleEcuJson(const char *bytes, int length);
+
+    /**
+     * @brief Hands a batch of channel values to the display, or applies them before the network task runs.
+     * @param samples Formatted channel values.
+     * @param count Number of samples.
+     */
+    static void deliverSamples(const DisplaySample *samples, uint8_t count);
+
+    /**
+     * @brief Hands a formatted channel value to the main display consumers.
+     * @param code Three letter channel code.
+     * @param text Formatted display text.
+     * @param value Parsed numeric value.
+     * @param receivedMicros micros() when the message was received.
+     */
+    static void applySample(const char *code, const char *text, float value, uint32_t receivedMicros);
+
+    /**
+     * @brief Applies a timer value or alert received from the broker.
+     * @param kind CRITICAL_*.
+     * @param payload The message payload.
+     */
+    static void applyCritical(uint8_t kind, const char *payload);
+
+    /**
+     * @brief Subscribes the primary client to the timer, alert and diagnostic topics.
+     */
+    void subscribeFixedTopics();
+
+    /**
+     * @brief Reconnects a client with backoff, restores its subscriptions and runs its loop.
+     * @param client mqtt or mqtt2.
+     * @param clientId MQTT client id.
+     * @param label Name for the log and boot timeline (string literal).
+     * @param link Connection state of the client.
+     * @param subscriptions Topics to restore after connecting.
+     * @param linkUp True if WiFi is connected.
+     * @param now Current millis().
+     * @return 1 if connected by this call, -1 if a connect attempt failed, 0 otherwise.
+     */
+    int maintainClient(MQTTClient &client, const char *clientId, const char *label,
+                       MqttLinkState &link, SubscriptionSet &subscriptions, bool linkUp, unsigned long now);
+
+    /**
+     * @brief Points both clients at another broker, disconnecting them if needed.
+     * @param index Broker index in the failover list.
+     * @param outageStart millis() when the connection was lost, for the switchover time.
+     * @param now Current millis().
+     */
+    void useBroker(uint8_t index, unsigned long outageStart, unsigned long now);
+
+    /**
+     * @brief Sends up to PUBLISH_FLUSH_BATCH held publishes, oldest first.
+     */
+    void flushOutbox();
+
+    /**
+     * @brief Checks if a broker accepts an MQTT session, without touching the active one.
+     * @param index Broker index in the failover list.
+     * @return True if the broker sent CONNACK within MQTT_BROKER_PROBE_TIMEOUT_MS.
+     */
+    bool probeBroker(uint8_t index);
+
+    /**
+     * @brief Records the first message after a (re)connect for the time-to-data metric.
+     * @param link Connection state of the client that received it.
+     * @param label Name for the log.
+     */
+    static void noteData(MqttLinkState &link, const char *label);
+
     /**
      * @brief Checks if the time string is in a valid format.
      * @param timeString The time string to check.
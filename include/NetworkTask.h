@@ -0,0 +1,132 @@
+// NetworkTask.h
+// Dedicated FreeRTOS task for MQTT I/O and the ingest queues to the display consumers
+
+#ifndef NETWORK_TASK_H
+#define NETWORK_TASK_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "Constants.h"
+#include "IngestQueues.h"
+
+/**
+ * @brief Outbound MQTT operation requested by another task
+ */
+struct NetCommand {
+    uint8_t type;                                 // NET_CMD_*
+    bool secondary;                               // Use the secondary client
+    bool periodic;                                // Publish superseded by the next one on its topic
+    char topic[MQTT_TOPIC_BUFFER_SIZE];
+    char payload[MQTT_COMMAND_PAYLOAD_SIZE];
+    unsigned long createdMillis;                  // When the request was made
+    uint32_t sequence;                            // Posting order, set by postCommand()
+};
+
+#define NET_CMD_PUBLISH 0
+#define NET_CMD_SUBSCRIBE 1
+#define NET_CMD_UNSUBSCRIBE 2
+
+/**
+ * @brief Runs both MQTT clients in their own pinned task.
+ *
+ * The task owns the MQTTClient instances: reconnects, loop() and every
+ * publish/subscribe happen here. Incoming messages are classified and handed
+ * to the main loop through the inherited IngestQueues.
+ *
+ * Publish/subscribe requests from other tasks go through a command queue.
+ * Posting never blocks: while the queue is full (the task is stuck in a
+ * connect) requests go to a small overflow list, and only when that is full
+ * too are they dropped and counted. Periodic publishes (running timer value
+ * and state) bypass both: each topic has one latest-wins slot, so a burst of
+ * them never fills the queue. The task runs slots, queue and overflow list in
+ * posting order.
+ */
+class NetworkTask : public IngestQueues {
+public:
+    NetworkTask();
+
+    /**
+     * @brief Create the queues and start the task
+     * @return true if the task is running
+     */
+    bool begin();
+
+    /**
+     * @brief Check if the task is running
+     * @return true once begin() succeeded
+     */
+    bool isRunning() const { return taskHandle != NULL; }
+
+    /**
+     * @brief Check if the caller is the network task
+     * @return true when called from the task itself
+     */
+    bool isCurrentTask() const { return taskHandle != NULL && xTaskGetCurrentTaskHandle() == taskHandle; }
+
+    /**
+     * @brief Hand an MQTT operation to the network task without blocking (any task but the network task)
+     * @param command Operation to run
+     * @return true if queued, held in the overflow list or stored in its periodic slot
+     */
+    bool postCommand(const NetCommand &command);
+
+    /**
+     * @brief Take the oldest queued, held or pending periodic operation (network task only)
+     * @param command Output operation
+     * @return true if an operation was taken
+     */
+    bool popCommand(NetCommand &command);
+
+    /**
+     * @brief Get the task handle
+     * @return Task handle, NULL if not running
+     */
+    TaskHandle_t handle() const { return taskHandle; }
+
+    uint32_t commandsSuperseded() const { return superseded.load(std::memory_order_relaxed); }
+    uint32_t commandsOverflowed() const { return overflowed.load(std::memory_order_relaxed); }
+    uint32_t commandsDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    static void taskLoop(void *parameter);
+
+    /**
+     * @brief Store a periodic publish in the slot of its topic
+     * @param command Sequenced publish
+     * @return false if all slots belong to other topics
+     */
+    bool storePeriodic(const NetCommand &command);
+
+    /**
+     * @brief Hold a command in the overflow list while the queue is full
+     * @param command Sequenced operation
+     * @return false if the list is full as well
+     */
+    bool storeOverflow(const NetCommand &command);
+
+    TaskHandle_t taskHandle;
+    QueueHandle_t commandQueue;
+    std::atomic<uint32_t> nextSequence;
+
+    // Latest-wins slots of periodic publishes, bound to their topic on first
+    // use, and the overflow ring; both under the same lock
+    portMUX_TYPE periodicLock = portMUX_INITIALIZER_UNLOCKED;
+    NetCommand periodicSlots[NETWORK_PERIODIC_SLOT_COUNT];
+    uint8_t periodicPending;          // Bit per slot
+    NetCommand overflow[NETWORK_COMMAND_OVERFLOW_LENGTH];
+    uint8_t overflowHead;
+    uint8_t overflowCount;
+
+    std::atomic<uint32_t> superseded; // Periodic publishes replaced before they were sent
+    std::atomic<uint32_t> overflowed; // Posts held in the overflow list
+    std::atomic<uint32_t> dropped;    // Posts lost with queue and overflow list full
+};
+
+// Global network task
+extern NetworkTask networkTask;
+
+#endif // NETWORK_TASK_H
@@ -0,0 +1,89 @@
+// NmeaParser.h
+// Byte-at-a-time NMEA 0183 parser for RMC, GGA and VTG sentences
+
+#ifndef NMEA_PARSER_H
+#define NMEA_PARSER_H
+
+#include <Arduino.h>
+#include "Constants.h"
+
+// Fields updated by a sentence (GpsFix::updated)
+#define GPS_FIELD_TIME     0x01
+#define GPS_FIELD_DATE     0x02
+#define GPS_FIELD_POSITION 0x04
+#define GPS_FIELD_SPEED    0x08
+#define GPS_FIELD_COURSE   0x10
+#define GPS_FIELD_ALTITUDE 0x20
+#define GPS_FIELD_QUALITY  0x40
+
+/**
+ * @brief Latest navigation data assembled from the parsed sentences
+ */
+struct GpsFix {
+    uint8_t hour, minute, second;   // UTC
+    uint8_t day, month;
+    uint16_t year;
+    double latitude;                // Degrees, south negative
+    double longitude;               // Degrees, west negative
+    float speedKmh;
+    float course;                   // Degrees true
+    float altitude;                 // Meters above mean sea level
+    uint8_t quality;                // GGA fix quality (0 = no fix)
+    uint8_t satellites;
+    uint8_t updated;                // GPS_FIELD_* set by the last sentence
+};
+
+/**
+ * @brief Streaming NMEA parser.
+ *
+ * Bytes are collected into one fixed sentence buffer; once the checksum
+ * matches, the fields are split in place and RMC, GGA and VTG (any talker,
+ * e.g. $GP or $GN) update the fix. Other sentences, bad checksums and
+ * overlong lines are counted and skipped. No allocation, no I/O.
+ */
+class NmeaParser {
+public:
+    NmeaParser();
+
+    /**
+     * @brief Feed one received byte
+     * @param c Byte from the receiver
+     * @return true when a sentence updated the fix (see fix().updated)
+     */
+    bool feed(char c);
+
+    /**
+     * @brief Get the latest fix
+     * @return Fix, updated in place by feed()
+     */
+    const GpsFix &fix() const { return current; }
+
+    uint32_t sentenceCount() const { return sentences; }
+    uint32_t checksumErrorCount() const { return checksumErrors; }
+    uint32_t ignoredCount() const { return ignored; }
+
+private:
+    /**
+     * @brief Split a checked sentence into fields and apply it
+     * @return true if it was RMC, GGA or VTG
+     */
+    bool apply();
+
+    void applyRmc(char **fields, uint8_t count);
+    void applyGga(char **fields, uint8_t count);
+    void applyVtg(char **fields, uint8_t count);
+
+    char buffer[NMEA_MAX_SENTENCE];
+    uint8_t length;
+    uint8_t checksum;          // XOR of the characters between '$' and '*'
+    uint8_t expected;          // Checksum sent after '*'
+    int8_t checksumDigits;     // -1 before '*', then 0..2
+    bool inSentence;
+
+    GpsFix current;
+    uint32_t sentences;
+    uint32_t checksumErrors;
+    uint32_t ignored;
+};
+
+#endif // NMEA_PARSER_H
@@ -0,0 +1,76 @@
+// PageScheduler.h
+// Rotating page list for the primary channel of the main display
+
+#ifndef PAGE_SCHEDULER_H
+#define PAGE_SCHEDULER_H
+
+#include <Arduino.h>
+#include "Constants.h"
+
+/**
+ * @brief Rotates the primary display channel through a configurable page list.
+ *
+ * Pages are stored in Config (pages, pageCount, pageIntervalS). Every page
+ * channel stays subscribed while it is in the list, so a page switch only
+ * re-reads the channel table and never waits for a new MQTT message.
+ *
+ * Pages advance on a timer (pageIntervalS > 0) or on an encoder click outside
+ * the menu when more than one page is configured.
+ */
+class PageScheduler {
+public:
+    PageScheduler();
+
+    /**
+     * @brief Subscribe all page channels and show the first page
+     */
+    void begin();
+
+    /**
+     * @brief Advance the page on the rotation timer
+     * @param now Current millis()
+     */
+    void update(unsigned long now);
+
+    /**
+     * @brief Show the next page
+     */
+    void next();
+
+    /**
+     * @brief Check if rotation is possible (more than one page)
+     * @return true if there is more than one page
+     */
+    bool isRotating() const;
+
+    /**
+     * @brief Get the index of the page currently shown
+     * @return Page index
+     */
+    uint8_t current() const { return currentPage; }
+
+    /**
+     * @brief Assign a channel to the page currently shown (menu P:ECU / P:GPS)
+     * @param code Three letter channel code
+     */
+    void assignCurrent(const char *code);
+
+    /**
+     * @brief Change the number of pages in the rotation
+     * @param count Number of pages (1..MAX_PAGES)
+     */
+    void setPageCount(uint8_t count);
+
+private:
+    void show(uint8_t page);
+    void subscribePages();
+
+    uint8_t currentPage;
+    unsigned long lastSwitchMillis;
+    bool started;
+};
+
+// Global page scheduler for the main display
+extern PageScheduler pageScheduler;
+
+#endif // PAGE_SCHEDULER_H
@@ -7,6 +7,7 @@
 #include <Arduino.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
+#include "TaskRegistry.h"
 
 // Enable/disable performance monitoring
 // #define ENABLE_PERFORMANCE_MONITORING
@@ -53,7 +54,12 @@ public:
     
     static void printAllStacks() {
         Serial.println("\n=== Stack Usage Report ===");
-        // Note: This requires task handles to be stored globally
+        for (uint8_t i = 0; i < TASK_REGISTRY_SIZE; i++) {
+            TaskRecord record;
+            if (taskRegistry.get(i, record)) {
+                printTaskStack(record.name, record.handle);
+            }
+        }
         Serial.printf("Free heap: %u bytes\n", ESP.getFreeHeap());
         Serial.printf("Min free heap: %u bytes\n", ESP.getMinFreeHeap());
         Serial.printf("Heap size: %u bytes\n", ESP.getHeapSize());
@@ -0,0 +1,92 @@
+// PublishBuffer.h
+// Store-and-forward ring for publishes made while the broker is unreachable
+
+#ifndef PUBLISH_BUFFER_H
+#define PUBLISH_BUFFER_H
+
+#include <Arduino.h>
+#include "Constants.h"
+
+/**
+ * @brief One held publish
+ */
+struct HeldPublish {
+    char topic[MQTT_TOPIC_BUFFER_SIZE];
+    char payload[MQTT_COMMAND_PAYLOAD_SIZE];
+    unsigned long createdMillis;      // When the event happened
+    bool periodic;                    // Superseded by a newer publish on the same topic
+};
+
+/**
+ * @brief Bounded FIFO of publishes, flushed in order once the client is back.
+ *
+ * Periodic topics (the running timer value) are collapsed: a new value
+ * replaces the previous one unless an event was held after it, so a long outage
+ * keeps one value between two start/pause events instead of ten per second.
+ * When the ring is full the oldest periodic entry is dropped first, then the
+ * oldest entry.
+ *
+ * Not thread-safe: used by the network task only.
+ */
+class PublishBuffer {
+public:
+    PublishBuffer();
+
+    /**
+     * @brief Hold a publish
+     * @param topic MQTT topic
+     * @param payload Message payload
+     * @param createdMillis millis() when the event happened
+     * @param periodic true for topics where only the latest value matters
+     */
+    void push(const char *topic, const char *payload, unsigned long createdMillis, bool periodic);
+
+    /**
+     * @brief Get the oldest held publish without removing it
+     * @return Entry, nullptr if empty
+     */
+    const HeldPublish *front() const;
+
+    /**
+     * @brief Remove the oldest held publish after it was sent
+     * @param now Current millis(), for the age statistics
+     */
+    void pop(unsigned long now);
+
+    /**
+     * @brief Check if nothing is held
+     * @return true if empty
+     */
+    bool empty() const { return used == 0; }
+
+    /**
+     * @brief Get the number of held publishes
+     * @return Entry count
+     */
+    uint8_t count() const { return used; }
+
+    uint32_t heldCount() const { return held; }
+    uint32_t collapsedCount() const { return collapsed; }
+    uint32_t droppedCount() const { return dropped; }
+    uint32_t forwardedCount() const { return forwarded; }
+
+    /**
+     * @brief Get the largest delay of a forwarded publish
+     * @return Milliseconds from the event to sending it
+     */
+    uint32_t maxDelayMs() const { return maxDelay; }
+
+private:
+    void removeAt(uint8_t position);
+
+    HeldPublish entries[PUBLISH_BUFFER_LENGTH];
+    uint8_t head;                     // Oldest entry
+    uint8_t used;
+    uint32_t held;
+    uint32_t collapsed;
+    uint32_t dropped;
+    uint32_t forwarded;
+    uint32_t maxDelay;
+};
+
+#endif // PUBLISH_BUFFER_H
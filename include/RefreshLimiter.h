@@ -0,0 +1,86 @@
+// RefreshLimiter.h
+// Refresh-rate cap and skip-if-unchanged filter for a display
+
+#ifndef REFRESH_LIMITER_H
+#define REFRESH_LIMITER_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Bounds how often a display is redrawn.
+ *
+ * Producers only overwrite the latest message and bump its sequence number;
+ * the display task asks ready() before reading it, so every message that
+ * arrives within one refresh interval is coalesced into the latest one.
+ * accept() then compares a hash of the text with the frame already shown and
+ * skips the redraw if nothing visible changed.
+ *
+ * Counters are written by the owning display task only and may be read from
+ * other tasks for diagnostics.
+ */
+class RefreshLimiter {
+public:
+    /**
+     * @brief Constructor
+     * @param maxRateHz Maximum refresh rate, 0 for no cap
+     */
+    explicit RefreshLimiter(uint16_t maxRateHz);
+
+    /**
+     * @brief Change the maximum refresh rate
+     * @param maxRateHz Maximum refresh rate, 0 for no cap
+     */
+    void setMaxRate(uint16_t maxRateHz);
+
+    /**
+     * @brief Check if the refresh interval since the last redraw has passed
+     * @param now Current millis()
+     * @return true if the display may be redrawn
+     */
+    bool ready(unsigned long now) const;
+
+    /**
+     * @brief Account for the latest message and decide if it must be drawn
+     * @param seq Sequence number of the message (one per received update)
+     * @param text Message text
+     * @param now Current millis()
+     * @return true if the text differs from the frame shown and must be drawn
+     */
+    bool accept(uint32_t seq, const char *text, unsigned long now);
+
+    /**
+     * @brief Record a redraw that did not go through accept()
+     * @param now Current millis()
+     */
+    void markRendered(unsigned long now);
+
+    /**
+     * @brief Forget the frame shown, so the next accept() always draws
+     */
+    void invalidate();
+
+    uint32_t receivedCount() const { return received; }
+    uint32_t coalescedCount() const { return coalesced; }
+    uint32_t unchangedCount() const { return unchanged; }
+    uint32_t renderedCount() const { return rendered; }
+
+private:
+    static uint32_t hashText(const char *text);
+
+    uint16_t minIntervalMs;
+    unsigned long lastRenderMillis;
+    uint32_t lastSeq;
+    uint32_t lastHash;
+    bool hashValid;
+
+    volatile uint32_t received;     // Updates produced up to the last one read
+    volatile uint32_t coalesced;    // Updates replaced before they were drawn
+    volatile uint32_t unchanged;    // Updates skipped as identical to the frame shown
+    volatile uint32_t rendered;     // Redraws
+};
+
+// Refresh limiters of the main and secondary displays
+extern RefreshLimiter mainRefresh;
+extern RefreshLimiter secondaryRefresh;
+
+#endif // REFRESH_LIMITER_H
@@ -20,6 +20,7 @@ extern volatile char secondaryScreenMode[];
 extern volatile bool newMessageAvailable2;
 extern volatile char newMessage2[128];
 extern const char *WELCOME_MSG2;
+extern volatile uint32_t secondaryStaleEvents;
 
 /**
  * @brief Scrolls the characters "GOLF 86" from left to right on the 8-digit display.
@@ -104,8 +105,9 @@ void displayTime(int hours, int minutes, int seconds, int hundredths);
  * @param minutes Minutes to display.
  * @param seconds Seconds to display.
  * @param hundredths Hundredths of seconds to display.
+ * @param periodic True for the running value, false for a lap time.
  */
-void setTimeToMqtt(int timer, int hours, int minutes, int seconds, int hundredths);
+void setTimeToMqtt(int timer, int hours, int minutes, int seconds, int hundredths, bool periodic = false);
 
 /**
  * @brief Displays the timer value in a formatted time.
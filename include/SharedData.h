@@ -52,6 +52,7 @@ class ThreadSafeMessage {
 private:
     char message[MESSAGE_BUFFER_SIZE];
     volatile bool available;
+    uint32_t seq;               // Incremented by every setMessage()
     SemaphoreHandle_t mutex;
 
 public:
@@ -60,6 +61,7 @@ public:
     
     bool setMessage(const char* newMessage);
     bool getMessage(char* buffer, size_t bufferSize);
+    bool takeMessage(char* buffer, size_t bufferSize, uint32_t* messageSeq);
     bool isAvailable();
     void clearAvailable();
     void setAvailable(bool value);
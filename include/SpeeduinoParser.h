@@ -0,0 +1,77 @@
+// SpeeduinoParser.h
+// Byte-wise parser of Speeduino realtime data responses
+
+#ifndef SPEEDUINO_PARSER_H
+#define SPEEDUINO_PARSER_H
+
+#include <Arduino.h>
+#include "Constants.h"
+#include "ChannelTable.h"
+
+/**
+ * @brief Parses the response to a Speeduino 'A' or 'n' realtime data command.
+ *
+ * 'A' answers with the 'A' echo and SPEEDUINO_A_PAYLOAD_SIZE bytes; 'n'
+ * answers with 'n', 0x32, a length byte and that many bytes. Both carry the
+ * same realtime data layout, which values() maps to the ecuDataStrings
+ * channels (NER is not part of it).
+ *
+ * Pure byte handling without I/O, so it can be fed from the UART task or, on
+ * a host, from a pseudo-terminal replaying captured responses.
+ */
+class SpeeduinoParser {
+public:
+    SpeeduinoParser();
+
+    /**
+     * @brief Expect the response to a command that was just sent
+     * @param command 'A' or 'n'
+     */
+    void begin(char command);
+
+    /**
+     * @brief Feed one received byte
+     * @param byte Byte from the ECU
+     * @return true when the response is complete
+     */
+    bool feed(uint8_t byte);
+
+    /**
+     * @brief Check if a complete response is available
+     * @return true after feed() returned true, until the next begin()
+     */
+    bool complete() const { return state == STATE_DONE; }
+
+    /**
+     * @brief Convert the complete response to channel values
+     * @param values Output, ECU_CHANNEL_COUNT values in ecuDataStrings order,
+     *               scaled like EcuFrame (one decimal channels times 10)
+     * @return Bit mask of the channels present in the response, 0 if none
+     */
+    uint32_t values(int16_t *values) const;
+
+    /**
+     * @brief Get the number of bytes ignored while waiting for a response header
+     * @return Byte count since boot
+     */
+    uint32_t junkCount() const { return junk; }
+
+private:
+    enum State : uint8_t {
+        STATE_IDLE,
+        STATE_ECHO,      // Waiting for the command echo
+        STATE_TYPE,      // 'n': waiting for the 0x32 packet type
+        STATE_LENGTH,    // 'n': waiting for the length byte
+        STATE_PAYLOAD,
+        STATE_DONE
+    };
+
+    char command;
+    State state;
+    uint8_t payload[SPEEDUINO_MAX_PAYLOAD_SIZE];
+    uint8_t expected;
+    uint8_t used;
+    uint32_t junk;
+};
+
+#endif // SPEEDUINO_PARSER_H
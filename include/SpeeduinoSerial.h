@@ -0,0 +1,81 @@
+// SpeeduinoSerial.h
+// Direct UART ingest from the Speeduino ECU, bypassing the MQTT bridge
+
+#ifndef SPEEDUINO_SERIAL_H
+#define SPEEDUINO_SERIAL_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "Constants.h"
+#include "SpeeduinoParser.h"
+
+/**
+ * @brief Polls the Speeduino realtime data over UART and feeds the displays.
+ *
+ * A task sends SPEEDUINO_COMMAND every SPEEDUINO_POLL_INTERVAL_MS, parses
+ * the response and hands all channels to the main loop in one batch through
+ * the network task's display slots, the same path MQTT values take. While
+ * serial data is live, ECU values arriving over MQTT are ignored. The data
+ * can be republished as /GOLF86/ECU/frame for other consumers.
+ */
+class SpeeduinoSerial {
+public:
+    SpeeduinoSerial();
+
+    /**
+     * @brief Open the UART and start the polling task
+     *
+     * Must be called after networkTask.begin().
+     *
+     * @return true if the task is running
+     */
+    bool begin();
+
+    /**
+     * @brief Check if recent data came from the serial link
+     * @return true if a response was parsed within SPEEDUINO_LIVE_TIMEOUT_MS
+     */
+    bool isLive() const;
+
+    uint32_t pollCount() const { return polls; }
+    uint32_t frameCount() const { return frames; }
+    uint32_t timeoutCount() const { return timeouts; }
+    uint32_t junkCount() const { return parser.junkCount(); }
+
+    /**
+     * @brief Get the time of the last request/response round trip
+     * @return Microseconds from sending the command to the parsed response
+     */
+    uint32_t lastResponseMicros() const { return responseMicros; }
+
+private:
+    static void taskLoop(void *parameter);
+
+    /**
+     * @brief Send one request and wait for its response
+     * @return true if a response was parsed
+     */
+    bool poll();
+
+    /**
+     * @brief Hand a parsed response to the displays and, when due, to MQTT
+     * @param sentMicros micros() when the command was sent
+     */
+    void deliver(uint32_t sentMicros);
+
+    TaskHandle_t taskHandle;
+    SpeeduinoParser parser;
+    uint16_t frameSeq;
+    unsigned long lastRepublishMillis;
+    volatile unsigned long lastFrameMillis;
+    volatile uint32_t polls;
+    volatile uint32_t frames;
+    volatile uint32_t timeouts;
+    volatile uint32_t responseMicros;
+};
+
+// Global instance
+extern SpeeduinoSerial speeduinoSerial;
+
+#endif // SPEEDUINO_SERIAL_H
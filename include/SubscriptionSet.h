@@ -0,0 +1,64 @@
+// SubscriptionSet.h
+// Topics a client should be subscribed to, restored after every reconnect
+
+#ifndef SUBSCRIPTION_SET_H
+#define SUBSCRIPTION_SET_H
+
+#include <Arduino.h>
+#include "Constants.h"
+
+/**
+ * @brief Fixed-size set of MQTT topics.
+ *
+ * Records the subscriptions a client should have, whether or not it is
+ * connected when they are requested, so they can be replayed in one pass
+ * after a reconnect (the broker forgets them with a clean session).
+ *
+ * Not thread-safe: only the task that owns the client may modify it.
+ */
+class SubscriptionSet {
+public:
+    SubscriptionSet();
+
+    /**
+     * @brief Add a topic
+     * @param topic MQTT topic (may contain wildcards)
+     * @return true if the topic is in the set, false if the set is full
+     */
+    bool add(const char *topic);
+
+    /**
+     * @brief Remove a topic
+     * @param topic MQTT topic
+     * @return true if the topic was in the set
+     */
+    bool remove(const char *topic);
+
+    /**
+     * @brief Check if a topic is in the set
+     * @param topic MQTT topic
+     * @return true if present
+     */
+    bool contains(const char *topic) const;
+
+    /**
+     * @brief Get the number of topics
+     * @return Topic count
+     */
+    uint8_t count() const { return used; }
+
+    /**
+     * @brief Get a topic by position
+     * @param index Position (0..count()-1)
+     * @return Topic, nullptr if out of range
+     */
+    const char *topicAt(uint8_t index) const;
+
+private:
+    int indexOf(const char *topic) const;
+
+    char topics[SUBSCRIPTION_SET_CAPACITY][MQTT_TOPIC_BUFFER_SIZE];
+    uint8_t used;
+};
+
+#endif // SUBSCRIPTION_SET_H
@@ -0,0 +1,127 @@
+// TaskRegistry.h
+// Keeps the handle of every task for stack and CPU reporting
+
+#ifndef TASK_REGISTRY_H
+#define TASK_REGISTRY_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include "Constants.h"
+
+/**
+ * @brief One registered task and its last sample
+ */
+struct TaskRecord {
+    TaskHandle_t handle;              // NULL = free slot
+    const char *name;                 // String literal passed at creation
+    uint32_t stackSize;               // Bytes requested at creation
+    int8_t core;                      // Pinned core, -1 = not pinned
+    uint8_t priority;
+    uint32_t stackFree;               // Least free stack seen, bytes
+    uint32_t runTime;                 // Run-time counter at the last sample
+    uint16_t cpuPermille;             // Share of its core over the last interval, 0 without run-time stats
+};
+
+/**
+ * @brief Registry of all tasks, sampled every TASK_SAMPLE_INTERVAL_MS.
+ *
+ * Tasks are created through create() (same arguments as
+ * xTaskCreatePinnedToCore) so their handle, name and core are kept. A task
+ * that deletes itself must call remove() first, the registry would
+ * otherwise query a freed handle.
+ *
+ * The CPU share of each task and the idle time per core come from the
+ * FreeRTOS run-time counters when configGENERATE_RUN_TIME_STATS is set. Without
+ * them only the core idle time is measured, from the CPU cycles between
+ * consecutive idle hook calls of each core, and only over one sample
+ * interval after requestIdleSample(): the hooks keep the cores from halting
+ * while they count.
+ */
+class TaskRegistry {
+public:
+    TaskRegistry();
+
+    /**
+     * @brief Create a pinned task and register it
+     * @return pdPASS if created; a task that does not fit the registry still
+     *         runs, with a warning
+     */
+    BaseType_t create(TaskFunction_t function, const char *name, uint32_t stackSize, void *parameter,
+                      UBaseType_t priority, TaskHandle_t *handle, BaseType_t core);
+
+    /**
+     * @brief Register a task that was not created here (the Arduino loop task)
+     * @param handle Task handle
+     * @param name Task name
+     * @param stackSize Stack size in bytes
+     * @param core Pinned core, -1 if not pinned
+     */
+    void add(TaskHandle_t handle, const char *name, uint32_t stackSize, int8_t core);
+
+    /**
+     * @brief Unregister a task before it is deleted
+     * @param handle Task handle, NULL for the calling task
+     */
+    void remove(TaskHandle_t handle);
+
+    /**
+     * @brief Sample stacks and CPU time once the interval has passed (main loop)
+     * @param now Current millis()
+     */
+    void sample(unsigned long now);
+
+    /**
+     * @brief Copy a registered task
+     * @param index Slot 0..TASK_REGISTRY_SIZE-1
+     * @param record Filled with the task and its last sample
+     * @return false for a free slot
+     */
+    bool get(uint8_t index, TaskRecord &record);
+
+    /**
+     * @brief Measure the core idle time over the next sample interval (main loop)
+     */
+    void requestIdleSample();
+
+    /**
+     * @brief Get the idle share of a core over the last measured interval
+     * @param core 0 or 1
+     * @return Permille
+     */
+    uint16_t idlePermille(uint8_t core) const { return core < portNUM_PROCESSORS ? idle[core] : 0; }
+
+    /**
+     * @brief Get when the idle shares were last measured
+     * @return millis() at the end of the interval, 0 if never
+     */
+    unsigned long idleSampleMillis() const { return idleMillis; }
+
+    /**
+     * @brief Check if per-task CPU shares are measured
+     * @return true if FreeRTOS run-time stats are compiled in
+     */
+    static bool hasRunTimeStats();
+
+private:
+    /**
+     * @brief Store a task in a free slot (mutex held)
+     */
+    void store(TaskHandle_t handle, const char *name, uint32_t stackSize, int8_t core, UBaseType_t priority);
+
+    TaskRecord records[TASK_REGISTRY_SIZE];
+    SemaphoreHandle_t mutex;
+    unsigned long lastSampleMillis;
+    uint32_t lastSampleMicros;
+    uint32_t lastIdleCount[portNUM_PROCESSORS]; // Idle run time, or idle cycles without run-time stats
+    uint16_t idle[portNUM_PROCESSORS];
+    unsigned long idleMillis;
+    bool hooksInstalled;      // Idle hooks counting, without run-time stats
+    bool idleRequested;
+};
+
+// Global instance
+extern TaskRegistry taskRegistry;
+
+#endif // TASK_REGISTRY_H
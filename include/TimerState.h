@@ -0,0 +1,87 @@
+// TimerState.h
+// Combined timer state message, published next to or instead of the legacy timer topics
+
+#ifndef TIMER_STATE_H
+#define TIMER_STATE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "Constants.h"
+
+/**
+ * @brief Publishes one compact state message per timer.
+ *
+ * `<timer topic>state` carries "running,paused,elapsed_ms,laps" (for example
+ * "1,0,83450,2"), published on every start, pause and reset and at
+ * Config::timerStateRateHz while running. Config::timerPublish selects this
+ * message, the legacy started/paused/value topics, or both. A pause counts
+ * as a lap; a reset clears the count.
+ *
+ * Changes are published from the main loop, periodic updates from the timer
+ * callbacks; each call only queues for the network task.
+ */
+class TimerStatePublisher {
+public:
+    TimerStatePublisher();
+
+    /**
+     * @brief Check if the legacy started/paused/value topics are enabled
+     * @return true unless only the state message is selected
+     */
+    bool legacyTopics() const;
+
+    /**
+     * @brief Publish the state after a timer was started
+     * @param timerId Timer (1 or 2)
+     */
+    void started(int timerId);
+
+    /**
+     * @brief Count a lap and publish the state after a timer was paused
+     * @param timerId Timer (1 or 2)
+     */
+    void paused(int timerId);
+
+    /**
+     * @brief Clear the lap count and publish the state after a timer was reset
+     * @param timerId Timer (1 or 2)
+     */
+    void reset(int timerId);
+
+    /**
+     * @brief Publish the state of a running timer if its rate interval elapsed
+     * @param timerId Timer (1 or 2)
+     * @param now Current millis()
+     */
+    void tick(int timerId, unsigned long now);
+
+    /**
+     * @brief Get the laps of a timer since its last reset
+     * @param timerId Timer (1 or 2)
+     * @return Lap count
+     */
+    uint16_t laps(int timerId) const;
+
+    /**
+     * @brief Get the number of state messages published since boot
+     * @return Message count
+     */
+    uint32_t publishedCount() const { return published.load(std::memory_order_relaxed); }
+
+private:
+    /**
+     * @brief Format and publish the state of a timer
+     * @param timerId Timer (1 or 2)
+     * @param periodic true for rate updates, which may be collapsed during an outage
+     */
+    void publish(int timerId, bool periodic);
+
+    volatile uint16_t lapCount[2];
+    volatile unsigned long lastMillis[2];
+    std::atomic<uint32_t> published; // Incremented from the main loop and the timer callbacks
+};
+
+// Global instance
+extern TimerStatePublisher timerState;
+
+#endif // TIMER_STATE_H
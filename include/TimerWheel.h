@@ -0,0 +1,69 @@
+// TimerWheel.h
+// Hashed timer wheel for cheap per-id deadlines
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <Arduino.h>
+#include "Constants.h"
+
+/**
+ * @brief Hashed timer wheel for up to TIMER_WHEEL_MAX_IDS small integer ids.
+ *
+ * Each id sits in at most one slot, chosen by its deadline. advance() only
+ * visits the slots of the ticks that passed since the previous call, so the
+ * cost per loop does not depend on the number of scheduled ids. Deadlines
+ * further away than one revolution (slots * tick) fire early; the owner is
+ * expected to re-check the real deadline when an id fires and reschedule it
+ * if it is not due yet. Ids are never removed, a fired id is simply not
+ * rescheduled.
+ *
+ * Not thread-safe, the owner serialises access.
+ */
+class TimerWheel {
+public:
+    /**
+     * @brief Callback for an id whose slot came up
+     * @param id Id that fired
+     * @param now Current millis()
+     * @param context Owner pointer passed to advance()
+     */
+    typedef void (*ExpiryCallback)(uint8_t id, unsigned long now, void *context);
+
+    TimerWheel();
+
+    /**
+     * @brief Schedule an id
+     * @param id Id (0..TIMER_WHEEL_MAX_IDS-1), must not be scheduled already
+     * @param deadline millis() at which the id should fire
+     * @return true if scheduled, false if invalid or already scheduled
+     */
+    bool schedule(uint8_t id, unsigned long deadline);
+
+    /**
+     * @brief Check if an id is waiting in the wheel
+     * @param id Id to check
+     * @return true if scheduled
+     */
+    bool isScheduled(uint8_t id) const;
+
+    /**
+     * @brief Fire every id in the slots of the ticks elapsed since the last call
+     * @param now Current millis()
+     * @param callback Called once per fired id, may reschedule it
+     * @param context Passed to the callback
+     * @return Number of ids that fired
+     */
+    uint8_t advance(unsigned long now, ExpiryCallback callback, void *context);
+
+private:
+    static const int8_t NONE = -1;
+
+    int8_t head[TIMER_WHEEL_SLOTS];      // First id of every slot
+    int8_t next[TIMER_WHEEL_MAX_IDS];    // Next id in the same slot
+    bool scheduled[TIMER_WHEEL_MAX_IDS];
+    unsigned long currentTick;           // Last tick processed
+    bool started;
+};
+
+#endif // TIMER_WHEEL_H
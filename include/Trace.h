@@ -0,0 +1,133 @@
+// Trace.h
+// Runtime-toggleable hot path tracing, exported as Chrome trace events
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "Constants.h"
+
+// Traced spans, names in TRACE_NAMES (Trace.cpp)
+#define TRACE_MQTT_RX 0          // Primary MQTT message, all handlers
+#define TRACE_UDP_RX 1           // One UDP datagram, all handlers
+#define TRACE_FORMAT 2           // Payload to display text
+#define TRACE_QUEUE 3            // Hand-off to the main loop slots, lock wait included
+#define TRACE_MAIN_DISPLAY 4     // One main display update
+#define TRACE_SPI_WRITE 5        // Secondary display write
+#define TRACE_TIMER_TICK 6       // 10 ms racing timer callback
+#define TRACE_WEB_REQUEST 7      // Stats page and /metrics
+#define TRACE_ID_COUNT 8
+
+/**
+ * @brief One completed span
+ */
+struct TraceEvent {
+    uint32_t startMicros;
+    uint32_t durationMicros;
+    uint8_t id;                  // TRACE_*
+    uint8_t core;                // xPortGetCoreID() at the end of the span
+};
+
+/**
+ * @brief Ring position read once for an export, so indexes stay stable
+ */
+struct TraceSnapshot {
+    uint32_t count;              // Spans kept, up to TRACE_RING_SIZE
+    uint32_t overwritten;        // Spans lost to the ring wrapping since start()
+    uint32_t oldest;             // Slot of the oldest kept span
+};
+
+/**
+ * @brief Fixed ring of completed spans, written lock-free from any task or core.
+ *
+ * A writer claims a slot with one atomic increment, so concurrent spans on
+ * both cores never wait for each other; once the ring is full the oldest
+ * spans are overwritten. Spans are stored complete (start + duration), which
+ * keeps preempted spans on the same core correct in the viewer.
+ *
+ * A span that ends after stop() is not recorded, and stop() waits for the
+ * writers already past that check, so an export reads a ring nobody writes.
+ *
+ * While disabled, each end of a span costs one load and a not-taken branch.
+ */
+class TraceRing {
+public:
+    TraceRing();
+
+    /**
+     * @brief Check if tracing is on (inline, hot path)
+     * @return true while recording
+     */
+    bool enabled() const { return active.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Clear the ring and start recording
+     */
+    void start();
+
+    /**
+     * @brief Stop recording and wait for spans being written, the ring keeps its spans for export
+     */
+    void stop();
+
+    /**
+     * @brief Store a completed span
+     * @param id TRACE_*
+     * @param startMicros micros() at the start of the span
+     * @param endMicros micros() at the end of the span
+     */
+    void record(uint8_t id, uint32_t startMicros, uint32_t endMicros);
+
+    /**
+     * @brief Read the ring position once (after stop())
+     * @return Kept and overwritten span counts and the oldest slot
+     */
+    TraceSnapshot snapshot() const;
+
+    /**
+     * @brief Get a kept span, oldest first
+     * @param snapshot Position from snapshot()
+     * @param index 0..snapshot.count-1
+     * @return Span
+     */
+    const TraceEvent &at(const TraceSnapshot &snapshot, uint32_t index) const;
+
+    /**
+     * @brief Get the name of a span id
+     * @param id TRACE_*
+     * @return Name for the trace viewer
+     */
+    static const char *name(uint8_t id);
+
+private:
+    TraceEvent events[TRACE_RING_SIZE];
+    std::atomic<uint32_t> written;   // Spans claimed since start()
+    std::atomic<uint32_t> writers;   // record() calls in progress
+    std::atomic<bool> active;
+};
+
+// Global instance
+extern TraceRing traceRing;
+
+/**
+ * @brief Span covering the enclosing scope, recorded only while tracing is on
+ */
+class TraceScope {
+public:
+    explicit TraceScope(uint8_t id) : id(id), startMicros(traceRing.enabled() ? micros() : 0) {}
+
+    ~TraceScope() {
+        if (startMicros != 0) {
+            traceRing.record(id, startMicros, micros());
+        }
+    }
+
+private:
+    uint8_t id;
+    uint32_t startMicros;        // 0 = not traced
+};
+
+#define TRACE_SCOPE(id) TraceScope __trace_scope(id)
+
+#endif // TRACE_H
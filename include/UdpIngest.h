@@ -0,0 +1,93 @@
+// UdpIngest.h
+// Datagram checks for the UDP telemetry listener
+
+#ifndef UDP_INGEST_H
+#define UDP_INGEST_H
+
+#include <Arduino.h>
+#include "Constants.h"
+
+#define UDP_TEXT_MAGIC 0x87
+#define UDP_TEXT_VERSION 1
+
+// Result of UdpIngest::accept()
+#define UDP_DATAGRAM_DROPPED 0
+#define UDP_DATAGRAM_FRAME 1     // EcuFrame, same bytes as /GOLF86/ECU/frame
+#define UDP_DATAGRAM_TEXT 2      // Topic/payload pairs
+
+/**
+ * @brief Header shared by both datagram kinds (4 bytes, little-endian).
+ *
+ * A frame datagram is an EcuFrame (magic ECU_FRAME_MAGIC), which starts with
+ * the same fields. A text datagram (magic UDP_TEXT_MAGIC) continues with one
+ * or more "topic\0payload\0" pairs, topics as on MQTT, e.g.
+ * "/GOLF86/ECU/RPM\0" "6250\0" "/GOLF86/GPS/SPD\0" "87.5\0".
+ */
+struct __attribute__((packed)) UdpHeader {
+    uint8_t magic;
+    uint8_t version;
+    uint16_t seq;            // Per kind, incremented per datagram (wraps)
+};
+
+/**
+ * @brief Sequence state of one datagram kind
+ */
+struct UdpSequence {
+    bool started;
+    uint16_t last;
+};
+
+/**
+ * @brief Checks datagram headers and sequence numbers.
+ *
+ * Lost datagrams are counted from sequence gaps. Duplicates and datagrams
+ * older than the last one applied are dropped, since a newer value was
+ * already shown; a jump back by more than UDP_SEQ_RESTART_WINDOW is taken
+ * as a restarted sender. No I/O, used by the UDP task only.
+ */
+class UdpIngest {
+public:
+    UdpIngest();
+
+    /**
+     * @brief Check a received datagram
+     * @param bytes Datagram
+     * @param length Datagram length, over UDP_MAX_DATAGRAM is rejected
+     * @return UDP_DATAGRAM_FRAME, UDP_DATAGRAM_TEXT or UDP_DATAGRAM_DROPPED
+     */
+    uint8_t accept(const uint8_t *bytes, int length);
+
+    /**
+     * @brief Get the next topic/payload pair of a text datagram
+     * @param bytes Datagram, with a zero byte after the last one
+     * @param length Datagram length
+     * @param offset sizeof(UdpHeader) for the first pair, then the return value
+     * @param topic Set to the topic
+     * @param payload Set to the payload
+     * @return Offset of the following pair, -1 if there is none
+     */
+    static int nextPair(const char *bytes, int length, int offset, const char *&topic, const char *&payload);
+
+    uint32_t receivedCount() const { return received; }
+    uint32_t rejectedCount() const { return rejected; }
+    uint32_t lostCount() const { return lost; }
+    uint32_t lateCount() const { return late; }
+
+private:
+    /**
+     * @brief Advance the sequence of a kind
+     * @param sequence Sequence state
+     * @param seq Sequence number of the datagram
+     * @return true if the datagram is newer than the last one applied
+     */
+    bool advance(UdpSequence &sequence, uint16_t seq);
+
+    UdpSequence frameSequence;
+    UdpSequence textSequence;
+    uint32_t received;
+    uint32_t rejected;
+    uint32_t lost;
+    uint32_t late;
+};
+
+#endif // UDP_INGEST_H
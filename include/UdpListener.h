@@ -0,0 +1,76 @@
+// UdpListener.h
+// Optional UDP telemetry transport next to the MQTT broker
+
+#ifndef UDP_LISTENER_H
+#define UDP_LISTENER_H
+
+#include <Arduino.h>
+#include <WiFiUdp.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "Constants.h"
+#include "UdpIngest.h"
+
+/**
+ * @brief Receives telemetry datagrams on Config::udpPort.
+ *
+ * Polled by its own task, so a blocking broker connect or probe in the
+ * network task never holds up datagrams; they go through the same channel
+ * handlers as primary MQTT messages without a broker round trip or TCP
+ * head-of-line blocking. The socket is (re)opened when WiFi is up and the
+ * configured port changes, 0 closes it.
+ */
+class UdpListener {
+public:
+    UdpListener();
+
+    /**
+     * @brief Start the polling task
+     *
+     * Must be called after networkTask.begin().
+     *
+     * @return true if the task is running
+     */
+    bool begin();
+
+    /**
+     * @brief Open/close the socket as configured and handle waiting datagrams
+     *
+     * Handles at most UDP_POLL_BUDGET datagrams per call (UDP task).
+     */
+    void poll();
+
+    /**
+     * @brief Get the port the socket is open on
+     * @return Port, 0 if closed
+     */
+    uint16_t boundPort() const { return bound ? port : 0; }
+
+    /**
+     * @brief Get the datagram counters
+     * @return Datagram checks, updated by the UDP task
+     */
+    const UdpIngest &ingest() const { return datagrams; }
+
+    /**
+     * @brief Get the longest time a datagram took from read to handed off
+     * @return Microseconds
+     */
+    uint32_t maxHandlingMicros() const { return maxHandling; }
+
+private:
+    static void taskLoop(void *parameter);
+
+    TaskHandle_t taskHandle;
+    WiFiUDP udp;
+    UdpIngest datagrams;
+    uint16_t port;           // Configured port the socket was opened for
+    bool bound;
+    uint32_t maxHandling;
+    char buffer[UDP_MAX_DATAGRAM + 1];
+};
+
+// Global instance
+extern UdpListener udpListener;
+
+#endif // UDP_LISTENER_H
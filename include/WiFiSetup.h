@@ -6,11 +6,17 @@
 #include <WiFiManager.h>
 #include <Preferences.h>
 #include <MD_Parola.h>
+#include "Constants.h"
 
 // Configuration constants
-#define CONFIG_VERSION 1
+#define CONFIG_VERSION 7
+#define FAST_CONNECT_VERSION 2
 #define MQTT_SERVER_SIZE 40
 #define MQTT_PORT_SIZE 6
+#define MQTT_FALLBACK_COUNT 2  // Backup brokers tried after mqtt_server
+#define MQTT_FALLBACK_PARAM_SIZE (MQTT_FALLBACK_COUNT * (MQTT_SERVER_SIZE + MQTT_PORT_SIZE))
+#define TIMER_PUBLISH_PARAM_SIZE 8   // "legacy", "state" or "both"
+#define TIMER_RATE_PARAM_SIZE 4
 #define MAX_BRIGHTNESS 15
 #define DEFAULT_BRIGHTNESS 5
 
@@ -24,10 +30,50 @@ struct Config
     textPosition_t align;         // Text alignment
     char mqtt_server[MQTT_SERVER_SIZE]; // MQTT server
     char mqtt_port[MQTT_PORT_SIZE];     // MQTT port
+    uint8_t renderMode;           // Main display render mode (RENDER_MODE_*)
+    char zoneChannel[MAX_DISPLAY_ZONES - 1][DATA_INDEX_SIZE]; // Channels of zones 1..N-1
+    char pages[MAX_PAGES][DATA_INDEX_SIZE]; // Primary channel page rotation list
+    uint8_t pageCount;            // Pages in the rotation (1 = no rotation)
+    uint8_t pageIntervalS;        // Timed rotation interval in seconds (0 = click only)
+    char mqtt_fallback_server[MQTT_FALLBACK_COUNT][MQTT_SERVER_SIZE]; // Backup brokers in order ("" = unused)
+    char mqtt_fallback_port[MQTT_FALLBACK_COUNT][MQTT_PORT_SIZE];
+    uint8_t timerPublish;         // Timer MQTT topics (TIMER_PUBLISH_*)
+    uint8_t timerStateRateHz;     // State publishes per second while running (0 = on change only)
+    uint16_t udpPort;             // UDP telemetry listener port (0 = off)
+};
+
+/**
+ * @brief Last successful association, used to skip the scan on the next connect.
+ *
+ * Only the access point is kept: the address always comes from DHCP, as a
+ * cached lease has no expiry the device could check and the router may have
+ * handed it to someone else. Kept apart from Config so a change of access
+ * point does not rewrite the user settings.
+ */
+struct FastConnectCache
+{
+    uint8_t version;   // FAST_CONNECT_VERSION
+    uint8_t bssid[6];  // Access point MAC
+    int32_t channel;   // Access point channel
+};
+
+/**
+ * @brief States of the background WiFi reconnect
+ */
+enum WiFiLinkState : uint8_t
+{
+    WIFI_LINK_UP = 0,     // Connected
+    WIFI_LINK_CONNECTING, // Reconnect attempt in progress
+    WIFI_LINK_BACKOFF,    // Waiting before the next attempt
+    WIFI_LINK_PORTAL      // Config portal open on user request
 };
 
 /**
  * @brief Class for managing WiFi setup and configuration.
+ *
+ * The config portal opens in begin() only when no network is saved yet (first
+ * boot), or later on user request via openPortal(). Connecting, reconnecting
+ * and the portal are all driven by update() without blocking the caller.
  */
 class WiFiSetup
 {
@@ -38,16 +84,53 @@ public:
     WiFiSetup();
 
     /**
-     * @brief Initializes WiFiSetup.
+     * @brief Starts connecting in the background, or opens the portal on first boot.
+     *
+     * Returns immediately; call paramLoad() before and update() from the loop.
      */
     void begin();
 
     /**
-     * @brief Connects to WiFi.
-     * @return True if connection is successful, false otherwise.
+     * @brief Starts a reconnection attempt with the saved credentials, without waiting.
+     * @return True if already connected, false if an attempt was started.
      */
     bool connect();
 
+    /**
+     * @brief Drives the reconnect state machine and the on-demand portal, never blocks.
+     * @param now Current millis().
+     */
+    void update(unsigned long now);
+
+    /**
+     * @brief Opens the config portal in the background until saved or timed out.
+     */
+    void openPortal();
+
+    /**
+     * @brief Gets the state of the background reconnect.
+     * @return One of WIFI_LINK_*.
+     */
+    WiFiLinkState linkState() const { return state; }
+
+    /**
+     * @brief Gets the number of times the connection was recovered.
+     * @return Reconnect count.
+     */
+    uint32_t reconnectCount() const { return reconnects; }
+
+    /**
+     * @brief Gets the time from power-on until WiFi was first connected.
+     * @return millis() at the first connection, 0 if not connected yet.
+     */
+    unsigned long bootConnectMs() const { return bootConnectMillis; }
+
+    /**
+     * @brief Checks if the boot connection used the cached access point.
+     * @return True if the fast path connected.
+     */
+    bool bootConnectWasFast() const { return bootConnectFast; }
+
     /**
      * @brief Callback function to save configuration.
      */
@@ -70,6 +153,89 @@ public:
 
 private:
     bool shouldSaveConfig = false; // Flag for saving data
+
+    WiFiManager wifiManager;
+    WiFiManagerParameter customMqttServer;
+    WiFiManagerParameter customMqttPort;
+    WiFiManagerParameter customMqttFallbacks;
+    WiFiManagerParameter customTimerPublish;
+    WiFiManagerParameter customTimerRate;
+    WiFiManagerParameter customUdpPort;
+
+    WiFiLinkState state = WIFI_LINK_UP;
+    uint8_t failedAttempts = 0;          // Failed attempts since the link was lost
+    unsigned long stateMillis = 0;       // When the current attempt or portal started
+    unsigned long backoffMs = 0;         // Wait before the next attempt
+    uint32_t reconnects = 0;
+
+    FastConnectCache fastCache;
+    bool fastCacheValid = false;
+    bool directedAttempt = false;       // Current attempt targets the cached access point
+    unsigned long bootConnectMillis = 0;
+    bool bootConnectFast = false;
+
+    /**
+     * @brief Starts associating with the saved network.
+     * @param directed Use the cached BSSID and channel instead of scanning.
+     */
+    void beginStation(bool directed);
+
+    /**
+     * @brief Loads the fast connect cache from Preferences.
+     */
+    void loadFastConnect();
+
+    /**
+     * @brief Stores the current access point if it changed.
+     */
+    void saveFastConnect();
+
+    /**
+     * @brief Fills the portal fields from config.
+     */
+    void setPortalValues();
+
+    /**
+     * @brief Copies the MQTT fields from the portal into config and saves it.
+     * @return True if the MQTT server or port changed.
+     */
+    bool applyPortalParams();
+
+    /**
+     * @brief Resets the main display layout fields to their defaults.
+     */
+    void setDisplayDefaults();
+
+    /**
+     * @brief Formats the backup brokers as "host:port,host:port" for the portal.
+     * @param buffer Output buffer.
+     * @param size Size of the output buffer.
+     */
+    void formatFallbacks(char *buffer, size_t size) const;
+
+    /**
+     * @brief Parses "host:port,host:port" from the portal into the backup brokers.
+     * @param text Comma separated list, the port defaults to 1883.
+     */
+    void parseFallbacks(const char *text);
+
+    /**
+     * @brief Resets the timer MQTT fields to their defaults.
+     */
+    void setTimerDefaults();
+
+    /**
+     * @brief Parses the timer topic and rate fields from the portal into config.
+     * @param mode "legacy", "state" or "both"; anything else keeps the current mode.
+     * @param rate State rate in Hz, capped to TIMER_STATE_MAX_RATE_HZ.
+     */
+    void parseTimerPublish(const char *mode, const char *rate);
+
+    /**
+     * @brief Parses the UDP telemetry port from the portal into config.
+     * @param text Port, empty or 0 closes the listener.
+     */
+    void parseUdpPort(const char *text);
 };
 
 // External declarations for global constants
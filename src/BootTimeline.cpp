@@ -0,0 +1,84 @@
+// BootTimeline.cpp
+// Implementation of the boot timeline
+
+#include "BootTimeline.h"
+#include <string.h>
+
+// Global instance
+BootTimeline bootTimeline;
+
+/**
+ * @brief Constructor for BootTimeline
+ */
+BootTimeline::BootTimeline() : stageCount(0) {
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    lock = unlocked;
+    for (uint8_t i = 0; i < BOOT_TIMELINE_MAX_STAGES; i++) {
+        stages[i] = nullptr;
+        marks[i] = 0;
+    }
+}
+
+/**
+ * @brief Record that a stage is ready now
+ * @param stage Stage name (string literal)
+ */
+void BootTimeline::mark(const char *stage) {
+    unsigned long now = millis();
+    bool stored = false;
+
+    portENTER_CRITICAL(&lock);
+    if (stageCount < BOOT_TIMELINE_MAX_STAGES) {
+        stages[stageCount] = stage;
+        marks[stageCount] = now;
+        stageCount++;
+        stored = true;
+    }
+    portEXIT_CRITICAL(&lock);
+
+    if (stored) {
+        Serial.printf("[BOOT] %6lu ms  %s\n", now, stage);
+    }
+}
+
+/**
+ * @brief Record a stage only the first time it is reached
+ * @param stage Stage name (string literal)
+ */
+void BootTimeline::markOnce(const char *stage) {
+    if (!contains(stage)) {
+        mark(stage);
+    }
+}
+
+/**
+ * @brief Get the name of a recorded stage
+ * @param index Stage index in recording order
+ * @return Stage name, nullptr if out of range
+ */
+const char *BootTimeline::stageAt(uint8_t index) const {
+    return index < stageCount ? stages[index] : nullptr;
+}
+
+/**
+ * @brief Get the time a stage was recorded
+ * @param index Stage index in recording order
+ * @return millis() of the mark, 0 if out of range
+ */
+unsigned long BootTimeline::millisAt(uint8_t index) const {
+    return index < stageCount ? marks[index] : 0;
+}
+
+/**
+ * @brief Check if a stage was already recorded
+ * @param stage Stage name
+ * @return true if recorded
+ */
+bool BootTimeline::contains(const char *stage) const {
+    for (uint8_t i = 0; i < stageCount; i++) {
+        if (stages[i] == stage || strcmp(stages[i], stage) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
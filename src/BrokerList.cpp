@@ -0,0 +1,136 @@
+// BrokerList.cpp
+// Implementation of the broker failover list
+
+#include "BrokerList.h"
+
+/**
+ * @brief Constructor for BrokerList
+ */
+BrokerList::BrokerList()
+    : brokerCount(1), current(0), consecutiveFailures(0), switching(false), returning(false),
+      returnedFrom(0), switchOutageStart(0), lastProbeMillis(0), switches(0), switchoverMs(0) {
+    for (uint8_t i = 0; i < MQTT_BROKER_MAX; i++) {
+        hosts[i] = "";
+        ports[i] = 0;
+        failures[i] = 0;
+    }
+}
+
+/**
+ * @brief Build the list from the config
+ * @param config Loaded configuration
+ */
+void BrokerList::begin(const Config &config) {
+    hosts[0] = config.mqtt_server;
+    ports[0] = atoi(config.mqtt_port);
+    brokerCount = 1;
+
+    for (uint8_t i = 0; i < MQTT_FALLBACK_COUNT; i++) {
+        if (config.mqtt_fallback_server[i][0] == '\0') {
+            continue;
+        }
+        hosts[brokerCount] = config.mqtt_fallback_server[i];
+        ports[brokerCount] = atoi(config.mqtt_fallback_port[i]);
+        brokerCount++;
+    }
+    current = 0;
+    returning = false;
+}
+
+/**
+ * @brief Get the host of a broker
+ * @param index Broker index
+ * @return Host name or address, "" if out of range
+ */
+const char *BrokerList::host(uint8_t index) const {
+    return index < brokerCount ? hosts[index] : "";
+}
+
+/**
+ * @brief Get the port of a broker
+ * @param index Broker index
+ * @return Port number, 0 if out of range
+ */
+int BrokerList::port(uint8_t index) const {
+    return index < brokerCount ? ports[index] : 0;
+}
+
+/**
+ * @brief Record a failed connect to the active broker
+ *
+ * A failure right after returnToFirst() asks for the backup again at once:
+ * the first broker took a probe session but not the real one.
+ *
+ * @return true if the next broker should be used now
+ */
+bool BrokerList::recordFailure() {
+    failures[current]++;
+    consecutiveFailures++;
+    return returning || (brokerCount > 1 && consecutiveFailures >= MQTT_FAILOVER_ATTEMPTS);
+}
+
+/**
+ * @brief Record a successful connect to the active broker
+ * @param now Current millis()
+ * @return true if this completed a switchover
+ */
+bool BrokerList::recordConnected(unsigned long now) {
+    consecutiveFailures = 0;
+    returning = false;
+    if (!switching) {
+        return false;
+    }
+
+    switching = false;
+    switchoverMs = now - switchOutageStart;
+    return true;
+}
+
+/**
+ * @brief Make a broker active
+ * @param index Broker index
+ * @param outageStart millis() when the connection was lost, for the switchover time
+ */
+void BrokerList::select(uint8_t index, unsigned long outageStart) {
+    if (index >= brokerCount || index == current) {
+        return;
+    }
+
+    // A switch during a pending one still measures from the original outage
+    if (!switching) {
+        switchOutageStart = outageStart;
+    }
+    current = index;
+    consecutiveFailures = 0;
+    switching = true;
+    returning = false;
+    switches++;
+}
+
+/**
+ * @brief Go back to the first broker after it accepted a probe session
+ * @param now Current millis(), the switchover time is measured from it
+ */
+void BrokerList::returnToFirst(unsigned long now) {
+    if (current == 0) {
+        return;
+    }
+
+    uint8_t backup = current;
+    select(0, now);
+    returning = true;
+    returnedFrom = backup;
+}
+
+/**
+ * @brief Check if it is time to probe the first broker
+ * @param now Current millis()
+ * @return true if a backup is active and the probe interval elapsed
+ */
+bool BrokerList::primaryProbeDue(unsigned long now) {
+    if (current == 0 || now - lastProbeMillis < MQTT_PRIMARY_PROBE_INTERVAL_MS) {
+        return false;
+    }
+    lastProbeMillis = now;
+    return true;
+}
@@ -0,0 +1,294 @@
+// ChannelTable.cpp
+// Implementation of the latest-value channel table
+
+#include "ChannelTable.h"
+#include "DeferredLog.h"
+#include <string.h>
+
+// String array for ECU and GPS Data parameters
+// Using const char* arrays instead of String to avoid heap allocations
+const char* const ecuDataStrings[ECU_CHANNEL_COUNT] = {"RPM", "TPS", "VE1", "O2P", "AFT", "MAT", "CAD", "MAP", "BAT", "ADV", "PW1", "SPK", "DWL", "ILL", "BAR", "TAE", "NER", "ENG"};
+const char* const gpsDataStrings[GPS_CHANNEL_COUNT] = {"SPD", "TME", "DTE", "LAT", "LNG", "ALT", "CRS", "QTY"};
+
+// Default stale timeouts in ms, same order as the code arrays above. Slowly
+// changing values (temperatures, battery, baro) may be published less often.
+static const uint16_t ecuStaleTimeoutMs[ECU_CHANNEL_COUNT] = {
+    2000, 2000, 2000, 2000, 2000, 5000, 5000, 2000, 5000, 2000, 2000, 2000, 2000, 2000, 5000, 2000, 5000, 2000};
+static const uint16_t gpsStaleTimeoutMs[GPS_CHANNEL_COUNT] = {
+    3000, 3000, 10000, 3000, 3000, 3000, 3000, 5000};
+
+static_assert(CHANNEL_COUNT <= TIMER_WHEEL_MAX_IDS, "Every channel needs a timer wheel id");
+
+// Shown in place of a stale value (defined in Main.cpp)
+extern char notAvailableMsg[];
+
+// Global instance
+ChannelTable g_channels;
+
+/**
+ * @brief Constructor for ChannelTable
+ */
+ChannelTable::ChannelTable() : staleEvents(0) {
+    mutex = xSemaphoreCreateMutex();
+    if (mutex == NULL) {
+        Serial.println("ERROR: Failed to create ChannelTable mutex!");
+    }
+
+    for (int i = 0; i < CHANNEL_COUNT; i++) {
+        bool gps = i >= ECU_CHANNEL_COUNT;
+        entries[i].code = gps ? gpsDataStrings[i - ECU_CHANNEL_COUNT] : ecuDataStrings[i];
+        entries[i].isGps = gps;
+        entries[i].text[0] = '\0';
+        entries[i].value = 0.0f;
+        entries[i].seq = 0;
+        entries[i].updatedMillis = 0;
+        entries[i].staleTimeoutMs = gps ? gpsStaleTimeoutMs[i - ECU_CHANNEL_COUNT] : ecuStaleTimeoutMs[i];
+        entries[i].stale = false;
+        entries[i].subscribers = 0;
+    }
+}
+
+/**
+ * @brief Destructor for ChannelTable
+ */
+ChannelTable::~ChannelTable() {
+    if (mutex != NULL) {
+        vSemaphoreDelete(mutex);
+    }
+}
+
+/**
+ * @brief Find a channel by its code
+ * @param code Three letter channel code
+ * @return Channel index, or -1 if unknown
+ */
+int ChannelTable::indexOf(const char *code) const {
+    if (code == NULL) {
+        return -1;
+    }
+
+    for (int i = 0; i < CHANNEL_COUNT; i++) {
+        if (strcmp(entries[i].code, code) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Get the code of a channel
+ * @param index Channel index
+ * @return Channel code, or nullptr if out of range
+ */
+const char *ChannelTable::codeAt(int index) const {
+    if (index < 0 || index >= CHANNEL_COUNT) {
+        return nullptr;
+    }
+    return entries[index].code;
+}
+
+/**
+ * @brief Check if a channel belongs to the GPS set
+ * @param index Channel index
+ * @return true for GPS channels, false for ECU channels or invalid index
+ */
+bool ChannelTable::isGps(int index) const {
+    if (index < 0 || index >= CHANNEL_COUNT) {
+        return false;
+    }
+    return entries[index].isGps;
+}
+
+/**
+ * @brief Store a new value for a channel
+ * @param code Three letter channel code
+ * @param text Formatted display text
+ * @param value Parsed numeric value
+ * @return true if stored, false if unknown code or mutex timeout
+ */
+bool ChannelTable::update(const char *code, const char *text, float value) {
+    int index = indexOf(code);
+    if (index < 0 || text == NULL || mutex == NULL) {
+        return false;
+    }
+
+    if (xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        ChannelEntry &entry = entries[index];
+        strncpy(entry.text, text, CHANNEL_TEXT_SIZE - 1);
+        entry.text[CHANNEL_TEXT_SIZE - 1] = '\0';
+        entry.value = value;
+        entry.updatedMillis = millis();
+        entry.stale = false;
+        entry.seq++;
+
+        // Arm the stale deadline once, it is re-checked lazily when it fires
+        if (!staleWheel.isScheduled(index)) {
+            staleWheel.schedule(index, entry.updatedMillis + entry.staleTimeoutMs);
+        }
+        xSemaphoreGive(mutex);
+        return true;
+    }
+
+    LOG_WARN("ChannelTable::update() mutex timeout");
+    return false;
+}
+
+/**
+ * @brief Read the latest text of a channel
+ * @param index Channel index
+ * @param buffer Buffer to copy the text into
+ * @param bufferSize Size of the buffer
+ * @param seq Optional output for the sequence number of the copied value
+ * A stale channel reads as notAvailableMsg.
+ *
+ * @return true if the channel has received at least one value
+ */
+bool ChannelTable::read(int index, char *buffer, size_t bufferSize, uint32_t *seq) {
+    if (index < 0 || index >= CHANNEL_COUNT || buffer == NULL || bufferSize == 0 || mutex == NULL) {
+        return false;
+    }
+
+    bool result = false;
+    if (xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        const ChannelEntry &entry = entries[index];
+        if (entry.seq != 0) {
+            strncpy(buffer, entry.stale ? notAvailableMsg : entry.text, bufferSize - 1);
+            buffer[bufferSize - 1] = '\0';
+            if (seq != nullptr) {
+                *seq = entry.seq;
+            }
+            result = true;
+        }
+        xSemaphoreGive(mutex);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Get the sequence number of a channel without copying its value
+ *
+ * A single aligned 32-bit read, used to cheaply detect changes before
+ * taking the mutex in read().
+ *
+ * @param index Channel index
+ * @return Sequence number, 0 if never updated or invalid index
+ */
+uint32_t ChannelTable::sequence(int index) const {
+    if (index < 0 || index >= CHANNEL_COUNT) {
+        return 0;
+    }
+    return entries[index].seq;
+}
+
+/**
+ * @brief Register a display user of a channel
+ * @param index Channel index
+ * @return true if this is the first user (topic must be subscribed)
+ */
+bool ChannelTable::acquire(int index) {
+    if (index < 0 || index >= CHANNEL_COUNT) {
+        return false;
+    }
+    return entries[index].subscribers++ == 0;
+}
+
+/**
+ * @brief Unregister a display user of a channel
+ * @param index Channel index
+ * @return true if this was the last user (topic may be unsubscribed)
+ */
+bool ChannelTable::release(int index) {
+    if (index < 0 || index >= CHANNEL_COUNT || entries[index].subscribers == 0) {
+        return false;
+    }
+    return --entries[index].subscribers == 0;
+}
+
+/**
+ * @brief Get the number of display users of a channel
+ * @param index Channel index
+ * @return Number of users, 0 for invalid index
+ */
+uint8_t ChannelTable::subscribers(int index) const {
+    if (index < 0 || index >= CHANNEL_COUNT) {
+        return 0;
+    }
+    return entries[index].subscribers;
+}
+
+/**
+ * @brief Mark channels stale whose timeout passed without an update
+ *
+ * Only the wheel slots of the ticks elapsed since the previous call are
+ * visited. A channel that went stale gets a new sequence number so that
+ * display zones re-render it as notAvailableMsg.
+ *
+ * @param now Current millis()
+ * @return Number of channels that became stale
+ */
+uint8_t ChannelTable::checkStale(unsigned long now) {
+    if (mutex == NULL) {
+        return 0;
+    }
+
+    uint8_t becameStale = 0;
+    if (xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        uint32_t before = staleEvents;
+        staleWheel.advance(now, onStaleDeadline, this);
+        becameStale = (uint8_t)(staleEvents - before);
+        xSemaphoreGive(mutex);
+    }
+
+    return becameStale;
+}
+
+/**
+ * @brief Timer wheel callback, caller holds the mutex
+ * @param id Channel index
+ * @param now Current millis()
+ * @param context ChannelTable instance
+ */
+void ChannelTable::onStaleDeadline(uint8_t id, unsigned long now, void *context) {
+    ChannelTable *table = static_cast<ChannelTable *>(context);
+    ChannelEntry &entry = table->entries[id];
+
+    unsigned long deadline = entry.updatedMillis + entry.staleTimeoutMs;
+    if ((long)(now - deadline) < 0) {
+        // Updated since the deadline was armed, or fired early
+        table->staleWheel.schedule(id, deadline);
+        return;
+    }
+
+    entry.stale = true;
+    entry.seq++;
+    table->staleEvents++;
+    LOG_INFO("Channel %s stale (no update for %u ms)", entry.code, entry.staleTimeoutMs);
+}
+
+/**
+ * @brief Check if a channel is stale
+ * @param index Channel index
+ * @return true if stale, false if fresh, never updated or invalid index
+ */
+bool ChannelTable::isStale(int index) const {
+    if (index < 0 || index >= CHANNEL_COUNT) {
+        return false;
+    }
+    return entries[index].stale;
+}
+
+/**
+ * @brief Change the stale timeout of a channel
+ *
+ * Takes effect when the armed deadline fires next.
+ *
+ * @param index Channel index
+ * @param timeoutMs Timeout in ms
+ */
+void ChannelTable::setStaleTimeout(int index, uint16_t timeoutMs) {
+    if (index < 0 || index >= CHANNEL_COUNT || timeoutMs == 0) {
+        return;
+    }
+    entries[index].staleTimeoutMs = timeoutMs;
+}
@@ -0,0 +1,242 @@
+// DeferredLog.cpp
+// Implementation of the deferred logger and its task
+
+#include "DeferredLog.h"
+#include "TaskRegistry.h"
+#include <stdarg.h>
+#include <string.h>
+
+static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "LOG_RING_SIZE must be a power of two");
+
+// Level letters in the printed lines, indexed by LOG_LEVEL_*
+static const char LOG_LEVEL_LETTERS[LOG_LEVEL_COUNT] = {'E', 'W', 'I', 'D'};
+static const char *const LOG_LEVEL_NAMES[LOG_LEVEL_COUNT] = {"error", "warn", "info", "debug"};
+
+// Global instance
+DeferredLog deferredLog;
+
+/**
+ * @brief Check if a line may be written
+ * @param now Current millis()
+ * @param suppressed Set to the lines skipped before this one
+ * @return true if the line is written
+ */
+bool LogSite::allow(uint32_t now, uint32_t &suppressed) {
+    uint32_t start = windowStart.load(std::memory_order_relaxed);
+    if (now - start >= LOG_SITE_WINDOW_MS &&
+        windowStart.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+        lines.store(0, std::memory_order_relaxed);
+    }
+    if (lines.fetch_add(1, std::memory_order_relaxed) >= LOG_SITE_BURST) {
+        skipped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    suppressed = skipped.exchange(0, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief Constructor for DeferredLog
+ */
+DeferredLog::DeferredLog()
+    : enqueuePosition(0), dequeuePosition(0), threshold(LOG_DEFAULT_LEVEL), written(0), dropped(0),
+      suppressedTotal(0), tailWritten(0), taskHandle(NULL) {
+    for (uint32_t i = 0; i < LOG_RING_SIZE; i++) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    tailMutex = xSemaphoreCreateMutex();
+    if (tailMutex == NULL) {
+        Serial.println("ERROR: Failed to create DeferredLog mutex!");
+    }
+}
+
+/**
+ * @brief Start the log task
+ * @return true if the task is running
+ */
+bool DeferredLog::begin() {
+    if (taskHandle != NULL) {
+        return true;
+    }
+
+    BaseType_t created = taskRegistry.create(
+        taskLoop,
+        "logTask",
+        LOG_TASK_STACK_SIZE,
+        this,
+        LOG_TASK_PRIORITY,
+        &taskHandle,
+        LOG_TASK_CORE);
+
+    if (created != pdPASS || taskHandle == NULL) {
+        taskHandle = NULL;
+        Serial.println("ERROR: Failed to create log task!");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Set the current level
+ * @param value LOG_LEVEL_*, larger values are capped to LOG_LEVEL_DEBUG
+ */
+void DeferredLog::setLevel(uint8_t value) {
+    threshold.store(value < LOG_LEVEL_COUNT ? value : LOG_LEVEL_DEBUG, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Format a line into the ring
+ *
+ * A slot is free for the writer at position p when its sequence equals p; the
+ * writer claims it by moving enqueuePosition past p, formats, then sets the
+ * sequence to p + 1 so the log task sees a complete line. The log task hands
+ * it back as p + LOG_RING_SIZE.
+ *
+ * @param site Rate limit of the call site
+ * @param level LOG_LEVEL_*
+ * @param format printf format, without the trailing newline
+ */
+void DeferredLog::write(LogSite &site, uint8_t level, const char *format, ...) {
+    uint32_t now = millis();
+    uint32_t suppressed = 0;
+    if (!site.allow(now, suppressed)) {
+        suppressedTotal.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    uint32_t position = enqueuePosition.load(std::memory_order_relaxed);
+    LogSlot *slot;
+    for (;;) {
+        slot = &slots[position % LOG_RING_SIZE];
+        int32_t state = (int32_t)(slot->sequence.load(std::memory_order_acquire) - position);
+        if (state == 0) {
+            if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (state < 0) {
+            // Not printed yet since the last lap: ring full
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            position = enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(slot->text, sizeof(slot->text), format, args);
+    va_end(args);
+    slot->millis = now;
+    slot->level = level;
+    slot->suppressed = suppressed > UINT16_MAX ? UINT16_MAX : (uint16_t)suppressed;
+    slot->sequence.store(position + 1, std::memory_order_release);
+    written.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Print the waiting lines and append them to the tail (log task)
+ *
+ * Stops at the first claimed slot that is still being formatted; it is
+ * printed on the next pass.
+ */
+void DeferredLog::drain() {
+    char line[LOG_LINE_SIZE + 48];
+    for (;;) {
+        LogSlot &slot = slots[dequeuePosition % LOG_RING_SIZE];
+        if (slot.sequence.load(std::memory_order_acquire) != dequeuePosition + 1) {
+            return;
+        }
+
+        int length;
+        if (slot.suppressed > 0) {
+            length = snprintf(line, sizeof(line), "[%7lu] %c %s (%u similar skipped)\n", (unsigned long)slot.millis,
+                              LOG_LEVEL_LETTERS[slot.level], slot.text, slot.suppressed);
+        } else {
+            length = snprintf(line, sizeof(line), "[%7lu] %c %s\n", (unsigned long)slot.millis,
+                              LOG_LEVEL_LETTERS[slot.level], slot.text);
+        }
+        slot.sequence.store(dequeuePosition + LOG_RING_SIZE, std::memory_order_release);
+        dequeuePosition++;
+
+        if (length < 0) {
+            continue;
+        }
+        if ((size_t)length >= sizeof(line)) {
+            length = sizeof(line) - 1;
+            line[length - 1] = '\n';
+        }
+        Serial.write((const uint8_t *)line, length);
+        appendTail(line, length);
+    }
+}
+
+/**
+ * @brief Append output to the tail ring (log task)
+ */
+void DeferredLog::appendTail(const char *text, size_t length) {
+    if (tailMutex == NULL || xSemaphoreTake(tailMutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return;
+    }
+    size_t offset = tailWritten % LOG_TAIL_SIZE;
+    size_t first = length < LOG_TAIL_SIZE - offset ? length : LOG_TAIL_SIZE - offset;
+    memcpy(tail + offset, text, first);
+    memcpy(tail, text + first, length - first);
+    tailWritten += length;
+    xSemaphoreGive(tailMutex);
+}
+
+/**
+ * @brief Get the total output offset of the oldest byte kept
+ * @return Offset to start readTail() from
+ */
+uint32_t DeferredLog::tailStart() const {
+    uint32_t total = tailWritten;
+    return total > LOG_TAIL_SIZE ? total - LOG_TAIL_SIZE : 0;
+}
+
+/**
+ * @brief Copy tail output, oldest first
+ * @param position Total output offset to read from, advanced by the bytes copied;
+ *                 moved up to the oldest byte kept if it was overwritten
+ * @param buffer Destination
+ * @param size Destination size
+ * @return Bytes copied, 0 at the end of the output
+ */
+size_t DeferredLog::readTail(uint32_t &position, char *buffer, size_t size) {
+    if (tailMutex == NULL || xSemaphoreTake(tailMutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return 0;
+    }
+    uint32_t oldest = tailWritten > LOG_TAIL_SIZE ? tailWritten - LOG_TAIL_SIZE : 0;
+    if (position < oldest) {
+        position = oldest;
+    }
+    size_t available = tailWritten - position;
+    size_t copied = available < size ? available : size;
+    size_t offset = position % LOG_TAIL_SIZE;
+    size_t first = copied < LOG_TAIL_SIZE - offset ? copied : LOG_TAIL_SIZE - offset;
+    memcpy(buffer, tail + offset, first);
+    memcpy(buffer + first, tail, copied - first);
+    position += copied;
+    xSemaphoreGive(tailMutex);
+    return copied;
+}
+
+/**
+ * @brief Get the name of a level
+ * @param level LOG_LEVEL_*
+ * @return Lower case name
+ */
+const char *DeferredLog::levelName(uint8_t level) {
+    return level < LOG_LEVEL_COUNT ? LOG_LEVEL_NAMES[level] : "unknown";
+}
+
+/**
+ * @brief Log task: prints the ring every LOG_DRAIN_INTERVAL_MS
+ */
+void DeferredLog::taskLoop(void *parameter) {
+    DeferredLog *log = static_cast<DeferredLog *>(parameter);
+    for (;;) {
+        log->drain();
+        vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_INTERVAL_MS));
+    }
+}
@@ -0,0 +1,173 @@
+// DisplayCompositor.cpp
+// Implementation of the main display layer compositor
+
+#include "DisplayCompositor.h"
+#include "DeferredLog.h"
+#include <string.h>
+
+// Global instance
+DisplayCompositor mainCompositor;
+
+/**
+ * @brief Constructor for DisplayCompositor
+ */
+DisplayCompositor::DisplayCompositor()
+    : renderedLayer(LAYER_NONE), renderedSeq(0), posted(0), absorbed(0), composed(0) {
+    mutex = xSemaphoreCreateMutex();
+    if (mutex == NULL) {
+        Serial.println("ERROR: Failed to create DisplayCompositor mutex!");
+    }
+
+    for (uint8_t l = 0; l < LAYER_COUNT; l++) {
+        layers[l].text[0] = '\0';
+        layers[l].active = false;
+        layers[l].timed = false;
+        layers[l].expiresMillis = 0;
+        layers[l].seq = 0;
+    }
+}
+
+/**
+ * @brief Destructor for DisplayCompositor
+ */
+DisplayCompositor::~DisplayCompositor() {
+    if (mutex != NULL) {
+        vSemaphoreDelete(mutex);
+    }
+}
+
+/**
+ * @brief Set the text of a layer
+ *
+ * Reposting the text already shown on a layer only refreshes its TTL, so a
+ * source may post on every update without causing redraws.
+ *
+ * @param layer Target layer
+ * @param text Message text
+ * @param ttlMs Time to live in ms, 0 to keep until cleared or replaced
+ * @return true if stored, false if invalid layer or mutex timeout
+ */
+bool DisplayCompositor::post(uint8_t layer, const char *text, uint32_t ttlMs) {
+    if (layer >= LAYER_COUNT || text == NULL || mutex == NULL) {
+        return false;
+    }
+
+    if (xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        unsigned long now = millis();
+        Layer &entry = layers[layer];
+        posted++;
+
+        if (!entry.active || strncmp(entry.text, text, MESSAGE_BUFFER_SIZE - 1) != 0) {
+            strncpy(entry.text, text, MESSAGE_BUFFER_SIZE - 1);
+            entry.text[MESSAGE_BUFFER_SIZE - 1] = '\0';
+            entry.seq++;
+
+            uint8_t visible = topLocked(now);
+            if (visible != LAYER_NONE && visible > layer) {
+                absorbed++;
+            }
+        }
+
+        entry.active = true;
+        entry.timed = ttlMs != 0;
+        entry.expiresMillis = now + ttlMs;
+        xSemaphoreGive(mutex);
+        return true;
+    }
+
+    LOG_WARN("DisplayCompositor::post() mutex timeout");
+    return false;
+}
+
+/**
+ * @brief Remove the message of a layer
+ * @param layer Target layer
+ */
+void DisplayCompositor::clear(uint8_t layer) {
+    if (layer >= LAYER_COUNT || mutex == NULL) {
+        return;
+    }
+
+    if (xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        layers[layer].active = false;
+        xSemaphoreGive(mutex);
+    }
+}
+
+/**
+ * @brief Get the highest active layer, expiring layers whose TTL passed
+ * @param now Current millis()
+ * @return Visible layer, or LAYER_NONE if nothing was posted yet
+ */
+uint8_t DisplayCompositor::top(unsigned long now) {
+    if (mutex == NULL) {
+        return LAYER_NONE;
+    }
+
+    uint8_t result = LAYER_NONE;
+    if (xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        result = topLocked(now);
+        xSemaphoreGive(mutex);
+    }
+    return result;
+}
+
+/**
+ * @brief Copy the visible message if it changed since the last call
+ *
+ * Only the visible layer and its sequence number are compared, so updates to
+ * hidden layers never cause a redraw.
+ *
+ * @param now Current millis()
+ * @param buffer Buffer to copy the text into
+ * @param bufferSize Size of the buffer
+ * @return true if the buffer was filled and must be rendered
+ */
+bool DisplayCompositor::compose(unsigned long now, char *buffer, size_t bufferSize) {
+    if (buffer == NULL || bufferSize == 0 || mutex == NULL) {
+        return false;
+    }
+
+    bool changed = false;
+    if (xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        uint8_t visible = topLocked(now);
+        if (visible != LAYER_NONE &&
+            (visible != renderedLayer || layers[visible].seq != renderedSeq)) {
+            strncpy(buffer, layers[visible].text, bufferSize - 1);
+            buffer[bufferSize - 1] = '\0';
+            renderedLayer = visible;
+            renderedSeq = layers[visible].seq;
+            composed++;
+            changed = true;
+        }
+        xSemaphoreGive(mutex);
+    }
+    return changed;
+}
+
+/**
+ * @brief Force the next compose() call to report a change
+ */
+void DisplayCompositor::invalidate() {
+    renderedLayer = LAYER_NONE;
+}
+
+/**
+ * @brief Select the visible layer, caller must hold the mutex
+ * @param now Current millis()
+ * @return Visible layer, or LAYER_NONE if no layer is active
+ */
+uint8_t DisplayCompositor::topLocked(unsigned long now) {
+    for (int8_t l = LAYER_COUNT - 1; l >= 0; l--) {
+        Layer &entry = layers[l];
+        if (!entry.active) {
+            continue;
+        }
+        if (entry.timed && (long)(now - entry.expiresMillis) >= 0) {
+            entry.active = false;
+            continue;
+        }
+        return l;
+    }
+    return LAYER_NONE;
+}
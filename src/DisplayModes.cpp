@@ -0,0 +1,206 @@
+// DisplayModes.cpp
+// Implementation of the graphical main display render modes
+
+#include "DisplayModes.h"
+#include <string.h>
+
+// Primary display channel selected in the menu
+extern char dataIndex[];
+
+// Global instance
+MainDisplayGraph mainGraph;
+
+// Row masks (bit 0 is the top row of a module)
+static const uint8_t BAR_ROWS = 0x7E;     // Rows 1-6 for the bar body
+static const uint8_t MARKER_ROWS = 0x81;  // Top and bottom rows for shift markers
+
+/**
+ * @brief Constructor for MainDisplayGraph
+ */
+MainDisplayGraph::MainDisplayGraph()
+    : mx(nullptr), mode(RENDER_MODE_TEXT), dirty(false), lastDrawMillis(0),
+      rpm(0.0f), shiftBlinkOn(false), lastBlinkMillis(0), historyHead(0), historyCount(0) {
+    sparkCode[0] = '\0';
+    memset(history, 0, sizeof(history));
+}
+
+/**
+ * @brief Attach the graph to the display driver
+ * @param graphics MD_MAX72XX instance from MD_Parola::getGraphicObject()
+ */
+void MainDisplayGraph::begin(MD_MAX72XX *graphics) {
+    mx = graphics;
+    dirty = true;
+}
+
+/**
+ * @brief Select the render mode
+ * @param newMode One of RENDER_MODE_*
+ */
+void MainDisplayGraph::setMode(uint8_t newMode) {
+    if (newMode >= RENDER_MODE_COUNT) {
+        newMode = RENDER_MODE_TEXT;
+    }
+    mode = newMode;
+    dirty = true;
+}
+
+/**
+ * @brief Get the channel drawn by the current mode
+ * @return "RPM" for the bar graph, the primary channel otherwise
+ */
+const char *MainDisplayGraph::channelCode() const {
+    return mode == RENDER_MODE_BAR ? "RPM" : dataIndex;
+}
+
+/**
+ * @brief Feed a numeric channel value
+ *
+ * RPM is always tracked for the bar graph. Values of the channel selected for
+ * the primary display are appended to the sparkline ring buffer; the buffer
+ * restarts when the selected channel changes.
+ *
+ * @param code Three letter channel code (e.g. "RPM")
+ * @param value Parsed numeric value
+ */
+void MainDisplayGraph::pushSample(const char *code, float value) {
+    if (code == nullptr) {
+        return;
+    }
+
+    if (strcmp(code, "RPM") == 0) {
+        rpm = value;
+        if (mode == RENDER_MODE_BAR) {
+            dirty = true;
+        }
+    }
+
+    if (strcmp(code, dataIndex) == 0) {
+        if (strcmp(sparkCode, code) != 0) {
+            strncpy(sparkCode, code, sizeof(sparkCode) - 1);
+            sparkCode[sizeof(sparkCode) - 1] = '\0';
+            historyHead = 0;
+            historyCount = 0;
+        }
+
+        history[historyHead] = value;
+        historyHead = (historyHead + 1) % SPARKLINE_HISTORY_SIZE;
+        if (historyCount < SPARKLINE_HISTORY_SIZE) {
+            historyCount++;
+        }
+
+        if (mode == RENDER_MODE_SPARK) {
+            dirty = true;
+        }
+    }
+}
+
+/**
+ * @brief Redraw the display if there is new data and the redraw interval elapsed
+ *
+ * All columns are written with display updates suspended and flushed once,
+ * so a redraw costs a single SPI transfer per module.
+ *
+ * @return true if the columns were rewritten
+ */
+bool MainDisplayGraph::render() {
+    if (mx == nullptr || mode == RENDER_MODE_TEXT) {
+        return false;
+    }
+
+    unsigned long now = millis();
+
+    // Blink the whole bar above the shift point
+    if (mode == RENDER_MODE_BAR && rpm >= RPM_SHIFT_POINT &&
+        now - lastBlinkMillis >= RPM_SHIFT_BLINK_MS) {
+        lastBlinkMillis = now;
+        shiftBlinkOn = !shiftBlinkOn;
+        dirty = true;
+    }
+
+    if (!dirty || now - lastDrawMillis < GRAPH_MIN_REDRAW_INTERVAL_MS) {
+        return false;
+    }
+
+    dirty = false;
+    lastDrawMillis = now;
+
+    uint16_t columns = mx->getColumnCount();
+
+    mx->control(MD_MAX72XX::UPDATE, MD_MAX72XX::OFF);
+    if (mode == RENDER_MODE_BAR) {
+        drawRpmBar(columns);
+    } else {
+        drawSparkline(columns);
+    }
+    mx->control(MD_MAX72XX::UPDATE, MD_MAX72XX::ON);
+
+    return true;
+}
+
+/**
+ * @brief Draw the RPM bar graph
+ *
+ * The bar grows from the left edge. Column 0 of MD_MAX72XX is the rightmost
+ * column, so bar position x maps to column (columns - 1 - x). Shift markers
+ * are drawn on the top and bottom rows at RPM_SHIFT_WARN and RPM_SHIFT_POINT.
+ *
+ * @param columns Total number of columns in the chain
+ */
+void MainDisplayGraph::drawRpmBar(uint16_t columns) {
+    float clamped = rpm < 0.0f ? 0.0f : (rpm > RPM_BAR_MAX ? RPM_BAR_MAX : rpm);
+    uint16_t filled = (uint16_t)((clamped * columns) / RPM_BAR_MAX);
+    uint16_t warnCol = (uint16_t)(((uint32_t)RPM_SHIFT_WARN * columns) / RPM_BAR_MAX);
+    uint16_t shiftCol = (uint16_t)(((uint32_t)RPM_SHIFT_POINT * columns) / RPM_BAR_MAX);
+    bool overShift = rpm >= RPM_SHIFT_POINT;
+
+    for (uint16_t x = 0; x < columns; x++) {
+        uint8_t bits = 0;
+
+        if (x < filled) {
+            bits = BAR_ROWS;
+        }
+        if (x == warnCol || x == shiftCol) {
+            bits |= MARKER_ROWS;
+        }
+        if (overShift && !shiftBlinkOn) {
+            bits = (x < filled) ? MARKER_ROWS : 0;
+        }
+
+        mx->setColumn(columns - 1 - x, bits);
+    }
+}
+
+/**
+ * @brief Draw the sparkline of the selected channel
+ *
+ * The newest sample is drawn in the rightmost column. The vertical scale
+ * follows the minimum and maximum of the samples currently in the buffer.
+ *
+ * @param columns Total number of columns in the chain
+ */
+void MainDisplayGraph::drawSparkline(uint16_t columns) {
+    float minValue = 0.0f;
+    float maxValue = 0.0f;
+
+    for (uint8_t i = 0; i < historyCount; i++) {
+        float value = history[(historyHead + SPARKLINE_HISTORY_SIZE - 1 - i) % SPARKLINE_HISTORY_SIZE];
+        if (i == 0 || value < minValue) minValue = value;
+        if (i == 0 || value > maxValue) maxValue = value;
+    }
+
+    float span = maxValue - minValue;
+
+    for (uint16_t col = 0; col < columns; col++) {
+        uint8_t bits = 0;
+
+        if (col < historyCount) {
+            float value = history[(historyHead + SPARKLINE_HISTORY_SIZE - 1 - col) % SPARKLINE_HISTORY_SIZE];
+            uint8_t level = (span > 0.0f) ? (uint8_t)(((value - minValue) * 7.0f) / span + 0.5f) : 3;
+            // Filled area from the bottom row up to the sample level
+            bits = (uint8_t)(0xFF << (7 - level));
+        }
+
+        mx->setColumn(col, bits);
+    }
+}
@@ -0,0 +1,148 @@
+// DisplayZones.cpp
+// Implementation of the multi-zone main display layout
+
+#include "DisplayZones.h"
+#include "MqttSetup.h"
+#include "DeferredLog.h"
+#include <string.h>
+
+static_assert(DOT_MATRIX_ZONE_COUNT >= 1 && DOT_MATRIX_ZONE_COUNT <= MAX_DISPLAY_ZONES,
+              "DOT_MATRIX_ZONE_COUNT must be between 1 and MAX_DISPLAY_ZONES");
+static_assert(DOT_MATRIX_MAX_DEVICES % DOT_MATRIX_ZONE_COUNT == 0,
+              "DOT_MATRIX_MAX_DEVICES must be a multiple of DOT_MATRIX_ZONE_COUNT");
+
+extern MqttSetup mqttSetup;
+
+// Global instance
+DisplayZones mainZones;
+
+// Marker for "render on next pass", never produced by the channel table
+static const uint32_t SEQ_INVALID = 0xFFFFFFFFUL;
+
+/**
+ * @brief Constructor for DisplayZones
+ */
+DisplayZones::DisplayZones() : parola(nullptr) {
+    for (uint8_t z = 0; z < MAX_DISPLAY_ZONES; z++) {
+        channel[z] = -1;
+        renderedSeq[z] = SEQ_INVALID;
+        strncpy(text[z], "---", CHANNEL_TEXT_SIZE - 1);
+        text[z][CHANNEL_TEXT_SIZE - 1] = '\0';
+    }
+}
+
+/**
+ * @brief Configure the MD_Parola zones
+ *
+ * MD_Parola numbers modules from the right end of the chain, zones are laid
+ * out so that zone 0 is the leftmost one.
+ *
+ * @param display Main display, already started with begin(DOT_MATRIX_ZONE_COUNT)
+ */
+void DisplayZones::begin(MD_Parola *display) {
+    parola = display;
+    if (parola == nullptr || DOT_MATRIX_ZONE_COUNT == 1) {
+        return;
+    }
+
+    const uint8_t modulesPerZone = DOT_MATRIX_MAX_DEVICES / DOT_MATRIX_ZONE_COUNT;
+    for (uint8_t z = 0; z < DOT_MATRIX_ZONE_COUNT; z++) {
+        uint8_t start = (DOT_MATRIX_ZONE_COUNT - 1 - z) * modulesPerZone;
+        parola->setZone(z, start, start + modulesPerZone - 1);
+    }
+
+    Serial.printf("Main display split into %d zones of %d modules\n",
+                  DOT_MATRIX_ZONE_COUNT, modulesPerZone);
+}
+
+/**
+ * @brief Bind a zone to a channel, updating the MQTT subscriptions
+ * @param zone Zone number
+ * @param code Three letter channel code
+ * @return true if the binding changed
+ */
+bool DisplayZones::bind(uint8_t zone, const char *code) {
+    if (zone >= DOT_MATRIX_ZONE_COUNT) {
+        LOG_ERROR("Invalid zone %d (max: %d)", zone, DOT_MATRIX_ZONE_COUNT - 1);
+        return false;
+    }
+
+    int index = g_channels.indexOf(code);
+    if (index < 0) {
+        LOG_ERROR("Unknown channel for zone %d", zone);
+        return false;
+    }
+
+    if (channel[zone] == index) {
+        return false;
+    }
+
+    if (channel[zone] >= 0) {
+        mqttSetup.unsubscribeChannel(g_channels.codeAt(channel[zone]));
+    }
+    mqttSetup.subscribeChannel(code);
+
+    channel[zone] = index;
+    renderedSeq[zone] = SEQ_INVALID;
+    return true;
+}
+
+/**
+ * @brief Get the channel code bound to a zone
+ * @param zone Zone number
+ * @return Channel code, or nullptr if the zone is unbound
+ */
+const char *DisplayZones::boundCode(uint8_t zone) const {
+    if (zone >= DOT_MATRIX_ZONE_COUNT) {
+        return nullptr;
+    }
+    return g_channels.codeAt(channel[zone]);
+}
+
+/**
+ * @brief Force every zone to be re-rendered on the next render() call
+ */
+void DisplayZones::invalidate() {
+    for (uint8_t z = 0; z < DOT_MATRIX_ZONE_COUNT; z++) {
+        renderedSeq[z] = SEQ_INVALID;
+    }
+}
+
+/**
+ * @brief Re-render zones whose channel received a new value
+ *
+ * Only the sequence number is compared on the fast path; the text is copied
+ * and handed to MD_Parola only for zones that changed and whose previous
+ * frame has finished.
+ *
+ * @param primary false to leave zone 0 to an overlay message
+ * @return Number of zones that were re-rendered
+ */
+uint8_t DisplayZones::render(bool primary) {
+    if (parola == nullptr) {
+        return 0;
+    }
+
+    uint8_t rendered = 0;
+    for (uint8_t z = primary ? 0 : 1; z < DOT_MATRIX_ZONE_COUNT; z++) {
+        if (channel[z] < 0) {
+            continue;
+        }
+
+        uint32_t seq = g_channels.sequence(channel[z]);
+        if (seq == renderedSeq[z] || !parola->getZoneStatus(z)) {
+            continue;
+        }
+
+        if (!g_channels.read(channel[z], text[z], sizeof(text[z]), &seq)) {
+            strncpy(text[z], "---", CHANNEL_TEXT_SIZE - 1);
+            text[z][CHANNEL_TEXT_SIZE - 1] = '\0';
+        }
+
+        parola->displayZoneText(z, text[z], PA_RIGHT, 0, 0, PA_PRINT, PA_NO_EFFECT);
+        renderedSeq[z] = seq;
+        rendered++;
+    }
+
+    return rendered;
+}
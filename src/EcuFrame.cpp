@@ -0,0 +1,107 @@
+// EcuFrame.cpp
+// Implementation of the packed ECU frame decoder
+
+#include "EcuFrame.h"
+#include <string.h>
+
+// Channels sent with one decimal, in ecuDataStrings order
+static const bool ECU_FRAME_TENTHS[ECU_CHANNEL_COUNT] = {
+    false, false, false, true,  // RPM TPS VE1 O2P
+    true,  false, false, false, // AFT MAT CAD MAP
+    true,  false, true,  false, // BAT ADV PW1 SPK
+    true,  false, false, false, // DWL ILL BAR TAE
+    false, false                // NER ENG
+};
+
+/**
+ * @brief Constructor for EcuFrameDecoder
+ */
+EcuFrameDecoder::EcuFrameDecoder() : received(0), rejected(0), lost(0), lastSeq(0) {
+}
+
+/**
+ * @brief Decode a frame payload
+ *
+ * The payload is copied once into an aligned frame after its length is
+ * checked, then every channel is formatted from it.
+ *
+ * @param bytes Payload
+ * @param length Payload length
+ * @param samples Output, ECU_CHANNEL_COUNT entries in ecuDataStrings order
+ * @param receivedMicros micros() when the message was received
+ * @return true if the payload is a valid frame, false if rejected
+ */
+bool EcuFrameDecoder::decode(const char *bytes, int length, DisplaySample *samples, uint32_t receivedMicros) {
+    EcuFrame frame;
+    if (bytes == nullptr || length != (int)sizeof(frame)) {
+        rejected++;
+        return false;
+    }
+    memcpy(&frame, bytes, sizeof(frame));
+    if (frame.magic != ECU_FRAME_MAGIC || frame.version != ECU_FRAME_VERSION) {
+        rejected++;
+        return false;
+    }
+
+    if (received > 0) {
+        uint16_t gap = frame.seq - lastSeq - 1;
+        // A large jump backwards is a publisher restart, not loss
+        if (gap < 0x8000) {
+            lost += gap;
+        }
+    }
+    lastSeq = frame.seq;
+    received++;
+
+    for (uint8_t i = 0; i < ECU_CHANNEL_COUNT; i++) {
+        DisplaySample &sample = samples[i];
+        strncpy(sample.code, ecuDataStrings[i], sizeof(sample.code) - 1);
+        sample.code[sizeof(sample.code) - 1] = '\0';
+        sample.value = format(i, frame.values[i], sample.text, sizeof(sample.text));
+        sample.receivedMicros = receivedMicros;
+    }
+    return true;
+}
+
+/**
+ * @brief Format one channel value as display text, with its unit
+ * @param index ECU channel index (ecuDataStrings order)
+ * @param raw Value as sent in the frame
+ * @param text Output buffer
+ * @param size Size of the output buffer
+ * @return Numeric value
+ */
+float EcuFrameDecoder::format(uint8_t index, int16_t raw, char *text, size_t size) {
+    const char *suffix = unit(ecuDataStrings[index]);
+    if (!ECU_FRAME_TENTHS[index]) {
+        snprintf(text, size, "%d%s", raw, suffix);
+        return raw;
+    }
+
+    int whole = raw / 10;
+    int tenths = raw % 10;
+    snprintf(text, size, "%s%d.%d%s", (raw < 0 && whole == 0) ? "-" : "", whole,
+             tenths < 0 ? -tenths : tenths, suffix);
+    return raw / 10.0f;
+}
+
+/**
+ * @brief Get the display unit of an ECU channel
+ * @param code Three letter channel code
+ * @return Unit suffix, "" if none
+ */
+const char *EcuFrameDecoder::unit(const char *code) {
+    if (strcmp(code, "TPS") == 0 || strcmp(code, "VE1") == 0 || strcmp(code, "TAE") == 0) {
+        return "%";
+    }
+    if (strcmp(code, "MAT") == 0 || strcmp(code, "CAD") == 0) {
+        return "C";
+    }
+    if (strcmp(code, "BAT") == 0) {
+        return "V";
+    }
+    if (strcmp(code, "DWL") == 0) {
+        return "ms";
+    }
+    return "";
+}
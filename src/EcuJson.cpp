@@ -0,0 +1,188 @@
+// EcuJson.cpp
+// Implementation of the ECU JSON batch parser
+
+#include "EcuJson.h"
+#include "EcuFrame.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Skip JSON whitespace
+ * @param p Current position
+ * @param end End of the payload
+ * @return First non-whitespace position (or end)
+ */
+static const char *skipSpace(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+        p++;
+    }
+    return p;
+}
+
+/**
+ * @brief Find the closing quote of a string token
+ * @param p Position after the opening quote
+ * @param end End of the payload
+ * @return Position of the closing quote, nullptr if unterminated
+ */
+static const char *stringEnd(const char *p, const char *end) {
+    while (p < end && *p != '"') {
+        // Escaped characters are skipped, never needed in codes or values
+        p += (*p == '\\') ? 2 : 1;
+    }
+    return p < end ? p : nullptr;
+}
+
+/**
+ * @brief Check for an unquoted JSON literal
+ * @param value Value characters (not terminated)
+ * @param length Value length
+ * @return true for true, false or null
+ */
+static bool isLiteral(const char *value, size_t length) {
+    return (length == 4 && memcmp(value, "true", 4) == 0) || (length == 5 && memcmp(value, "false", 5) == 0) ||
+           (length == 4 && memcmp(value, "null", 4) == 0);
+}
+
+/**
+ * @brief Find the ECU channel of a key
+ * @param key Key characters (not terminated)
+ * @param length Key length
+ * @return Index in ecuDataStrings, -1 if unknown
+ */
+static int ecuIndexOf(const char *key, size_t length) {
+    if (length != DATA_INDEX_SIZE - 1) {
+        return -1;
+    }
+    for (int i = 0; i < ECU_CHANNEL_COUNT; i++) {
+        if (memcmp(ecuDataStrings[i], key, length) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Constructor for EcuJsonParser
+ */
+EcuJsonParser::EcuJsonParser() : received(0), rejected(0), unknownKeys(0) {
+}
+
+/**
+ * @brief Parse a payload into display samples
+ * @param bytes Payload (need not be terminated)
+ * @param length Payload length
+ * @param samples Output, room for ECU_CHANNEL_COUNT entries
+ * @param receivedMicros micros() when the message was received
+ * @return Number of samples, 0 if the message was rejected or had no known keys
+ */
+uint8_t EcuJsonParser::parse(const char *bytes, int length, DisplaySample *samples, uint32_t receivedMicros) {
+    received++;
+    if (bytes == nullptr || length <= 0) {
+        rejected++;
+        return 0;
+    }
+
+    const char *end = bytes + length;
+    const char *p = skipSpace(bytes, end);
+    uint8_t count = 0;
+    uint32_t unknown = 0;
+
+    if (p == end || *p++ != '{') {
+        rejected++;
+        return 0;
+    }
+    p = skipSpace(p, end);
+    bool closed = p < end && *p == '}';
+    if (closed) {
+        p++;
+    }
+
+    while (!closed) {
+        // "KEY"
+        if (p == end || *p != '"') {
+            break;
+        }
+        const char *key = p + 1;
+        const char *keyEnd = stringEnd(key, end);
+        if (keyEnd == nullptr) {
+            break;
+        }
+        p = skipSpace(keyEnd + 1, end);
+        if (p == end || *p++ != ':') {
+            break;
+        }
+        p = skipSpace(p, end);
+        if (p == end) {
+            break;
+        }
+
+        // Value: string, number or literal
+        const char *value;
+        const char *valueEnd;
+        bool literal = false;
+        float number = 0.0f;
+        if (*p == '"') {
+            value = p + 1;
+            valueEnd = stringEnd(value, end);
+            if (valueEnd == nullptr) {
+                break;
+            }
+            p = valueEnd + 1;
+            // strtof stops at the closing quote
+            number = strtof(value, nullptr);
+        } else if (*p == '{' || *p == '[') {
+            break;
+        } else {
+            value = p;
+            while (p < end && *p != ',' && *p != '}' && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r') {
+                p++;
+            }
+            valueEnd = p;
+            if (valueEnd == end || valueEnd == value) {
+                break;
+            }
+            literal = isLiteral(value, valueEnd - value);
+            if (!literal) {
+                // Anything else unquoted must be a number, ending at the delimiter
+                char *numberEnd = nullptr;
+                number = strtof(value, &numberEnd);
+                if (numberEnd != valueEnd) {
+                    break;
+                }
+            }
+        }
+
+        int index = ecuIndexOf(key, keyEnd - key);
+        if (index < 0) {
+            unknown++;
+        } else if (!literal && valueEnd > value && count < ECU_CHANNEL_COUNT) {
+            DisplaySample &sample = samples[count++];
+            memcpy(sample.code, ecuDataStrings[index], sizeof(sample.code));
+            sample.value = number;
+            snprintf(sample.text, sizeof(sample.text), "%.*s%s", (int)(valueEnd - value), value,
+                     EcuFrameDecoder::unit(sample.code));
+            sample.receivedMicros = receivedMicros;
+        }
+
+        p = skipSpace(p, end);
+        if (p < end && *p == ',') {
+            p = skipSpace(p + 1, end);
+        } else if (p < end && *p == '}') {
+            p++;
+            closed = true;
+        } else {
+            break;
+        }
+    }
+
+    // Only whitespace (or the terminator the client adds) may follow the object
+    p = skipSpace(p, end);
+    if (!closed || (p < end && *p != '\0')) {
+        rejected++;
+        return 0;
+    }
+
+    unknownKeys += unknown;
+    return count;
+}
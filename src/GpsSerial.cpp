@@ -0,0 +1,146 @@
+// GpsSerial.cpp
+// Implementation of the NMEA GPS UART ingest task
+
+#include "GpsSerial.h"
+#include "NetworkTask.h"
+#include "TaskRegistry.h"
+#include <esp_task_wdt.h>
+#include <string.h>
+
+// Global instance
+GpsSerial gpsSerial;
+
+/**
+ * @brief Fill one GPS sample
+ * @param sample Sample to fill
+ * @param channel Index in gpsDataStrings
+ * @param value Numeric value
+ * @param receivedMicros micros() when the sentence was complete
+ * @return Text buffer of the sample
+ */
+static char *gpsSample(DisplaySample &sample, uint8_t channel, float value, uint32_t receivedMicros) {
+    memcpy(sample.code, gpsDataStrings[channel], sizeof(sample.code));
+    sample.value = value;
+    sample.receivedMicros = receivedMicros;
+    return sample.text;
+}
+
+/**
+ * @brief Constructor for GpsSerial
+ */
+GpsSerial::GpsSerial()
+    : taskHandle(NULL), lastSentenceMillis(0), bytes(0), sentenceMicros(0) {
+}
+
+/**
+ * @brief Open the UART and start the reading task
+ *
+ * Must be called after networkTask.begin().
+ *
+ * @return true if the task is running
+ */
+bool GpsSerial::begin() {
+    if (taskHandle != NULL) {
+        return true;
+    }
+
+    // Receive only, so no TX pin is claimed from the other peripherals
+    Serial1.begin(GPS_BAUD, SERIAL_8N1, GPS_RX_PIN, -1);
+
+    BaseType_t created = taskRegistry.create(
+        taskLoop,
+        "gpsTask",
+        GPS_TASK_STACK_SIZE,
+        this,
+        GPS_TASK_PRIORITY,
+        &taskHandle,
+        GPS_TASK_CORE);
+
+    if (created != pdPASS || taskHandle == NULL) {
+        taskHandle = NULL;
+        Serial.println("ERROR: Failed to create GPS task!");
+        return false;
+    }
+
+    esp_task_wdt_add(taskHandle);
+    Serial.printf("GPS serial ingest started (%d baud)\n", GPS_BAUD);
+    return true;
+}
+
+/**
+ * @brief Check if recent data came from the serial link
+ * @return true if a sentence was parsed within GPS_LIVE_TIMEOUT_MS
+ */
+bool GpsSerial::isLive() const {
+    return parser.sentenceCount() > 0 && millis() - lastSentenceMillis < GPS_LIVE_TIMEOUT_MS;
+}
+
+/**
+ * @brief Hand the channels updated by the last sentence to the displays
+ *
+ * Texts match the MQTT GPS path: SPD "57kmh", TME "HH:MM" (colon blanked
+ * on odd seconds), DTE "dd/mm", ALT "123.4m".
+ *
+ * @param completedMicros micros() when the sentence was complete
+ */
+void GpsSerial::deliver(uint32_t completedMicros) {
+    const GpsFix &fix = parser.fix();
+    DisplaySample samples[GPS_CHANNEL_COUNT];
+    uint8_t count = 0;
+    char *text;
+
+    if (fix.updated & GPS_FIELD_SPEED) {
+        text = gpsSample(samples[count++], 0, fix.speedKmh, completedMicros);
+        snprintf(text, CHANNEL_TEXT_SIZE, "%dkmh", (int)fix.speedKmh);
+    }
+    if (fix.updated & GPS_FIELD_TIME) {
+        text = gpsSample(samples[count++], 1, fix.hour, completedMicros);
+        snprintf(text, CHANNEL_TEXT_SIZE, "%02u%c%02u", fix.hour, fix.second % 2 ? ' ' : ':', fix.minute);
+    }
+    if (fix.updated & GPS_FIELD_DATE) {
+        text = gpsSample(samples[count++], 2, fix.day, completedMicros);
+        snprintf(text, CHANNEL_TEXT_SIZE, "%02u/%02u", fix.day, fix.month);
+    }
+    if (fix.updated & GPS_FIELD_POSITION) {
+        text = gpsSample(samples[count++], 3, fix.latitude, completedMicros);
+        snprintf(text, CHANNEL_TEXT_SIZE, "%.5f", fix.latitude);
+        text = gpsSample(samples[count++], 4, fix.longitude, completedMicros);
+        snprintf(text, CHANNEL_TEXT_SIZE, "%.5f", fix.longitude);
+    }
+    if (fix.updated & GPS_FIELD_ALTITUDE) {
+        text = gpsSample(samples[count++], 5, fix.altitude, completedMicros);
+        snprintf(text, CHANNEL_TEXT_SIZE, "%.1fm", fix.altitude);
+    }
+    if (fix.updated & GPS_FIELD_COURSE) {
+        text = gpsSample(samples[count++], 6, fix.course, completedMicros);
+        snprintf(text, CHANNEL_TEXT_SIZE, "%.1f", fix.course);
+    }
+    if (fix.updated & GPS_FIELD_QUALITY) {
+        text = gpsSample(samples[count++], 7, fix.quality, completedMicros);
+        snprintf(text, CHANNEL_TEXT_SIZE, "%u", fix.quality);
+    }
+
+    networkTask.pushSamples(samples, count);
+    lastSentenceMillis = millis();
+    sentenceMicros = micros() - completedMicros;
+}
+
+/**
+ * @brief Task body: drain the UART through the parser
+ * @param parameter The GpsSerial instance
+ */
+void GpsSerial::taskLoop(void *parameter) {
+    GpsSerial &self = *static_cast<GpsSerial *>(parameter);
+
+    while (1) {
+        int available = Serial1.available();
+        for (int i = 0; i < available; i++) {
+            if (self.parser.feed((char)Serial1.read())) {
+                self.deliver(micros());
+            }
+        }
+        self.bytes += available;
+        esp_task_wdt_reset();
+        vTaskDelay(pdMS_TO_TICKS(GPS_READ_INTERVAL_MS));
+    }
+}
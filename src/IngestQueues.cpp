@@ -0,0 +1,212 @@
+// IngestQueues.cpp
+// Implementation of the per-class ingest queues
+
+#include "IngestQueues.h"
+#include "DeferredLog.h"
+#include "Metrics.h"
+#include "Trace.h"
+
+static_assert(CHANNEL_COUNT <= 32, "Pending display slots are tracked in a 32-bit mask");
+
+/**
+ * @brief Constructor for IngestQueues
+ */
+IngestQueues::IngestQueues()
+    : criticalQueue(NULL), diagnosticQueue(NULL), slotMutex(NULL), pendingMask(0), pendingCount(0) {
+    for (uint8_t c = 0; c < INGEST_CLASS_COUNT; c++) {
+        classStats[c].received = 0;
+        classStats[c].dropped = 0;
+        classStats[c].highWater = 0;
+    }
+}
+
+/**
+ * @brief Create the queues and the slot mutex
+ * @return true if all were created
+ */
+bool IngestQueues::beginQueues() {
+    if (slotMutex != NULL) {
+        return true;
+    }
+
+    criticalQueue = xQueueCreate(INGEST_CRITICAL_QUEUE_LENGTH, sizeof(CriticalMessage));
+    diagnosticQueue = xQueueCreate(INGEST_DIAGNOSTIC_QUEUE_LENGTH, sizeof(DiagnosticMessage));
+    slotMutex = xSemaphoreCreateMutex();
+    return criticalQueue != NULL && diagnosticQueue != NULL && slotMutex != NULL;
+}
+
+/**
+ * @brief Store the latest value of a channel for the main display (producer)
+ *
+ * A value that was not read yet is overwritten and counted as dropped, the
+ * display only ever needs the latest one.
+ *
+ * @param sample Formatted channel value
+ * @return true if stored without overwriting an unread value
+ */
+bool IngestQueues::pushSample(const DisplaySample &sample) {
+    return pushSamples(&sample, 1) == 1;
+}
+
+/**
+ * @brief Store the latest values of several channels under one lock (producer)
+ *
+ * Used for a whole ECU frame, so the main loop never sees half of it.
+ * Unknown channel codes are skipped.
+ *
+ * @param samples Formatted channel values
+ * @param count Number of samples
+ * @return Number stored without overwriting an unread value
+ */
+uint8_t IngestQueues::pushSamples(const DisplaySample *samples, uint8_t count) {
+    TRACE_SCOPE(TRACE_QUEUE);
+    if (slotMutex == NULL) {
+        return 0;
+    }
+
+    uint8_t clean = 0;
+    if (xSemaphoreTake(slotMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        IngestStats &stats = classStats[INGEST_DISPLAY];
+        for (uint8_t i = 0; i < count; i++) {
+            int index = g_channels.indexOf(samples[i].code);
+            if (index < 0) {
+                continue;
+            }
+            uint32_t bit = 1UL << index;
+            stats.received++;
+            channelMessages.add(index);
+            if (pendingMask & bit) {
+                stats.dropped++;
+            } else {
+                pendingMask |= bit;
+                pendingCount++;
+                clean++;
+            }
+            slots[index] = samples[i];
+        }
+        noteBacklog(INGEST_DISPLAY, pendingCount);
+        xSemaphoreGive(slotMutex);
+    }
+    return clean;
+}
+
+/**
+ * @brief Take one pending channel value (main loop)
+ * @param sample Output sample
+ * @return true if a sample was taken
+ */
+bool IngestQueues::popSample(DisplaySample &sample) {
+    if (slotMutex == NULL || pendingMask == 0) {
+        return false;
+    }
+
+    bool taken = false;
+    if (xSemaphoreTake(slotMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        if (pendingMask != 0) {
+            uint8_t index = __builtin_ctz(pendingMask);
+            sample = slots[index];
+            pendingMask &= ~(1UL << index);
+            pendingCount--;
+            taken = true;
+        }
+        xSemaphoreGive(slotMutex);
+    }
+    return taken;
+}
+
+/**
+ * @brief Queue a critical message, waiting a bounded time while the queue is full (producer)
+ *
+ * While the network task waits it reads nothing from the socket, which
+ * pushes back on the broker during a burst. A queue that stays full for
+ * INGEST_CRITICAL_WAIT_MS means the main loop stopped draining: the message
+ * is dropped and counted, and the producer goes on, so the stalled main loop
+ * is caught by its own watchdog instead of both tasks waiting forever.
+ *
+ * @param message Message to deliver
+ * @return true if queued, false if dropped after the wait
+ */
+bool IngestQueues::pushCritical(const CriticalMessage &message) {
+    if (criticalQueue == NULL) {
+        return false;
+    }
+
+    IngestStats &stats = classStats[INGEST_CRITICAL];
+    stats.received++;
+    if (xQueueSend(criticalQueue, &message, pdMS_TO_TICKS(INGEST_CRITICAL_WAIT_MS)) != pdTRUE) {
+        stats.dropped++;
+        LOG_WARN("Critical queue full for %d ms, message dropped", INGEST_CRITICAL_WAIT_MS);
+        return false;
+    }
+    noteBacklog(INGEST_CRITICAL, uxQueueMessagesWaiting(criticalQueue));
+    return true;
+}
+
+/**
+ * @brief Take the oldest critical message (main loop)
+ * @param message Output message
+ * @return true if a message was taken
+ */
+bool IngestQueues::popCritical(CriticalMessage &message) {
+    return criticalQueue != NULL && xQueueReceive(criticalQueue, &message, 0) == pdTRUE;
+}
+
+/**
+ * @brief Queue a diagnostic message if there is room (producer)
+ *
+ * Diagnostics are shed as soon as their queue is full, or earlier when the
+ * critical queue is half full, to leave the main loop time for the rest.
+ *
+ * @param message Message to deliver
+ * @return true if queued, false if shed
+ */
+bool IngestQueues::pushDiagnostic(const DiagnosticMessage &message) {
+    if (diagnosticQueue == NULL) {
+        return false;
+    }
+
+    IngestStats &stats = classStats[INGEST_DIAGNOSTIC];
+    stats.received++;
+
+    bool overloaded = uxQueueMessagesWaiting(criticalQueue) > INGEST_CRITICAL_QUEUE_LENGTH / 2;
+    if (overloaded || xQueueSend(diagnosticQueue, &message, 0) != pdTRUE) {
+        stats.dropped++;
+        return false;
+    }
+
+    noteBacklog(INGEST_DIAGNOSTIC, uxQueueMessagesWaiting(diagnosticQueue));
+    return true;
+}
+
+/**
+ * @brief Take the oldest diagnostic message (main loop)
+ * @param message Output message
+ * @return true if a message was taken
+ */
+bool IngestQueues::popDiagnostic(DiagnosticMessage &message) {
+    return diagnosticQueue != NULL && xQueueReceive(diagnosticQueue, &message, 0) == pdTRUE;
+}
+
+/**
+ * @brief Get the counters of an ingest class
+ * @param ingestClass One of INGEST_*
+ * @return Counters, zero for an invalid class
+ */
+IngestStats IngestQueues::stats(uint8_t ingestClass) const {
+    if (ingestClass >= INGEST_CLASS_COUNT) {
+        IngestStats none = {0, 0, 0};
+        return none;
+    }
+    return classStats[ingestClass];
+}
+
+/**
+ * @brief Track the largest backlog of a class
+ * @param ingestClass One of INGEST_*
+ * @param backlog Messages currently waiting
+ */
+void IngestQueues::noteBacklog(uint8_t ingestClass, uint16_t backlog) {
+    if (backlog > classStats[ingestClass].highWater) {
+        classStats[ingestClass].highWater = backlog;
+    }
+}
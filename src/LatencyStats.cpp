@@ -0,0 +1,90 @@
+// LatencyStats.cpp
+// Implementation of the latency histogram
+
+#include "LatencyStats.h"
+
+// Global instance
+LatencyStats displayLatency;
+
+/**
+ * @brief Constructor for LatencyStats
+ */
+LatencyStats::LatencyStats() {
+    reset();
+}
+
+/**
+ * @brief Record one latency sample
+ * @param latencyUs Latency in microseconds
+ */
+void LatencyStats::record(uint32_t latencyUs) {
+    uint32_t bucket = latencyUs / 1000;
+    if (bucket >= LATENCY_HISTOGRAM_BUCKETS) {
+        bucket = LATENCY_HISTOGRAM_BUCKETS - 1;
+    }
+
+    buckets[bucket]++;
+    total++;
+    if (latencyUs > maxLatencyUs) {
+        maxLatencyUs = latencyUs;
+    }
+}
+
+/**
+ * @brief Remember the start time of the event being measured
+ * @param startMicros micros() when the event entered the pipeline
+ */
+void LatencyStats::start(uint32_t startMicros) {
+    pendingMicros = startMicros;
+    pending = true;
+}
+
+/**
+ * @brief Record the latency of the pending event, if any
+ * @param nowMicros Current micros()
+ */
+void LatencyStats::finish(uint32_t nowMicros) {
+    if (!pending) {
+        return;
+    }
+    record(nowMicros - pendingMicros);
+    pending = false;
+}
+
+/**
+ * @brief Get a percentile of the recorded latencies
+ * @param percent Percentile (1..100)
+ * @return Upper bound of the bucket in ms, 0 if nothing was recorded
+ */
+uint16_t LatencyStats::percentileMs(uint8_t percent) const {
+    if (total == 0) {
+        return 0;
+    }
+    if (percent > 100) {
+        percent = 100;
+    }
+
+    // Rank of the sample at the requested percentile, rounded up
+    uint32_t rank = (uint32_t)(((uint64_t)total * percent + 99) / 100);
+    uint32_t seen = 0;
+    for (uint16_t b = 0; b < LATENCY_HISTOGRAM_BUCKETS; b++) {
+        seen += buckets[b];
+        if (seen >= rank) {
+            return b + 1;
+        }
+    }
+    return LATENCY_HISTOGRAM_BUCKETS;
+}
+
+/**
+ * @brief Clear all samples
+ */
+void LatencyStats::reset() {
+    for (uint16_t b = 0; b < LATENCY_HISTOGRAM_BUCKETS; b++) {
+        buckets[b] = 0;
+    }
+    total = 0;
+    maxLatencyUs = 0;
+    pendingMicros = 0;
+    pending = false;
+}
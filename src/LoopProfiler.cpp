@@ -0,0 +1,156 @@
+// LoopProfiler.cpp
+// Implementation of the main loop stage profiler
+
+#include "LoopProfiler.h"
+#include "DeferredLog.h"
+#include <string.h>
+
+// Names of the stages, indexed by LOOP_STAGE_*, then the whole iteration
+static const char *const LOOP_STAGE_NAMES[LOOP_STAGE_COUNT + 1] = {
+    "wifi", "samples", "display", "switches", "web", "tasks", "total"};
+
+// Default budgets in microseconds, same order
+static const uint32_t LOOP_DEFAULT_BUDGETS_US[LOOP_STAGE_COUNT + 1] = {
+    LOOP_BUDGET_WIFI_US, LOOP_BUDGET_SAMPLES_US, LOOP_BUDGET_DISPLAY_US, LOOP_BUDGET_SWITCHES_US,
+    LOOP_BUDGET_WEB_US, LOOP_BUDGET_TASKS_US, LOOP_BUDGET_TOTAL_US};
+
+// Global instance
+LoopProfiler loopProfiler;
+
+/**
+ * @brief Constructor for LoopProfiler
+ */
+LoopProfiler::LoopProfiler() : iterationStart(0), stageStart(0) {
+    memcpy(budgets, LOOP_DEFAULT_BUDGETS_US, sizeof(budgets));
+    memset(current, 0, sizeof(current));
+    reset();
+}
+
+/**
+ * @brief Clear the counters, maxima, histogram and slowest iterations
+ */
+void LoopProfiler::reset() {
+    memset(last, 0, sizeof(last));
+    memset(maxima, 0, sizeof(maxima));
+    memset(overruns, 0, sizeof(overruns));
+    memset(histogram, 0, sizeof(histogram));
+    memset(slow, 0, sizeof(slow));
+    for (uint8_t i = 0; i < LOOP_SLOWEST_COUNT; i++) {
+        order[i] = i;
+    }
+    iterations = 0;
+    slowUsed = 0;
+}
+
+/**
+ * @brief End the iteration and check it against the budgets
+ * @param now Current micros()
+ * @return Work time of the iteration in microseconds
+ */
+uint32_t LoopProfiler::finish(uint32_t now) {
+    uint32_t total = now - iterationStart;
+    iterations++;
+
+    // Stage with the largest overrun, or the longest one if none overran
+    uint8_t worst = 0;
+    uint32_t worstOverrun = 0;
+    for (uint8_t stage = 0; stage < LOOP_STAGE_COUNT; stage++) {
+        uint32_t duration = current[stage];
+        last[stage] = duration;
+        if (duration > maxima[stage]) {
+            maxima[stage] = duration;
+        }
+        if (duration > budgets[stage]) {
+            overruns[stage]++;
+            if (duration - budgets[stage] > worstOverrun) {
+                worstOverrun = duration - budgets[stage];
+                worst = stage;
+            }
+        } else if (worstOverrun == 0 && duration > current[worst]) {
+            worst = stage;
+        }
+    }
+
+    last[LOOP_STAGE_TOTAL] = total;
+    if (total > maxima[LOOP_STAGE_TOTAL]) {
+        maxima[LOOP_STAGE_TOTAL] = total;
+    }
+    if (total > budgets[LOOP_STAGE_TOTAL]) {
+        overruns[LOOP_STAGE_TOTAL]++;
+        LOG_DEBUG("Loop took %lu us, %s at %lu us", (unsigned long)total, LOOP_STAGE_NAMES[worst],
+                  (unsigned long)current[worst]);
+    }
+
+    // Bucket 0 is below 64 us, bucket n covers [32 << n, 64 << n)
+    uint8_t bucket = 0;
+    if (total >= 64) {
+        bucket = 31 - __builtin_clz(total) - 5;
+        if (bucket >= LOOP_HISTOGRAM_BUCKETS) {
+            bucket = LOOP_HISTOGRAM_BUCKETS - 1;
+        }
+    }
+    histogram[bucket]++;
+
+    // Keep it if it is among the slowest, replacing the fastest kept one
+    if (slowUsed == LOOP_SLOWEST_COUNT && total <= slow[order[LOOP_SLOWEST_COUNT - 1]].totalMicros) {
+        return total;
+    }
+    uint8_t position = slowUsed < LOOP_SLOWEST_COUNT ? slowUsed++ : LOOP_SLOWEST_COUNT - 1;
+    uint8_t slot = order[position];
+    LoopIteration &iteration = slow[slot];
+    iteration.millis = millis();
+    iteration.totalMicros = total;
+    memcpy(iteration.stageMicros, current, sizeof(iteration.stageMicros));
+    iteration.worstStage = worst;
+    iteration.overrunMicros = worstOverrun;
+
+    while (position > 0 && slow[order[position - 1]].totalMicros < total) {
+        order[position] = order[position - 1];
+        position--;
+    }
+    order[position] = slot;
+    return total;
+}
+
+/**
+ * @brief Set the budget of a stage
+ * @param stage LOOP_STAGE_* or LOOP_STAGE_TOTAL
+ * @param micros Budget in microseconds
+ */
+void LoopProfiler::setBudget(uint8_t stage, uint32_t micros) {
+    if (stage <= LOOP_STAGE_TOTAL) {
+        budgets[stage] = micros;
+    }
+}
+
+/**
+ * @brief Get the name of a stage
+ * @param stage LOOP_STAGE_* or LOOP_STAGE_TOTAL
+ * @return Name for /loop and /metrics
+ */
+const char *LoopProfiler::stageName(uint8_t stage) {
+    return stage <= LOOP_STAGE_TOTAL ? LOOP_STAGE_NAMES[stage] : "unknown";
+}
+
+/**
+ * @brief Find a stage by name
+ * @param name Stage name, "total" for the whole iteration
+ * @return LOOP_STAGE_* or LOOP_STAGE_TOTAL, -1 if unknown
+ */
+int LoopProfiler::findStage(const char *name) {
+    for (uint8_t stage = 0; stage <= LOOP_STAGE_TOTAL; stage++) {
+        if (strcmp(name, LOOP_STAGE_NAMES[stage]) == 0) {
+            return stage;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Get the upper bound of a histogram bucket
+ * @param bucket 0..LOOP_HISTOGRAM_BUCKETS-1
+ * @return Microseconds, 0 for the last (open) bucket
+ */
+uint32_t LoopProfiler::bucketLimit(uint8_t bucket) {
+    return bucket < LOOP_HISTOGRAM_BUCKETS - 1 ? (uint32_t)64 << bucket : 0;
+}
@@ -16,6 +16,24 @@
 #include "MqttSetup.h"
 #include "TimerButtons.h"
 #include "SharedData.h"
+#include "DisplayModes.h"
+#include "DisplayZones.h"
+#include "PageScheduler.h"
+#include "DisplayCompositor.h"
+#include "RefreshLimiter.h"
+#include "ChannelTable.h"
+#include "NetworkTask.h"
+#include "LatencyStats.h"
+#include "BootTimeline.h"
+#include "TimerState.h"
+#include "SpeeduinoSerial.h"
+#include "GpsSerial.h"
+#include "UdpListener.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include "TaskRegistry.h"
+#include "DeferredLog.h"
+#include "LoopProfiler.h"
 #include "Constants.h"
 #include <WebServer.h>
 #include <WiFi.h>
@@ -33,14 +51,19 @@ const char *WELCOME_MSG2 = WELCOME_MSG_SECONDARY;
 
 // MQTT topic strings - using const char* to avoid heap fragmentation
 const char MQTT_ECU_TOPIC[] = "/GOLF86/ECU/";
+const char MQTT_ECU_FRAME_TOPIC[] = "/GOLF86/ECU/frame";
+const char MQTT_ECU_JSON_TOPIC[] = "/GOLF86/ECU/json";
 const char MQTT_GPS_TOPIC[] = "/GOLF86/GPS/";
 const char MQTT_TIMER1_TOPIC[] = "/GOLF86/TM1/";
 const char MQTT_TIMER2_TOPIC[] = "/GOLF86/TM2/";
+const char MQTT_ALERT_TOPIC[] = "/GOLF86/ALERT";
+const char MQTT_DIAG_TOPIC[] = "/GOLF86/DIAG/";
 
 // Global message buffers shared by Serial and Scrolling functions
 char notAvailableMsg[] = "..N/A..";
 bool firstRun = true;
 bool newMessageAvailable = false;
+uint32_t newMessageSeq = 0; // Values of the selected channel drained for the base layer
 char curMessage[MESSAGE_BUFFER_SIZE];
 char newMessage[MESSAGE_BUFFER_SIZE];
 
@@ -96,8 +119,30 @@ const char* htmlPage = R"rawliteral(
     <p><strong>Uptime:</strong> %UPTIME%</p>
     <p><strong>Free Heap:</strong> %FREE_HEAP%</p>
     <p><strong>WiFi Signal Strength:</strong> %SIGNAL_STRENGTH%</p>
+    <p><strong>WiFi Reconnects:</strong> %WIFI_RECONNECTS%</p>
+    <p><strong>WiFi Connected After Power-on:</strong> %WIFI_CONNECT_TIME%</p>
+    <p><strong>Boot Timeline:</strong> %BOOT_TIMELINE%</p>
+    <p><strong>MQTT Broker (active / switches / last switchover):</strong> %MQTT_BROKER%</p>
+    <p><strong>MQTT Reconnects (primary / secondary):</strong> %MQTT_RECONNECTS%</p>
+    <p><strong>MQTT Time to Data (from loss / from connect):</strong> %MQTT_TIME_TO_DATA%</p>
+    <p><strong>Timer Topics (mode / state rate / state messages):</strong> %TIMER_PUBLISH%</p>
+    <p><strong>Held Publishes (held / collapsed / dropped / forwarded / max delay):</strong> %PUBLISH_BUFFER%</p>
+    <p><strong>Network Commands (periodic superseded / overflowed / dropped):</strong> %NET_COMMANDS%</p>
     <p><strong>MQTT Server:</strong> %MQTT_SERVER%</p>
     <p><strong>MQTT Port:</strong> %MQTT_PORT%</p>
+    <p><strong>Main Display (received / coalesced / unchanged / rendered):</strong> %MAIN_REFRESH%</p>
+    <p><strong>Secondary Display (received / coalesced / unchanged / rendered):</strong> %SECONDARY_REFRESH%</p>
+    <p><strong>Stale Events (channels / secondary):</strong> %STALE_EVENTS%</p>
+    <p><strong>Display Latency p50 / p95 / p99 / max (ms):</strong> %LATENCY%</p>
+    <p><strong>Speeduino Serial (polls / responses / timeouts / junk bytes / round trip):</strong> %SPEEDUINO_SERIAL%</p>
+    <p><strong>GPS Serial (sentences / checksum errors / ignored / bytes / parse time):</strong> %GPS_SERIAL%</p>
+    <p><strong>ECU Frames (received / rejected / lost):</strong> %ECU_FRAMES%</p>
+    <p><strong>ECU JSON (received / rejected / unknown keys):</strong> %ECU_JSON%</p>
+    <p><strong>UDP Telemetry (port / received / rejected / lost / late / max handling):</strong> %UDP_TELEMETRY%</p>
+    <p><strong>Critical Messages (received / dropped / high water):</strong> %INGEST_CRITICAL%</p>
+    <p><strong>Channel Values (received / coalesced / high water):</strong> %INGEST_DISPLAY%</p>
+    <p><strong>Diagnostics (received / dropped / high water):</strong> %INGEST_DIAGNOSTIC%</p>
+    <p><strong>Log (lines / dropped / rate limited / level):</strong> %LOG%</p>
   </div>
 </body>
 </html>)rawliteral";
@@ -115,15 +160,386 @@ String processor(const String& var) {
   } else if (var == "SIGNAL_STRENGTH") {
     snprintf(buffer, sizeof(buffer), "%d dBm", WiFi.RSSI());
     return String(buffer);
+  } else if (var == "WIFI_RECONNECTS") {
+    snprintf(buffer, sizeof(buffer), "%lu", (unsigned long)wifiSetup.reconnectCount());
+    return String(buffer);
+  } else if (var == "WIFI_CONNECT_TIME") {
+    snprintf(buffer, sizeof(buffer), "%lu ms (%s)", wifiSetup.bootConnectMs(),
+             wifiSetup.bootConnectWasFast() ? "fast" : "full");
+    return String(buffer);
+  } else if (var == "BOOT_TIMELINE") {
+    String timeline;
+    for (uint8_t i = 0; i < bootTimeline.count(); i++) {
+      snprintf(buffer, sizeof(buffer), "%s%s %lu ms", i ? ", " : "",
+               bootTimeline.stageAt(i), bootTimeline.millisAt(i));
+      timeline += buffer;
+    }
+    return timeline;
+  } else if (var == "MQTT_BROKER") {
+    const BrokerList &brokers = mqttSetup.brokerList();
+    snprintf(buffer, sizeof(buffer), "%s:%d (%u of %u) / %lu / %lu ms",
+             brokers.host(brokers.active()), brokers.port(brokers.active()),
+             brokers.active() + 1, brokers.count(),
+             (unsigned long)brokers.switchCount(), (unsigned long)brokers.lastSwitchoverMs());
+    return String(buffer);
+  } else if (var == "MQTT_RECONNECTS") {
+    snprintf(buffer, sizeof(buffer), "%lu / %lu",
+             (unsigned long)mqttSetup.primaryLinkState().reconnects,
+             (unsigned long)mqttSetup.secondaryLinkState().reconnects);
+    return String(buffer);
+  } else if (var == "MQTT_TIME_TO_DATA") {
+    const MqttLinkState &link = mqttSetup.primaryLinkState();
+    snprintf(buffer, sizeof(buffer), "%lu ms / %lu ms",
+             (unsigned long)link.timeToDataMs, (unsigned long)link.connectToDataMs);
+    return String(buffer);
+  } else if (var == "SPEEDUINO_SERIAL") {
+    if (!SPEEDUINO_SERIAL_ENABLED) {
+      return String("disabled");
+    }
+    snprintf(buffer, sizeof(buffer), "%lu / %lu / %lu / %lu / %lu us",
+             (unsigned long)speeduinoSerial.pollCount(), (unsigned long)speeduinoSerial.frameCount(),
+             (unsigned long)speeduinoSerial.timeoutCount(), (unsigned long)speeduinoSerial.junkCount(),
+             (unsigned long)speeduinoSerial.lastResponseMicros());
+    return String(buffer);
+  } else if (var == "GPS_SERIAL") {
+    if (!GPS_SERIAL_ENABLED) {
+      return String("disabled");
+    }
+    snprintf(buffer, sizeof(buffer), "%lu / %lu / %lu / %lu / %lu us",
+             (unsigned long)gpsSerial.sentenceCount(), (unsigned long)gpsSerial.checksumErrorCount(),
+             (unsigned long)gpsSerial.ignoredCount(), (unsigned long)gpsSerial.byteCount(),
+             (unsigned long)gpsSerial.lastSentenceMicros());
+    return String(buffer);
+  } else if (var == "ECU_FRAMES") {
+    const EcuFrameDecoder &frames = mqttSetup.ecuFrameDecoder();
+    snprintf(buffer, sizeof(buffer), "%lu / %lu / %lu",
+             (unsigned long)frames.receivedCount(), (unsigned long)frames.rejectedCount(),
+             (unsigned long)frames.lostCount());
+    return String(buffer);
+  } else if (var == "ECU_JSON") {
+    const EcuJsonParser &json = mqttSetup.ecuJsonParser();
+    snprintf(buffer, sizeof(buffer), "%lu / %lu / %lu",
+             (unsigned long)json.receivedCount(), (unsigned long)json.rejectedCount(),
+             (unsigned long)json.unknownKeyCount());
+    return String(buffer);
+  } else if (var == "UDP_TELEMETRY") {
+    if (udpListener.boundPort() == 0) {
+      return String("off");
+    }
+    const UdpIngest &udp = udpListener.ingest();
+    snprintf(buffer, sizeof(buffer), "%u / %lu / %lu / %lu / %lu / %lu us",
+             udpListener.boundPort(), (unsigned long)udp.receivedCount(),
+             (unsigned long)udp.rejectedCount(), (unsigned long)udp.lostCount(),
+             (unsigned long)udp.lateCount(), (unsigned long)udpListener.maxHandlingMicros());
+    return String(buffer);
+  } else if (var == "TIMER_PUBLISH") {
+    static const char *const modes[TIMER_PUBLISH_COUNT] = {"legacy", "state", "both"};
+    snprintf(buffer, sizeof(buffer), "%s / %u Hz / %lu",
+             modes[wifiSetup.config.timerPublish], wifiSetup.config.timerStateRateHz,
+             (unsigned long)timerState.publishedCount());
+    return String(buffer);
+  } else if (var == "PUBLISH_BUFFER") {
+    const PublishBuffer &outbox = mqttSetup.publishBuffer();
+    snprintf(buffer, sizeof(buffer), "%lu / %lu / %lu / %lu / %lu ms",
+             (unsigned long)outbox.heldCount(), (unsigned long)outbox.collapsedCount(),
+             (unsigned long)outbox.droppedCount(), (unsigned long)outbox.forwardedCount(),
+             (unsigned long)outbox.maxDelayMs());
+    return String(buffer);
+  } else if (var == "NET_COMMANDS") {
+    snprintf(buffer, sizeof(buffer), "%lu / %lu / %lu", (unsigned long)networkTask.commandsSuperseded(),
+             (unsigned long)networkTask.commandsOverflowed(), (unsigned long)networkTask.commandsDropped());
+    return String(buffer);
   } else if (var == "MQTT_SERVER") {
     return String(wifiSetup.config.mqtt_server);
   } else if (var == "MQTT_PORT") {
     return String(wifiSetup.config.mqtt_port);
+  } else if (var == "MAIN_REFRESH" || var == "SECONDARY_REFRESH") {
+    const RefreshLimiter &limiter = (var == "MAIN_REFRESH") ? mainRefresh : secondaryRefresh;
+    snprintf(buffer, sizeof(buffer), "%lu / %lu / %lu / %lu",
+             (unsigned long)limiter.receivedCount(), (unsigned long)limiter.coalescedCount(),
+             (unsigned long)limiter.unchangedCount(), (unsigned long)limiter.renderedCount());
+    return String(buffer);
+  } else if (var == "STALE_EVENTS") {
+    snprintf(buffer, sizeof(buffer), "%lu / %lu",
+             (unsigned long)g_channels.staleEventCount(), (unsigned long)secondaryStaleEvents);
+    return String(buffer);
+  } else if (var == "LATENCY") {
+    snprintf(buffer, sizeof(buffer), "%u / %u / %u / %lu (%lu samples, %s)",
+             displayLatency.percentileMs(50), displayLatency.percentileMs(95),
+             displayLatency.percentileMs(99), (unsigned long)(displayLatency.maxUs() / 1000),
+             (unsigned long)displayLatency.count(), NETWORK_TASK_ENABLED ? "network task" : "inline MQTT");
+    return String(buffer);
+  } else if (var == "INGEST_CRITICAL" || var == "INGEST_DISPLAY" || var == "INGEST_DIAGNOSTIC") {
+    uint8_t ingestClass = (var == "INGEST_CRITICAL") ? INGEST_CRITICAL
+                        : (var == "INGEST_DISPLAY") ? INGEST_DISPLAY : INGEST_DIAGNOSTIC;
+    IngestStats stats = networkTask.stats(ingestClass);
+    snprintf(buffer, sizeof(buffer), "%lu / %lu / %u",
+             (unsigned long)stats.received, (unsigned long)stats.dropped, stats.highWater);
+    return String(buffer);
+  } else if (var == "LOG") {
+    snprintf(buffer, sizeof(buffer), "%lu / %lu / %lu / %s",
+             (unsigned long)deferredLog.writtenCount(), (unsigned long)deferredLog.droppedCount(),
+             (unsigned long)deferredLog.suppressedCount(), DeferredLog::levelName(deferredLog.level()));
+    return String(buffer);
   }
   return String();
 }
 
+// Values other modules already keep, read when /metrics is scraped
+static MetricCallback metricWifiReconnects(
+    "g86_wifi_reconnects_total", "WiFi reconnects after a lost link", METRIC_COUNTER,
+    [](uint8_t, uint32_t &value) { value = wifiSetup.reconnectCount(); return true; });
+static MetricCallback metricMqttReconnects(
+    "g86_mqtt_reconnects_total", "MQTT reconnects after a lost connection", METRIC_COUNTER,
+    [](uint8_t index, uint32_t &value) {
+      value = (index == 0 ? mqttSetup.primaryLinkState() : mqttSetup.secondaryLinkState()).reconnects;
+      return true;
+    },
+    "client", [](uint8_t index) { return index == 0 ? "primary" : "secondary"; }, 2);
+static MetricCallback metricFreeHeap(
+    "g86_heap_free_bytes", "Free heap", METRIC_GAUGE,
+    [](uint8_t, uint32_t &value) { value = ESP.getFreeHeap(); return true; });
+static MetricCallback metricMinFreeHeap(
+    "g86_heap_min_free_bytes", "Lowest free heap since boot", METRIC_GAUGE,
+    [](uint8_t, uint32_t &value) { value = ESP.getMinFreeHeap(); return true; });
+static MetricCallback metricTaskStacks(
+    "g86_task_stack_free_bytes", "Stack high-water mark (least free) per task", METRIC_GAUGE,
+    [](uint8_t index, uint32_t &value) {
+      TaskRecord record;
+      if (!taskRegistry.get(index, record)) {
+        return false;
+      }
+      value = record.stackFree;
+      return true;
+    },
+    "task", [](uint8_t index) {
+      TaskRecord record;
+      return taskRegistry.get(index, record) ? record.name : "";
+    }, TASK_REGISTRY_SIZE);
+static MetricCallback metricCoreIdle(
+    "g86_core_idle_permille", "Idle share of each core over the last measured interval", METRIC_GAUGE,
+    [](uint8_t index, uint32_t &value) {
+      value = taskRegistry.idlePermille(index);
+      return taskRegistry.idleSampleMillis() != 0;
+    },
+    "core", [](uint8_t index) { return index == 0 ? "0" : "1"; }, portNUM_PROCESSORS);
+static MetricCallback metricLogLines(
+    "g86_log_lines_total", "Log lines by outcome", METRIC_COUNTER,
+    [](uint8_t index, uint32_t &value) {
+      value = index == 0 ? deferredLog.writtenCount()
+            : index == 1 ? deferredLog.droppedCount() : deferredLog.suppressedCount();
+      return true;
+    },
+    "result", [](uint8_t index) { return index == 0 ? "written" : index == 1 ? "dropped" : "rate_limited"; }, 3);
+static MetricCallback metricLoopOverruns(
+    "g86_loop_stage_overruns_total", "Main loop iterations in which a stage exceeded its budget", METRIC_COUNTER,
+    [](uint8_t index, uint32_t &value) { value = loopProfiler.overrunCount(index); return true; },
+    "stage", [](uint8_t index) { return LoopProfiler::stageName(index); }, LOOP_STAGE_COUNT + 1);
+static MetricCallback metricLoopMax(
+    "g86_loop_stage_max_microseconds", "Longest run of each main loop stage since the last reset", METRIC_GAUGE,
+    [](uint8_t index, uint32_t &value) { value = loopProfiler.maxMicros(index); return true; },
+    "stage", [](uint8_t index) { return LoopProfiler::stageName(index); }, LOOP_STAGE_COUNT + 1);
+
+void handleMetrics() {
+  TRACE_SCOPE(TRACE_WEB_REQUEST);
+  String text;
+  text.reserve(METRICS_RESPONSE_RESERVE);
+  Metric::writeAll(text);
+  taskRegistry.requestIdleSample(); // Idle time for the next scrape
+  server.send(200, "text/plain; version=0.0.4", text);
+}
+
+// Registered tasks with their last stack and CPU sample
+void handleTasks() {
+  TRACE_SCOPE(TRACE_WEB_REQUEST);
+  String text;
+  char line[96];
+  text.reserve(TASK_REGISTRY_SIZE * sizeof(line));
+  text += "task                  core prio   stack min free  cpu %\n";
+  for (uint8_t i = 0; i < TASK_REGISTRY_SIZE; i++) {
+    TaskRecord record;
+    if (!taskRegistry.get(i, record)) {
+      continue;
+    }
+    char cpu[8] = "n/a";
+    if (TaskRegistry::hasRunTimeStats()) {
+      snprintf(cpu, sizeof(cpu), "%u.%u", record.cpuPermille / 10, record.cpuPermille % 10);
+    }
+    snprintf(line, sizeof(line), "%-21s %4d %4u %7lu %8lu %6s\n", record.name, record.core, record.priority,
+             (unsigned long)record.stackSize, (unsigned long)record.stackFree, cpu);
+    text += line;
+  }
+  // Without run-time stats this shows the window measured for the last request
+  unsigned long idleMillis = taskRegistry.idleSampleMillis();
+  for (uint8_t core = 0; core < portNUM_PROCESSORS; core++) {
+    uint16_t idle = taskRegistry.idlePermille(core);
+    if (idleMillis == 0) {
+      snprintf(line, sizeof(line), "core %u idle n/a (measuring, reload in a second)\n", core);
+    } else if (TaskRegistry::hasRunTimeStats()) {
+      snprintf(line, sizeof(line), "core %u idle %u.%u %%\n", core, idle / 10, idle % 10);
+    } else {
+      snprintf(line, sizeof(line), "core %u idle %u.%u %% (%lu s ago)\n", core, idle / 10, idle % 10,
+               (millis() - idleMillis) / 1000);
+    }
+    text += line;
+  }
+  taskRegistry.requestIdleSample();
+  server.send(200, "text/plain", text);
+}
+
+// Last LOG_TAIL_SIZE bytes of log output; ?level=error|warn|info|debug sets the level
+void handleLog() {
+  TRACE_SCOPE(TRACE_WEB_REQUEST);
+  if (server.hasArg("level")) {
+    for (uint8_t level = 0; level < LOG_LEVEL_COUNT; level++) {
+      if (server.arg("level") == DeferredLog::levelName(level)) {
+        deferredLog.setLevel(level);
+      }
+    }
+  }
+
+  char chunk[LOG_TAIL_CHUNK];
+  snprintf(chunk, sizeof(chunk), "# level %s, %lu lines, %lu dropped, %lu rate limited\n",
+           DeferredLog::levelName(deferredLog.level()), (unsigned long)deferredLog.writtenCount(),
+           (unsigned long)deferredLog.droppedCount(), (unsigned long)deferredLog.suppressedCount());
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "text/plain", chunk);
+
+  uint32_t position = deferredLog.tailStart();
+  bool lineStart = position == 0;
+  size_t length;
+  while ((length = deferredLog.readTail(position, chunk, sizeof(chunk))) > 0) {
+    size_t skip = 0;
+    if (!lineStart) {
+      // The oldest line kept is cut, start after it
+      while (skip < length && chunk[skip] != '\n') {
+        skip++;
+      }
+      if (skip == length) {
+        continue;
+      }
+      skip++;
+      lineStart = true;
+    }
+    server.sendContent(chunk + skip, length - skip);
+  }
+  server.sendContent("");
+}
+
+// Main loop stages against their budgets, work time histogram and slowest iterations;
+// ?stage=<name>&budget=<us> sets a budget, ?reset=1 clears the statistics
+void handleLoop() {
+  TRACE_SCOPE(TRACE_WEB_REQUEST);
+  if (server.hasArg("stage") && server.hasArg("budget")) {
+    int stage = LoopProfiler::findStage(server.arg("stage").c_str());
+    long budget = server.arg("budget").toInt();
+    if (stage < 0 || budget <= 0) {
+      server.send(400, "text/plain", "unknown stage or invalid budget");
+      return;
+    }
+    loopProfiler.setBudget(stage, budget);
+  }
+  if (server.hasArg("reset")) {
+    loopProfiler.reset();
+  }
+
+  String text;
+  char line[128];
+  text.reserve(LOOP_RESPONSE_RESERVE);
+  snprintf(line, sizeof(line), "%lu iterations\nstage     budget us  last us   max us  overruns\n",
+           (unsigned long)loopProfiler.iterationCount());
+  text += line;
+  for (uint8_t stage = 0; stage <= LOOP_STAGE_TOTAL; stage++) {
+    snprintf(line, sizeof(line), "%-9s %9lu %8lu %8lu %9lu\n", LoopProfiler::stageName(stage),
+             (unsigned long)loopProfiler.budget(stage), (unsigned long)loopProfiler.lastMicros(stage),
+             (unsigned long)loopProfiler.maxMicros(stage), (unsigned long)loopProfiler.overrunCount(stage));
+    text += line;
+  }
+
+  text += "\nwork per iteration (2 ms pause excluded)\n";
+  for (uint8_t bucket = 0; bucket < LOOP_HISTOGRAM_BUCKETS; bucket++) {
+    uint32_t limit = LoopProfiler::bucketLimit(bucket);
+    if (limit != 0) {
+      snprintf(line, sizeof(line), "  < %6lu us %9lu\n", (unsigned long)limit,
+               (unsigned long)loopProfiler.histogramCount(bucket));
+    } else {
+      snprintf(line, sizeof(line), " >= %6lu us %9lu\n", (unsigned long)LoopProfiler::bucketLimit(bucket - 1),
+               (unsigned long)loopProfiler.histogramCount(bucket));
+    }
+    text += line;
+  }
+
+  text += "\nslowest iterations\n     at ms  total us  worst     over us";
+  for (uint8_t stage = 0; stage < LOOP_STAGE_COUNT; stage++) {
+    snprintf(line, sizeof(line), " %8s", LoopProfiler::stageName(stage));
+    text += line;
+  }
+  text += "\n";
+  for (uint8_t i = 0; i < loopProfiler.slowestCount(); i++) {
+    const LoopIteration &iteration = loopProfiler.slowest(i);
+    snprintf(line, sizeof(line), "%10lu %9lu  %-9s %7lu", (unsigned long)iteration.millis,
+             (unsigned long)iteration.totalMicros, LoopProfiler::stageName(iteration.worstStage),
+             (unsigned long)iteration.overrunMicros);
+    text += line;
+    for (uint8_t stage = 0; stage < LOOP_STAGE_COUNT; stage++) {
+      snprintf(line, sizeof(line), " %8lu", (unsigned long)iteration.stageMicros[stage]);
+      text += line;
+    }
+    text += "\n";
+  }
+  server.send(200, "text/plain", text);
+}
+
+void handleTraceStart() {
+  traceRing.start();
+  server.send(200, "text/plain", "tracing");
+}
+
+void handleTraceStop() {
+  traceRing.stop();
+  server.send(200, "text/plain", "stopped");
+}
+
+// Streams the recorded spans as Chrome trace-event JSON, one thread per core
+void handleTraceExport() {
+  traceRing.stop();
+  TraceSnapshot snapshot = traceRing.snapshot();
+
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/json", "");
+  server.sendContent("{\"traceEvents\":["
+                     "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"core 0\"}},"
+                     "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"core 1\"}}");
+
+  char chunk[TRACE_EXPORT_CHUNK];
+  size_t used = 0;
+  for (uint32_t i = 0; i < snapshot.count; i++) {
+    const TraceEvent &event = traceRing.at(snapshot, i);
+    int length = snprintf(chunk + used, sizeof(chunk) - used,
+                          ",{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%lu,\"dur\":%lu,\"pid\":1,\"tid\":%u}",
+                          TraceRing::name(event.id), (unsigned long)event.startMicros,
+                          (unsigned long)event.durationMicros, event.core);
+    if (length < 0 || (size_t)length >= sizeof(chunk) - used) {
+      // Chunk full, send it and write the event again at the start
+      server.sendContent(chunk, used);
+      used = 0;
+      i--;
+      continue;
+    }
+    used += length;
+  }
+  if (used > 0) {
+    server.sendContent(chunk, used);
+  }
+
+  snprintf(chunk, sizeof(chunk), "],\"otherData\":{\"overwritten\":%lu}}",
+           (unsigned long)snapshot.overwritten);
+  server.sendContent(chunk);
+  server.sendContent("");
+}
+
 void handleRoot() {
+  TRACE_SCOPE(TRACE_WEB_REQUEST);
   // Check if client is actually connected
   if (!server.client() || !server.client().connected()) {
     return;
@@ -133,8 +549,30 @@ void handleRoot() {
   htmlContent.replace("%UPTIME%", processor("UPTIME"));
   htmlContent.replace("%FREE_HEAP%", processor("FREE_HEAP"));
   htmlContent.replace("%SIGNAL_STRENGTH%", processor("SIGNAL_STRENGTH"));
+  htmlContent.replace("%WIFI_RECONNECTS%", processor("WIFI_RECONNECTS"));
+  htmlContent.replace("%WIFI_CONNECT_TIME%", processor("WIFI_CONNECT_TIME"));
+  htmlContent.replace("%BOOT_TIMELINE%", processor("BOOT_TIMELINE"));
+  htmlContent.replace("%MQTT_BROKER%", processor("MQTT_BROKER"));
+  htmlContent.replace("%MQTT_RECONNECTS%", processor("MQTT_RECONNECTS"));
+  htmlContent.replace("%MQTT_TIME_TO_DATA%", processor("MQTT_TIME_TO_DATA"));
+  htmlContent.replace("%TIMER_PUBLISH%", processor("TIMER_PUBLISH"));
+  htmlContent.replace("%PUBLISH_BUFFER%", processor("PUBLISH_BUFFER"));
+  htmlContent.replace("%NET_COMMANDS%", processor("NET_COMMANDS"));
   htmlContent.replace("%MQTT_SERVER%", processor("MQTT_SERVER"));
   htmlContent.replace("%MQTT_PORT%", processor("MQTT_PORT"));
+  htmlContent.replace("%MAIN_REFRESH%", processor("MAIN_REFRESH"));
+  htmlContent.replace("%SECONDARY_REFRESH%", processor("SECONDARY_REFRESH"));
+  htmlContent.replace("%STALE_EVENTS%", processor("STALE_EVENTS"));
+  htmlContent.replace("%LATENCY%", processor("LATENCY"));
+  htmlContent.replace("%SPEEDUINO_SERIAL%", processor("SPEEDUINO_SERIAL"));
+  htmlContent.replace("%GPS_SERIAL%", processor("GPS_SERIAL"));
+  htmlContent.replace("%UDP_TELEMETRY%", processor("UDP_TELEMETRY"));
+  htmlContent.replace("%ECU_FRAMES%", processor("ECU_FRAMES"));
+  htmlContent.replace("%ECU_JSON%", processor("ECU_JSON"));
+  htmlContent.replace("%INGEST_CRITICAL%", processor("INGEST_CRITICAL"));
+  htmlContent.replace("%INGEST_DISPLAY%", processor("INGEST_DISPLAY"));
+  htmlContent.replace("%INGEST_DIAGNOSTIC%", processor("INGEST_DIAGNOSTIC"));
+  htmlContent.replace("%LOG%", processor("LOG"));
   
   // Send with proper headers
   server.sendHeader("Cache-Control", "no-cache, no-store, must-revalidate");
@@ -149,11 +587,20 @@ void setup()
   // Initialize Serial communication
   Serial.begin(115200);
 
+  // Runtime messages go through the log task from here on
+  deferredLog.begin();
+
   // Initialize preferences for persistent storage
   wifiSetup.prefs.begin(PRIMARY_MQTT_CLIENT_NAME, false);
+  wifiSetup.paramLoad();
+  bootTimeline.mark("config");
 
-  // Initialize DOT matrix display
-  mainDisplay.begin();
+  // Displays, inputs and timers come up first; WiFi and MQTT connect in the
+  // background afterwards, so nothing here waits for the network
+
+  // Initialize DOT matrix display (one MD_Parola zone per displayed channel)
+  mainDisplay.begin(DOT_MATRIX_ZONE_COUNT);
+  mainZones.begin(&mainDisplay);
   mainDisplay.setIntensity(wifiSetup.config.bright);
   mainDisplay.setCharSpacing(DOT_MATRIX_CHAR_SPACING);
 
@@ -161,24 +608,37 @@ void setup()
   mainDisplay.displayText(WELCOME_MSG, PA_CENTER, 0, 0, PA_PRINT, PA_NO_EFFECT);
   mainDisplay.displayAnimate();
 
+  // Attach graph render modes to the display driver
+  mainGraph.begin(mainDisplay.getGraphicObject());
+
   // Initialize 7 Segment secondary display
   secondaryDisplay = LedController<1, 1>(SEVEN_SEG_DIN_PIN, SEVEN_SEG_CLK_PIN, SEVEN_SEG_CS_PIN);
   secondaryDisplay.setIntensity(SEVEN_SEG_DEFAULT_INTENSITY);
   secondaryDisplay.clearMatrix();
   Serial.println("7-Segment display initialized");
+  bootTimeline.mark("displays");
 
+  // Register display channels before MQTT connects so they are subscribed on connect
+  for (uint8_t zone = 1; zone < mainZones.count(); zone++) {
+    mainZones.bind(zone, wifiSetup.config.zoneChannel[zone - 1]);
+  }
+  if (wifiSetup.config.renderMode == RENDER_MODE_BAR) {
+    mqttSetup.subscribeChannel("RPM");
+  }
+  pageScheduler.begin();
 
-
-  // Initialize WiFi and MQTT setups
-  wifiSetup.begin();
+  // Only configures the clients, the network task connects them
   mqttSetup.begin();
+
   setupNav();
   setupTimerSwitches();
+  mainGraph.setMode(wifiSetup.config.renderMode);
 
   // Initialize Menu
   M.begin();
   M.setAutoStart(true);
   M.setTimeout(MENU_TIMEOUT);
+  bootTimeline.mark("menu and timers");
 
   // Initialize shared data synchronization primitives
   initSharedData();
@@ -186,10 +646,11 @@ void setup()
   // Configure watchdog timer for both cores
   esp_task_wdt_init(WATCHDOG_TIMEOUT_S, true); // Enable panic on timeout
   esp_task_wdt_add(NULL); // Add current task (Core 1)
+  taskRegistry.add(xTaskGetCurrentTaskHandle(), "loopTask", CONFIG_ARDUINO_LOOP_STACK_SIZE, xPortGetCoreID());
 
   // Create a secondary display task on a separate core
   TaskHandle_t secondaryTaskHandle = NULL;
-  BaseType_t taskCreated = xTaskCreatePinnedToCore(
+  BaseType_t taskCreated = taskRegistry.create(
       secondaryDisplayLoop,
       "secondaryDisplayLoop",
       SECONDARY_DISPLAY_STACK_SIZE, // 16KB stack to prevent overflow
@@ -203,12 +664,53 @@ void setup()
     // Add secondary task to watchdog
     esp_task_wdt_add(secondaryTaskHandle);
     Serial.println("Secondary display task created and added to watchdog");
+    bootTimeline.mark("secondary task");
   } else {
     Serial.println("ERROR: Failed to create secondary display task!");
   }
 
+  // Start WiFi in the background (opens the config portal on first boot),
+  // loop() drives it through wifiSetup.update()
+  wifiSetup.begin();
+
+#if NETWORK_TASK_ENABLED
+  // From here on only the network task touches the MQTT clients
+  networkTask.begin();
+  bootTimeline.mark("network task");
+
+  // UDP telemetry apart from the network task, a broker connect must not hold it up
+  if (udpListener.begin()) {
+    bootTimeline.mark("udp task");
+  }
+#else
+  // Latency baseline: loop() runs MQTT and UDP inline, the handlers apply
+  // values directly; the serial sources still use the ingest queues
+  networkTask.beginQueues();
+#endif
+
+#if SPEEDUINO_SERIAL_ENABLED
+  // ECU data straight from the UART, needs the network task's display slots
+  if (speeduinoSerial.begin()) {
+    bootTimeline.mark("speeduino serial");
+  }
+#endif
+
+#if GPS_SERIAL_ENABLED
+  // GPS data straight from the receiver, same display slots
+  if (gpsSerial.begin()) {
+    bootTimeline.mark("gps serial");
+  }
+#endif
+
   // Initialize web server
   server.on("/", HTTP_GET, handleRoot);
+  server.on("/metrics", HTTP_GET, handleMetrics);
+  server.on("/tasks", HTTP_GET, handleTasks);
+  server.on("/log", HTTP_GET, handleLog);
+  server.on("/loop", HTTP_GET, handleLoop);
+  server.on("/trace/start", HTTP_GET, handleTraceStart);
+  server.on("/trace/stop", HTTP_GET, handleTraceStop);
+  server.on("/trace.json", HTTP_GET, handleTraceExport);
   
   // 404 handler
   server.onNotFound([]() {
@@ -217,6 +719,7 @@ void setup()
   
   server.begin();
   Serial.println("HTTP server started on port " + String(WEB_SERVER_PORT));
+  bootTimeline.mark("setup done");
 }
 
 /**
@@ -224,6 +727,8 @@ void setup()
  */
 void updateMainDisplay(bool &wasInMenu, bool &firstRun, char *curMessage)
 {
+  TRACE_SCOPE(TRACE_MAIN_DISPLAY);
+
   if (wasInMenu && !M.isInMenu())
   {
     // Properly reset display when exiting menu
@@ -231,7 +736,23 @@ void updateMainDisplay(bool &wasInMenu, bool &firstRun, char *curMessage)
     mainDisplay.displayReset();
     delay(50); // Increased delay to ensure display is fully cleared
 
-    if (firstRun)
+    if (mainGraph.isActive())
+    {
+      // Graph modes redraw all columns themselves, skip the welcome animation
+      firstRun = false;
+      mainGraph.invalidate();
+      mainCompositor.invalidate();
+      mainRefresh.invalidate();
+    }
+    else if (mainZones.count() > 1)
+    {
+      // Multi-zone layout re-renders every zone from the channel table
+      firstRun = false;
+      mainZones.invalidate();
+      mainCompositor.invalidate();
+      mainRefresh.invalidate();
+    }
+    else if (firstRun)
     {
       // Display welcome message and animation on first run
       mainDisplay.setSpriteData(pacman, W_PMAN, F_PMAN, pacman, W_PMAN, F_PMAN);
@@ -249,33 +770,97 @@ void updateMainDisplay(bool &wasInMenu, bool &firstRun, char *curMessage)
   wasInMenu = M.isInMenu();
   M.runMenu();
 
-  if (!M.isInMenu())
+  if (M.isInMenu())
+  {
+    return;
+  }
+
+  unsigned long now = millis();
+
+  // Timed page rotation, rendered from values already in the channel table
+  pageScheduler.update(now);
+
+  // The primary channel value feeds the base layer of the compositor
+  if (newMessageAvailable)
   {
-    if (mainDisplay.displayAnimate())
+    mainCompositor.post(LAYER_BASE, newMessage);
+    newMessageAvailable = false;
+  }
+
+  // Channels without updates swap to notAvailableMsg. Zones pick this up from
+  // the channel table, the primary text and graph views are fed here.
+  const char *primaryCode = mainGraph.isActive() ? mainGraph.channelCode() : dataIndex;
+  bool primaryStale = g_channels.isStale(g_channels.indexOf(primaryCode));
+  if (g_channels.checkStale(now) > 0 && !primaryStale &&
+      g_channels.isStale(g_channels.indexOf(primaryCode)))
+  {
+    primaryStale = true;
+    mainCompositor.post(LAYER_BASE, notAvailableMsg);
+  }
+
+  // Overlays and alerts take the primary zone over graph and zone rendering,
+  // a graph whose channel is stale falls back to text as well
+  static bool textShown = false;
+  uint8_t layer = mainCompositor.top(now);
+  bool overlay = layer != LAYER_NONE && layer > LAYER_BASE;
+  bool textOverGraph = overlay || (mainGraph.isActive() && primaryStale);
+  if (textOverGraph != textShown)
+  {
+    mainDisplay.displayClear();
+    mainGraph.invalidate();
+    mainZones.invalidate();
+    mainCompositor.invalidate();
+    mainRefresh.invalidate();
+    textShown = textOverGraph;
+  }
+
+  if (mainGraph.isActive() && !textOverGraph)
+  {
+    // Bar graph / sparkline write columns directly, bypassing text rendering
+    mainGraph.render();
+  }
+  else if (mainZones.count() > 1)
+  {
+    // Only zones whose channel changed are handed new text
+    mainDisplay.displayAnimate();
+    if (overlay && mainDisplay.getZoneStatus(0) &&
+        mainCompositor.compose(now, curMessage, MESSAGE_BUFFER_SIZE))
     {
-      if (firstRun)
-      {
-        // After first animation completes, keep showing welcome animation until data arrives
-        firstRun = false;
-        mainDisplay.displayReset();
-      }
-      else if (newMessageAvailable)
+      mainDisplay.displayZoneText(0, curMessage, PA_RIGHT, 0, 0, PA_PRINT, PA_NO_EFFECT);
+    }
+    if (mainRefresh.ready(now) && mainZones.render(!overlay) > 0)
+    {
+      mainRefresh.markRendered(now);
+    }
+  }
+  else if (mainDisplay.displayAnimate())
+  {
+    if (firstRun)
+    {
+      // After first animation completes, keep showing welcome animation until data arrives
+      firstRun = false;
+      mainDisplay.displayReset();
+    }
+    else if (mainRefresh.ready(now) && mainCompositor.compose(now, curMessage, MESSAGE_BUFFER_SIZE))
+    {
+      // Show the highest priority message at most MAIN_DISPLAY_MAX_RATE_HZ, only if its text changed.
+      // Only channel values count as received, alerts and overlays are not display updates
+      if (mainRefresh.accept(newMessageSeq, curMessage, now))
       {
-        // Update current message if new message is available
-        strcpy(curMessage, newMessage);
-        newMessageAvailable = false;
-        
-        // Clear and reset display before showing new message
         mainDisplay.displayClear();
         delay(10);
         mainDisplay.displayText(curMessage, PA_RIGHT, 0, 0, PA_PRINT, PA_NO_EFFECT);
-      }
-      else
-      {
-        // Keep looping welcome animation until we get MQTT data
-        mainDisplay.displayReset();
+        if (layer == LAYER_BASE)
+        {
+          displayLatency.finish(micros());
+        }
       }
     }
+    else
+    {
+      // Keep looping welcome animation until we get MQTT data
+      mainDisplay.displayReset();
+    }
   }
 }
 
@@ -284,23 +869,39 @@ void updateMainDisplay(bool &wasInMenu, bool &firstRun, char *curMessage)
  */
 void loop()
 {
-  // Check WiFi connection and reconnect if needed
-  if (WiFi.status() != WL_CONNECTED) {
-    Serial.println("WiFi disconnected! Attempting reconnection...");
-    wifiSetup.begin(); // This will attempt to reconnect
-  }
+  loopProfiler.start(micros());
 
-  // Connect to MQTT server with reconnection logic
+  // Reconnect WiFi in the background, displays and timers keep running
+  wifiSetup.update(millis());
+  loopProfiler.mark(LOOP_STAGE_WIFI, micros());
+
+#if !NETWORK_TASK_ENABLED
+  // Latency baseline: MQTT I/O inline, as before the network task
   mqttSetup.connect();
+  mqttSetup.processCommands();
+  udpListener.poll();
+#endif
+
+  // Values received by the network task since the last pass
+  mqttSetup.processSamples();
+  loopProfiler.mark(LOOP_STAGE_SAMPLES, micros());
 
   static bool wasInMenu = true;
 
   // Update the main display based on the current state
   updateMainDisplay(wasInMenu, firstRun, curMessage);
+  displayUpdateDuration.record(loopProfiler.mark(LOOP_STAGE_DISPLAY, micros()));
   monitorTimerSwitches();
+  loopProfiler.mark(LOOP_STAGE_SWITCHES, micros());
   
   // Handle web server requests
   server.handleClient();
+  loopProfiler.mark(LOOP_STAGE_WEB, micros());
+
+  // Stack and CPU samples for /tasks, once per TASK_SAMPLE_INTERVAL_MS
+  taskRegistry.sample(millis());
+  loopProfiler.mark(LOOP_STAGE_TASKS, micros());
+  loopDuration.record(loopProfiler.finish(micros()));
   
   // Small delay to prevent overwhelming the display controller
   delay(2);
@@ -1,6 +1,11 @@
 // Menu.cpp
 #include "Menu.h"
 #include "SharedData.h"
+#include "DisplayModes.h"
+#include "DisplayZones.h"
+#include "ChannelTable.h"
+#include "PageScheduler.h"
+#include "DeferredLog.h"
 #include "Constants.h"
 
 // Rotary switch and button initialization (using centralized constants)
@@ -25,9 +30,17 @@ char dataIndex2[] = "RPM";
 
 // Menu definition
 
+// Last menu item id (zone channel items only exist on multi-zone displays)
+#if DOT_MATRIX_ZONE_COUNT > 1
+#define MENU_PORTAL_ITEM 14
+#else
+#define MENU_PORTAL_ITEM 11
+#endif
+#define MENU_LAST_ITEM MENU_PORTAL_ITEM
+
 // Header data for the menu
 const PROGMEM MD_Menu::mnuHeader_t mnuHdr[] = {
-    {1, "Menu>>>", 1, 7, 1},
+    {1, "Menu>>>", 1, MENU_LAST_ITEM, 1},
 };
 
 // Menu item data for ECU, GPS, POS, and BRT options
@@ -38,6 +51,15 @@ const PROGMEM MD_Menu::mnuItem_t mnuItm[] = {
     {5, "S:GPS", MD_Menu::MNU_INPUT, 5},
     {6, "POS", MD_Menu::MNU_INPUT, 6},
     {7, "BRT", MD_Menu::MNU_INPUT, 7},
+    {8, "MOD", MD_Menu::MNU_INPUT, 8},
+    {9, "PGS", MD_Menu::MNU_INPUT, 9},
+    {10, "ROT", MD_Menu::MNU_INPUT, 10},
+#if DOT_MATRIX_ZONE_COUNT > 1
+    {11, "Z2", MD_Menu::MNU_INPUT, 11},
+    {12, "Z3", MD_Menu::MNU_INPUT, 12},
+    {13, "Z4", MD_Menu::MNU_INPUT, 13},
+#endif
+    {MENU_PORTAL_ITEM, "WiFi", MD_Menu::MNU_INPUT, MENU_PORTAL_ITEM},
 };
 
 // Mapping of 3-letter values to their corresponding parameters in the Speeduino ECU data
@@ -74,6 +96,14 @@ const PROGMEM char listGPS[] = "SPD|TME|DTE|LAT|LNG|ALT|CRS|QTY";
 // Text alignment options
 const PROGMEM char listAlign[] = "L|C|R";
 
+// Main display render modes (text, RPM bar graph, sparkline)
+const PROGMEM char listMode[] = "TXT|BAR|SPK";
+
+#if DOT_MATRIX_ZONE_COUNT > 1
+// All channels in channel table order (ECU then GPS), used by zone selection
+const PROGMEM char listAll[] = "RPM|TPS|VE1|O2P|AFT|MAT|CAD|MAP|BAT|ADV|PW1|SPK|DWL|ILL|BAR|TAE|NER|ENG|SPD|TME|DTE|LAT|LNG|ALT|CRS|QTY";
+#endif
+
 // Menu input data for ECU, GPS, and alignment options
 const PROGMEM MD_Menu::mnuInput_t mnuInp[] = {
     {2, "", MD_Menu::INP_LIST, mnuValueRqst, 3, 0, 0, 0, 0, 0, listECU},
@@ -82,6 +112,15 @@ const PROGMEM MD_Menu::mnuInput_t mnuInp[] = {
     {5, "", MD_Menu::INP_LIST, mnuValueRqst, 3, 0, 0, 0, 0, 0, listGPS},
     {6, "P", MD_Menu::INP_LIST, mnuValueRqst, 1, 0, 0, 0, 0, 0, listAlign},
     {7, "B", MD_Menu::INP_INT, mnuValueRqst, 2, 0, 0, 15, 0, 10, nullptr},
+    {8, "M", MD_Menu::INP_LIST, mnuValueRqst, 3, 0, 0, 0, 0, 0, listMode},
+    {9, "N", MD_Menu::INP_INT, mnuValueRqst, 1, 1, 0, MAX_PAGES, 0, 10, nullptr},
+    {10, "S", MD_Menu::INP_INT, mnuValueRqst, 2, 0, 0, PAGE_INTERVAL_MAX_S, 0, 10, nullptr},
+#if DOT_MATRIX_ZONE_COUNT > 1
+    {11, "", MD_Menu::INP_LIST, mnuValueRqst, 3, 0, 0, 0, 0, 0, listAll},
+    {12, "", MD_Menu::INP_LIST, mnuValueRqst, 3, 0, 0, 0, 0, 0, listAll},
+    {13, "", MD_Menu::INP_LIST, mnuValueRqst, 3, 0, 0, 0, 0, 0, listAll},
+#endif
+    {MENU_PORTAL_ITEM, "Portal", MD_Menu::INP_RUN, mnuValueRqst, 0, 0, 0, 0, 0, 0, nullptr},
 };
 
 // Menu global object
@@ -117,6 +156,20 @@ MD_Menu::userNavAction_t navigation(uint16_t &incDelta)
   }
 
   MD_UISwitch::keyResult_t keyResult = swCtl.read();
+
+  // With a page rotation, a click outside the menu shows the next page and a
+  // long press opens the menu instead
+  if (!M.isInMenu() && pageScheduler.isRotating())
+  {
+    if (keyResult == MD_UISwitch::KEY_PRESS)
+    {
+      pageScheduler.next();
+      return MD_Menu::NAV_NULL;
+    }
+    if (keyResult == MD_UISwitch::KEY_LONGPRESS)
+      return MD_Menu::NAV_SEL;
+  }
+
   switch (keyResult)
   {
   case MD_UISwitch::KEY_PRESS:
@@ -157,10 +210,7 @@ void setupNav(void)
   M.setMenuWrap(true);
 }
 
-// String array for ECU and GPS Data parameters
-// Using const char* arrays instead of String to avoid heap allocations
-const char* const ecuDataStrings[] = {"RPM", "TPS", "VE1", "O2P", "AFT", "MAT", "CAD", "MAP", "BAT", "ADV", "PW1", "SPK", "DWL", "ILL", "BAR", "TAE", "NER", "ENG"};
-const char* const gpsDataStrings[] = {"SPD", "TME", "DTE", "LAT", "LNG", "ALT", "CRS", "QTY"};
+// ECU and GPS data parameter arrays (ecuDataStrings, gpsDataStrings) live in ChannelTable.cpp
 
 // Helper to unsubscribe from both ECU and GPS topics
 void unsubscribeAll(MQTTClient &client, const char *idx)
@@ -169,10 +219,10 @@ void unsubscribeAll(MQTTClient &client, const char *idx)
   char topic[64];
   
   snprintf(topic, sizeof(topic), "%s%s", MQTT_ECU_TOPIC, idx);
-  client.unsubscribe(topic);
+  mqttSetup.unsubscribe(client, topic);
   
   snprintf(topic, sizeof(topic), "%s%s", MQTT_GPS_TOPIC, idx);
-  client.unsubscribe(topic);
+  mqttSetup.unsubscribe(client, topic);
 }
 
 // Helper to update index from array
@@ -207,6 +257,10 @@ int findArrayIndex(const char* const arr[], size_t size, const char *val)
  * - 5: GPS secondary display
  * - 6: Text alignment
  * - 7: Brightness
+ * - 8: Main display render mode
+ * - 9: Number of pages in the primary channel rotation
+ * - 10: Page rotation interval in seconds (0 = encoder click only)
+ * - 11-13: Channel of main display zones 2-4 (multi-zone displays only)
  *
  * For text alignment and brightness, the function directly modifies the display settings.
  * For other IDs, it subscribes to the appropriate MQTT topics and updates message availability.
@@ -217,43 +271,26 @@ MD_Menu::value_t *mnuValueRqst(MD_Menu::mnuId_t id, bool bGet)
 
   // For primary display (non-volatile vars) - optimized to avoid String allocations
   auto handlePrimary = [&](int arraySize,
-                           const char* const arr[],
-                           char *indexRef,
-                           MQTTClient &client,
-                           char *messageRef,
-                           bool *msgAvail,
-                           const char *topicBase)
+                           const char* const arr[])
   {
-    if (!bGet)
-      unsubscribeAll(client, indexRef);
-
     if (bGet)
     {
-      v.value = findArrayIndex(arr, arraySize, indexRef);
+      v.value = findArrayIndex(arr, arraySize, dataIndex);
       if (v.value < 0) v.value = 0; // Fallback to first item if not found
     }
     else
     {
       // Validate array index
       if (v.value < 0 || v.value >= arraySize) {
-        Serial.printf("ERROR: Invalid array index %d (max: %d)\n", v.value, arraySize - 1);
+        LOG_ERROR("Invalid array index %d (max: %d)", v.value, arraySize - 1);
         return;
       }
       
-      strncpy(indexRef, arr[v.value], sizeof(dataIndex));
-      indexRef[sizeof(dataIndex) - 1] = '\0';
-      
-      // Build topic without String allocation
-      char fullTopic[64];
-      snprintf(fullTopic, sizeof(fullTopic), "%s%s", topicBase, indexRef);
-      client.subscribe(fullTopic);
-      
-      Serial.print("\nSubscribed to topic: ");
-      Serial.println(fullTopic);
-      
-      strncpy(messageRef, "---", MESSAGE_BUFFER_SIZE - 1);
-      messageRef[MESSAGE_BUFFER_SIZE - 1] = '\0';
-      *msgAvail = true;
+      // The selection becomes the channel of the page currently shown. The
+      // page scheduler updates dataIndex and zone 0; subscriptions are
+      // reference counted, so a channel still used by another page, zone or
+      // the bar graph stays subscribed.
+      pageScheduler.assignCurrent(arr[v.value]);
     }
   };
 
@@ -278,7 +315,7 @@ MD_Menu::value_t *mnuValueRqst(MD_Menu::mnuId_t id, bool bGet)
     {
       // Validate array index
       if (v.value < 0 || v.value >= arraySize) {
-        Serial.printf("ERROR: Invalid secondary array index %d (max: %d)\n", v.value, arraySize - 1);
+        LOG_ERROR("Invalid secondary array index %d (max: %d)", v.value, arraySize - 1);
         return;
       }
       
@@ -288,18 +325,17 @@ MD_Menu::value_t *mnuValueRqst(MD_Menu::mnuId_t id, bool bGet)
       // Build topic without String allocation
       char fullTopic[64];
       snprintf(fullTopic, sizeof(fullTopic), "%s%s", topicBase, indexRef);
-      client.subscribe(fullTopic);
+      mqttSetup.subscribe(client, fullTopic);
       
       // Thread-safe mode setting
       if (!g_secondaryMode.set("MQTT")) {
-        Serial.println("WARNING: Failed to set secondary mode to MQTT");
+        LOG_WARN("Failed to set secondary mode to MQTT");
         // Fallback to legacy volatile
         strncpy((char*)secondaryScreenMode, "MQTT", MODE_BUFFER_SIZE - 1);
         ((char*)secondaryScreenMode)[MODE_BUFFER_SIZE - 1] = '\0';
       }
       
-      Serial.print("\nSubscribed to secondary: ");
-      Serial.println(fullTopic);
+      LOG_INFO("Subscribed to secondary: %s", fullTopic);
       
       strncpy((char *)messageRef, "---", MESSAGE_BUFFER_SIZE - 1);
       ((char*)messageRef)[MESSAGE_BUFFER_SIZE - 1] = '\0';
@@ -312,23 +348,13 @@ MD_Menu::value_t *mnuValueRqst(MD_Menu::mnuId_t id, bool bGet)
   case 2: // ECU primary
     handlePrimary(
         ARRAY_SIZE(ecuDataStrings),
-        ecuDataStrings,
-        dataIndex,
-        mqttSetup.mqtt,
-        newMessage,
-        &newMessageAvailable,
-        MQTT_ECU_TOPIC);
+        ecuDataStrings);
     break;
 
   case 3: // GPS primary
     handlePrimary(
         ARRAY_SIZE(gpsDataStrings),
-        gpsDataStrings,
-        dataIndex,
-        mqttSetup.mqtt,
-        newMessage,
-        &newMessageAvailable,
-        MQTT_GPS_TOPIC);
+        gpsDataStrings);
     break;
 
   case 4: // ECU secondary
@@ -399,8 +425,93 @@ MD_Menu::value_t *mnuValueRqst(MD_Menu::mnuId_t id, bool bGet)
     }
     break;
 
+  case 8: // Render mode
+    if (bGet)
+    {
+      v.value = wifiSetup.config.renderMode;
+    }
+    else
+    {
+      if (v.value < 0 || v.value >= RENDER_MODE_COUNT) {
+        LOG_ERROR("Invalid render mode %d", v.value);
+        return nullptr;
+      }
+
+      // The bar graph needs RPM regardless of the channel selected for the primary display
+      if (wifiSetup.config.renderMode != RENDER_MODE_BAR && v.value == RENDER_MODE_BAR)
+        mqttSetup.subscribeChannel("RPM");
+      else if (wifiSetup.config.renderMode == RENDER_MODE_BAR && v.value != RENDER_MODE_BAR)
+        mqttSetup.unsubscribeChannel("RPM");
+
+      wifiSetup.config.renderMode = v.value;
+      mainGraph.setMode(wifiSetup.config.renderMode);
+    }
+    break;
+
+  case 9: // Number of pages in the rotation
+    if (bGet)
+    {
+      v.value = wifiSetup.config.pageCount;
+    }
+    else
+    {
+      pageScheduler.setPageCount(v.value);
+    }
+    break;
+
+  case 10: // Page rotation interval
+    if (bGet)
+    {
+      v.value = wifiSetup.config.pageIntervalS;
+    }
+    else
+    {
+      wifiSetup.config.pageIntervalS = v.value;
+    }
+    break;
+
+#if DOT_MATRIX_ZONE_COUNT > 1
+  case 11: // Zone 2 channel
+  case 12: // Zone 3 channel
+  case 13: // Zone 4 channel
+  {
+    uint8_t zone = id - 10;
+    if (zone >= DOT_MATRIX_ZONE_COUNT)
+    {
+      LOG_ERROR("Zone %d not configured (zones: %d)", zone + 1, DOT_MATRIX_ZONE_COUNT);
+      return nullptr;
+    }
+
+    if (bGet)
+    {
+      v.value = g_channels.indexOf(wifiSetup.config.zoneChannel[zone - 1]);
+      if (v.value < 0) v.value = 0;
+    }
+    else
+    {
+      const char *code = g_channels.codeAt(v.value);
+      if (code == nullptr) {
+        LOG_ERROR("Invalid channel index %d", v.value);
+        return nullptr;
+      }
+      strncpy(wifiSetup.config.zoneChannel[zone - 1], code, DATA_INDEX_SIZE - 1);
+      wifiSetup.config.zoneChannel[zone - 1][DATA_INDEX_SIZE - 1] = '\0';
+      mainZones.bind(zone, code);
+    }
+    break;
+  }
+#endif
+
+  case MENU_PORTAL_ITEM: // Open the WiFi config portal
+    if (!bGet)
+    {
+      wifiSetup.openPortal();
+      return nullptr;
+    }
+    break;
+
   default:
-    Serial.printf("ERROR: Unknown menu ID: %d\n", id);
+    LOG_ERROR("Unknown menu ID: %d", id);
     return nullptr;
   }
 
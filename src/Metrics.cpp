@@ -0,0 +1,145 @@
+// Metrics.cpp
+// Implementation of the metrics registry and its text exposition
+
+#include "Metrics.h"
+
+// Upper bounds of the histogram buckets, 50 us to 50 ms
+static const uint32_t METRIC_DURATION_BUCKETS_US[METRIC_HISTOGRAM_BUCKETS] = {
+    50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000};
+
+static const char *const METRIC_TYPE_NAMES[] = {"counter", "gauge", "histogram"};
+
+Metric *Metric::head = nullptr;
+
+// Instruments updated across modules
+MetricChannelCounter channelMessages("g86_channel_messages_total",
+                                     "Channel values received, before coalescing");
+MetricHistogram callbackDuration("g86_callback_duration_microseconds",
+                                 "Time in the primary message handlers (MQTT and UDP)");
+MetricHistogram displayUpdateDuration("g86_display_update_duration_microseconds",
+                                      "Time in one main display update");
+MetricHistogram loopDuration("g86_loop_duration_microseconds",
+                             "Main loop iteration time without the pause");
+
+/**
+ * @brief Register a metric
+ * @param name Metric name
+ * @param help Help text
+ * @param type METRIC_*
+ */
+Metric::Metric(const char *name, const char *help, uint8_t type)
+    : name(name), help(help), type(type), next(head) {
+    // Static construction runs on one core before the scheduler starts
+    head = this;
+}
+
+/**
+ * @brief Append all registered metrics in the text exposition format
+ * @param out Response text
+ */
+void Metric::writeAll(String &out) {
+    for (const Metric *metric = head; metric != nullptr; metric = metric->next) {
+        out += "# HELP ";
+        out += metric->name;
+        out += ' ';
+        out += metric->help;
+        out += "\n# TYPE ";
+        out += metric->name;
+        out += ' ';
+        out += METRIC_TYPE_NAMES[metric->type];
+        out += '\n';
+        metric->writeSamples(out);
+    }
+}
+
+/**
+ * @brief Append one sample line
+ * @param out Response text
+ * @param suffix Appended to the name ("" for none)
+ * @param label Label name, nullptr for none
+ * @param labelValue Label value
+ * @param value Sample value
+ */
+void Metric::writeSample(String &out, const char *suffix, const char *label, const char *labelValue,
+                         uint32_t value) const {
+    char line[128];
+    if (label != nullptr) {
+        snprintf(line, sizeof(line), "%s%s{%s=\"%s\"} %lu\n", name, suffix, label, labelValue,
+                 (unsigned long)value);
+    } else {
+        snprintf(line, sizeof(line), "%s%s %lu\n", name, suffix, (unsigned long)value);
+    }
+    out += line;
+}
+
+void MetricCounter::writeSamples(String &out) const {
+    writeSample(out, "", nullptr, nullptr, value.load(std::memory_order_relaxed));
+}
+
+/**
+ * @brief Constructor for MetricChannelCounter
+ * @param name Metric name
+ * @param help Help text
+ */
+MetricChannelCounter::MetricChannelCounter(const char *name, const char *help)
+    : Metric(name, help, METRIC_COUNTER) {
+    for (uint8_t i = 0; i < CHANNEL_COUNT; i++) {
+        values[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void MetricChannelCounter::writeSamples(String &out) const {
+    for (uint8_t i = 0; i < CHANNEL_COUNT; i++) {
+        const char *code = i < ECU_CHANNEL_COUNT ? ecuDataStrings[i] : gpsDataStrings[i - ECU_CHANNEL_COUNT];
+        writeSample(out, "", "channel", code, values[i].load(std::memory_order_relaxed));
+    }
+}
+
+void MetricCallback::writeSamples(String &out) const {
+    for (uint8_t i = 0; i < count; i++) {
+        uint32_t value;
+        if (read(i, value)) {
+            writeSample(out, "", label, label != nullptr ? labelAt(i) : nullptr, value);
+        }
+    }
+}
+
+/**
+ * @brief Constructor for MetricHistogram
+ * @param name Metric name
+ * @param help Help text
+ */
+MetricHistogram::MetricHistogram(const char *name, const char *help)
+    : Metric(name, help, METRIC_HISTOGRAM), sum(0) {
+    for (uint8_t i = 0; i <= METRIC_HISTOGRAM_BUCKETS; i++) {
+        buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Record one duration
+ * @param micros Duration in microseconds
+ */
+void MetricHistogram::record(uint32_t micros) {
+    uint8_t bucket = 0;
+    while (bucket < METRIC_HISTOGRAM_BUCKETS && micros > METRIC_DURATION_BUCKETS_US[bucket]) {
+        bucket++;
+    }
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(micros, std::memory_order_relaxed);
+}
+
+void MetricHistogram::writeSamples(String &out) const {
+    // Buckets are stored per range, the format wants them cumulative
+    uint32_t cumulative = 0;
+    char bound[12];
+    for (uint8_t i = 0; i < METRIC_HISTOGRAM_BUCKETS; i++) {
+        cumulative += buckets[i].load(std::memory_order_relaxed);
+        snprintf(bound, sizeof(bound), "%lu", (unsigned long)METRIC_DURATION_BUCKETS_US[i]);
+        writeSample(out, "_bucket", "le", bound, cumulative);
+    }
+    cumulative += buckets[METRIC_HISTOGRAM_BUCKETS].load(std::memory_order_relaxed);
+    writeSample(out, "_bucket", "le", "+Inf", cumulative);
+    writeSample(out, "_sum", nullptr, nullptr, sum.load(std::memory_order_relaxed));
+    writeSample(out, "_count", nullptr, nullptr, cumulative);
+}
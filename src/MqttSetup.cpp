@@ -1,113 +1,675 @@
 #include "MqttSetup.h"
 #include "TimerButtons.h"
 #include "SharedData.h"
+#include "DisplayModes.h"
+#include "ChannelTable.h"
+#include "DisplayCompositor.h"
+#include "NetworkTask.h"
+#include "LatencyStats.h"
+#include "BootTimeline.h"
+#include "SpeeduinoSerial.h"
+#include "GpsSerial.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include "DeferredLog.h"
+
+extern MqttSetup mqttSetup;
 
 unsigned long MqttSetup::lastBlinkMillis = 0;
 bool MqttSetup::colonVisible = true;
 
 /**
- * Initialize MQTT setup with timeout and retry logic.
+ * Initialize both MQTT clients. Nothing is connected here: the network task
+ * connects once WiFi is up, so boot does not wait for the broker.
  */
 void MqttSetup::begin()
 {
-    // Initialize MQTT connection for Primary client
-    mqtt.begin(wifiSetup.config.mqtt_server, atoi(wifiSetup.config.mqtt_port), net);
-    mqtt.onMessage(MqttMessageReceivedPrimary);
+    // Start on the first broker, the backups are used when it fails
+    brokers.begin(wifiSetup.config);
 
-    Serial.printf("\nConnecting to MQTT Primary at %s:%s\n", 
-                  wifiSetup.config.mqtt_server, wifiSetup.config.mqtt_port);
+    handlerMutex = xSemaphoreCreateMutex();
+    if (handlerMutex == NULL) {
+        Serial.println("ERROR: Failed to create MQTT handler mutex!");
+    }
 
-    // Attempt to connect to MQTT Primary with timeout
-    int attempts = 0;
-    while (!mqtt.connect(PRIMARY_MQTT_CLIENT_NAME, "public", "public") && 
-           attempts < MQTT_MAX_CONNECT_ATTEMPTS)
-    {
-        Serial.print(".");
-        delay(MQTT_CONNECT_RETRY_DELAY_MS);
-        attempts++;
+    mqtt.begin(brokers.host(0), brokers.port(0), net);
+    mqtt.onMessageAdvanced(MqttMessageReceivedPrimaryRaw);
+    mqtt.setKeepAlive(MQTT_KEEPALIVE_S);
+    mqtt.setTimeout(MQTT_COMMAND_TIMEOUT_MS);
+
+    mqtt2.begin(brokers.host(0), brokers.port(0), net2);
+    mqtt2.onMessage(MqttMessageReceivedSecondary);
+    mqtt2.setKeepAlive(MQTT_KEEPALIVE_S);
+    mqtt2.setTimeout(MQTT_COMMAND_TIMEOUT_MS);
+
+    probeClient.begin(brokers.host(0), brokers.port(0), probeNet);
+    probeClient.setTimeout(MQTT_BROKER_PROBE_TIMEOUT_MS);
+
+    Serial.printf("MQTT broker %s:%d (%u configured), connecting in background\n",
+                  brokers.host(0), brokers.port(0), brokers.count());
+
+    // Recorded now, sent on the first connect
+    subscribeFixedTopics();
+}
+
+/**
+ * Subscribe the primary client to the timer value, alert, ECU batch and diagnostic topics.
+ */
+void MqttSetup::subscribeFixedTopics()
+{
+    char topic[MQTT_TOPIC_BUFFER_SIZE];
+    snprintf(topic, sizeof(topic), "%svalue", MQTT_TIMER1_TOPIC);
+    subscribe(mqtt, topic);
+    snprintf(topic, sizeof(topic), "%svalue", MQTT_TIMER2_TOPIC);
+    subscribe(mqtt, topic);
+    subscribe(mqtt, MQTT_ALERT_TOPIC);
+    subscribe(mqtt, MQTT_ECU_FRAME_TOPIC);
+    subscribe(mqtt, MQTT_ECU_JSON_TOPIC);
+    snprintf(topic, sizeof(topic), "%s#", MQTT_DIAG_TOPIC);
+    subscribe(mqtt, topic);
+}
+
+/**
+ * Build the ECU or GPS topic of a channel.
+ * @param index Channel table index.
+ * @param topic Output buffer.
+ * @param topicSize Size of the output buffer.
+ * @return True if the topic was built.
+ */
+static bool buildChannelTopic(int index, char *topic, size_t topicSize)
+{
+    const char *code = g_channels.codeAt(index);
+    if (code == nullptr) {
+        return false;
     }
+    snprintf(topic, topicSize, "%s%s", g_channels.isGps(index) ? MQTT_GPS_TOPIC : MQTT_ECU_TOPIC, code);
+    return true;
+}
 
-    if (mqtt.connected()) {
-        Serial.println("\nMQTT Primary connected!");
-    } else {
-        Serial.printf("\nWARNING: MQTT Primary connection failed after %d attempts. Will retry in background.\n", attempts);
+/**
+ * Register a display user of a channel (zone, graph mode). The topic is
+ * subscribed only when the first user appears, so several displays can share
+ * one subscription.
+ * @param code Three letter channel code.
+ */
+void MqttSetup::subscribeChannel(const char *code)
+{
+    int index = g_channels.indexOf(code);
+    char topic[MQTT_TOPIC_BUFFER_SIZE];
+
+    if (g_channels.acquire(index) && buildChannelTopic(index, topic, sizeof(topic))) {
+        subscribe(mqtt, topic);
+        LOG_INFO("Subscribed to channel: %s", topic);
     }
+}
 
-    // Initialize MQTT connection for Secondary client
-    mqtt2.begin(wifiSetup.config.mqtt_server, atoi(wifiSetup.config.mqtt_port), net2);
-    mqtt2.onMessage(MqttMessageReceivedSecondary);
+/**
+ * Unregister a display user of a channel. The topic is unsubscribed only
+ * when no display uses it any more.
+ * @param code Three letter channel code.
+ */
+void MqttSetup::unsubscribeChannel(const char *code)
+{
+    int index = g_channels.indexOf(code);
+    char topic[MQTT_TOPIC_BUFFER_SIZE];
 
-    Serial.printf("\nConnecting to MQTT Secondary at %s:%s\n", 
-                  wifiSetup.config.mqtt_server, wifiSetup.config.mqtt_port);
+    if (g_channels.release(index) && buildChannelTopic(index, topic, sizeof(topic))) {
+        unsubscribe(mqtt, topic);
+        LOG_INFO("Unsubscribed from channel: %s", topic);
+    }
+}
 
-    // Attempt to connect to MQTT Secondary with timeout
-    attempts = 0;
-    while (!mqtt2.connect(SECONDARY_MQTT_CLIENT_NAME, "public", "public") && 
-           attempts < MQTT_MAX_CONNECT_ATTEMPTS)
-    {
-        Serial.print(".");
-        delay(MQTT_CONNECT_RETRY_DELAY_MS);
-        attempts++;
+/**
+ * Queue an MQTT operation for the network task, or run it directly while the
+ * task is not started yet (setup) or when the network task itself asks.
+ * @param client mqtt or mqtt2.
+ * @param type NET_CMD_*.
+ * @param topic The MQTT topic.
+ * @param payload Payload for NET_CMD_PUBLISH, nullptr otherwise.
+ * @param periodic True if only the latest publish on the topic matters.
+ */
+static void runOrQueue(MqttSetup &setup, MQTTClient &client, uint8_t type, const char *topic, const char *payload,
+                       bool periodic = false)
+{
+    if (topic == nullptr) {
+        return;
     }
 
-    if (mqtt2.connected()) {
-        Serial.println("\nMQTT Secondary connected!");
-    } else {
-        Serial.printf("\nWARNING: MQTT Secondary connection failed after %d attempts. Will retry in background.\n", attempts);
+    if (!networkTask.isRunning() || networkTask.isCurrentTask()) {
+        setup.runCommand(client, type, topic, payload, millis(), periodic);
+        return;
     }
 
-    // Subscribe to timer topics if connected
-    if (mqtt.connected()) {
-        char topic[48];
-        snprintf(topic, sizeof(topic), "%svalue", MQTT_TIMER1_TOPIC);
-        mqtt.subscribe(topic);
-        snprintf(topic, sizeof(topic), "%svalue", MQTT_TIMER2_TOPIC);
-        mqtt.subscribe(topic);
+    NetCommand command;
+    command.type = type;
+    command.secondary = &client == &setup.mqtt2;
+    command.periodic = periodic;
+    strncpy(command.topic, topic, sizeof(command.topic) - 1);
+    command.topic[sizeof(command.topic) - 1] = '\0';
+    strncpy(command.payload, payload != nullptr ? payload : "", sizeof(command.payload) - 1);
+    command.payload[sizeof(command.payload) - 1] = '\0';
+    command.createdMillis = millis();
+    networkTask.postCommand(command);
+}
+
+/**
+ * Publish on the primary client from any task.
+ * @param topic The MQTT topic.
+ * @param payload The message payload.
+ * @param periodic True if a newer publish on the topic supersedes this one.
+ */
+void MqttSetup::publish(const char *topic, const char *payload, bool periodic)
+{
+    runOrQueue(*this, mqtt, NET_CMD_PUBLISH, topic, payload, periodic);
+}
+
+/**
+ * Publish an ECU snapshot from any task. Only the latest frame is kept; the
+ * network task sends it with its binary length in processCommands().
+ * @param frame Packed ECU frame.
+ */
+void MqttSetup::publishEcuFrame(const EcuFrame &frame)
+{
+    portENTER_CRITICAL(&frameLock);
+    pendingFrame = frame;
+    framePending = true;
+    portEXIT_CRITICAL(&frameLock);
+}
+
+/**
+ * Subscribe a client to a topic from any task.
+ * @param client mqtt or mqtt2.
+ * @param topic The MQTT topic.
+ */
+void MqttSetup::subscribe(MQTTClient &client, const char *topic)
+{
+    runOrQueue(*this, client, NET_CMD_SUBSCRIBE, topic, nullptr);
+}
+
+/**
+ * Unsubscribe a client from a topic from any task.
+ * @param client mqtt or mqtt2.
+ * @param topic The MQTT topic.
+ */
+void MqttSetup::unsubscribe(MQTTClient &client, const char *topic)
+{
+    runOrQueue(*this, client, NET_CMD_UNSUBSCRIBE, topic, nullptr);
+}
+
+/**
+ * Run one operation on a client. Subscriptions are recorded in the client's
+ * set first, so one requested while disconnected is sent on the next
+ * connect. Publishes on the primary client (timer events) are held while it
+ * is disconnected, behind those already held so the order is kept, or when
+ * the publish fails on a client that still reports connected; publishes on
+ * the secondary client are dropped while it is disconnected.
+ * @param client mqtt or mqtt2.
+ * @param type NET_CMD_*.
+ * @param topic The MQTT topic.
+ * @param payload Payload for NET_CMD_PUBLISH.
+ * @param createdMillis millis() when the publish was requested.
+ * @param periodic True if a newer publish on the topic supersedes this one.
+ */
+void MqttSetup::runCommand(MQTTClient &client, uint8_t type, const char *topic, const char *payload,
+                           unsigned long createdMillis, bool periodic)
+{
+    SubscriptionSet &subscriptions = (&client == &mqtt2) ? secondarySubscriptions : primarySubscriptions;
+
+    if (type == NET_CMD_SUBSCRIBE)
+        subscriptions.add(topic);
+    else if (type == NET_CMD_UNSUBSCRIBE)
+        subscriptions.remove(topic);
+    else if (&client == &mqtt && (!client.connected() || !outbox.empty())) {
+        outbox.push(topic, payload, createdMillis, periodic);
+        return;
+    }
+
+    if (!client.connected()) {
+        return;
+    }
+
+    if (type == NET_CMD_PUBLISH) {
+        // A publish that fails on a live connection is held like one made offline
+        if (!client.publish(topic, payload) && &client == &mqtt)
+            outbox.push(topic, payload, createdMillis, periodic);
+    } else if (type == NET_CMD_SUBSCRIBE) {
+        client.subscribe(topic);
+    } else if (type == NET_CMD_UNSUBSCRIBE) {
+        client.unsubscribe(topic);
+    }
+}
+
+/**
+ * Run the operations queued by other tasks, then send the pending ECU frame.
+ * Called from the network task, the only task that touches the MQTT clients
+ * once it runs.
+ */
+void MqttSetup::processCommands()
+{
+    NetCommand command;
+    while (networkTask.popCommand(command)) {
+        runCommand(command.secondary ? mqtt2 : mqtt, command.type, command.topic, command.payload,
+                   command.createdMillis, command.periodic);
+    }
+
+    if (framePending) {
+        EcuFrame frame;
+        portENTER_CRITICAL(&frameLock);
+        frame = pendingFrame;
+        framePending = false;
+        portEXIT_CRITICAL(&frameLock);
+
+        if (mqtt.connected()) {
+            mqtt.publish(MQTT_ECU_FRAME_TOPIC, (const char *)&frame, (int)sizeof(frame));
+        }
+    }
+}
+
+/**
+ * Apply the messages queued by the network task. Called from the main loop,
+ * which owns the display state (graph history, primary message). Each class
+ * is bounded: the critical queue and the channel slots by their size, the
+ * diagnostics by INGEST_DIAGNOSTIC_BUDGET, so a burst cannot stall the loop.
+ */
+void MqttSetup::processSamples()
+{
+    CriticalMessage critical;
+    for (uint8_t i = 0; i < INGEST_CRITICAL_QUEUE_LENGTH && networkTask.popCritical(critical); i++) {
+        applyCritical(critical.kind, critical.payload);
+    }
+
+    DisplaySample sample;
+    for (uint8_t i = 0; i < CHANNEL_COUNT && networkTask.popSample(sample); i++) {
+        applySample(sample.code, sample.text, sample.value, sample.receivedMicros);
+    }
+
+    DiagnosticMessage diagnostic;
+    for (uint8_t i = 0; i < INGEST_DIAGNOSTIC_BUDGET && networkTask.popDiagnostic(diagnostic); i++) {
+        LOG_INFO("[DIAG] %s: %s", diagnostic.name, diagnostic.payload);
+    }
+}
+
+/**
+ * Apply a timer value or alert received from the broker.
+ * @param kind CRITICAL_*.
+ * @param payload The message payload.
+ */
+void MqttSetup::applyCritical(uint8_t kind, const char *payload)
+{
+    if (kind == CRITICAL_TIMER1_VALUE || kind == CRITICAL_TIMER2_VALUE)
+    {
+        // A running local timer is the source of truth, ignore echoes of it
+        unsigned long timerValue = strtoul(payload, nullptr, 10);
+        if (kind == CRITICAL_TIMER1_VALUE && !timer1Started)
+            timer1Value = timerValue;
+        else if (kind == CRITICAL_TIMER2_VALUE && !timer2Started)
+            timer2Value = timerValue;
+    }
+    else if (kind == CRITICAL_ALERT)
+    {
+        // An empty alert payload clears the alert
+        if (payload[0] == '\0')
+            mainCompositor.clear(LAYER_ALERT);
+        else
+            mainCompositor.post(LAYER_ALERT, payload);
+    }
+}
+
+/**
+ * Hand a formatted channel value to the main display consumers.
+ * @param code Three letter channel code.
+ * @param text Formatted display text.
+ * @param value Parsed numeric value.
+ * @param receivedMicros micros() when the message was received.
+ */
+void MqttSetup::applySample(const char *code, const char *text, float value, uint32_t receivedMicros)
+{
+    mainGraph.pushSample(code, value);
+
+    // Keep the latest value of every channel for the display zones
+    g_channels.update(code, text, value);
+
+    // Single zone display only shows the channel selected in the menu
+    if (strcmp(code, dataIndex) == 0)
+    {
+        strncpy(newMessage, text, sizeof(newMessage) - 1);
+        newMessage[sizeof(newMessage) - 1] = '\0';
+        newMessageAvailable = true;
+        newMessageSeq++;
+        displayLatency.start(receivedMicros);
     }
 }
 
 /**
  * Handle MQTT connections for both Primary and Secondary clients with reconnection logic.
+ * Each client keeps its own backoff, so a failing one does not hold up the other.
  */
 void MqttSetup::connect()
 {
-    static unsigned long lastReconnectAttempt = 0;
+    static bool primaryEverConnected = false;
+    static bool alertShown = false;
     unsigned long now = millis();
 
-    // Check and reconnect Primary client if disconnected
-    if (!mqtt.connected() && (now - lastReconnectAttempt > MQTT_RECONNECT_INTERVAL_MS)) {
-        Serial.println("MQTT Primary disconnected, attempting reconnection...");
-        if (mqtt.connect(PRIMARY_MQTT_CLIENT_NAME, "public", "public")) {
-            Serial.println("MQTT Primary reconnected!");
-            char topic[48];
-            snprintf(topic, sizeof(topic), "%svalue", MQTT_TIMER1_TOPIC);
-            mqtt.subscribe(topic);
-            snprintf(topic, sizeof(topic), "%svalue", MQTT_TIMER2_TOPIC);
-            mqtt.subscribe(topic);
-            // TODO: Resubscribe to last selected topic from menu
+    // Alert on the main display while the primary client is disconnected,
+    // giving the first connection after boot a grace period
+    bool primaryConnected = mqtt.connected();
+    if (primaryConnected) {
+        primaryEverConnected = true;
+    }
+    bool alert = !primaryConnected && (primaryEverConnected || now >= MQTT_BOOT_GRACE_MS);
+    if (alert != alertShown) {
+        if (alert) {
+            mainCompositor.post(LAYER_LINK, ALERT_MQTT_LOST_MSG);
         } else {
-            Serial.println("MQTT Primary reconnection failed");
+            mainCompositor.clear(LAYER_LINK);
         }
-        lastReconnectAttempt = now;
+        alertShown = alert;
     }
 
-    // Check and reconnect Secondary client if disconnected
-    if (!mqtt2.connected() && (now - lastReconnectAttempt > MQTT_RECONNECT_INTERVAL_MS)) {
-        Serial.println("MQTT Secondary disconnected, attempting reconnection...");
-        if (mqtt2.connect(SECONDARY_MQTT_CLIENT_NAME, "public", "public")) {
-            Serial.println("MQTT Secondary reconnected!");
-            // TODO: Resubscribe to last selected topic from menu
-        } else {
-            Serial.println("MQTT Secondary reconnection failed");
-        }
+    // No point dialling the broker while WiFiSetup is still getting the link back
+    bool linkUp = WiFi.status() == WL_CONNECTED;
+
+    // The primary client decides when to move to another broker, the secondary follows
+    int primaryResult = maintainClient(mqtt, PRIMARY_MQTT_CLIENT_NAME, "MQTT Primary",
+                                       primaryLink, primarySubscriptions, linkUp, now);
+    if (primaryResult < 0 && brokers.recordFailure()) {
+        useBroker(brokers.next(), primaryLink.lostMillis, now);
+    } else if (primaryResult > 0 && brokers.recordConnected(millis())) {
+        LOG_INFO("MQTT switchover to %s:%d took %lu ms", brokers.host(brokers.active()),
+                 brokers.port(brokers.active()), (unsigned long)brokers.lastSwitchoverMs());
+    }
+
+    // Timer events held during the outage go out first, in order
+    if (mqtt.connected() && !outbox.empty()) {
+        flushOutbox();
     }
 
-    // Process MQTT messages
+    maintainClient(mqtt2, SECONDARY_MQTT_CLIENT_NAME, "MQTT Secondary",
+                   secondaryLink, secondarySubscriptions, linkUp, now);
+
+    // Go back to the first broker once it accepts an MQTT session again; the
+    // backup session is kept until then, and a failed first connect returns to it
+    if (mqtt.connected() && brokers.primaryProbeDue(now) && probeBroker(0)) {
+        LOG_INFO("MQTT first broker is back, switching");
+        brokers.returnToFirst(now);
+        useBroker(0, now, now);
+    }
+}
+
+/**
+ * Point both clients at another broker. Connected clients are disconnected;
+ * the next connect attempt runs right away instead of after the backoff.
+ * @param index Broker index in the failover list.
+ * @param outageStart millis() when the connection was lost, for the switchover time.
+ * @param now Current millis().
+ */
+void MqttSetup::useBroker(uint8_t index, unsigned long outageStart, unsigned long now)
+{
+    brokers.select(index, outageStart);
+    LOG_INFO("MQTT using broker %u: %s:%d", index, brokers.host(index), brokers.port(index));
+
     if (mqtt.connected()) {
-        mqtt.loop();
+        mqtt.disconnect();
     }
     if (mqtt2.connected()) {
-        mqtt2.loop();
+        mqtt2.disconnect();
+    }
+    mqtt.setHost(brokers.host(index), brokers.port(index));
+    mqtt2.setHost(brokers.host(index), brokers.port(index));
+
+    primaryLink.backoffMs = MQTT_BACKOFF_MIN_MS;
+    primaryLink.nextAttemptMillis = now;
+    secondaryLink.backoffMs = MQTT_BACKOFF_MIN_MS;
+    secondaryLink.nextAttemptMillis = now;
+}
+
+/**
+ * Send up to PUBLISH_FLUSH_BATCH held publishes, oldest first, so a long
+ * backlog does not keep the network task from polling the clients. Stops at
+ * the first failed publish; the entry stays held for the next connect.
+ */
+void MqttSetup::flushOutbox()
+{
+    for (uint8_t i = 0; i < PUBLISH_FLUSH_BATCH; i++) {
+        const HeldPublish *entry = outbox.front();
+        if (entry == nullptr || !mqtt.publish(entry->topic, entry->payload)) {
+            return;
+        }
+        outbox.pop(millis());
+    }
+
+    if (outbox.empty()) {
+        LOG_INFO("MQTT held publishes forwarded (longest delay %lu ms)",
+                 (unsigned long)outbox.maxDelayMs());
+    }
+}
+
+/**
+ * Check if a broker accepts an MQTT session, on a client of its own so the
+ * active session on the backup stays up. The probe session is closed right
+ * away and subscribes to nothing.
+ * @param index Broker index in the failover list.
+ * @return True if the broker sent CONNACK within MQTT_BROKER_PROBE_TIMEOUT_MS.
+ */
+bool MqttSetup::probeBroker(uint8_t index)
+{
+    probeClient.setHost(brokers.host(index), brokers.port(index));
+    bool up = probeClient.connect(MQTT_CLIENT_PROBE, MQTT_USERNAME, MQTT_PASSWORD);
+    if (up) {
+        probeClient.disconnect();
+    } else {
+        probeNet.stop();
+    }
+    return up;
+}
+
+/**
+ * Keep one client connected. A failed attempt doubles the delay up to
+ * MQTT_BACKOFF_MAX_MS, spread by MQTT_BACKOFF_JITTER_PERCENT so both clients
+ * (and other devices after a broker restart) do not retry in lockstep.
+ * The 256dpi client has no asynchronous connect; attempts run here in the
+ * network task, so the displays never wait for them.
+ * @param client mqtt or mqtt2.
+ * @param clientId MQTT client id.
+ * @param label Name for the log and boot timeline.
+ * @param link Connection state of the client.
+ * @param subscriptions Topics to restore after connecting.
+ * @param linkUp True if WiFi is connected.
+ * @param now Current millis().
+ * @return 1 if connected by this call, -1 if a connect attempt failed, 0 otherwise.
+ */
+int MqttSetup::maintainClient(MQTTClient &client, const char *clientId, const char *label,
+                              MqttLinkState &link, SubscriptionSet &subscriptions, bool linkUp, unsigned long now)
+{
+    if (client.connected()) {
+        client.loop();
+        return 0;
+    }
+
+    if (link.wasConnected) {
+        LOG_INFO("%s disconnected", label);
+        link.wasConnected = false;
+        link.lostMillis = now;
+        link.awaitingData = false;
+        link.backoffMs = MQTT_BACKOFF_MIN_MS;
+        link.nextAttemptMillis = now;
+    }
+
+    if (!linkUp || (long)(now - link.nextAttemptMillis) < 0) {
+        return 0;
+    }
+
+    if (!client.connect(clientId, MQTT_USERNAME, MQTT_PASSWORD)) {
+        unsigned long spread = link.backoffMs * MQTT_BACKOFF_JITTER_PERCENT / 100;
+        unsigned long wait = link.backoffMs - spread + random(2 * spread + 1);
+        LOG_INFO("%s connection failed, retry in %lu ms", label, wait);
+        link.nextAttemptMillis = now + wait;
+        link.backoffMs *= 2;
+        if (link.backoffMs > MQTT_BACKOFF_MAX_MS) {
+            link.backoffMs = MQTT_BACKOFF_MAX_MS;
+        }
+        return -1;
+    }
+
+    // The broker forgot the subscriptions of the clean session, replay them in one pass
+    uint8_t restored = 0;
+    for (uint8_t i = 0; i < subscriptions.count(); i++) {
+        if (client.subscribe(subscriptions.topicAt(i))) {
+            restored++;
+        }
+    }
+
+    unsigned long connectedAt = millis();
+    if (link.lostMillis != 0) {
+        link.reconnects++;
+    }
+    link.wasConnected = true;
+    link.awaitingData = true;
+    link.connectedMillis = connectedAt;
+    link.backoffMs = MQTT_BACKOFF_MIN_MS;
+    LOG_INFO("%s connected, restored %u/%u subscriptions", label, restored, subscriptions.count());
+    bootTimeline.markOnce(label);
+    return 1;
+}
+
+/**
+ * Record the first message after a (re)connect: the time from losing the
+ * connection (or power-on) until data flows again.
+ * @param link Connection state of the client that received it.
+ * @param label Name for the log.
+ */
+void MqttSetup::noteData(MqttLinkState &link, const char *label)
+{
+    if (!link.awaitingData) {
+        return;
+    }
+
+    unsigned long now = millis();
+    link.awaitingData = false;
+    link.timeToDataMs = now - link.lostMillis;
+    link.connectToDataMs = now - link.connectedMillis;
+    LOG_INFO("%s data %lu ms after the outage (%lu ms after connecting)",
+             label, (unsigned long)link.timeToDataMs, (unsigned long)link.connectToDataMs);
+}
+
+/**
+ * Raw callback of the Primary channel, used so binary payloads are not cut at
+ * a zero byte (the client terminates the payload before calling it).
+ * @param client The receiving client.
+ * @param topic The MQTT topic.
+ * @param bytes The MQTT payload.
+ * @param length Payload length.
+ */
+void MqttSetup::MqttMessageReceivedPrimaryRaw(MQTTClient *client, char topic[], char bytes[], int length)
+{
+    TRACE_SCOPE(TRACE_MQTT_RX);
+    noteData(mqttSetup.primaryLink, "MQTT Primary");
+    uint32_t start = micros();
+    handlePrimaryMessage(topic, bytes, length);
+    callbackDuration.record(micros() - start);
+}
+
+/**
+ * Feed a message to the primary channel handlers. Shared by the MQTT client
+ * on the network task and the UDP listener on its own task, so one message
+ * is handled at a time (the ECU frame decoder keeps the sequence state, the
+ * ingest counters are plain integers). A binary ECU frame may
+ * contain zero bytes, so it is decoded from the raw payload, as is the JSON
+ * batch (no String copies); every other topic goes to the text callback
+ * exactly as onMessage() would pass it.
+ * @param topic The MQTT topic.
+ * @param bytes The message payload, followed by a zero byte.
+ * @param length Payload length.
+ */
+void MqttSetup::handlePrimaryMessage(const char *topic, const char *bytes, int length)
+{
+    SemaphoreHandle_t mutex = mqttSetup.handlerMutex;
+    if (mutex == NULL || xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) != pdTRUE)
+    {
+        LOG_WARN("Primary handlers busy, %s dropped", topic);
+        return;
+    }
+
+    bool frame = strcmp(topic, MQTT_ECU_FRAME_TOPIC) == 0;
+    if (frame || strcmp(topic, MQTT_ECU_JSON_TOPIC) == 0)
+    {
+        // The direct serial link is fresher (this may be our own republish)
+        if (!speeduinoSerial.isLive() && frame)
+            handleEcuFrame(bytes, length);
+        else if (!speeduinoSerial.isLive())
+            handleEcuJson(bytes, length);
+    }
+    else
+    {
+        String topicString(topic);
+        String payloadString(bytes);
+        MqttMessageReceivedPrimary(topicString, payloadString);
+    }
+
+    xSemaphoreGive(mutex);
+}
+
+/**
+ * Decode a packed ECU frame and hand all channels over in one batch.
+ * @param bytes The MQTT payload.
+ * @param length Payload length.
+ */
+void MqttSetup::handleEcuFrame(const char *bytes, int length)
+{
+    TRACE_SCOPE(TRACE_FORMAT);
+    DisplaySample samples[ECU_CHANNEL_COUNT];
+    EcuFrameDecoder &decoder = mqttSetup.ecuFrames;
+    if (!decoder.decode(bytes, length, samples, micros()))
+    {
+        // Reported once, the stats page keeps the count
+        if (decoder.rejectedCount() == 1)
+            LOG_WARN("ECU frame rejected (%d bytes, expected %u)", length, (unsigned)sizeof(EcuFrame));
+        return;
+    }
+
+    deliverSamples(samples, ECU_CHANNEL_COUNT);
+}
+
+/**
+ * Parse an ECU JSON batch. A malformed message is dropped as a whole.
+ * @param bytes The MQTT payload.
+ * @param length Payload length.
+ */
+void MqttSetup::handleEcuJson(const char *bytes, int length)
+{
+    TRACE_SCOPE(TRACE_FORMAT);
+    DisplaySample samples[ECU_CHANNEL_COUNT];
+    EcuJsonParser &parser = mqttSetup.ecuJson;
+    uint32_t rejectedBefore = parser.rejectedCount();
+    uint8_t count = parser.parse(bytes, length, samples, micros());
+
+    // Reported once, the stats page keeps the count
+    if (rejectedBefore == 0 && parser.rejectedCount() == 1)
+        LOG_WARN("ECU JSON rejected (%d bytes)", length);
+
+    deliverSamples(samples, count);
+}
+
+/**
+ * Hand a batch of channel values to the main loop under one lock, so it
+ * applies a whole snapshot at once. Before the network task runs (setup) they
+ * are applied directly.
+ * @param samples Formatted channel values.
+ * @param count Number of samples.
+ */
+void MqttSetup::deliverSamples(const DisplaySample *samples, uint8_t count)
+{
+    if (count == 0)
+        return;
+
+    if (!networkTask.isRunning())
+    {
+        for (uint8_t i = 0; i < count; i++)
+            applySample(samples[i].code, samples[i].text, samples[i].value, samples[i].receivedMicros);
+    }
+    else
+    {
+        networkTask.pushSamples(samples, count);
     }
 }
 
@@ -129,41 +691,68 @@ void MqttSetup::MqttMessageReceivedPrimary(String &topic, String &payload)
         {
             String secondLastSegment = topic.substring(secondLastSlashIndex + 1, lastSlashIndex);
 
+            // Bridge values are ignored while a direct serial link delivers the same channels
+            bool ecuFromSerial = secondLastSegment == "ECU" && speeduinoSerial.isLive();
+            bool gpsFromSerial = secondLastSegment == "GPS" && gpsSerial.isLive();
+
             // Switch between the last two segments
-            if (secondLastSegment == "GPS")
+            if ((secondLastSegment == "GPS" && !gpsFromSerial) || (secondLastSegment == "ECU" && !ecuFromSerial))
             {
-                handleGpsPayload(lastSegment, payload);
-                // Convert formatted String to char array
-                strncpy(newMessage, payload.c_str(), sizeof(newMessage) - 1);
-                newMessage[sizeof(newMessage) - 1] = '\0';
-                newMessageAvailable = true;
-            }
-            else if (secondLastSegment == "ECU")
-            {
-                handleEcuPayload(lastSegment, payload);
-                // Convert formatted String to char array
-                strncpy(newMessage, payload.c_str(), sizeof(newMessage) - 1);
-                newMessage[sizeof(newMessage) - 1] = '\0';
-                newMessageAvailable = true;
+                uint32_t receivedMicros = micros();
+                float value = payload.toFloat();
+
+                if (secondLastSegment == "GPS")
+                    handleGpsPayload(lastSegment, payload);
+                else
+                    handleEcuPayload(lastSegment, payload);
+
+                // Formatting happens here, the main loop only copies the result
+                DisplaySample sample;
+                strncpy(sample.code, lastSegment.c_str(), sizeof(sample.code) - 1);
+                sample.code[sizeof(sample.code) - 1] = '\0';
+                strncpy(sample.text, payload.c_str(), sizeof(sample.text) - 1);
+                sample.text[sizeof(sample.text) - 1] = '\0';
+                sample.value = value;
+                sample.receivedMicros = receivedMicros;
+
+                if (!networkTask.isRunning())
+                    applySample(sample.code, sample.text, sample.value, sample.receivedMicros);
+                else
+                    networkTask.pushSample(sample);
             }
         }
 
-        // Handle timer topics
+        // Handle timer and alert topics, these are never dropped
         char timer1Topic[48], timer2Topic[48];
         snprintf(timer1Topic, sizeof(timer1Topic), "%svalue", MQTT_TIMER1_TOPIC);
         snprintf(timer2Topic, sizeof(timer2Topic), "%svalue", MQTT_TIMER2_TOPIC);
         
-        if (topic == timer1Topic || topic == timer2Topic)
+        if (topic == timer1Topic || topic == timer2Topic || topic == MQTT_ALERT_TOPIC)
         {
-            unsigned long timerValue = payload.toInt();
-            if (topic == timer1Topic && !timer1Started)
-            {
-                timer1Value = timerValue;
-            }
-            else if (topic == timer2Topic && !timer2Started)
-            {
-                timer2Value = timerValue;
-            }
+            CriticalMessage message;
+            if (topic == timer1Topic)
+                message.kind = CRITICAL_TIMER1_VALUE;
+            else if (topic == timer2Topic)
+                message.kind = CRITICAL_TIMER2_VALUE;
+            else
+                message.kind = CRITICAL_ALERT;
+            strncpy(message.payload, payload.c_str(), sizeof(message.payload) - 1);
+            message.payload[sizeof(message.payload) - 1] = '\0';
+
+            if (!networkTask.isRunning())
+                applyCritical(message.kind, message.payload);
+            else
+                networkTask.pushCritical(message);
+        }
+        else if (topic.startsWith(MQTT_DIAG_TOPIC))
+        {
+            // Diagnostics are shed first when the main loop falls behind
+            DiagnosticMessage message;
+            strncpy(message.name, topic.c_str() + strlen(MQTT_DIAG_TOPIC), sizeof(message.name) - 1);
+            message.name[sizeof(message.name) - 1] = '\0';
+            strncpy(message.payload, payload.c_str(), sizeof(message.payload) - 1);
+            message.payload[sizeof(message.payload) - 1] = '\0';
+            networkTask.pushDiagnostic(message);
         }
     }
 }
@@ -185,6 +774,7 @@ void MqttSetup::MqttMessageReceivedPrimary(String &topic, String &payload)
  */
 void MqttSetup::handleGpsPayload(const String &lastSegment, String &payload)
 {
+    TRACE_SCOPE(TRACE_FORMAT);
     if (lastSegment == "TME")
     {
         MqttSetup::transformTime(payload);
@@ -224,26 +814,9 @@ void MqttSetup::handleGpsPayload(const String &lastSegment, String &payload)
  */
 void MqttSetup::handleEcuPayload(const String &lastSegment, String &payload)
 {
-    if (lastSegment == "TPS" || lastSegment == "VE1" || lastSegment == "TAE")
-    {
-        // Add '%' sign to the end of the numeric value
-        payload = payload + "%";
-    }
-    else if (lastSegment == "MAT" || lastSegment == "CAD")
-    {
-        // Add 'C'
-        payload = payload + "C";
-    }
-    else if (lastSegment == "BAT")
-    {
-        // Add 'V'
-        payload = payload + "V";
-    }
-    else if (lastSegment == "DWL")
-    {
-        // Add 'ms'
-        payload = payload + "ms";
-    }
+    TRACE_SCOPE(TRACE_FORMAT);
+    // Same units as the ECU frame path
+    payload = payload + EcuFrameDecoder::unit(lastSegment.c_str());
 }
 
 /**
@@ -253,6 +826,8 @@ void MqttSetup::handleEcuPayload(const String &lastSegment, String &payload)
  */
 void MqttSetup::MqttMessageReceivedSecondary(String &topic, String &payload)
 {
+    noteData(mqttSetup.secondaryLink, "MQTT Secondary");
+
     // reverse string, as 7segment display expects it.
     MqttSetup::reverseString(payload);
 
@@ -282,13 +857,12 @@ void MqttSetup::MqttMessageReceivedSecondary(String &topic, String &payload)
     
     // Thread-safe message setting with size validation
     if (payload.length() >= MESSAGE_BUFFER_SIZE) {
-        Serial.printf("WARNING: MQTT payload truncated from %d to %d chars\n", 
-                     payload.length(), MESSAGE_BUFFER_SIZE - 1);
+        LOG_WARN("MQTT payload truncated from %u to %d chars", payload.length(), MESSAGE_BUFFER_SIZE - 1);
     }
     
     if (!g_secondaryMessage.setMessage(payload.c_str())) {
         // Fallback to legacy volatile if thread-safe operation fails
-        Serial.println("WARNING: Thread-safe message set failed, using fallback");
+        LOG_WARN("Thread-safe message set failed, using fallback");
         strncpy((char*)newMessage2, payload.c_str(), MESSAGE_BUFFER_SIZE - 1);
         ((char*)newMessage2)[MESSAGE_BUFFER_SIZE - 1] = '\0';
         newMessageAvailable2 = true;
@@ -323,7 +897,7 @@ void MqttSetup::transformTime(String &timeString)
 {
     if (!isValidTimeFormat(timeString))
     {
-        Serial.println("Invalid time format: " + timeString);
+        LOG_WARN("Invalid time format: %s", timeString.c_str());
         return;
     }
 
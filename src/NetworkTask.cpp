@@ -0,0 +1,214 @@
+// NetworkTask.cpp
+// Implementation of the MQTT network task
+
+#include "NetworkTask.h"
+#include "MqttSetup.h"
+#include "TaskRegistry.h"
+#include "DeferredLog.h"
+#include <esp_task_wdt.h>
+#include <string.h>
+
+extern MqttSetup mqttSetup;
+
+// Global instance
+NetworkTask networkTask;
+
+/**
+ * @brief Constructor for NetworkTask
+ */
+NetworkTask::NetworkTask()
+    : taskHandle(NULL), commandQueue(NULL), nextSequence(0), periodicPending(0), overflowHead(0), overflowCount(0),
+      superseded(0), overflowed(0), dropped(0) {
+    memset(periodicSlots, 0, sizeof(periodicSlots));
+}
+
+/**
+ * @brief Create the queues and start the task
+ *
+ * Must be called after mqttSetup.begin(); from then on only the network task
+ * touches the MQTT clients.
+ *
+ * @return true if the task is running
+ */
+bool NetworkTask::begin() {
+    if (taskHandle != NULL) {
+        return true;
+    }
+
+    commandQueue = xQueueCreate(NETWORK_COMMAND_QUEUE_LENGTH, sizeof(NetCommand));
+    if (!beginQueues() || commandQueue == NULL) {
+        Serial.println("ERROR: Failed to create network queues!");
+        return false;
+    }
+
+    BaseType_t created = taskRegistry.create(
+        taskLoop,
+        "networkTask",
+        NETWORK_TASK_STACK_SIZE,
+        this,
+        NETWORK_TASK_PRIORITY,
+        &taskHandle,
+        NETWORK_TASK_CORE);
+
+    if (created != pdPASS || taskHandle == NULL) {
+        taskHandle = NULL;
+        Serial.println("ERROR: Failed to create network task!");
+        return false;
+    }
+
+    esp_task_wdt_add(taskHandle);
+    Serial.printf("Network task started on core %d\n", NETWORK_TASK_CORE);
+    return true;
+}
+
+/**
+ * @brief Hand an MQTT operation to the network task without blocking (any task but the network task)
+ *
+ * A periodic publish only replaces the pending one of its topic. Everything
+ * else is queued; while the queue is full (the network task is stuck in a
+ * connect) the command is held in the overflow list, so the main loop and
+ * timer callbacks never wait on the network. A command is dropped, counted
+ * and logged only when the overflow list is full as well.
+ *
+ * @param command Operation to run
+ * @return true if queued, held in the overflow list or stored in its periodic slot
+ */
+bool NetworkTask::postCommand(const NetCommand &command) {
+    if (commandQueue == NULL) {
+        return false;
+    }
+
+    NetCommand sequenced = command;
+    if (command.type == NET_CMD_PUBLISH && command.periodic) {
+        sequenced.sequence = nextSequence.fetch_add(1, std::memory_order_relaxed);
+        if (storePeriodic(sequenced)) {
+            return true;
+        }
+    }
+
+    sequenced.sequence = nextSequence.fetch_add(1, std::memory_order_relaxed);
+    if (xQueueSend(commandQueue, &sequenced, 0) == pdTRUE) {
+        return true;
+    }
+
+    if (storeOverflow(sequenced)) {
+        overflowed.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    LOG_WARN("Network command queue full, dropped %s", command.topic);
+    return false;
+}
+
+/**
+ * @brief Store a periodic publish in the slot of its topic
+ *
+ * Slots are bound to a topic on first use and keep it; a pending publish
+ * that is replaced is counted as superseded.
+ *
+ * @param command Sequenced publish
+ * @return false if all slots belong to other topics
+ */
+bool NetworkTask::storePeriodic(const NetCommand &command) {
+    bool stored = false;
+    portENTER_CRITICAL(&periodicLock);
+    for (uint8_t i = 0; i < NETWORK_PERIODIC_SLOT_COUNT; i++) {
+        NetCommand &slot = periodicSlots[i];
+        if (slot.topic[0] != '\0' && strcmp(slot.topic, command.topic) != 0) {
+            continue;
+        }
+        if (periodicPending & (1 << i)) {
+            superseded.fetch_add(1, std::memory_order_relaxed);
+        }
+        slot = command;
+        periodicPending |= 1 << i;
+        stored = true;
+        break;
+    }
+    portEXIT_CRITICAL(&periodicLock);
+    return stored;
+}
+
+/**
+ * @brief Hold a command in the overflow list while the queue is full
+ * @param command Sequenced operation
+ * @return false if the list is full as well
+ */
+bool NetworkTask::storeOverflow(const NetCommand &command) {
+    bool stored = false;
+    portENTER_CRITICAL(&periodicLock);
+    if (overflowCount < NETWORK_COMMAND_OVERFLOW_LENGTH) {
+        overflow[(overflowHead + overflowCount) % NETWORK_COMMAND_OVERFLOW_LENGTH] = command;
+        overflowCount++;
+        stored = true;
+    }
+    portEXIT_CRITICAL(&periodicLock);
+    return stored;
+}
+
+/**
+ * @brief Take the oldest queued, held or pending periodic operation (network task only)
+ *
+ * Whichever of the queue head, the overflow head and the oldest pending slot
+ * was posted first goes first, so a running value posted before a pause
+ * event is not sent after it, and a held command is not overtaken by one
+ * queued once there was room again. The queue head cannot change between
+ * the peek and the receive, this task is the only reader.
+ *
+ * @param command Output operation
+ * @return true if an operation was taken
+ */
+bool NetworkTask::popCommand(NetCommand &command) {
+    if (commandQueue == NULL) {
+        return false;
+    }
+
+    NetCommand queued;
+    bool haveQueued = xQueuePeek(commandQueue, &queued, 0) == pdTRUE;
+
+    bool taken = false;
+    portENTER_CRITICAL(&periodicLock);
+    int8_t oldest = -1;
+    for (uint8_t i = 0; i < NETWORK_PERIODIC_SLOT_COUNT; i++) {
+        if ((periodicPending & (1 << i)) &&
+            (oldest < 0 || (int32_t)(periodicSlots[i].sequence - periodicSlots[oldest].sequence) < 0)) {
+            oldest = i;
+        }
+    }
+    // The earlier of the queue and overflow heads competes with the slots
+    bool overflowFirst = overflowCount > 0 &&
+        (!haveQueued || (int32_t)(overflow[overflowHead].sequence - queued.sequence) < 0);
+    bool haveOther = haveQueued || overflowCount > 0;
+    uint32_t otherSequence = overflowFirst ? overflow[overflowHead].sequence : queued.sequence;
+    if (oldest >= 0 && (!haveOther || (int32_t)(periodicSlots[oldest].sequence - otherSequence) < 0)) {
+        command = periodicSlots[oldest];
+        periodicPending &= ~(1 << oldest);
+        taken = true;
+    } else if (overflowFirst) {
+        command = overflow[overflowHead];
+        overflowHead = (overflowHead + 1) % NETWORK_COMMAND_OVERFLOW_LENGTH;
+        overflowCount--;
+        taken = true;
+    }
+    portEXIT_CRITICAL(&periodicLock);
+
+    if (taken) {
+        return true;
+    }
+    return haveQueued && xQueueReceive(commandQueue, &command, 0) == pdTRUE;
+}
+
+/**
+ * @brief Network task body: reconnect, run queued operations, process MQTT
+ * @param parameter Unused, the global instance is used
+ */
+void NetworkTask::taskLoop(void *parameter) {
+    while (1) {
+        mqttSetup.connect();
+        mqttSetup.processCommands();
+
+        esp_task_wdt_reset();
+        vTaskDelay(pdMS_TO_TICKS(NETWORK_TASK_INTERVAL_MS));
+    }
+}
@@ -0,0 +1,242 @@
+// NmeaParser.cpp
+// Implementation of the streaming NMEA parser
+
+#include "NmeaParser.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define NMEA_MAX_FIELDS 20
+#define KNOTS_TO_KMH 1.852f
+
+/**
+ * @brief Value of a hex digit
+ * @param c Character
+ * @return 0..15, -1 if not a hex digit
+ */
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+/**
+ * @brief Value of two decimal digits
+ * @param p First digit
+ * @return 0..99
+ */
+static uint8_t twoDigits(const char *p) {
+    return (p[0] - '0') * 10 + (p[1] - '0');
+}
+
+/**
+ * @brief Convert an NMEA ddmm.mmmm / dddmm.mmmm coordinate to degrees
+ * @param value Coordinate field
+ * @param hemisphere N, S, E or W field
+ * @return Degrees, negative for S and W
+ */
+static double toDegrees(const char *value, const char *hemisphere) {
+    double raw = strtod(value, nullptr);
+    int degrees = (int)(raw / 100);
+    double result = degrees + (raw - degrees * 100) / 60.0;
+    return (hemisphere[0] == 'S' || hemisphere[0] == 'W') ? -result : result;
+}
+
+/**
+ * @brief Parse hhmmss(.ss) into the fix
+ * @param fix Fix to update
+ * @param value Time field
+ * @return true if the field was valid
+ */
+static bool parseTime(GpsFix &fix, const char *value) {
+    if (strlen(value) < 6) {
+        return false;
+    }
+    fix.hour = twoDigits(value);
+    fix.minute = twoDigits(value + 2);
+    fix.second = twoDigits(value + 4);
+    fix.updated |= GPS_FIELD_TIME;
+    return true;
+}
+
+/**
+ * @brief Constructor for NmeaParser
+ */
+NmeaParser::NmeaParser()
+    : length(0), checksum(0), expected(0), checksumDigits(-1), inSentence(false),
+      sentences(0), checksumErrors(0), ignored(0) {
+    memset(&current, 0, sizeof(current));
+}
+
+/**
+ * @brief Feed one received byte
+ * @param c Byte from the receiver
+ * @return true when a sentence updated the fix (see fix().updated)
+ */
+bool NmeaParser::feed(char c) {
+    if (c == '$') {
+        // A new sentence always restarts, even after a truncated one
+        inSentence = true;
+        length = 0;
+        checksum = 0;
+        checksumDigits = -1;
+        return false;
+    }
+    if (!inSentence) {
+        return false;
+    }
+
+    if (checksumDigits < 0) {
+        if (c == '*') {
+            checksumDigits = 0;
+            expected = 0;
+        } else if (c == '\r' || c == '\n' || length >= NMEA_MAX_SENTENCE - 1) {
+            // No checksum or too long
+            inSentence = false;
+            ignored++;
+        } else {
+            buffer[length++] = c;
+            checksum ^= (uint8_t)c;
+        }
+        return false;
+    }
+
+    int digit = hexValue(c);
+    if (digit < 0) {
+        inSentence = false;
+        checksumErrors++;
+        return false;
+    }
+    expected = (expected << 4) | digit;
+    if (++checksumDigits < 2) {
+        return false;
+    }
+
+    inSentence = false;
+    if (expected != checksum) {
+        checksumErrors++;
+        return false;
+    }
+    buffer[length] = '\0';
+    return apply();
+}
+
+/**
+ * @brief Split a checked sentence into fields and apply it
+ * @return true if it was RMC, GGA or VTG
+ */
+bool NmeaParser::apply() {
+    char *fields[NMEA_MAX_FIELDS];
+    uint8_t count = 0;
+    char *p = buffer;
+    fields[count++] = p;
+    while (*p != '\0') {
+        if (*p == ',') {
+            *p = '\0';
+            if (count == NMEA_MAX_FIELDS) {
+                break;
+            }
+            fields[count++] = p + 1;
+        }
+        p++;
+    }
+
+    // Sentence id is talker (2 letters) + type, e.g. GPRMC or GNGGA
+    const char *type = strlen(fields[0]) == 5 ? fields[0] + 2 : "";
+    current.updated = 0;
+    if (strcmp(type, "RMC") == 0) {
+        applyRmc(fields, count);
+    } else if (strcmp(type, "GGA") == 0) {
+        applyGga(fields, count);
+    } else if (strcmp(type, "VTG") == 0) {
+        applyVtg(fields, count);
+    } else {
+        ignored++;
+        return false;
+    }
+    sentences++;
+    return true;
+}
+
+/**
+ * @brief RMC: time, status, position, speed (knots), course, date
+ * @param fields Sentence fields
+ * @param count Number of fields
+ */
+void NmeaParser::applyRmc(char **fields, uint8_t count) {
+    if (count < 10) {
+        return;
+    }
+    parseTime(current, fields[1]);
+    if (strlen(fields[9]) == 6) {
+        current.day = twoDigits(fields[9]);
+        current.month = twoDigits(fields[9] + 2);
+        current.year = 2000 + twoDigits(fields[9] + 4);
+        current.updated |= GPS_FIELD_DATE;
+    }
+
+    // Position, speed and course only count with an active fix
+    if (fields[2][0] != 'A') {
+        return;
+    }
+    if (fields[3][0] != '\0' && fields[5][0] != '\0') {
+        current.latitude = toDegrees(fields[3], fields[4]);
+        current.longitude = toDegrees(fields[5], fields[6]);
+        current.updated |= GPS_FIELD_POSITION;
+    }
+    if (fields[7][0] != '\0') {
+        current.speedKmh = strtof(fields[7], nullptr) * KNOTS_TO_KMH;
+        current.updated |= GPS_FIELD_SPEED;
+    }
+    if (fields[8][0] != '\0') {
+        current.course = strtof(fields[8], nullptr);
+        current.updated |= GPS_FIELD_COURSE;
+    }
+}
+
+/**
+ * @brief GGA: time, position, fix quality, satellites, altitude
+ * @param fields Sentence fields
+ * @param count Number of fields
+ */
+void NmeaParser::applyGga(char **fields, uint8_t count) {
+    if (count < 10) {
+        return;
+    }
+    parseTime(current, fields[1]);
+    current.quality = (uint8_t)atoi(fields[6]);
+    current.satellites = (uint8_t)atoi(fields[7]);
+    current.updated |= GPS_FIELD_QUALITY;
+
+    if (current.quality == 0) {
+        return;
+    }
+    if (fields[2][0] != '\0' && fields[4][0] != '\0') {
+        current.latitude = toDegrees(fields[2], fields[3]);
+        current.longitude = toDegrees(fields[4], fields[5]);
+        current.updated |= GPS_FIELD_POSITION;
+    }
+    if (fields[9][0] != '\0') {
+        current.altitude = strtof(fields[9], nullptr);
+        current.updated |= GPS_FIELD_ALTITUDE;
+    }
+}
+
+/**
+ * @brief VTG: course and speed (km/h)
+ * @param fields Sentence fields
+ * @param count Number of fields
+ */
+void NmeaParser::applyVtg(char **fields, uint8_t count) {
+    if (count < 8) {
+        return;
+    }
+    if (fields[1][0] != '\0') {
+        current.course = strtof(fields[1], nullptr);
+        current.updated |= GPS_FIELD_COURSE;
+    }
+    if (fields[7][0] != '\0') {
+        current.speedKmh = strtof(fields[7], nullptr);
+        current.updated |= GPS_FIELD_SPEED;
+    }
+}
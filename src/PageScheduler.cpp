@@ -0,0 +1,149 @@
+// PageScheduler.cpp
+// Implementation of the main display page rotation
+
+#include "PageScheduler.h"
+#include "MqttSetup.h"
+#include "ChannelTable.h"
+#include "DisplayModes.h"
+#include "DisplayZones.h"
+#include "DeferredLog.h"
+#include <string.h>
+
+extern MqttSetup mqttSetup;
+
+// Global instance
+PageScheduler pageScheduler;
+
+/**
+ * @brief Constructor for PageScheduler
+ */
+PageScheduler::PageScheduler() : currentPage(0), lastSwitchMillis(0), started(false) {
+}
+
+/**
+ * @brief Subscribe all page channels and show the first page
+ *
+ * Must be called after the configuration is loaded. Subscriptions are
+ * registered before MQTT connects and sent once the client is up.
+ */
+void PageScheduler::begin() {
+    subscribePages();
+    started = true;
+    show(0);
+
+    // Keep the welcome animation running until the first value arrives
+    newMessageAvailable = false;
+    Serial.printf("Page rotation: %d pages, interval %d s\n",
+                  wifiSetup.config.pageCount, wifiSetup.config.pageIntervalS);
+}
+
+/**
+ * @brief Advance the page on the rotation timer
+ * @param now Current millis()
+ */
+void PageScheduler::update(unsigned long now) {
+    if (!isRotating() || wifiSetup.config.pageIntervalS == 0) {
+        return;
+    }
+
+    if (now - lastSwitchMillis >= (unsigned long)wifiSetup.config.pageIntervalS * 1000UL) {
+        next();
+    }
+}
+
+/**
+ * @brief Show the next page
+ */
+void PageScheduler::next() {
+    if (!isRotating()) {
+        return;
+    }
+    show((currentPage + 1) % wifiSetup.config.pageCount);
+}
+
+/**
+ * @brief Check if rotation is possible (more than one page)
+ * @return true if there is more than one page
+ */
+bool PageScheduler::isRotating() const {
+    return started && wifiSetup.config.pageCount > 1;
+}
+
+/**
+ * @brief Assign a channel to the page currently shown (menu P:ECU / P:GPS)
+ * @param code Three letter channel code
+ */
+void PageScheduler::assignCurrent(const char *code) {
+    if (g_channels.indexOf(code) < 0) {
+        LOG_ERROR("Unknown channel for page");
+        return;
+    }
+
+    char *pageCode = wifiSetup.config.pages[currentPage];
+    if (strcmp(pageCode, code) != 0) {
+        mqttSetup.subscribeChannel(code);
+        mqttSetup.unsubscribeChannel(pageCode);
+        strncpy(pageCode, code, DATA_INDEX_SIZE - 1);
+        pageCode[DATA_INDEX_SIZE - 1] = '\0';
+    }
+
+    show(currentPage);
+}
+
+/**
+ * @brief Change the number of pages in the rotation
+ * @param count Number of pages (1..MAX_PAGES)
+ */
+void PageScheduler::setPageCount(uint8_t count) {
+    if (count < 1 || count > MAX_PAGES) {
+        LOG_ERROR("Invalid page count %d (max: %d)", count, MAX_PAGES);
+        return;
+    }
+
+    // Subscribe the new set before releasing the old one to keep shared topics alive
+    uint8_t oldCount = wifiSetup.config.pageCount;
+    for (uint8_t i = 0; i < count; i++) {
+        mqttSetup.subscribeChannel(wifiSetup.config.pages[i]);
+    }
+    for (uint8_t i = 0; i < oldCount; i++) {
+        mqttSetup.unsubscribeChannel(wifiSetup.config.pages[i]);
+    }
+
+    wifiSetup.config.pageCount = count;
+    show(currentPage < count ? currentPage : 0);
+}
+
+/**
+ * @brief Show a page immediately from the channel table
+ *
+ * Sets the primary channel (dataIndex, zone 0) and hands the latest known
+ * value to the display, so the switch does not wait for the next message.
+ *
+ * @param page Page index
+ */
+void PageScheduler::show(uint8_t page) {
+    const char *code = wifiSetup.config.pages[page];
+
+    currentPage = page;
+    lastSwitchMillis = millis();
+
+    strncpy(dataIndex, code, DATA_INDEX_SIZE - 1);
+    dataIndex[DATA_INDEX_SIZE - 1] = '\0';
+    mainZones.bind(0, code);
+    mainGraph.invalidate();
+
+    if (!g_channels.read(g_channels.indexOf(code), newMessage, MESSAGE_BUFFER_SIZE)) {
+        strncpy(newMessage, "---", MESSAGE_BUFFER_SIZE - 1);
+        newMessage[MESSAGE_BUFFER_SIZE - 1] = '\0';
+    }
+    newMessageAvailable = true;
+}
+
+/**
+ * @brief Register every page channel as a display user
+ */
+void PageScheduler::subscribePages() {
+    for (uint8_t i = 0; i < wifiSetup.config.pageCount; i++) {
+        mqttSetup.subscribeChannel(wifiSetup.config.pages[i]);
+    }
+}
@@ -0,0 +1,98 @@
+// PublishBuffer.cpp
+// Implementation of the store-and-forward ring
+
+#include "PublishBuffer.h"
+#include <string.h>
+
+/**
+ * @brief Constructor for PublishBuffer
+ */
+PublishBuffer::PublishBuffer()
+    : head(0), used(0), held(0), collapsed(0), dropped(0), forwarded(0), maxDelay(0) {
+}
+
+/**
+ * @brief Hold a publish
+ * @param topic MQTT topic
+ * @param payload Message payload
+ * @param createdMillis millis() when the event happened
+ * @param periodic true for topics where only the latest value matters
+ */
+void PublishBuffer::push(const char *topic, const char *payload, unsigned long createdMillis, bool periodic) {
+    held++;
+
+    // A newer periodic value supersedes a held one of the same topic, as long
+    // as no event was held after it (both timers may be running)
+    for (uint8_t i = used; periodic && i > 0; i--) {
+        HeldPublish &entry = entries[(head + i - 1) % PUBLISH_BUFFER_LENGTH];
+        if (!entry.periodic) {
+            break;
+        }
+        if (strcmp(entry.topic, topic) == 0) {
+            strncpy(entry.payload, payload, sizeof(entry.payload) - 1);
+            entry.payload[sizeof(entry.payload) - 1] = '\0';
+            entry.createdMillis = createdMillis;
+            collapsed++;
+            return;
+        }
+    }
+
+    if (used == PUBLISH_BUFFER_LENGTH) {
+        // Periodic values are the cheapest loss, events only go when nothing else can
+        uint8_t victim = 0;
+        for (uint8_t i = 0; i < used; i++) {
+            if (entries[(head + i) % PUBLISH_BUFFER_LENGTH].periodic) {
+                victim = i;
+                break;
+            }
+        }
+        removeAt(victim);
+        dropped++;
+    }
+
+    HeldPublish &entry = entries[(head + used) % PUBLISH_BUFFER_LENGTH];
+    strncpy(entry.topic, topic, sizeof(entry.topic) - 1);
+    entry.topic[sizeof(entry.topic) - 1] = '\0';
+    strncpy(entry.payload, payload, sizeof(entry.payload) - 1);
+    entry.payload[sizeof(entry.payload) - 1] = '\0';
+    entry.createdMillis = createdMillis;
+    entry.periodic = periodic;
+    used++;
+}
+
+/**
+ * @brief Get the oldest held publish without removing it
+ * @return Entry, nullptr if empty
+ */
+const HeldPublish *PublishBuffer::front() const {
+    return used > 0 ? &entries[head] : nullptr;
+}
+
+/**
+ * @brief Remove the oldest held publish after it was sent
+ * @param now Current millis(), for the age statistics
+ */
+void PublishBuffer::pop(unsigned long now) {
+    if (used == 0) {
+        return;
+    }
+
+    uint32_t delay = now - entries[head].createdMillis;
+    if (delay > maxDelay) {
+        maxDelay = delay;
+    }
+    forwarded++;
+    head = (head + 1) % PUBLISH_BUFFER_LENGTH;
+    used--;
+}
+
+/**
+ * @brief Remove an entry, keeping the order of the others
+ * @param position Position counted from the oldest entry
+ */
+void PublishBuffer::removeAt(uint8_t position) {
+    for (uint8_t i = position; i + 1 < used; i++) {
+        entries[(head + i) % PUBLISH_BUFFER_LENGTH] = entries[(head + i + 1) % PUBLISH_BUFFER_LENGTH];
+    }
+    used--;
+}
@@ -0,0 +1,103 @@
+// RefreshLimiter.cpp
+// Implementation of the display refresh-rate cap
+
+#include "RefreshLimiter.h"
+#include "Constants.h"
+
+// Global instances
+RefreshLimiter mainRefresh(MAIN_DISPLAY_MAX_RATE_HZ);
+RefreshLimiter secondaryRefresh(SECONDARY_DISPLAY_MAX_RATE_HZ);
+
+/**
+ * @brief Constructor for RefreshLimiter
+ * @param maxRateHz Maximum refresh rate, 0 for no cap
+ */
+RefreshLimiter::RefreshLimiter(uint16_t maxRateHz)
+    : minIntervalMs(0), lastRenderMillis(0), lastSeq(0), lastHash(0), hashValid(false),
+      received(0), coalesced(0), unchanged(0), rendered(0) {
+    setMaxRate(maxRateHz);
+}
+
+/**
+ * @brief Change the maximum refresh rate
+ * @param maxRateHz Maximum refresh rate, 0 for no cap
+ */
+void RefreshLimiter::setMaxRate(uint16_t maxRateHz) {
+    minIntervalMs = maxRateHz == 0 ? 0 : 1000 / maxRateHz;
+}
+
+/**
+ * @brief Check if the refresh interval since the last redraw has passed
+ * @param now Current millis()
+ * @return true if the display may be redrawn
+ */
+bool RefreshLimiter::ready(unsigned long now) const {
+    return now - lastRenderMillis >= minIntervalMs;
+}
+
+/**
+ * @brief Account for the latest message and decide if it must be drawn
+ *
+ * Any gap in the sequence numbers is counted as coalesced: those messages
+ * were overwritten by a newer one before the display got to them.
+ *
+ * @param seq Sequence number of the message (one per received update)
+ * @param text Message text
+ * @param now Current millis()
+ * @return true if the text differs from the frame shown and must be drawn
+ */
+bool RefreshLimiter::accept(uint32_t seq, const char *text, unsigned long now) {
+    if (seq != lastSeq) {
+        coalesced += seq - lastSeq - 1;
+        received = seq;
+        lastSeq = seq;
+    }
+
+    uint32_t hash = hashText(text);
+    if (hashValid && hash == lastHash) {
+        unchanged++;
+        return false;
+    }
+
+    lastHash = hash;
+    hashValid = true;
+    markRendered(now);
+    return true;
+}
+
+/**
+ * @brief Record a redraw that did not go through accept()
+ * @param now Current millis()
+ */
+void RefreshLimiter::markRendered(unsigned long now) {
+    lastRenderMillis = now;
+    rendered++;
+}
+
+/**
+ * @brief Forget the frame shown, so the next accept() always draws
+ *
+ * Must be called whenever something else (menu, welcome animation, graph
+ * modes) has drawn over the display.
+ */
+void RefreshLimiter::invalidate() {
+    hashValid = false;
+}
+
+/**
+ * @brief 32-bit FNV-1a hash of a string
+ * @param text Null terminated string
+ * @return Hash value
+ */
+uint32_t RefreshLimiter::hashText(const char *text) {
+    uint32_t hash = 2166136261UL;
+    if (text == NULL) {
+        return hash;
+    }
+
+    while (*text != '\0') {
+        hash ^= (uint8_t)*text++;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
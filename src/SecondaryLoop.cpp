@@ -1,5 +1,10 @@
 #include "SecondaryLoop.h"
 #include "SharedData.h"
+#include "RefreshLimiter.h"
+#include "TimerState.h"
+#include "Trace.h"
+#include "TaskRegistry.h"
+#include "DeferredLog.h"
 #include <esp_task_wdt.h>
 
 LedController<1, 1> secondaryDisplay; // Secondary 7-segment LED display
@@ -8,6 +13,12 @@ unsigned long delaytime = 300;        // Delay time for scrolling animation (inc
 // Define variables to store timer values
 volatile unsigned long timer1Value = 0;
 volatile unsigned long timer2Value = 0;
+// Times the MQTT message on the 7-segment display went stale
+volatile uint32_t secondaryStaleEvents = 0;
+
+// Shown in place of a stale value (defined in Main.cpp)
+extern char notAvailableMsg[];
+
 bool timer1Started = false;
 bool timer2Started = false;
 bool timer1Paused = false;
@@ -62,9 +73,11 @@ void scrollGolf86On7Segment()
  */
 void showText(const char *text)
 {
+  TRACE_SCOPE(TRACE_SPI_WRITE);
+
   // Add NULL pointer check
   if (text == NULL) {
-    Serial.println("ERROR: showText received NULL pointer");
+    LOG_ERROR("showText received NULL pointer");
     return;
   }
   
@@ -97,7 +110,11 @@ void showText(const char *text)
 void secondaryDisplayLoop(void *parameter)
 {
   char currentMode[MODE_BUFFER_SIZE];
+  char lastMode[MODE_BUFFER_SIZE] = "";
   char messageBuffer[MESSAGE_BUFFER_SIZE];
+  uint32_t messageSeq;
+  unsigned long lastMessageMillis = 0;
+  bool messageStale = false;
 
   while (1)
   {
@@ -108,19 +125,40 @@ void secondaryDisplayLoop(void *parameter)
       currentMode[sizeof(currentMode) - 1] = '\0';
     }
 
+    // Other modes draw over the last MQTT message, it must be redrawn when we return
+    if (strcmp(currentMode, lastMode) != 0)
+    {
+      secondaryRefresh.invalidate();
+      strncpy(lastMode, currentMode, sizeof(lastMode) - 1);
+      lastMode[sizeof(lastMode) - 1] = '\0';
+    }
+
     if (strcmp(currentMode, "WELCOME") == 0)
     {
       scrollGolf86On7Segment();
     }
     else if (strcmp(currentMode, "MQTT") == 0)
     {
-      // Thread-safe message reading
-      if (g_secondaryMessage.isAvailable())
+      // Thread-safe message reading, capped at SECONDARY_DISPLAY_MAX_RATE_HZ.
+      // Messages arriving in between overwrite each other, only the latest is shown.
+      unsigned long now = millis();
+      if (secondaryRefresh.ready(now) &&
+          g_secondaryMessage.takeMessage(messageBuffer, sizeof(messageBuffer), &messageSeq))
       {
-        if (g_secondaryMessage.getMessage(messageBuffer, sizeof(messageBuffer))) {
+        if (secondaryRefresh.accept(messageSeq, messageBuffer, now)) {
           showText(messageBuffer);
-          g_secondaryMessage.clearAvailable();
         }
+        lastMessageMillis = now;
+        messageStale = false;
+      }
+      else if (!messageStale && lastMessageMillis != 0 &&
+               now - lastMessageMillis >= SECONDARY_STALE_TIMEOUT_MS)
+      {
+        // Publisher went quiet, do not keep showing the last value
+        showText(notAvailableMsg);
+        secondaryRefresh.invalidate();
+        secondaryStaleEvents++;
+        messageStale = true;
       }
     }
     else if (strcmp(currentMode, "TIMER1") == 0)
@@ -175,11 +213,13 @@ void displayTimer(int timerValue)
  */
 void handleTimerCallback(volatile unsigned long &timerValue, const char *mode, int timerId)
 {
+  TRACE_SCOPE(TRACE_TIMER_TICK);
+
   // Overflow protection - cap at ~11 hours
   if (timerValue < MAX_TIMER_VALUE_MS) {
     timerValue += 10;
   } else {
-    Serial.printf("WARNING: Timer %d reached maximum value\n", timerId);
+    LOG_WARN("Timer %d reached maximum value", timerId);
   }
 
   int hours, minutes, seconds, hundredths;
@@ -196,13 +236,18 @@ void handleTimerCallback(volatile unsigned long &timerValue, const char *mode, i
   // Check if 100ms has elapsed
   if (counter == 10)
   {
-    setTimeToMqtt(timerId, hours, minutes, seconds, hundredths);
+    if (timerState.legacyTopics())
+    {
+      setTimeToMqtt(timerId, hours, minutes, seconds, hundredths, true);
+    }
     counter = 0; // Reset the counter
   }
   else
   {
     counter++;
   }
+
+  timerState.tick(timerId, millis());
 }
 
 /**
@@ -251,21 +296,22 @@ void timerChronometer(void *parameter)
     xTimerStop(timerHandle, 0);
     xTimerDelete(timerHandle, 0);
     timerHandle = NULL;
-    Serial.printf("Deleted existing timer for %s\n", mode);
+    LOG_INFO("Deleted existing timer for %s", mode);
   }
 
   // Create and start new timer
   timerHandle = xTimerCreate(mode, pdMS_TO_TICKS(10), pdTRUE, nullptr, timerCallback);
   if (timerHandle != NULL) {
     if (xTimerStart(timerHandle, 0) == pdPASS) {
-      Serial.printf("Timer %s started successfully\n", mode);
+      LOG_INFO("Timer %s started successfully", mode);
     } else {
-      Serial.printf("ERROR: Failed to start timer %s\n", mode);
+      LOG_ERROR("Failed to start timer %s", mode);
     }
   } else {
-    Serial.printf("ERROR: Failed to create timer %s\n", mode);
+    LOG_ERROR("Failed to create timer %s", mode);
   }
 
+  taskRegistry.remove(NULL);
   vTaskDelete(nullptr);
 }
 
@@ -321,6 +367,7 @@ void convertTimerToTime(unsigned long timerValue, int &hours, int &minutes, int
  */
 void displayTime(int hours, int minutes, int seconds, int hundredths)
 {
+  TRACE_SCOPE(TRACE_SPI_WRITE);
   const int numDigits = 8;
   char timeText[9];
 
@@ -356,8 +403,9 @@ void displayTime(int hours, int minutes, int seconds, int hundredths)
  * @param minutes An integer representing the minutes component of the time.
  * @param seconds An integer representing the seconds component of the time.
  * @param hundredths An integer representing the hundredths of a second component of the time.
+ * @param periodic True for the running value, false for a lap time.
  */
-void setTimeToMqtt(int timer, int hours, int minutes, int seconds, int hundredths)
+void setTimeToMqtt(int timer, int hours, int minutes, int seconds, int hundredths, bool periodic)
 {
   char timeText[13]; // Adjusted size to accommodate thousandths
 
@@ -369,11 +417,11 @@ void setTimeToMqtt(int timer, int hours, int minutes, int seconds, int hundredth
   if (timer == 1)
   {
     snprintf(topic, sizeof(topic), "%svalue", MQTT_TIMER1_TOPIC);
-    mqttSetup.mqtt.publish(topic, timeText);
+    mqttSetup.publish(topic, timeText, periodic);
   }
   else if (timer == 2)
   {
     snprintf(topic, sizeof(topic), "%svalue", MQTT_TIMER2_TOPIC);
-    mqttSetup.mqtt.publish(topic, timeText);
+    mqttSetup.publish(topic, timeText, periodic);
   }
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 // Implementation of thread-safe shared data structures
 
 #include "SharedData.h"
+#include "DeferredLog.h"
 #include <string.h>
 
 // Global instances
@@ -56,7 +57,7 @@ bool SecondaryDisplayMode::set(const char* newMode) {
         return true;
     }
     
-    Serial.println("WARNING: SecondaryDisplayMode::set() mutex timeout");
+    LOG_WARN("SecondaryDisplayMode::set() mutex timeout");
     return false;
 }
 
@@ -78,7 +79,7 @@ bool SecondaryDisplayMode::get(char* buffer, size_t bufferSize) {
         return true;
     }
     
-    Serial.println("WARNING: SecondaryDisplayMode::get() mutex timeout");
+    LOG_WARN("SecondaryDisplayMode::get() mutex timeout");
     return false;
 }
 
@@ -111,6 +112,7 @@ ThreadSafeMessage::ThreadSafeMessage() {
     }
     message[0] = '\0';
     available = false;
+    seq = 0;
 }
 
 /**
@@ -135,8 +137,7 @@ bool ThreadSafeMessage::setMessage(const char* newMessage) {
     if (xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
         size_t len = strlen(newMessage);
         if (len >= MESSAGE_BUFFER_SIZE) {
-            Serial.printf("WARNING: Message truncated from %d to %d chars\n", 
-                         len, MESSAGE_BUFFER_SIZE - 1);
+            LOG_WARN("Message truncated from %u to %d chars", (unsigned)len, MESSAGE_BUFFER_SIZE - 1);
         }
         
         strncpy(message, newMessage, MESSAGE_BUFFER_SIZE - 1);
@@ -148,12 +149,13 @@ bool ThreadSafeMessage::setMessage(const char* newMessage) {
         
         available = true;
         newMessageAvailable2 = true;
+        seq++;
         
         xSemaphoreGive(mutex);
         return true;
     }
     
-    Serial.println("WARNING: ThreadSafeMessage::setMessage() mutex timeout");
+    LOG_WARN("ThreadSafeMessage::setMessage() mutex timeout");
     return false;
 }
 
@@ -181,6 +183,39 @@ bool ThreadSafeMessage::getMessage(char* buffer, size_t bufferSize) {
     return false;
 }
 
+/**
+ * @brief Thread-safe read and clear of the latest message
+ *
+ * Copying and clearing the available flag under one lock guarantees a
+ * message set in between is not lost; older unread messages are simply
+ * overwritten (latest wins).
+ *
+ * @param buffer Buffer to copy message into
+ * @param bufferSize Size of the buffer
+ * @param messageSeq Output for the sequence number of the message
+ * @return true if a message was taken, false if mutex timeout or no message
+ */
+bool ThreadSafeMessage::takeMessage(char* buffer, size_t bufferSize, uint32_t* messageSeq) {
+    if (mutex == NULL || buffer == NULL || bufferSize == 0 || messageSeq == NULL) {
+        return false;
+    }
+    
+    bool result = false;
+    if (xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        if (available) {
+            strncpy(buffer, message, bufferSize - 1);
+            buffer[bufferSize - 1] = '\0';
+            *messageSeq = seq;
+            available = false;
+            newMessageAvailable2 = false;
+            result = true;
+        }
+        xSemaphoreGive(mutex);
+    }
+    
+    return result;
+}
+
 /**
  * @brief Check if message is available
  * @return true if message available, false otherwise
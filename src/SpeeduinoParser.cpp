@@ -0,0 +1,156 @@
+// SpeeduinoParser.cpp
+// Implementation of the Speeduino realtime data parser
+
+#include "SpeeduinoParser.h"
+
+// How a channel is stored in the realtime data
+enum FieldKind : uint8_t {
+    FIELD_NONE,      // Not in the realtime data
+    FIELD_U8,
+    FIELD_S8,
+    FIELD_U8_TEMP,   // Offset by +40 C
+    FIELD_U16,       // Little-endian
+    FIELD_U16_US     // Little-endian microseconds, sent as tenths of ms
+};
+
+struct FieldMap {
+    uint8_t offset;
+    FieldKind kind;
+};
+
+// Realtime data layout, in ecuDataStrings order
+static const FieldMap SPEEDUINO_FIELDS[ECU_CHANNEL_COUNT] = {
+    {14, FIELD_U16},     // RPM
+    {26, FIELD_U8},      // TPS
+    {19, FIELD_U8},      // VE1
+    {10, FIELD_U8},      // O2P, AFR x10
+    {21, FIELD_U8},      // AFT, AFR target x10
+    {6, FIELD_U8_TEMP},  // MAT
+    {7, FIELD_U8_TEMP},  // CAD
+    {4, FIELD_U16},      // MAP, kPa
+    {9, FIELD_U8},       // BAT, V x10
+    {25, FIELD_S8},      // ADV
+    {22, FIELD_U16_US},  // PW1
+    {33, FIELD_U8},      // SPK, spark status bits
+    {3, FIELD_U8},       // DWL, ms x10
+    {39, FIELD_U8},      // ILL
+    {42, FIELD_U8},      // BAR
+    {16, FIELD_U8},      // TAE
+    {0, FIELD_NONE},     // NER
+    {2, FIELD_U8},       // ENG, engine status bits
+};
+
+static_assert(SPEEDUINO_MIN_PAYLOAD_SIZE == 43, "Minimum payload must reach the last mapped field");
+
+/**
+ * @brief Constructor for SpeeduinoParser
+ */
+SpeeduinoParser::SpeeduinoParser()
+    : command('A'), state(STATE_IDLE), expected(0), used(0), junk(0) {
+}
+
+/**
+ * @brief Expect the response to a command that was just sent
+ * @param command 'A' or 'n'
+ */
+void SpeeduinoParser::begin(char command) {
+    this->command = command;
+    state = STATE_ECHO;
+    expected = 0;
+    used = 0;
+}
+
+/**
+ * @brief Feed one received byte
+ * @param byte Byte from the ECU
+ * @return true when the response is complete
+ */
+bool SpeeduinoParser::feed(uint8_t byte) {
+    switch (state) {
+    case STATE_ECHO:
+        if (byte != (uint8_t)command) {
+            junk++;
+        } else if (command == 'n') {
+            state = STATE_TYPE;
+        } else {
+            expected = SPEEDUINO_A_PAYLOAD_SIZE;
+            state = STATE_PAYLOAD;
+        }
+        return false;
+
+    case STATE_TYPE:
+        state = (byte == 0x32) ? STATE_LENGTH : STATE_ECHO;
+        if (state == STATE_ECHO) {
+            junk++;
+        }
+        return false;
+
+    case STATE_LENGTH:
+        if (byte < SPEEDUINO_MIN_PAYLOAD_SIZE || byte > SPEEDUINO_MAX_PAYLOAD_SIZE) {
+            junk++;
+            state = STATE_ECHO;
+            return false;
+        }
+        expected = byte;
+        state = STATE_PAYLOAD;
+        return false;
+
+    case STATE_PAYLOAD:
+        payload[used++] = byte;
+        if (used == expected) {
+            state = STATE_DONE;
+            return true;
+        }
+        return false;
+
+    default:
+        // No command pending, or the response is already complete
+        junk++;
+        return false;
+    }
+}
+
+/**
+ * @brief Convert the complete response to channel values
+ * @param values Output, ECU_CHANNEL_COUNT values in ecuDataStrings order,
+ *               scaled like EcuFrame (one decimal channels times 10)
+ * @return Bit mask of the channels present in the response, 0 if none
+ */
+uint32_t SpeeduinoParser::values(int16_t *values) const {
+    if (state != STATE_DONE) {
+        return 0;
+    }
+
+    uint32_t present = 0;
+    for (uint8_t i = 0; i < ECU_CHANNEL_COUNT; i++) {
+        const FieldMap &field = SPEEDUINO_FIELDS[i];
+        uint8_t size = (field.kind == FIELD_U16 || field.kind == FIELD_U16_US) ? 2 : 1;
+        values[i] = 0;
+        if (field.kind == FIELD_NONE || field.offset + size > used) {
+            continue;
+        }
+
+        const uint8_t *p = payload + field.offset;
+        switch (field.kind) {
+        case FIELD_U8:
+            values[i] = p[0];
+            break;
+        case FIELD_S8:
+            values[i] = (int8_t)p[0];
+            break;
+        case FIELD_U8_TEMP:
+            values[i] = (int16_t)p[0] - 40;
+            break;
+        case FIELD_U16:
+            values[i] = (int16_t)(p[0] | (p[1] << 8));
+            break;
+        case FIELD_U16_US:
+            values[i] = (int16_t)((p[0] | (p[1] << 8)) / 100);
+            break;
+        default:
+            break;
+        }
+        present |= 1UL << i;
+    }
+    return present;
+}
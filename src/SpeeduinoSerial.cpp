@@ -0,0 +1,149 @@
+// SpeeduinoSerial.cpp
+// Implementation of the Speeduino UART ingest task
+
+#include "SpeeduinoSerial.h"
+#include "NetworkTask.h"
+#include "MqttSetup.h"
+#include "EcuFrame.h"
+#include "TaskRegistry.h"
+#include <esp_task_wdt.h>
+#include <string.h>
+
+extern MqttSetup mqttSetup;
+
+// Global instance
+SpeeduinoSerial speeduinoSerial;
+
+/**
+ * @brief Constructor for SpeeduinoSerial
+ */
+SpeeduinoSerial::SpeeduinoSerial()
+    : taskHandle(NULL), frameSeq(0), lastRepublishMillis(0), lastFrameMillis(0),
+      polls(0), frames(0), timeouts(0), responseMicros(0) {
+}
+
+/**
+ * @brief Open the UART and start the polling task
+ *
+ * Must be called after networkTask.begin().
+ *
+ * @return true if the task is running
+ */
+bool SpeeduinoSerial::begin() {
+    if (taskHandle != NULL) {
+        return true;
+    }
+
+    Serial2.begin(SPEEDUINO_BAUD, SERIAL_8N1, SPEEDUINO_RX_PIN, SPEEDUINO_TX_PIN);
+
+    BaseType_t created = taskRegistry.create(
+        taskLoop,
+        "speeduinoTask",
+        SPEEDUINO_TASK_STACK_SIZE,
+        this,
+        SPEEDUINO_TASK_PRIORITY,
+        &taskHandle,
+        SPEEDUINO_TASK_CORE);
+
+    if (created != pdPASS || taskHandle == NULL) {
+        taskHandle = NULL;
+        Serial.println("ERROR: Failed to create Speeduino task!");
+        return false;
+    }
+
+    esp_task_wdt_add(taskHandle);
+    Serial.printf("Speeduino serial ingest started ('%c' every %d ms)\n",
+                  SPEEDUINO_COMMAND, SPEEDUINO_POLL_INTERVAL_MS);
+    return true;
+}
+
+/**
+ * @brief Check if recent data came from the serial link
+ * @return true if a response was parsed within SPEEDUINO_LIVE_TIMEOUT_MS
+ */
+bool SpeeduinoSerial::isLive() const {
+    return frames > 0 && millis() - lastFrameMillis < SPEEDUINO_LIVE_TIMEOUT_MS;
+}
+
+/**
+ * @brief Send one request and wait for its response
+ * @return true if a response was parsed
+ */
+bool SpeeduinoSerial::poll() {
+    // Leftovers of a timed out response would be taken for the next one
+    while (Serial2.available() > 0) {
+        Serial2.read();
+    }
+
+    parser.begin(SPEEDUINO_COMMAND);
+    Serial2.write((uint8_t)SPEEDUINO_COMMAND);
+    uint32_t sentMicros = micros();
+    unsigned long sentMillis = millis();
+    polls++;
+
+    while (millis() - sentMillis < SPEEDUINO_RESPONSE_TIMEOUT_MS) {
+        while (Serial2.available() > 0) {
+            if (parser.feed((uint8_t)Serial2.read())) {
+                deliver(sentMicros);
+                return true;
+            }
+        }
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+
+    timeouts++;
+    return false;
+}
+
+/**
+ * @brief Hand a parsed response to the displays and, when due, to MQTT
+ * @param sentMicros micros() when the command was sent
+ */
+void SpeeduinoSerial::deliver(uint32_t sentMicros) {
+    int16_t values[ECU_CHANNEL_COUNT];
+    uint32_t present = parser.values(values);
+    uint32_t receivedMicros = micros();
+
+    DisplaySample samples[ECU_CHANNEL_COUNT];
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < ECU_CHANNEL_COUNT; i++) {
+        if (!(present & (1UL << i))) {
+            continue;
+        }
+        DisplaySample &sample = samples[count++];
+        memcpy(sample.code, ecuDataStrings[i], sizeof(sample.code));
+        sample.value = EcuFrameDecoder::format(i, values[i], sample.text, sizeof(sample.text));
+        sample.receivedMicros = receivedMicros;
+    }
+    networkTask.pushSamples(samples, count);
+
+    frames++;
+    lastFrameMillis = millis();
+    responseMicros = receivedMicros - sentMicros;
+
+    if (SPEEDUINO_REPUBLISH_INTERVAL_MS > 0 &&
+        lastFrameMillis - lastRepublishMillis >= SPEEDUINO_REPUBLISH_INTERVAL_MS) {
+        EcuFrame frame;
+        frame.magic = ECU_FRAME_MAGIC;
+        frame.version = ECU_FRAME_VERSION;
+        frame.seq = frameSeq++;
+        memcpy(frame.values, values, sizeof(frame.values));
+        mqttSetup.publishEcuFrame(frame);
+        lastRepublishMillis = lastFrameMillis;
+    }
+}
+
+/**
+ * @brief Task body: poll the ECU at a fixed rate
+ * @param parameter The SpeeduinoSerial instance
+ */
+void SpeeduinoSerial::taskLoop(void *parameter) {
+    SpeeduinoSerial &self = *static_cast<SpeeduinoSerial *>(parameter);
+    TickType_t lastWake = xTaskGetTickCount();
+
+    while (1) {
+        self.poll();
+        esp_task_wdt_reset();
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(SPEEDUINO_POLL_INTERVAL_MS));
+    }
+}
@@ -0,0 +1,85 @@
+// SubscriptionSet.cpp
+// Implementation of the subscription set
+
+#include "SubscriptionSet.h"
+#include <string.h>
+
+/**
+ * @brief Constructor for SubscriptionSet
+ */
+SubscriptionSet::SubscriptionSet() : used(0) {
+}
+
+/**
+ * @brief Add a topic
+ * @param topic MQTT topic (may contain wildcards)
+ * @return true if the topic is in the set, false if the set is full
+ */
+bool SubscriptionSet::add(const char *topic) {
+    if (topic == nullptr || indexOf(topic) >= 0) {
+        return topic != nullptr;
+    }
+    if (used >= SUBSCRIPTION_SET_CAPACITY) {
+        Serial.printf("ERROR: Subscription set full, %s not restored on reconnect\n", topic);
+        return false;
+    }
+
+    strncpy(topics[used], topic, MQTT_TOPIC_BUFFER_SIZE - 1);
+    topics[used][MQTT_TOPIC_BUFFER_SIZE - 1] = '\0';
+    used++;
+    return true;
+}
+
+/**
+ * @brief Remove a topic
+ * @param topic MQTT topic
+ * @return true if the topic was in the set
+ */
+bool SubscriptionSet::remove(const char *topic) {
+    int index = indexOf(topic);
+    if (index < 0) {
+        return false;
+    }
+
+    // Order does not matter, move the last topic into the gap
+    used--;
+    if (index != used) {
+        memcpy(topics[index], topics[used], MQTT_TOPIC_BUFFER_SIZE);
+    }
+    return true;
+}
+
+/**
+ * @brief Check if a topic is in the set
+ * @param topic MQTT topic
+ * @return true if present
+ */
+bool SubscriptionSet::contains(const char *topic) const {
+    return indexOf(topic) >= 0;
+}
+
+/**
+ * @brief Get a topic by position
+ * @param index Position (0..count()-1)
+ * @return Topic, nullptr if out of range
+ */
+const char *SubscriptionSet::topicAt(uint8_t index) const {
+    return index < used ? topics[index] : nullptr;
+}
+
+/**
+ * @brief Find a topic
+ * @param topic MQTT topic
+ * @return Position, -1 if not present
+ */
+int SubscriptionSet::indexOf(const char *topic) const {
+    if (topic == nullptr) {
+        return -1;
+    }
+    for (uint8_t i = 0; i < used; i++) {
+        if (strncmp(topics[i], topic, MQTT_TOPIC_BUFFER_SIZE - 1) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
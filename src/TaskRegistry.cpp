@@ -0,0 +1,275 @@
+// TaskRegistry.cpp
+// Implementation of the task registry and its sampling
+
+#include "TaskRegistry.h"
+#include <esp_cpu.h>
+#include <esp_freertos_hooks.h>
+#include <esp_idf_version.h>
+#include <esp_timer.h>
+#include <string.h>
+
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+#define TASK_RUN_TIME_STATS 1
+#else
+#define TASK_RUN_TIME_STATS 0
+#endif
+
+#if ESP_IDF_VERSION_MAJOR < 5
+// IDF 4.4 (Arduino core 2.x) has the cycle counter under its older name
+#define esp_cpu_get_cycle_count esp_cpu_get_ccount
+#endif
+
+// Global instance
+TaskRegistry taskRegistry;
+
+#if !TASK_RUN_TIME_STATS
+// CPU cycles each core spent in its idle task, and the cycle count at its
+// last idle hook call
+static volatile uint32_t idleHookCycles[portNUM_PROCESSORS];
+static uint32_t idleHookLastCycle[portNUM_PROCESSORS];
+static uint32_t idleGapCycles;
+
+/**
+ * @brief Add the cycles since the previous idle hook call of a core
+ *
+ * The hooks return false, so while they are registered (one sample interval
+ * after requestIdleSample()) the idle task loops without halting the core
+ * until the next interrupt and calls its hook every few hundred cycles. A
+ * gap longer than TASK_IDLE_GAP_US means other tasks ran in between and is
+ * not counted; interrupts shorter than that are counted as idle.
+ * @param core Core of the idle task
+ */
+static void countIdleCycles(uint8_t core) {
+    uint32_t now = esp_cpu_get_cycle_count();
+    uint32_t gap = now - idleHookLastCycle[core];
+    idleHookLastCycle[core] = now;
+    if (gap < idleGapCycles) {
+        idleHookCycles[core] += gap;
+    }
+}
+
+static bool idleHookCore0() {
+    countIdleCycles(0);
+    return false;
+}
+
+static bool idleHookCore1() {
+    countIdleCycles(1);
+    return false;
+}
+#endif
+
+/**
+ * @brief Constructor for TaskRegistry
+ */
+TaskRegistry::TaskRegistry()
+    : lastSampleMillis(0), lastSampleMicros(0), idleMillis(0), hooksInstalled(false), idleRequested(false) {
+    mutex = xSemaphoreCreateMutex();
+    if (mutex == NULL) {
+        Serial.println("ERROR: Failed to create TaskRegistry mutex!");
+    }
+    memset(records, 0, sizeof(records));
+    memset(lastIdleCount, 0, sizeof(lastIdleCount));
+    memset(idle, 0, sizeof(idle));
+}
+
+/**
+ * @brief Create a pinned task and register it
+ * @return pdPASS if created; a task that does not fit the registry still
+ *         runs, with a warning
+ */
+BaseType_t TaskRegistry::create(TaskFunction_t function, const char *name, uint32_t stackSize, void *parameter,
+                                UBaseType_t priority, TaskHandle_t *handle, BaseType_t core) {
+    TaskHandle_t created = NULL;
+
+    // Held across the creation, so a task removing itself right away waits
+    // until it was stored
+    bool locked = mutex != NULL && xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdTRUE;
+    BaseType_t result = xTaskCreatePinnedToCore(function, name, stackSize, parameter, priority, &created, core);
+    if (result == pdPASS && created != NULL) {
+        if (locked) {
+            store(created, name, stackSize, (int8_t)core, priority);
+        } else {
+            Serial.printf("WARNING: Task %s not registered, mutex timeout\n", name);
+        }
+    }
+    if (locked) {
+        xSemaphoreGive(mutex);
+    }
+
+    if (handle != NULL) {
+        *handle = created;
+    }
+    return result;
+}
+
+/**
+ * @brief Register a task that was not created here (the Arduino loop task)
+ * @param handle Task handle
+ * @param name Task name
+ * @param stackSize Stack size in bytes
+ * @param core Pinned core, -1 if not pinned
+ */
+void TaskRegistry::add(TaskHandle_t handle, const char *name, uint32_t stackSize, int8_t core) {
+    if (mutex == NULL || handle == NULL) {
+        return;
+    }
+    if (xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        store(handle, name, stackSize, core, uxTaskPriorityGet(handle));
+        xSemaphoreGive(mutex);
+    }
+}
+
+/**
+ * @brief Store a task in a free slot (mutex held)
+ */
+void TaskRegistry::store(TaskHandle_t handle, const char *name, uint32_t stackSize, int8_t core,
+                         UBaseType_t priority) {
+    for (uint8_t i = 0; i < TASK_REGISTRY_SIZE; i++) {
+        TaskRecord &record = records[i];
+        if (record.handle == NULL) {
+            record.handle = handle;
+            record.name = name;
+            record.stackSize = stackSize;
+            record.core = core;
+            record.priority = (uint8_t)priority;
+            record.stackFree = stackSize;
+            record.runTime = 0;
+            record.cpuPermille = 0;
+            return;
+        }
+    }
+    Serial.printf("WARNING: Task registry full, %s not tracked\n", name);
+}
+
+/**
+ * @brief Unregister a task before it is deleted
+ * @param handle Task handle, NULL for the calling task
+ */
+void TaskRegistry::remove(TaskHandle_t handle) {
+    if (handle == NULL) {
+        handle = xTaskGetCurrentTaskHandle();
+    }
+    if (mutex == NULL || xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return;
+    }
+    for (uint8_t i = 0; i < TASK_REGISTRY_SIZE; i++) {
+        if (records[i].handle == handle) {
+            records[i].handle = NULL;
+        }
+    }
+    xSemaphoreGive(mutex);
+}
+
+/**
+ * @brief Sample stacks and CPU time once the interval has passed (main loop)
+ * @param now Current millis()
+ */
+void TaskRegistry::sample(unsigned long now) {
+    if (now - lastSampleMillis < TASK_SAMPLE_INTERVAL_MS) {
+        return;
+    }
+    lastSampleMillis = now;
+
+    if (mutex == NULL || xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return;
+    }
+
+    uint32_t nowMicros = (uint32_t)esp_timer_get_time();
+    uint32_t elapsedMicros = nowMicros - lastSampleMicros;
+    for (uint8_t i = 0; i < TASK_REGISTRY_SIZE; i++) {
+        TaskRecord &record = records[i];
+        if (record.handle == NULL) {
+            continue;
+        }
+        record.stackFree = uxTaskGetStackHighWaterMark(record.handle) * sizeof(StackType_t);
+#if TASK_RUN_TIME_STATS
+        TaskStatus_t status;
+        vTaskGetInfo(record.handle, &status, pdFALSE, eRunning);
+        uint32_t ran = status.ulRunTimeCounter - record.runTime;
+        record.cpuPermille = elapsedMicros > 0 ? (uint16_t)((uint64_t)ran * 1000 / elapsedMicros) : 0;
+        record.runTime = status.ulRunTimeCounter;
+#endif
+    }
+    xSemaphoreGive(mutex);
+
+    // Idle time per core, the first interval after boot is skipped. Without
+    // run-time stats only a window opened by requestIdleSample() is measured
+#if TASK_RUN_TIME_STATS
+    bool measured = lastSampleMicros != 0;
+#else
+    bool measured = hooksInstalled;
+    if (hooksInstalled) {
+        esp_deregister_freertos_idle_hook_for_cpu(idleHookCore0, 0);
+        esp_deregister_freertos_idle_hook_for_cpu(idleHookCore1, 1);
+        hooksInstalled = false;
+    }
+#endif
+    for (uint8_t core = 0; core < portNUM_PROCESSORS; core++) {
+#if TASK_RUN_TIME_STATS
+        TaskStatus_t status;
+        vTaskGetInfo(xTaskGetIdleTaskHandleForCPU(core), &status, pdFALSE, eReady);
+        uint32_t count = status.ulRunTimeCounter;
+        uint32_t span = elapsedMicros;
+#else
+        // Both cores count cycles at the same clock
+        uint32_t count = idleHookCycles[core];
+        uint32_t span = elapsedMicros * getCpuFrequencyMhz();
+#endif
+        uint32_t idleCount = count - lastIdleCount[core];
+        if (measured && span > 0) {
+            uint32_t permille = (uint64_t)idleCount * 1000 / span;
+            idle[core] = permille > 1000 ? 1000 : permille;
+        }
+        lastIdleCount[core] = count;
+    }
+    if (measured) {
+        idleMillis = now;
+    }
+
+#if !TASK_RUN_TIME_STATS
+    if (idleRequested) {
+        idleRequested = false;
+        idleGapCycles = TASK_IDLE_GAP_US * getCpuFrequencyMhz();
+        esp_register_freertos_idle_hook_for_cpu(idleHookCore0, 0);
+        esp_register_freertos_idle_hook_for_cpu(idleHookCore1, 1);
+        hooksInstalled = true;
+    }
+#endif
+    lastSampleMicros = nowMicros;
+}
+
+/**
+ * @brief Measure the core idle time over the next sample interval (main loop)
+ *
+ * With run-time stats every interval is measured and this does nothing.
+ * Without them the idle hooks keep the cores from halting while they count,
+ * so they are registered for one interval per request only.
+ */
+void TaskRegistry::requestIdleSample() {
+    idleRequested = true;
+}
+
+/**
+ * @brief Copy a registered task
+ * @param index Slot 0..TASK_REGISTRY_SIZE-1
+ * @param record Filled with the task and its last sample
+ * @return false for a free slot
+ */
+bool TaskRegistry::get(uint8_t index, TaskRecord &record) {
+    if (index >= TASK_REGISTRY_SIZE || mutex == NULL ||
+        xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return false;
+    }
+    record = records[index];
+    xSemaphoreGive(mutex);
+    return record.handle != NULL;
+}
+
+/**
+ * @brief Check if per-task CPU shares are measured
+ * @return true if FreeRTOS run-time stats are compiled in
+ */
+bool TaskRegistry::hasRunTimeStats() {
+    return TASK_RUN_TIME_STATS;
+}
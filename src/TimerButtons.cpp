@@ -6,6 +6,10 @@
 #include "TimerButtons.h"
 #include "SecondaryLoop.h"
 #include "SharedData.h"
+#include "DisplayCompositor.h"
+#include "TimerState.h"
+#include "TaskRegistry.h"
+#include "DeferredLog.h"
 
 // Global variable to store the active timer
 int activeTimer;
@@ -74,34 +78,45 @@ void monitorTimerSwitches()
         char topic[48];
         if (!timerStarted)
         {
-            snprintf(topic, sizeof(topic), "%sstarted", mqttTopicBase);
-            mqttSetup.mqtt.publish(topic, "true");
-            snprintf(topic, sizeof(topic), "%spaused", mqttTopicBase);
-            mqttSetup.mqtt.publish(topic, "false");
+            if (timerState.legacyTopics())
+            {
+                snprintf(topic, sizeof(topic), "%sstarted", mqttTopicBase);
+                mqttSetup.publish(topic, "true");
+                snprintf(topic, sizeof(topic), "%spaused", mqttTopicBase);
+                mqttSetup.publish(topic, "false");
+            }
             
             if (timerId == 1)
                 startTimer1();
             else
                 startTimer2();
+            timerState.started(timerId);
         }
         else
         {
-            snprintf(topic, sizeof(topic), "%spaused", mqttTopicBase);
-            mqttSetup.mqtt.publish(topic, "true");
+            if (timerState.legacyTopics())
+            {
+                snprintf(topic, sizeof(topic), "%spaused", mqttTopicBase);
+                mqttSetup.publish(topic, "true");
+            }
             pauseTimer(timerId);
+            timerState.paused(timerId);
         }
     };
 
     auto handleTimerReset = [](int timerId, const char *mqttTopicBase) {
         char topic[48];
         resetTimer(timerId);
+        timerState.reset(timerId);
+        if (!timerState.legacyTopics())
+            return;
         
         snprintf(topic, sizeof(topic), "%sstarted", mqttTopicBase);
-        mqttSetup.mqtt.publish(topic, "false");
+        mqttSetup.publish(topic, "false");
         snprintf(topic, sizeof(topic), "%spaused", mqttTopicBase);
-        mqttSetup.mqtt.publish(topic, "false");
+        mqttSetup.publish(topic, "false");
         snprintf(topic, sizeof(topic), "%svalue", mqttTopicBase);
-        mqttSetup.mqtt.publish(topic, "00-00-00:000");
+        mqttSetup.publish(topic, "00-00-00:000");
     };
 
     // Check sw1Timer state
@@ -146,18 +161,18 @@ void monitorTimerSwitches()
  */
 void startTimer(int timerId, const char *taskName, TaskFunction_t taskFunction, const char *screenMode, bool &timerStarted)
 {
-    if (xTaskCreatePinnedToCore(taskFunction, taskName, TIMER_TASK_STACK_SIZE, NULL, 2, NULL, 1) == pdPASS)
+    if (taskRegistry.create(taskFunction, taskName, TIMER_TASK_STACK_SIZE, NULL, 2, NULL, 1) == pdPASS)
     {
         // Task creation successful - use thread-safe mode setting
         if (!g_secondaryMode.set(screenMode)) {
-            Serial.printf("WARNING: Failed to set mode to %s, using fallback\n", screenMode);
+            LOG_WARN("Failed to set mode to %s, using fallback", screenMode);
             strncpy((char*)secondaryScreenMode, screenMode, MODE_BUFFER_SIZE - 1);
             ((char*)secondaryScreenMode)[MODE_BUFFER_SIZE - 1] = '\0';
         }
         timerStarted = true;
-        Serial.printf("Timer task %s started successfully\n", taskName);
+        LOG_INFO("Timer task %s started successfully", taskName);
     } else {
-        Serial.printf("ERROR: Failed to create timer task %s\n", taskName);
+        LOG_ERROR("Failed to create timer task %s", taskName);
     }
 }
 
@@ -195,7 +210,7 @@ void processTgPos(int timerId, const char *screenMode)
         if (!g_secondaryMode.equals(screenMode))
         {
             if (!g_secondaryMode.set(screenMode)) {
-                Serial.printf("WARNING: Failed to set mode to %s\n", screenMode);
+                LOG_WARN("Failed to set mode to %s", screenMode);
                 strncpy((char*)secondaryScreenMode, screenMode, MODE_BUFFER_SIZE - 1);
                 ((char*)secondaryScreenMode)[MODE_BUFFER_SIZE - 1] = '\0';
             }
@@ -247,7 +262,7 @@ void resetTimer(int timerNr)
         timerPaused = &timer2Paused;
     }
     else {
-        Serial.printf("ERROR: Invalid timer number: %d\n", timerNr);
+        LOG_ERROR("Invalid timer number: %d", timerNr);
         return;
     }
 
@@ -256,9 +271,9 @@ void resetTimer(int timerNr)
         *timerValue = 0;
         *timerStarted = false;
         *timerPaused = false;
-        Serial.printf("Timer %d reset successfully\n", timerNr);
+        LOG_INFO("Timer %d reset successfully", timerNr);
     } else {
-        Serial.printf("WARNING: Timer %d handle is NULL\n", timerNr);
+        LOG_WARN("Timer %d handle is NULL", timerNr);
     }
 }
 
@@ -288,7 +303,7 @@ void pauseTimer(int timerNr)
         timerPaused = &timer2Paused;
     }
     else {
-        Serial.printf("ERROR: Invalid timer number: %d\n", timerNr);
+        LOG_ERROR("Invalid timer number: %d", timerNr);
         return;
     }
 
@@ -303,12 +318,21 @@ void pauseTimer(int timerNr)
 
         // Update both display and MQTT with the same time value
         displayTime(hours, minutes, seconds, hundredths);
-        setTimeToMqtt(timerNr, hours, minutes, seconds, hundredths);
+        if (timerState.legacyTopics())
+            setTimeToMqtt(timerNr, hours, minutes, seconds, hundredths);
+
+        // Flash the lap time on the main display
+        char lapText[16];
+        if (hours > 0)
+            snprintf(lapText, sizeof(lapText), "%d:%02d:%02d", hours, minutes, seconds);
+        else
+            snprintf(lapText, sizeof(lapText), "%d:%02d.%02d", minutes, seconds, hundredths);
+        mainCompositor.post(LAYER_OVERLAY, lapText, OVERLAY_TTL_MS);
 
         // Ensure the timer value is preserved
         *timerStarted = false;
-        Serial.printf("Timer %d paused at %02d:%02d:%02d.%02d\n", timerNr, hours, minutes, seconds, hundredths);
+        LOG_INFO("Timer %d paused at %02d:%02d:%02d.%02d", timerNr, hours, minutes, seconds, hundredths);
     } else {
-        Serial.printf("WARNING: Timer %d handle is NULL\n", timerNr);
+        LOG_WARN("Timer %d handle is NULL", timerNr);
     }
 }
\ No newline at end of file
@@ -0,0 +1,112 @@
+// TimerState.cpp
+// Implementation of the combined timer state message
+
+#include "TimerState.h"
+#include "SecondaryLoop.h"
+#include "WiFiSetup.h"
+
+extern WiFiSetup wifiSetup;
+
+// Global instance
+TimerStatePublisher timerState;
+
+/**
+ * @brief Constructor for TimerStatePublisher
+ */
+TimerStatePublisher::TimerStatePublisher() : published(0) {
+    for (uint8_t i = 0; i < 2; i++) {
+        lapCount[i] = 0;
+        lastMillis[i] = 0;
+    }
+}
+
+/**
+ * @brief Check if the legacy started/paused/value topics are enabled
+ * @return true unless only the state message is selected
+ */
+bool TimerStatePublisher::legacyTopics() const {
+    return wifiSetup.config.timerPublish != TIMER_PUBLISH_STATE;
+}
+
+/**
+ * @brief Publish the state after a timer was started
+ * @param timerId Timer (1 or 2)
+ */
+void TimerStatePublisher::started(int timerId) {
+    publish(timerId, false);
+}
+
+/**
+ * @brief Count a lap and publish the state after a timer was paused
+ * @param timerId Timer (1 or 2)
+ */
+void TimerStatePublisher::paused(int timerId) {
+    if (timerId != 1 && timerId != 2) {
+        return;
+    }
+    if (lapCount[timerId - 1] < UINT16_MAX) {
+        lapCount[timerId - 1]++;
+    }
+    publish(timerId, false);
+}
+
+/**
+ * @brief Clear the lap count and publish the state after a timer was reset
+ * @param timerId Timer (1 or 2)
+ */
+void TimerStatePublisher::reset(int timerId) {
+    if (timerId != 1 && timerId != 2) {
+        return;
+    }
+    lapCount[timerId - 1] = 0;
+    publish(timerId, false);
+}
+
+/**
+ * @brief Publish the state of a running timer if its rate interval elapsed
+ * @param timerId Timer (1 or 2)
+ * @param now Current millis()
+ */
+void TimerStatePublisher::tick(int timerId, unsigned long now) {
+    uint8_t rateHz = wifiSetup.config.timerStateRateHz;
+    if ((timerId != 1 && timerId != 2) || rateHz == 0) {
+        return;
+    }
+    if (now - lastMillis[timerId - 1] >= 1000UL / rateHz) {
+        publish(timerId, true);
+    }
+}
+
+/**
+ * @brief Get the laps of a timer since its last reset
+ * @param timerId Timer (1 or 2)
+ * @return Lap count
+ */
+uint16_t TimerStatePublisher::laps(int timerId) const {
+    return (timerId == 1 || timerId == 2) ? lapCount[timerId - 1] : 0;
+}
+
+/**
+ * @brief Format and publish the state of a timer
+ * @param timerId Timer (1 or 2)
+ * @param periodic true for rate updates, which may be collapsed during an outage
+ */
+void TimerStatePublisher::publish(int timerId, bool periodic) {
+    if ((timerId != 1 && timerId != 2) || wifiSetup.config.timerPublish == TIMER_PUBLISH_LEGACY) {
+        return;
+    }
+
+    bool running = (timerId == 1) ? timer1Started : timer2Started;
+    unsigned long elapsed = (timerId == 1) ? timer1Value : timer2Value;
+    bool paused = !running && elapsed > 0;
+
+    char topic[48];
+    char payload[TIMER_STATE_PAYLOAD_SIZE];
+    snprintf(topic, sizeof(topic), "%sstate", (timerId == 1) ? MQTT_TIMER1_TOPIC : MQTT_TIMER2_TOPIC);
+    snprintf(payload, sizeof(payload), "%d,%d,%lu,%u", running ? 1 : 0, paused ? 1 : 0, elapsed,
+             (unsigned)lapCount[timerId - 1]);
+
+    mqttSetup.publish(topic, payload, periodic);
+    lastMillis[timerId - 1] = millis();
+    published.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,107 @@
+// TimerWheel.cpp
+// Implementation of the hashed timer wheel
+
+#include "TimerWheel.h"
+
+static_assert(TIMER_WHEEL_MAX_IDS <= 127, "Timer wheel ids must fit in int8_t");
+
+/**
+ * @brief Constructor for TimerWheel
+ */
+TimerWheel::TimerWheel() : currentTick(0), started(false) {
+    for (uint16_t s = 0; s < TIMER_WHEEL_SLOTS; s++) {
+        head[s] = NONE;
+    }
+    for (uint8_t i = 0; i < TIMER_WHEEL_MAX_IDS; i++) {
+        next[i] = NONE;
+        scheduled[i] = false;
+    }
+}
+
+/**
+ * @brief Schedule an id
+ *
+ * Deadlines in the past fire on the next tick, deadlines beyond one
+ * revolution land in the last slot of the revolution.
+ *
+ * @param id Id (0..TIMER_WHEEL_MAX_IDS-1), must not be scheduled already
+ * @param deadline millis() at which the id should fire
+ * @return true if scheduled, false if invalid or already scheduled
+ */
+bool TimerWheel::schedule(uint8_t id, unsigned long deadline) {
+    if (id >= TIMER_WHEEL_MAX_IDS || scheduled[id]) {
+        return false;
+    }
+
+    if (!started) {
+        currentTick = millis() / TIMER_WHEEL_TICK_MS;
+        started = true;
+    }
+
+    unsigned long tick = deadline / TIMER_WHEEL_TICK_MS;
+    if ((long)(tick - currentTick) <= 0) {
+        tick = currentTick + 1;
+    } else if (tick - currentTick >= TIMER_WHEEL_SLOTS) {
+        tick = currentTick + TIMER_WHEEL_SLOTS - 1;
+    }
+
+    uint16_t slot = tick % TIMER_WHEEL_SLOTS;
+    next[id] = head[slot];
+    head[slot] = id;
+    scheduled[id] = true;
+    return true;
+}
+
+/**
+ * @brief Check if an id is waiting in the wheel
+ * @param id Id to check
+ * @return true if scheduled
+ */
+bool TimerWheel::isScheduled(uint8_t id) const {
+    return id < TIMER_WHEEL_MAX_IDS && scheduled[id];
+}
+
+/**
+ * @brief Fire every id in the slots of the ticks elapsed since the last call
+ *
+ * A slot list is detached before its ids are fired, so the callback may
+ * reschedule an id without it firing twice in the same pass.
+ *
+ * @param now Current millis()
+ * @param callback Called once per fired id, may reschedule it
+ * @param context Passed to the callback
+ * @return Number of ids that fired
+ */
+uint8_t TimerWheel::advance(unsigned long now, ExpiryCallback callback, void *context) {
+    if (!started) {
+        return 0;
+    }
+
+    unsigned long nowTick = now / TIMER_WHEEL_TICK_MS;
+    uint8_t fired = 0;
+
+    // After a long stall one revolution covers every slot
+    if (nowTick - currentTick > TIMER_WHEEL_SLOTS) {
+        currentTick = nowTick - TIMER_WHEEL_SLOTS;
+    }
+
+    while ((long)(nowTick - currentTick) > 0) {
+        currentTick++;
+        uint16_t slot = currentTick % TIMER_WHEEL_SLOTS;
+
+        int8_t id = head[slot];
+        head[slot] = NONE;
+        while (id != NONE) {
+            int8_t following = next[id];
+            next[id] = NONE;
+            scheduled[id] = false;
+            fired++;
+            if (callback != nullptr) {
+                callback(id, now, context);
+            }
+            id = following;
+        }
+    }
+
+    return fired;
+}
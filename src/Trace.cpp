@@ -0,0 +1,95 @@
+// Trace.cpp
+// Implementation of the span ring
+
+#include "Trace.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Names of the span ids, indexed by TRACE_*
+static const char *const TRACE_NAMES[TRACE_ID_COUNT] = {
+    "mqtt_rx", "udp_rx", "format", "queue", "main_display", "spi_write", "timer_tick", "web_request"};
+
+// Global instance
+TraceRing traceRing;
+
+/**
+ * @brief Constructor for TraceRing
+ */
+TraceRing::TraceRing() : written(0), writers(0), active(false) {
+}
+
+/**
+ * @brief Clear the ring and start recording
+ */
+void TraceRing::start() {
+    stop();
+    written.store(0, std::memory_order_relaxed);
+    active.store(true, std::memory_order_release);
+}
+
+/**
+ * @brief Stop recording and wait for spans being written, the ring keeps its spans for export
+ *
+ * A writer counts itself before it checks the flag, so once the count is
+ * zero every later record() sees the flag cleared. The wait blocks instead of
+ * spinning, a writer preempted on this core by a higher priority task gets
+ * to finish.
+ */
+void TraceRing::stop() {
+    active.store(false, std::memory_order_seq_cst);
+    while (writers.load(std::memory_order_seq_cst) != 0) {
+        vTaskDelay(1);
+    }
+}
+
+/**
+ * @brief Store a completed span
+ * @param id TRACE_*
+ * @param startMicros micros() at the start of the span
+ * @param endMicros micros() at the end of the span
+ */
+void TraceRing::record(uint8_t id, uint32_t startMicros, uint32_t endMicros) {
+    // A span that started before stop() ends here without touching the ring
+    writers.fetch_add(1, std::memory_order_seq_cst);
+    if (active.load(std::memory_order_seq_cst)) {
+        uint32_t slot = written.fetch_add(1, std::memory_order_relaxed);
+        TraceEvent &event = events[slot % TRACE_RING_SIZE];
+        event.startMicros = startMicros;
+        event.durationMicros = endMicros - startMicros;
+        event.id = id;
+        event.core = (uint8_t)xPortGetCoreID();
+    }
+    writers.fetch_sub(1, std::memory_order_release);
+}
+
+/**
+ * @brief Read the ring position once (after stop())
+ * @return Kept and overwritten span counts and the oldest slot
+ */
+TraceSnapshot TraceRing::snapshot() const {
+    uint32_t total = written.load(std::memory_order_acquire);
+    TraceSnapshot snapshot;
+    snapshot.count = total < TRACE_RING_SIZE ? total : TRACE_RING_SIZE;
+    snapshot.overwritten = total - snapshot.count;
+    snapshot.oldest = total < TRACE_RING_SIZE ? 0 : total % TRACE_RING_SIZE;
+    return snapshot;
+}
+
+/**
+ * @brief Get a kept span, oldest first
+ * @param snapshot Position from snapshot()
+ * @param index 0..snapshot.count-1
+ * @return Span
+ */
+const TraceEvent &TraceRing::at(const TraceSnapshot &snapshot, uint32_t index) const {
+    return events[(snapshot.oldest + index) % TRACE_RING_SIZE];
+}
+
+/**
+ * @brief Get the name of a span id
+ * @param id TRACE_*
+ * @return Name for the trace viewer
+ */
+const char *TraceRing::name(uint8_t id) {
+    return id < TRACE_ID_COUNT ? TRACE_NAMES[id] : "unknown";
+}
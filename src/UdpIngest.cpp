@@ -0,0 +1,98 @@
+// UdpIngest.cpp
+// Implementation of the UDP datagram checks
+
+#include "UdpIngest.h"
+#include "EcuFrame.h"
+#include <string.h>
+
+/**
+ * @brief Constructor for UdpIngest
+ */
+UdpIngest::UdpIngest()
+    : frameSequence{false, 0}, textSequence{false, 0}, received(0), rejected(0), lost(0), late(0) {
+}
+
+/**
+ * @brief Check a received datagram
+ * @param bytes Datagram
+ * @param length Datagram length
+ * @return UDP_DATAGRAM_FRAME, UDP_DATAGRAM_TEXT or UDP_DATAGRAM_DROPPED
+ */
+uint8_t UdpIngest::accept(const uint8_t *bytes, int length) {
+    received++;
+
+    UdpHeader header;
+    if (length < (int)sizeof(header) || length > UDP_MAX_DATAGRAM) {
+        rejected++;
+        return UDP_DATAGRAM_DROPPED;
+    }
+    memcpy(&header, bytes, sizeof(header));
+
+    uint8_t kind;
+    UdpSequence *sequence;
+    if (header.magic == ECU_FRAME_MAGIC && header.version == ECU_FRAME_VERSION &&
+        length == (int)sizeof(EcuFrame)) {
+        kind = UDP_DATAGRAM_FRAME;
+        sequence = &frameSequence;
+    } else if (header.magic == UDP_TEXT_MAGIC && header.version == UDP_TEXT_VERSION) {
+        kind = UDP_DATAGRAM_TEXT;
+        sequence = &textSequence;
+    } else {
+        rejected++;
+        return UDP_DATAGRAM_DROPPED;
+    }
+
+    if (!advance(*sequence, header.seq)) {
+        late++;
+        return UDP_DATAGRAM_DROPPED;
+    }
+    return kind;
+}
+
+/**
+ * @brief Advance the sequence of a kind
+ * @param sequence Sequence state
+ * @param seq Sequence number of the datagram
+ * @return true if the datagram is newer than the last one applied
+ */
+bool UdpIngest::advance(UdpSequence &sequence, uint16_t seq) {
+    if (sequence.started) {
+        uint16_t ahead = seq - sequence.last;
+        uint16_t behind = sequence.last - seq;
+        if (ahead == 0) {
+            return false;
+        }
+        if (ahead >= 0x8000 && behind <= UDP_SEQ_RESTART_WINDOW) {
+            return false;
+        }
+        if (ahead < 0x8000) {
+            lost += ahead - 1;
+        }
+    }
+    sequence.started = true;
+    sequence.last = seq;
+    return true;
+}
+
+/**
+ * @brief Get the next topic/payload pair of a text datagram
+ * @param bytes Datagram, with a zero byte after the last one
+ * @param length Datagram length
+ * @param offset sizeof(UdpHeader) for the first pair, then the return value
+ * @param topic Set to the topic
+ * @param payload Set to the payload
+ * @return Offset of the following pair, -1 if there is none
+ */
+int UdpIngest::nextPair(const char *bytes, int length, int offset, const char *&topic, const char *&payload) {
+    if (offset >= length) {
+        return -1;
+    }
+    topic = bytes + offset;
+    offset += strlen(topic) + 1;
+    if (offset > length || topic[0] == '\0') {
+        return -1;
+    }
+    // The last payload may omit its terminator, the caller adds one
+    payload = bytes + offset;
+    return offset + strlen(payload) + 1;
+}
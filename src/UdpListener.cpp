@@ -0,0 +1,126 @@
+// UdpListener.cpp
+// Implementation of the UDP telemetry listener
+
+#include "UdpListener.h"
+#include "MqttSetup.h"
+#include "Metrics.h"
+#include "TaskRegistry.h"
+#include "Trace.h"
+#include "DeferredLog.h"
+#include <WiFi.h>
+#include <esp_task_wdt.h>
+#include <string.h>
+
+// Global instance
+UdpListener udpListener;
+
+/**
+ * @brief Constructor for UdpListener
+ */
+UdpListener::UdpListener()
+    : taskHandle(NULL), port(0), bound(false), maxHandling(0) {
+}
+
+/**
+ * @brief Start the polling task
+ *
+ * Must be called after networkTask.begin(), the datagrams are handed to its
+ * ingest queues.
+ *
+ * @return true if the task is running
+ */
+bool UdpListener::begin() {
+    if (taskHandle != NULL) {
+        return true;
+    }
+
+    BaseType_t created = taskRegistry.create(
+        taskLoop,
+        "udpTask",
+        UDP_TASK_STACK_SIZE,
+        this,
+        UDP_TASK_PRIORITY,
+        &taskHandle,
+        UDP_TASK_CORE);
+
+    if (created != pdPASS || taskHandle == NULL) {
+        taskHandle = NULL;
+        Serial.println("ERROR: Failed to create UDP task!");
+        return false;
+    }
+
+    esp_task_wdt_add(taskHandle);
+    Serial.printf("UDP task started on core %d\n", UDP_TASK_CORE);
+    return true;
+}
+
+/**
+ * @brief Open/close the socket as configured and handle waiting datagrams
+ *
+ * Handles at most UDP_POLL_BUDGET datagrams per call (UDP task).
+ */
+void UdpListener::poll() {
+    uint16_t wanted = WiFi.status() == WL_CONNECTED ? wifiSetup.config.udpPort : 0;
+    if (wanted != port) {
+        if (bound) {
+            udp.stop();
+            LOG_INFO("UDP telemetry closed on port %u", port);
+        }
+        port = wanted;
+        bound = port != 0 && udp.begin(port);
+        if (bound) {
+            LOG_INFO("UDP telemetry listening on port %u", port);
+        } else if (port != 0) {
+            LOG_ERROR("UDP telemetry could not open port %u", port);
+        }
+    }
+    if (!bound) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < UDP_POLL_BUDGET; i++) {
+        int size = udp.parsePacket();
+        if (size <= 0) {
+            return;
+        }
+        TRACE_SCOPE(TRACE_UDP_RX);
+        uint32_t start = micros();
+
+        // An oversized datagram is read partly and rejected by its size
+        int length = udp.read(buffer, UDP_MAX_DATAGRAM);
+        buffer[length < 0 ? 0 : length] = '\0';
+        uint8_t kind = datagrams.accept((const uint8_t *)buffer, size);
+
+        if (kind == UDP_DATAGRAM_FRAME) {
+            MqttSetup::handlePrimaryMessage(MQTT_ECU_FRAME_TOPIC, buffer, length);
+        } else if (kind == UDP_DATAGRAM_TEXT) {
+            const char *topic;
+            const char *payload;
+            int offset = sizeof(UdpHeader);
+            while ((offset = UdpIngest::nextPair(buffer, length, offset, topic, payload)) >= 0) {
+                MqttSetup::handlePrimaryMessage(topic, payload, strlen(payload));
+            }
+        }
+
+        uint32_t handling = micros() - start;
+        callbackDuration.record(handling);
+        if (handling > maxHandling) {
+            maxHandling = handling;
+        }
+    }
+}
+
+/**
+ * @brief Task body: poll the socket
+ * @param parameter The UdpListener instance
+ */
+void UdpListener::taskLoop(void *parameter) {
+    UdpListener &self = *static_cast<UdpListener *>(parameter);
+
+    while (1) {
+        self.poll();
+
+        esp_task_wdt_reset();
+        vTaskDelay(pdMS_TO_TICKS(UDP_TASK_INTERVAL_MS));
+    }
+}
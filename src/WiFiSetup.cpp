@@ -1,8 +1,26 @@
 #include "WiFiSetup.h"
+#include "ChannelTable.h"
+#include "BootTimeline.h"
+#include "DeferredLog.h"
 #include <Arduino.h>
 
+// Default channels for zones 1..N-1 of the main display
+static const char *const DEFAULT_ZONE_CHANNELS[MAX_DISPLAY_ZONES - 1] = {"CAD", "BAT", "SPD"};
+
+// Default primary channel page list
+static const char *const DEFAULT_PAGES[MAX_PAGES] = {"RPM", "CAD", "BAT", "SPD", "TPS", "MAT"};
+
+// Portal names of the timer MQTT modes, indexed by TIMER_PUBLISH_*
+static const char *const TIMER_PUBLISH_NAMES[TIMER_PUBLISH_COUNT] = {"legacy", "state", "both"};
+
 // Constructor
 WiFiSetup::WiFiSetup()
+    : customMqttServer("server", "MQTT server", "", MQTT_SERVER_SIZE),
+      customMqttPort("port", "MQTT port", "", MQTT_PORT_SIZE),
+      customMqttFallbacks("fallbacks", "Backup MQTT brokers (host:port,host:port)", "", MQTT_FALLBACK_PARAM_SIZE),
+      customTimerPublish("timers", "Timer MQTT topics (legacy, state or both)", "", TIMER_PUBLISH_PARAM_SIZE),
+      customTimerRate("timer_hz", "Timer state publishes per second (0 = on change only)", "", TIMER_RATE_PARAM_SIZE),
+      customUdpPort("udp_port", "UDP telemetry port (0 = off)", "", MQTT_PORT_SIZE)
 {
     prefs.begin("G86-INFO", false);
 }
@@ -10,12 +28,8 @@ WiFiSetup::WiFiSetup()
 // Initialize WiFiSetup
 void WiFiSetup::begin()
 {
-    WiFiManagerParameter custom_mqtt_server("server", "MQTT server", config.mqtt_server, 40);
-    WiFiManagerParameter custom_mqtt_port("port", "MQTT port", config.mqtt_port, 6);
+    setPortalValues();
 
-    // WiFiManager, Local initialization.
-    WiFiManager wifiManager;
-    
     // Reduce debug output to minimize ESP32 core error messages
     wifiManager.setDebugOutput(false);
 
@@ -24,77 +38,276 @@ void WiFiSetup::begin()
                                       { saveConfigCallback(); });
     wifiManager.setPreSaveConfigCallback([this]()
                                          { saveConfigCallback(); });
-    wifiManager.addParameter(&custom_mqtt_server);
-    wifiManager.addParameter(&custom_mqtt_port);
+    wifiManager.addParameter(&customMqttServer);
+    wifiManager.addParameter(&customMqttPort);
+    wifiManager.addParameter(&customMqttFallbacks);
+    wifiManager.addParameter(&customTimerPublish);
+    wifiManager.addParameter(&customTimerRate);
+    wifiManager.addParameter(&customUdpPort);
 
-    wifiManager.setTimeout(180);
+    wifiManager.setTimeout(WIFI_MANAGER_TIMEOUT_S);
 
-    // Automatically connect using saved credentials,
-    // if connection fails, it starts an access point with the specified name ("G86-INFO"),
-    // then goes into a blocking loop awaiting configuration and will return a success result
-    if (!wifiManager.autoConnect(AP_NAME, WIFI_PASSWORD))
+    // update() serves the portal, so it never blocks the displays and timers
+    wifiManager.setConfigPortalBlocking(false);
+
+    // Station mode up front, the saved credentials are read from the WiFi driver
+    WiFi.mode(WIFI_STA);
+    loadFastConnect();
+
+    if (!wifiManager.getWiFiIsSaved())
     {
-        Serial.println("Failed to connect and hit timeout");
-        delay(3000);
-        // Reset and try again, or maybe put it to deep sleep
-        ESP.restart();
-        delay(5000);
+        // First boot: nothing to connect to until the network is configured
+        Serial.println("No saved WiFi network");
+        openPortal();
+        return;
     }
 
-    // Save the custom parameters to FS
-    if (shouldSaveConfig)
+    // Connect in the background, update() follows the attempt
+    failedAttempts = 0;
+    state = WIFI_LINK_CONNECTING;
+    stateMillis = millis();
+    connect();
+}
+
+// Start a reconnection attempt with the stored credentials (non-blocking)
+bool WiFiSetup::connect()
+{
+    if (WiFi.status() == WL_CONNECTED)
     {
-        Serial.println("Saving config");
-        strncpy(config.mqtt_server, custom_mqtt_server.getValue(), sizeof(config.mqtt_server) - 1);
-        strncpy(config.mqtt_port, custom_mqtt_port.getValue(), sizeof(config.mqtt_port) - 1);
-        paramSave();
-        shouldSaveConfig = false; // Reset the flag
-        Serial.println("MQTT config saved: ");
-        Serial.println("\tmqtt_server : " + String(config.mqtt_server));
-        Serial.println("\tmqtt_port : " + String(config.mqtt_port));
+        return true; // Already connected
     }
 
-    // Load config data from Preferences
-    paramLoad();
+    LOG_INFO("Attempting WiFi reconnection (attempt %u)...", failedAttempts + 1);
 
-    Serial.println("Local IP");
-    Serial.println(WiFi.localIP());
+    // The cached access point gets the first try (no scan),
+    // then scan in case the car moved to another one
+    directedAttempt = failedAttempts == 0 && fastCacheValid;
+    beginStation(directedAttempt);
+    return false;
+}
+
+// Reconnect state machine, called from loop()
+void WiFiSetup::update(unsigned long now)
+{
+    bool connected = WiFi.status() == WL_CONNECTED;
+
+    switch (state)
+    {
+    case WIFI_LINK_UP:
+        if (!connected)
+        {
+            LOG_WARN("WiFi disconnected!");
+            failedAttempts = 0;
+            state = WIFI_LINK_CONNECTING;
+            stateMillis = now;
+            connect();
+        }
+        break;
+
+    case WIFI_LINK_CONNECTING:
+    case WIFI_LINK_BACKOFF:
+        if (connected)
+        {
+            if (bootConnectMillis == 0)
+            {
+                bootConnectMillis = now;
+                bootConnectFast = directedAttempt;
+                LOG_INFO("WiFi connected %lu ms after power-on (%s path)",
+                         bootConnectMillis, directedAttempt ? "fast" : "full");
+                bootTimeline.mark("wifi");
+            }
+            else
+            {
+                reconnects++;
+                LOG_INFO("Reconnected to WiFi after %u failed attempts", failedAttempts);
+            }
+            saveFastConnect();
+            LOG_INFO("IP: %s, RSSI: %d dBm", WiFi.localIP().toString().c_str(), WiFi.RSSI());
+            failedAttempts = 0;
+            state = WIFI_LINK_UP;
+        }
+        else if (state == WIFI_LINK_CONNECTING && directedAttempt && now - stateMillis >= WIFI_FAST_CONNECT_TIMEOUT_MS)
+        {
+            // Access point moved or gone: forget it and scan right away, the
+            // next successful connect refreshes the cache
+            LOG_WARN("Fast connect to the cached access point failed, scanning");
+            fastCacheValid = false;
+            stateMillis = now;
+            connect();
+        }
+        else if (state == WIFI_LINK_CONNECTING && now - stateMillis >= WIFI_CONNECT_ATTEMPT_MS)
+        {
+            // Exponential backoff, so an absent network costs almost nothing
+            if (failedAttempts < 16)
+            {
+                failedAttempts++;
+            }
+            backoffMs = WIFI_RECONNECT_BACKOFF_MIN_MS << (failedAttempts - 1);
+            if (backoffMs > WIFI_RECONNECT_BACKOFF_MAX_MS)
+            {
+                backoffMs = WIFI_RECONNECT_BACKOFF_MAX_MS;
+            }
+            LOG_WARN("WiFi reconnect failed, next attempt in %lu ms", backoffMs);
+            state = WIFI_LINK_BACKOFF;
+            stateMillis = now;
+        }
+        else if (state == WIFI_LINK_BACKOFF && now - stateMillis >= backoffMs)
+        {
+            state = WIFI_LINK_CONNECTING;
+            stateMillis = now;
+            connect();
+        }
+        break;
+
+    case WIFI_LINK_PORTAL:
+        wifiManager.process();
+        if (!wifiManager.getConfigPortalActive() || now - stateMillis >= WIFI_MANAGER_TIMEOUT_S * 1000UL)
+        {
+            wifiManager.stopConfigPortal();
+            Serial.println("Config portal closed");
 
-    Serial.println("Connected to WiFi..");
+            // The MQTT clients were set up with the old broker
+            if (applyPortalParams())
+            {
+                Serial.println("MQTT settings changed, restarting");
+                ESP.restart();
+            }
+
+            // Keep the portal up until there is a network to connect to
+            if (!wifiManager.getWiFiIsSaved())
+            {
+                wifiManager.startConfigPortal(AP_NAME, WIFI_PASSWORD);
+                stateMillis = now;
+                break;
+            }
+
+            failedAttempts = 0;
+            state = connected ? WIFI_LINK_UP : WIFI_LINK_CONNECTING;
+            stateMillis = now;
+            if (!connected)
+            {
+                connect();
+            }
+        }
+        break;
+    }
 }
 
-// Connect to WiFi (reconnection attempt)
-bool WiFiSetup::connect()
+// Open the config portal without blocking, update() serves it
+void WiFiSetup::openPortal()
 {
-    if (WiFi.status() == WL_CONNECTED)
+    if (state == WIFI_LINK_PORTAL)
     {
-        return true; // Already connected
+        return;
     }
 
-    Serial.println("Attempting WiFi reconnection...");
-    
-    // Try to reconnect using stored credentials
-    WiFi.reconnect();
+    setPortalValues();
 
-    const unsigned long startAttemptTime = millis();
-    const unsigned long timeout = 30000; // 30 seconds timeout
+    Serial.printf("Opening config portal \"%s\"\n", AP_NAME);
+    wifiManager.startConfigPortal(AP_NAME, WIFI_PASSWORD);
+    state = WIFI_LINK_PORTAL;
+    stateMillis = millis();
+}
 
-    while (WiFi.status() != WL_CONNECTED && millis() - startAttemptTime < timeout)
+// Fill the portal fields from config
+void WiFiSetup::setPortalValues()
+{
+    char fallbacks[MQTT_FALLBACK_PARAM_SIZE];
+    char rate[TIMER_RATE_PARAM_SIZE];
+    char udpPort[MQTT_PORT_SIZE];
+    formatFallbacks(fallbacks, sizeof(fallbacks));
+    snprintf(rate, sizeof(rate), "%u", config.timerStateRateHz);
+    snprintf(udpPort, sizeof(udpPort), "%u", config.udpPort);
+    customMqttServer.setValue(config.mqtt_server, MQTT_SERVER_SIZE);
+    customMqttPort.setValue(config.mqtt_port, MQTT_PORT_SIZE);
+    customMqttFallbacks.setValue(fallbacks, MQTT_FALLBACK_PARAM_SIZE);
+    customTimerPublish.setValue(TIMER_PUBLISH_NAMES[config.timerPublish], TIMER_PUBLISH_PARAM_SIZE);
+    customTimerRate.setValue(rate, TIMER_RATE_PARAM_SIZE);
+    customUdpPort.setValue(udpPort, MQTT_PORT_SIZE);
+}
+
+// Save the MQTT fields entered in the portal
+bool WiFiSetup::applyPortalParams()
+{
+    if (!shouldSaveConfig)
     {
-        delay(500);
-        Serial.print(".");
+        return false;
     }
 
-    if (WiFi.status() == WL_CONNECTED)
+    Serial.println("Saving config");
+    char fallbacks[MQTT_FALLBACK_PARAM_SIZE];
+    formatFallbacks(fallbacks, sizeof(fallbacks));
+    bool changed = strncmp(config.mqtt_server, customMqttServer.getValue(), sizeof(config.mqtt_server) - 1) != 0 ||
+                   strncmp(config.mqtt_port, customMqttPort.getValue(), sizeof(config.mqtt_port) - 1) != 0 ||
+                   strcmp(fallbacks, customMqttFallbacks.getValue()) != 0;
+    strncpy(config.mqtt_server, customMqttServer.getValue(), sizeof(config.mqtt_server) - 1);
+    strncpy(config.mqtt_port, customMqttPort.getValue(), sizeof(config.mqtt_port) - 1);
+    parseFallbacks(customMqttFallbacks.getValue());
+    // Timer topics apply without a restart, they are read on every publish
+    parseTimerPublish(customTimerPublish.getValue(), customTimerRate.getValue());
+    // The network task reopens the UDP listener when the port changes
+    parseUdpPort(customUdpPort.getValue());
+    paramSave();
+    shouldSaveConfig = false; // Reset the flag
+    Serial.println("MQTT config saved: ");
+    Serial.println("\tmqtt_server : " + String(config.mqtt_server));
+    Serial.println("\tmqtt_port : " + String(config.mqtt_port));
+    Serial.println("\tmqtt_fallbacks : " + String(customMqttFallbacks.getValue()));
+    Serial.printf("\ttimer_topics : %s at %u Hz\n", TIMER_PUBLISH_NAMES[config.timerPublish],
+                  config.timerStateRateHz);
+    Serial.printf("\tudp_port : %u\n", config.udpPort);
+    return changed;
+}
+
+// Associate with the saved network, directed to the cached access point or with a scan, always with DHCP
+void WiFiSetup::beginStation(bool directed)
+{
+    String ssid = wifiManager.getWiFiSSID(true);
+    String pass = wifiManager.getWiFiPass(true);
+
+    if (directed)
     {
-        Serial.println("\nReconnected to WiFi");
-        Serial.printf("IP: %s, RSSI: %d dBm\n", WiFi.localIP().toString().c_str(), WiFi.RSSI());
-        return true;
+        WiFi.begin(ssid.c_str(), pass.c_str(), fastCache.channel, fastCache.bssid);
     }
     else
     {
-        Serial.println("\nFailed to reconnect to WiFi");
-        return false;
+        WiFi.begin(ssid.c_str(), pass.c_str());
+    }
+}
+
+// Load the last successful association from Preferences
+void WiFiSetup::loadFastConnect()
+{
+    size_t bytesRead = prefs.getBytes("fastconn", &fastCache, sizeof(fastCache));
+    fastCacheValid = bytesRead == sizeof(fastCache) &&
+                     fastCache.version == FAST_CONNECT_VERSION &&
+                     fastCache.channel != 0;
+}
+
+// Store the current access point, only when it changed to spare the flash
+void WiFiSetup::saveFastConnect()
+{
+    FastConnectCache current;
+    memset(&current, 0, sizeof(current));
+    current.version = FAST_CONNECT_VERSION;
+    const uint8_t *bssid = WiFi.BSSID();
+    if (bssid == nullptr)
+    {
+        return;
+    }
+    memcpy(current.bssid, bssid, sizeof(current.bssid));
+    current.channel = WiFi.channel();
+
+    if (fastCacheValid && memcmp(&current, &fastCache, sizeof(current)) == 0)
+    {
+        return;
+    }
+
+    fastCache = current;
+    fastCacheValid = current.channel != 0;
+    if (prefs.putBytes("fastconn", &fastCache, sizeof(fastCache)) == 0)
+    {
+        Serial.println("ERROR: Failed to save fast connect cache");
     }
 }
 
@@ -133,9 +346,31 @@ void WiFiSetup::paramLoad()
         config.mqtt_server[sizeof(config.mqtt_server) - 1] = '\0';
         strncpy(config.mqtt_port, "1883", sizeof(config.mqtt_port) - 1);
         config.mqtt_port[sizeof(config.mqtt_port) - 1] = '\0';
+        setDisplayDefaults();
+        parseFallbacks("");
+        setTimerDefaults();
+        config.udpPort = UDP_DEFAULT_PORT;
         return;
     }
     
+    // Version 5 only appended the backup brokers, version 6 the timer topics,
+    // version 7 the UDP port
+    if (config.version == 4) {
+        Serial.println("Config migrated from version 4, no backup brokers");
+        config.version = 5;
+        parseFallbacks("");
+    }
+    if (config.version == 5) {
+        Serial.println("Config migrated from version 5, legacy timer topics");
+        config.version = 6;
+        setTimerDefaults();
+    }
+    if (config.version == 6) {
+        Serial.println("Config migrated from version 6, UDP telemetry off");
+        config.version = CONFIG_VERSION;
+        config.udpPort = UDP_DEFAULT_PORT;
+    }
+
     // Version check for config migration
     if (config.version != CONFIG_VERSION) {
         Serial.printf("Config version mismatch (found: %d, expected: %d), resetting to defaults\n", 
@@ -143,6 +378,10 @@ void WiFiSetup::paramLoad()
         config.version = CONFIG_VERSION;
         config.bright = DEFAULT_BRIGHTNESS;
         config.align = PA_CENTER;
+        setDisplayDefaults();
+        parseFallbacks("");
+        setTimerDefaults();
+        config.udpPort = UDP_DEFAULT_PORT;
     }
     
     // Validate and bound brightness
@@ -151,6 +390,46 @@ void WiFiSetup::paramLoad()
         config.bright = MAX_BRIGHTNESS;
     }
 
+    // Validate render mode
+    if (config.renderMode >= RENDER_MODE_COUNT) {
+        Serial.printf("WARNING: Invalid render mode %d, using text\n", config.renderMode);
+        config.renderMode = RENDER_MODE_TEXT;
+    }
+
+    // Validate timer topics
+    if (config.timerPublish >= TIMER_PUBLISH_COUNT) {
+        Serial.printf("WARNING: Invalid timer topics %d, using legacy\n", config.timerPublish);
+        config.timerPublish = TIMER_PUBLISH_LEGACY;
+    }
+    if (config.timerStateRateHz > TIMER_STATE_MAX_RATE_HZ) {
+        config.timerStateRateHz = TIMER_STATE_MAX_RATE_HZ;
+    }
+
+    // Validate zone channels
+    for (int i = 0; i < MAX_DISPLAY_ZONES - 1; i++) {
+        config.zoneChannel[i][DATA_INDEX_SIZE - 1] = '\0';
+        if (g_channels.indexOf(config.zoneChannel[i]) < 0) {
+            Serial.printf("WARNING: Invalid channel for zone %d, using %s\n", i + 1, DEFAULT_ZONE_CHANNELS[i]);
+            strncpy(config.zoneChannel[i], DEFAULT_ZONE_CHANNELS[i], DATA_INDEX_SIZE - 1);
+        }
+    }
+
+    // Validate page rotation
+    for (int i = 0; i < MAX_PAGES; i++) {
+        config.pages[i][DATA_INDEX_SIZE - 1] = '\0';
+        if (g_channels.indexOf(config.pages[i]) < 0) {
+            Serial.printf("WARNING: Invalid channel for page %d, using %s\n", i + 1, DEFAULT_PAGES[i]);
+            strncpy(config.pages[i], DEFAULT_PAGES[i], DATA_INDEX_SIZE - 1);
+        }
+    }
+    if (config.pageCount < 1 || config.pageCount > MAX_PAGES) {
+        Serial.printf("WARNING: Invalid page count %d, using 1\n", config.pageCount);
+        config.pageCount = 1;
+    }
+    if (config.pageIntervalS > PAGE_INTERVAL_MAX_S) {
+        config.pageIntervalS = PAGE_INTERVAL_MAX_S;
+    }
+
     // Validate or set default values for configuration fields
     setDefaultIfEmpty(config.mqtt_port, "1883", sizeof(config.mqtt_port));
     setDefaultIfEmpty(config.mqtt_server, "localhost", sizeof(config.mqtt_server));
@@ -158,10 +437,119 @@ void WiFiSetup::paramLoad()
     // Ensure null-termination
     config.mqtt_server[sizeof(config.mqtt_server) - 1] = '\0';
     config.mqtt_port[sizeof(config.mqtt_port) - 1] = '\0';
+    for (int i = 0; i < MQTT_FALLBACK_COUNT; i++) {
+        config.mqtt_fallback_server[i][MQTT_SERVER_SIZE - 1] = '\0';
+        config.mqtt_fallback_port[i][MQTT_PORT_SIZE - 1] = '\0';
+    }
     
     Serial.println("Config loaded successfully");
 }
 
+// Reset main display layout fields to defaults
+void WiFiSetup::setDisplayDefaults()
+{
+    config.renderMode = RENDER_MODE_TEXT;
+    for (int i = 0; i < MAX_DISPLAY_ZONES - 1; i++) {
+        strncpy(config.zoneChannel[i], DEFAULT_ZONE_CHANNELS[i], DATA_INDEX_SIZE - 1);
+        config.zoneChannel[i][DATA_INDEX_SIZE - 1] = '\0';
+    }
+    for (int i = 0; i < MAX_PAGES; i++) {
+        strncpy(config.pages[i], DEFAULT_PAGES[i], DATA_INDEX_SIZE - 1);
+        config.pages[i][DATA_INDEX_SIZE - 1] = '\0';
+    }
+    config.pageCount = 1;
+    config.pageIntervalS = 0;
+}
+
+// Format the backup brokers as "host:port,host:port"
+void WiFiSetup::formatFallbacks(char *buffer, size_t size) const
+{
+    size_t used = 0;
+    buffer[0] = '\0';
+    for (int i = 0; i < MQTT_FALLBACK_COUNT && used < size; i++) {
+        if (config.mqtt_fallback_server[i][0] == '\0') {
+            continue;
+        }
+        int written = snprintf(buffer + used, size - used, "%s%s:%s", used ? "," : "",
+                               config.mqtt_fallback_server[i], config.mqtt_fallback_port[i]);
+        if (written < 0) {
+            break;
+        }
+        used += written;
+    }
+}
+
+// Parse "host:port,host:port" into the backup brokers, unused entries are cleared
+void WiFiSetup::parseFallbacks(const char *text)
+{
+    memset(config.mqtt_fallback_server, 0, sizeof(config.mqtt_fallback_server));
+    memset(config.mqtt_fallback_port, 0, sizeof(config.mqtt_fallback_port));
+
+    const char *item = text;
+    for (int i = 0; i < MQTT_FALLBACK_COUNT && item != nullptr && *item != '\0'; ) {
+        while (*item == ' ') {
+            item++;
+        }
+        const char *end = strchr(item, ',');
+        size_t length = end ? (size_t)(end - item) : strlen(item);
+        const char *colon = (const char *)memchr(item, ':', length);
+        size_t hostLength = colon ? (size_t)(colon - item) : length;
+
+        if (hostLength > 0 && hostLength < MQTT_SERVER_SIZE) {
+            memcpy(config.mqtt_fallback_server[i], item, hostLength);
+            size_t portLength = colon ? length - hostLength - 1 : 0;
+            if (portLength > 0 && portLength < MQTT_PORT_SIZE) {
+                memcpy(config.mqtt_fallback_port[i], colon + 1, portLength);
+            } else {
+                strncpy(config.mqtt_fallback_port[i], "1883", MQTT_PORT_SIZE - 1);
+            }
+            i++;
+        } else if (hostLength > 0) {
+            Serial.printf("WARNING: Backup broker host too long, ignored\n");
+        }
+
+        item = end ? end + 1 : nullptr;
+    }
+}
+
+// Reset the timer MQTT fields to defaults
+void WiFiSetup::setTimerDefaults()
+{
+    config.timerPublish = TIMER_PUBLISH_LEGACY;
+    config.timerStateRateHz = TIMER_STATE_DEFAULT_RATE_HZ;
+}
+
+// Parse the timer topic mode and state rate entered in the portal
+void WiFiSetup::parseTimerPublish(const char *mode, const char *rate)
+{
+    bool known = false;
+    for (uint8_t i = 0; i < TIMER_PUBLISH_COUNT; i++) {
+        if (strcasecmp(mode, TIMER_PUBLISH_NAMES[i]) == 0) {
+            config.timerPublish = i;
+            known = true;
+        }
+    }
+    if (!known) {
+        Serial.printf("WARNING: Unknown timer topics \"%s\", kept %s\n", mode, TIMER_PUBLISH_NAMES[config.timerPublish]);
+    }
+
+    if (rate[0] != '\0') {
+        int hz = atoi(rate);
+        config.timerStateRateHz = hz < 0 ? 0 : (hz > TIMER_STATE_MAX_RATE_HZ ? TIMER_STATE_MAX_RATE_HZ : hz);
+    }
+}
+
+// Parse the UDP telemetry port entered in the portal
+void WiFiSetup::parseUdpPort(const char *text)
+{
+    long value = atol(text);
+    if (value < 0 || value > 65535) {
+        Serial.printf("WARNING: Invalid UDP port \"%s\", kept %u\n", text, config.udpPort);
+        return;
+    }
+    config.udpPort = (uint16_t)value;
+}
+
 void WiFiSetup::setDefaultIfEmpty(char* field, const char* defaultValue, size_t fieldSize)
 {
     if (strlen(field) == 0)
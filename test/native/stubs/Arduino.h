@@ -0,0 +1,143 @@
+// Arduino.h (native test stub)
+// The parts of the ESP32 Arduino core used by the host-tested modules
+
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+#include <chrono>
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+typedef uint8_t byte;
+
+/**
+ * @brief Current time in milliseconds; tests may set nativeMillisOverride to drive it
+ */
+inline bool nativeMillisFrozen = false;
+inline unsigned long nativeMillisOverride = 0;
+
+inline unsigned long millis() {
+    if (nativeMillisFrozen) {
+        return nativeMillisOverride;
+    }
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+inline unsigned long micros() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+inline uint32_t getCpuFrequencyMhz() {
+    return 240;
+}
+
+inline void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+/**
+ * @brief Growable text, only what the host-tested modules and the text topic
+ * path of the ECU benchmark use
+ */
+class String {
+public:
+    String() {}
+    String(const char *text) : text(text != nullptr ? text : "") {}
+
+    String &operator+=(const char *more) {
+        text += more;
+        return *this;
+    }
+    String &operator+=(const String &more) {
+        text += more.text;
+        return *this;
+    }
+    String &operator+=(char c) {
+        text += c;
+        return *this;
+    }
+
+    String operator+(const char *more) const {
+        String result(*this);
+        result += more;
+        return result;
+    }
+    bool operator==(const char *other) const { return text == other; }
+    bool operator==(const String &other) const { return text == other.text; }
+
+    int lastIndexOf(char c) const { return lastIndexOf(c, (int)text.size() - 1); }
+    int lastIndexOf(char c, int from) const {
+        if (from < 0) {
+            return -1;
+        }
+        size_t found = text.rfind(c, from);
+        return found == std::string::npos ? -1 : (int)found;
+    }
+    String substring(unsigned int from) const { return substring(from, text.size()); }
+    String substring(unsigned int from, unsigned int to) const {
+        String result;
+        if (from < to && from < text.size()) {
+            result.text = text.substr(from, to - from);
+        }
+        return result;
+    }
+    bool startsWith(const char *prefix) const { return text.compare(0, strlen(prefix), prefix) == 0; }
+    float toFloat() const { return strtof(text.c_str(), nullptr); }
+
+    const char *c_str() const { return text.c_str(); }
+    unsigned int length() const { return text.size(); }
+    bool reserve(unsigned int size) {
+        text.reserve(size);
+        return true;
+    }
+
+private:
+    std::string text;
+};
+
+/**
+ * @brief Serial port printing to stdout; tests may set nativeSerialMuted to discard output
+ */
+inline bool nativeSerialMuted = false;
+
+class HardwareSerial {
+public:
+    size_t print(const char *text) {
+        if (nativeSerialMuted) {
+            return strlen(text);
+        }
+        return fputs(text, stdout) >= 0 ? strlen(text) : 0;
+    }
+    size_t println(const char *text = "") { return print(text) + print("\n"); }
+    size_t write(const uint8_t *data, size_t length) {
+        return nativeSerialMuted ? length : fwrite(data, 1, length, stdout);
+    }
+    int printf(const char *format, ...) __attribute__((format(printf, 2, 3))) {
+        if (nativeSerialMuted) {
+            return 0;
+        }
+        va_list args;
+        va_start(args, format);
+        int length = vprintf(format, args);
+        va_end(args);
+        return length;
+    }
+};
+
+inline HardwareSerial Serial;
+
+#endif // NATIVE_ARDUINO_H
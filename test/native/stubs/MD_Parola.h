@@ -0,0 +1,12 @@
+// MD_Parola.h (native test stub), the alignment type used by Config
+
+#ifndef NATIVE_MD_PAROLA_H
+#define NATIVE_MD_PAROLA_H
+
+#include <Arduino.h>
+
+enum textPosition_t { PA_LEFT, PA_CENTER, PA_RIGHT };
+
+class MD_Parola;
+
+#endif // NATIVE_MD_PAROLA_H
@@ -0,0 +1,10 @@
+// Preferences.h (native test stub), declarations only
+
+#ifndef NATIVE_PREFERENCES_H
+#define NATIVE_PREFERENCES_H
+
+#include <Arduino.h>
+
+class Preferences {};
+
+#endif // NATIVE_PREFERENCES_H
@@ -0,0 +1,16 @@
+// WiFiManager.h (native test stub), declarations only: WiFiSetup.h needs the types for Config
+
+#ifndef NATIVE_WIFI_MANAGER_H
+#define NATIVE_WIFI_MANAGER_H
+
+#include <Arduino.h>
+
+class WiFiManagerParameter {
+public:
+    WiFiManagerParameter(const char *id, const char *label, const char *value, int length);
+    const char *getValue();
+};
+
+class WiFiManager {};
+
+#endif // NATIVE_WIFI_MANAGER_H
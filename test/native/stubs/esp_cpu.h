@@ -0,0 +1,19 @@
+// esp_cpu.h (native test stub)
+
+#ifndef NATIVE_ESP_CPU_H
+#define NATIVE_ESP_CPU_H
+
+#include <chrono>
+#include <stdint.h>
+
+/**
+ * @brief CPU cycles at 240 MHz since an arbitrary start, like esp_cpu_get_cycle_count()
+ */
+inline uint32_t esp_cpu_get_cycle_count() {
+    return (uint32_t)(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now().time_since_epoch())
+                          .count() *
+                      240 / 1000);
+}
+
+#endif // NATIVE_ESP_CPU_H
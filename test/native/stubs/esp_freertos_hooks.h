@@ -0,0 +1,17 @@
+// esp_freertos_hooks.h (native test stub), hooks are accepted and never called
+
+#ifndef NATIVE_ESP_FREERTOS_HOOKS_H
+#define NATIVE_ESP_FREERTOS_HOOKS_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef int esp_err_t;
+typedef bool (*esp_freertos_idle_cb_t)();
+
+inline esp_err_t esp_register_freertos_idle_hook_for_cpu(esp_freertos_idle_cb_t hook, UBaseType_t cpu) {
+    return 0;
+}
+
+inline void esp_deregister_freertos_idle_hook_for_cpu(esp_freertos_idle_cb_t hook, UBaseType_t cpu) {}
+
+#endif // NATIVE_ESP_FREERTOS_HOOKS_H
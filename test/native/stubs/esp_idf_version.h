@@ -0,0 +1,8 @@
+// esp_idf_version.h (native test stub)
+
+#ifndef NATIVE_ESP_IDF_VERSION_H
+#define NATIVE_ESP_IDF_VERSION_H
+
+#define ESP_IDF_VERSION_MAJOR 5
+
+#endif // NATIVE_ESP_IDF_VERSION_H
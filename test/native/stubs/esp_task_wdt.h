@@ -0,0 +1,19 @@
+// esp_task_wdt.h (native test stub), there is no watchdog on the host
+
+#ifndef NATIVE_ESP_TASK_WDT_H
+#define NATIVE_ESP_TASK_WDT_H
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+typedef int esp_err_t;
+
+inline esp_err_t esp_task_wdt_add(TaskHandle_t task) {
+    return 0;
+}
+
+inline esp_err_t esp_task_wdt_reset() {
+    return 0;
+}
+
+#endif // NATIVE_ESP_TASK_WDT_H
@@ -0,0 +1,18 @@
+// esp_timer.h (native test stub)
+
+#ifndef NATIVE_ESP_TIMER_H
+#define NATIVE_ESP_TIMER_H
+
+#include <chrono>
+#include <stdint.h>
+
+/**
+ * @brief Microseconds since an arbitrary start, like esp_timer_get_time()
+ */
+inline int64_t esp_timer_get_time() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+#endif // NATIVE_ESP_TIMER_H
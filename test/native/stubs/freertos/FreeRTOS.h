@@ -0,0 +1,35 @@
+// FreeRTOS.h (native test stub)
+// Types and tick conversion of FreeRTOS for host builds; 1 tick = 1 ms
+
+#ifndef NATIVE_FREERTOS_H
+#define NATIVE_FREERTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint8_t StackType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xffffffffUL
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portNUM_PROCESSORS 2
+#define tskNO_AFFINITY 0x7fffffff
+
+#define configUSE_TRACE_FACILITY 0
+#define configGENERATE_RUN_TIME_STATS 0
+
+/**
+ * @brief Core the caller runs on, always 0 on the host
+ */
+inline BaseType_t xPortGetCoreID() {
+    return 0;
+}
+
+#endif // NATIVE_FREERTOS_H
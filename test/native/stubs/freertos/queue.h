@@ -0,0 +1,75 @@
+// queue.h (native test stub)
+// FreeRTOS queues as a bounded copy-in/copy-out ring with a condition variable
+
+#ifndef NATIVE_QUEUE_H
+#define NATIVE_QUEUE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string.h>
+#include <vector>
+#include "FreeRTOS.h"
+
+/**
+ * @brief Bounded queue of fixed-size items, same blocking rules as xQueueSend/xQueueReceive
+ */
+struct NativeQueue {
+    NativeQueue(UBaseType_t length, UBaseType_t itemSize)
+        : storage(length * itemSize), length(length), itemSize(itemSize), head(0), waiting(0) {}
+
+    std::vector<uint8_t> storage;
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    UBaseType_t head;
+    UBaseType_t waiting;
+    std::mutex mutex;
+    std::condition_variable changed;
+};
+
+typedef NativeQueue *QueueHandle_t;
+
+inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    return new NativeQueue(length, itemSize);
+}
+
+inline void vQueueDelete(QueueHandle_t queue) {
+    delete queue;
+}
+
+inline BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!queue->changed.wait_for(lock, std::chrono::milliseconds(ticks),
+                                 [queue] { return queue->waiting < queue->length; })) {
+        return pdFALSE;
+    }
+    UBaseType_t slot = (queue->head + queue->waiting) % queue->length;
+    memcpy(&queue->storage[slot * queue->itemSize], item, queue->itemSize);
+    queue->waiting++;
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+
+inline BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!queue->changed.wait_for(lock, std::chrono::milliseconds(ticks), [queue] { return queue->waiting > 0; })) {
+        return pdFALSE;
+    }
+    memcpy(item, &queue->storage[queue->head * queue->itemSize], queue->itemSize);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->waiting--;
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+
+inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return queue->waiting;
+}
+
+inline UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return queue->length - queue->waiting;
+}
+
+#endif // NATIVE_QUEUE_H
@@ -0,0 +1,30 @@
+// semphr.h (native test stub)
+// FreeRTOS mutexes on std::timed_mutex
+
+#ifndef NATIVE_SEMPHR_H
+#define NATIVE_SEMPHR_H
+
+#include <chrono>
+#include <mutex>
+#include "FreeRTOS.h"
+
+typedef std::timed_mutex *SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return new std::timed_mutex();
+}
+
+inline void vSemaphoreDelete(SemaphoreHandle_t mutex) {
+    delete mutex;
+}
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex, TickType_t ticks) {
+    return mutex->try_lock_for(std::chrono::milliseconds(ticks)) ? pdTRUE : pdFALSE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex) {
+    mutex->unlock();
+    return pdTRUE;
+}
+
+#endif // NATIVE_SEMPHR_H
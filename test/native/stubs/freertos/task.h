@@ -0,0 +1,66 @@
+// task.h (native test stub)
+// FreeRTOS tasks as detached std::threads, without priorities or stack limits
+
+#ifndef NATIVE_TASK_H
+#define NATIVE_TASK_H
+
+#include <chrono>
+#include <thread>
+#include "FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+typedef enum { eRunning = 0, eReady, eBlocked, eSuspended, eDeleted, eInvalid } eTaskState;
+
+typedef struct {
+    TaskHandle_t xHandle;
+    const char *pcTaskName;
+    eTaskState eCurrentState;
+    uint32_t ulRunTimeCounter;
+} TaskStatus_t;
+
+inline TickType_t xTaskGetTickCount() {
+    return (TickType_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+inline void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+/**
+ * @brief Start the function on a detached thread; the handle is only an identity
+ */
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stackSize,
+                                          void *parameter, UBaseType_t priority, TaskHandle_t *handle,
+                                          BaseType_t core) {
+    static uint8_t handles[32];
+    static uint8_t used = 0;
+    if (used == sizeof(handles)) {
+        return pdFAIL;
+    }
+    if (handle != NULL) {
+        *handle = &handles[used];
+    }
+    used++;
+    std::thread(function, parameter).detach();
+    return pdPASS;
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return NULL;
+}
+
+inline UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    return 0;
+}
+
+inline UBaseType_t uxTaskPriorityGet(TaskHandle_t task) {
+    return 1;
+}
+
+inline void vTaskDelete(TaskHandle_t task) {}
+
+#endif // NATIVE_TASK_H
@@ -0,0 +1,232 @@
+// test_main.cpp
+// Host tests of the broker failover list: failure counting, switchover time
+// and the return to the first broker
+
+#include <Arduino.h>
+#include <unity.h>
+#include "BrokerList.h"
+
+// Defined in Main.cpp on the device
+char notAvailableMsg[] = "..N/A..";
+
+static Config config;
+
+/**
+ * @brief Config with the first broker and up to two backups ("" = unused)
+ */
+static void setBrokers(const char *first, const char *backup1, const char *backup2) {
+    memset(&config, 0, sizeof(config));
+    strcpy(config.mqtt_server, first);
+    strcpy(config.mqtt_port, "1883");
+    strcpy(config.mqtt_fallback_server[0], backup1);
+    strcpy(config.mqtt_fallback_port[0], "1884");
+    strcpy(config.mqtt_fallback_server[1], backup2);
+    strcpy(config.mqtt_fallback_port[1], "1885");
+}
+
+void setUp(void) {
+    setBrokers("primary.local", "backup1.local", "backup2.local");
+}
+
+void tearDown(void) {}
+
+void test_begin_lists_configured_brokers_in_order() {
+    BrokerList brokers;
+    brokers.begin(config);
+    TEST_ASSERT_EQUAL_UINT8(3, brokers.count());
+    TEST_ASSERT_EQUAL_UINT8(0, brokers.active());
+    TEST_ASSERT_EQUAL_STRING("primary.local", brokers.host(0));
+    TEST_ASSERT_EQUAL_STRING("backup2.local", brokers.host(2));
+    TEST_ASSERT_EQUAL_INT(1885, brokers.port(2));
+    TEST_ASSERT_EQUAL_STRING("", brokers.host(3));
+    TEST_ASSERT_EQUAL_INT(0, brokers.port(3));
+}
+
+void test_begin_skips_unused_backups() {
+    setBrokers("primary.local", "", "backup2.local");
+    BrokerList brokers;
+    brokers.begin(config);
+    TEST_ASSERT_EQUAL_UINT8(2, brokers.count());
+    TEST_ASSERT_EQUAL_STRING("backup2.local", brokers.host(1));
+    TEST_ASSERT_EQUAL_INT(1885, brokers.port(1));
+}
+
+void test_record_failure_asks_for_the_next_broker_after_the_attempts() {
+    BrokerList brokers;
+    brokers.begin(config);
+    for (uint8_t i = 1; i < MQTT_FAILOVER_ATTEMPTS; i++) {
+        TEST_ASSERT_FALSE(brokers.recordFailure());
+    }
+    TEST_ASSERT_TRUE(brokers.recordFailure());
+    TEST_ASSERT_EQUAL_UINT32(MQTT_FAILOVER_ATTEMPTS, brokers.failureCount(0));
+
+    // A successful connect starts the count over
+    brokers.recordConnected(0);
+    TEST_ASSERT_FALSE(brokers.recordFailure());
+}
+
+void test_single_broker_never_fails_over() {
+    setBrokers("primary.local", "", "");
+    BrokerList brokers;
+    brokers.begin(config);
+    for (uint8_t i = 0; i < MQTT_FAILOVER_ATTEMPTS * 3; i++) {
+        TEST_ASSERT_FALSE(brokers.recordFailure());
+    }
+    TEST_ASSERT_EQUAL_UINT8(0, brokers.next());
+}
+
+void test_next_wraps_to_the_first_broker() {
+    BrokerList brokers;
+    brokers.begin(config);
+    TEST_ASSERT_EQUAL_UINT8(1, brokers.next());
+    brokers.select(2, 0);
+    TEST_ASSERT_EQUAL_UINT8(0, brokers.next());
+}
+
+void test_select_ignores_the_active_and_unknown_brokers() {
+    BrokerList brokers;
+    brokers.begin(config);
+    brokers.select(0, 100);
+    brokers.select(3, 100);
+    TEST_ASSERT_EQUAL_UINT8(0, brokers.active());
+    TEST_ASSERT_EQUAL_UINT32(0, brokers.switchCount());
+    TEST_ASSERT_FALSE(brokers.recordConnected(200));
+}
+
+void test_switchover_time_runs_from_the_outage_to_the_new_connect() {
+    BrokerList brokers;
+    brokers.begin(config);
+
+    // Connection lost at 10 s, the retries fail after the doubling backoff
+    const unsigned long lost = 10000;
+    unsigned long now = lost + MQTT_BACKOFF_MIN_MS;
+    bool failover = false;
+    for (uint8_t i = 0; i < MQTT_FAILOVER_ATTEMPTS; i++) {
+        failover = brokers.recordFailure();
+        if (!failover) {
+            now += MQTT_BACKOFF_MIN_MS << (i + 1);
+        }
+    }
+    TEST_ASSERT_TRUE(failover);
+    brokers.select(brokers.next(), lost);
+    TEST_ASSERT_EQUAL_UINT8(1, brokers.active());
+    TEST_ASSERT_EQUAL_UINT32(1, brokers.switchCount());
+
+    // The backup accepts the connect right away
+    now += 40;
+    TEST_ASSERT_TRUE(brokers.recordConnected(now));
+    TEST_ASSERT_EQUAL_UINT32(now - lost, brokers.lastSwitchoverMs());
+
+    // Later connects are not switchovers
+    TEST_ASSERT_FALSE(brokers.recordConnected(now + 1000));
+}
+
+void test_chained_switch_measures_from_the_first_outage() {
+    BrokerList brokers;
+    brokers.begin(config);
+    brokers.select(1, 5000);
+
+    // The first backup is down too
+    for (uint8_t i = 0; i < MQTT_FAILOVER_ATTEMPTS; i++) {
+        brokers.recordFailure();
+    }
+    brokers.select(brokers.next(), 8000);
+    TEST_ASSERT_EQUAL_UINT8(2, brokers.active());
+    TEST_ASSERT_EQUAL_UINT32(MQTT_FAILOVER_ATTEMPTS, brokers.failureCount(1));
+
+    TEST_ASSERT_TRUE(brokers.recordConnected(9000));
+    TEST_ASSERT_EQUAL_UINT32(4000, brokers.lastSwitchoverMs());
+    TEST_ASSERT_EQUAL_UINT32(2, brokers.switchCount());
+}
+
+void test_primary_probe_is_due_only_on_a_backup_at_the_interval() {
+    BrokerList brokers;
+    brokers.begin(config);
+    TEST_ASSERT_FALSE(brokers.primaryProbeDue(MQTT_PRIMARY_PROBE_INTERVAL_MS * 2));
+
+    brokers.select(1, 1000);
+    brokers.recordConnected(2000);
+    TEST_ASSERT_FALSE(brokers.primaryProbeDue(MQTT_PRIMARY_PROBE_INTERVAL_MS - 1));
+    TEST_ASSERT_TRUE(brokers.primaryProbeDue(MQTT_PRIMARY_PROBE_INTERVAL_MS));
+    TEST_ASSERT_FALSE(brokers.primaryProbeDue(MQTT_PRIMARY_PROBE_INTERVAL_MS + 1));
+    TEST_ASSERT_FALSE(brokers.primaryProbeDue(MQTT_PRIMARY_PROBE_INTERVAL_MS * 2 - 1));
+    TEST_ASSERT_TRUE(brokers.primaryProbeDue(MQTT_PRIMARY_PROBE_INTERVAL_MS * 2));
+}
+
+void test_switching_back_to_the_primary_after_a_probe() {
+    BrokerList brokers;
+    brokers.begin(config);
+    brokers.select(1, 1000);
+    TEST_ASSERT_TRUE(brokers.recordConnected(1500));
+
+    // The probe finds the first broker back: MqttSetup switches with the probe time as outage start
+    unsigned long now = MQTT_PRIMARY_PROBE_INTERVAL_MS;
+    TEST_ASSERT_TRUE(brokers.primaryProbeDue(now));
+    brokers.returnToFirst(now);
+    TEST_ASSERT_EQUAL_UINT8(0, brokers.active());
+    TEST_ASSERT_TRUE(brokers.recordConnected(now + 25));
+    TEST_ASSERT_EQUAL_UINT32(25, brokers.lastSwitchoverMs());
+    TEST_ASSERT_EQUAL_UINT32(2, brokers.switchCount());
+
+    // Back on the primary there is nothing to probe
+    TEST_ASSERT_FALSE(brokers.primaryProbeDue(now + MQTT_PRIMARY_PROBE_INTERVAL_MS * 2));
+}
+
+void test_failed_connect_after_switching_back_returns_to_the_backup() {
+    BrokerList brokers;
+    brokers.begin(config);
+    brokers.select(2, 1000);
+    brokers.recordConnected(1500);
+
+    // The first broker took the probe session but refuses the real one
+    brokers.returnToFirst(40000);
+    TEST_ASSERT_EQUAL_UINT8(0, brokers.active());
+    TEST_ASSERT_EQUAL_UINT8(2, brokers.next());
+    TEST_ASSERT_TRUE(brokers.recordFailure());
+    brokers.select(brokers.next(), 40000);
+    TEST_ASSERT_EQUAL_UINT8(2, brokers.active());
+    TEST_ASSERT_TRUE(brokers.recordConnected(40100));
+    TEST_ASSERT_EQUAL_UINT32(100, brokers.lastSwitchoverMs());
+
+    // Back on the backup the usual order applies
+    TEST_ASSERT_EQUAL_UINT8(0, brokers.next());
+}
+
+void test_return_to_the_first_broker_ends_at_its_connect() {
+    BrokerList brokers;
+    brokers.begin(config);
+
+    // Already on the first broker: nothing to do
+    brokers.returnToFirst(1000);
+    TEST_ASSERT_EQUAL_UINT32(0, brokers.switchCount());
+    TEST_ASSERT_EQUAL_UINT8(1, brokers.next());
+
+    brokers.select(1, 1000);
+    brokers.recordConnected(1200);
+    brokers.returnToFirst(40000);
+    TEST_ASSERT_TRUE(brokers.recordConnected(40050));
+
+    // Later outages of the first broker fail over after the attempts again
+    TEST_ASSERT_EQUAL_UINT8(1, brokers.next());
+    for (uint8_t i = 1; i < MQTT_FAILOVER_ATTEMPTS; i++) {
+        TEST_ASSERT_FALSE(brokers.recordFailure());
+    }
+    TEST_ASSERT_TRUE(brokers.recordFailure());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_begin_lists_configured_brokers_in_order);
+    RUN_TEST(test_begin_skips_unused_backups);
+    RUN_TEST(test_record_failure_asks_for_the_next_broker_after_the_attempts);
+    RUN_TEST(test_single_broker_never_fails_over);
+    RUN_TEST(test_next_wraps_to_the_first_broker);
+    RUN_TEST(test_select_ignores_the_active_and_unknown_brokers);
+    RUN_TEST(test_switchover_time_runs_from_the_outage_to_the_new_connect);
+    RUN_TEST(test_chained_switch_measures_from_the_first_outage);
+    RUN_TEST(test_primary_probe_is_due_only_on_a_backup_at_the_interval);
+    RUN_TEST(test_switching_back_to_the_primary_after_a_probe);
+    RUN_TEST(test_failed_connect_after_switching_back_returns_to_the_backup);
+    RUN_TEST(test_return_to_the_first_broker_ends_at_its_connect);
+    return UNITY_END();
+}
@@ -0,0 +1,274 @@
+// test_main.cpp
+// Host tests of the deferred logger: the multi-producer ring, drop counting,
+// per call site rate limits, the level filter and the /log tail
+
+#include <Arduino.h>
+#include <unity.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "DeferredLog.h"
+
+#define WRITER_THREADS 4
+#define LINES_PER_ROUND (LOG_RING_SIZE / WRITER_THREADS)
+#define WRITER_ROUNDS 200
+#define STREAM_LINES 5000
+
+// Defined in Main.cpp on the device
+char notAvailableMsg[] = "..N/A..";
+
+/**
+ * @brief Read all tail output written since a position
+ * @param log Logger to read
+ * @param position Total output offset, advanced to the end of the output
+ */
+static std::string readAll(DeferredLog &log, uint32_t &position) {
+    std::string text;
+    char buffer[LOG_TAIL_CHUNK];
+    size_t copied;
+    while ((copied = log.readTail(position, buffer, sizeof(buffer))) > 0) {
+        text.append(buffer, copied);
+    }
+    return text;
+}
+
+/**
+ * @brief Split output into lines without the trailing newlines
+ */
+static std::vector<std::string> lines(const std::string &text) {
+    std::vector<std::string> result;
+    size_t start = 0;
+    size_t end;
+    while ((end = text.find('\n', start)) != std::string::npos) {
+        result.push_back(text.substr(start, end - start));
+        start = end + 1;
+    }
+    return result;
+}
+
+void setUp(void) {
+    nativeSerialMuted = true;
+    nativeMillisFrozen = false;
+}
+
+void tearDown(void) {
+    nativeSerialMuted = false;
+    nativeMillisFrozen = false;
+}
+
+void test_lines_are_printed_in_order_with_time_and_level() {
+    DeferredLog log;
+    static LogSite first, second;
+    nativeMillisFrozen = true;
+    nativeMillisOverride = 1234;
+    log.write(first, LOG_LEVEL_WARN, "low fuel %d", 7);
+    log.write(second, LOG_LEVEL_DEBUG, "tick");
+    log.drain();
+
+    uint32_t position = log.tailStart();
+    TEST_ASSERT_EQUAL_STRING("[   1234] W low fuel 7\n[   1234] D tick\n", readAll(log, position).c_str());
+    TEST_ASSERT_EQUAL_UINT32(2, log.writtenCount());
+    TEST_ASSERT_EQUAL_UINT32(0, log.droppedCount());
+}
+
+void test_level_filter_skips_lines_before_formatting() {
+    uint8_t saved = deferredLog.level();
+    uint32_t written = deferredLog.writtenCount();
+
+    deferredLog.setLevel(LOG_LEVEL_WARN);
+    LOG_INFO("not written");
+    LOG_DEBUG("not written");
+    TEST_ASSERT_EQUAL_UINT32(written, deferredLog.writtenCount());
+    LOG_WARN("written");
+    LOG_ERROR("written");
+    TEST_ASSERT_EQUAL_UINT32(written + 2, deferredLog.writtenCount());
+
+    deferredLog.setLevel(9);
+    TEST_ASSERT_EQUAL_UINT8(LOG_LEVEL_DEBUG, deferredLog.level());
+    TEST_ASSERT_EQUAL_STRING("warn", DeferredLog::levelName(LOG_LEVEL_WARN));
+    TEST_ASSERT_EQUAL_STRING("unknown", DeferredLog::levelName(LOG_LEVEL_COUNT));
+
+    deferredLog.setLevel(saved);
+    deferredLog.drain();
+}
+
+void test_call_site_is_limited_and_reports_skipped_lines() {
+    DeferredLog log;
+    static LogSite site;
+    static LogSite other;
+    nativeMillisFrozen = true;
+    nativeMillisOverride = 5000;
+    for (uint8_t i = 0; i < LOG_SITE_BURST + 3; i++) {
+        log.write(site, LOG_LEVEL_INFO, "burst %u", i);
+    }
+    // Another call site has its own limit
+    log.write(other, LOG_LEVEL_INFO, "other");
+    TEST_ASSERT_EQUAL_UINT32(LOG_SITE_BURST + 1, log.writtenCount());
+    TEST_ASSERT_EQUAL_UINT32(3, log.suppressedCount());
+
+    // Still in the same window
+    nativeMillisOverride = 5000 + LOG_SITE_WINDOW_MS - 1;
+    log.write(site, LOG_LEVEL_INFO, "late");
+    TEST_ASSERT_EQUAL_UINT32(4, log.suppressedCount());
+
+    nativeMillisOverride = 5000 + LOG_SITE_WINDOW_MS;
+    log.write(site, LOG_LEVEL_INFO, "next window");
+    log.write(site, LOG_LEVEL_INFO, "no longer skipping");
+    log.drain();
+
+    uint32_t position = log.tailStart();
+    std::vector<std::string> printed = lines(readAll(log, position));
+    TEST_ASSERT_EQUAL_UINT32(LOG_SITE_BURST + 3, printed.size());
+    TEST_ASSERT_EQUAL_STRING("[   6000] I next window (4 similar skipped)", printed[LOG_SITE_BURST + 1].c_str());
+    TEST_ASSERT_EQUAL_STRING("[   6000] I no longer skipping", printed[LOG_SITE_BURST + 2].c_str());
+}
+
+void test_full_ring_drops_and_counts_lines() {
+    DeferredLog log;
+    static LogSite sites[LOG_RING_SIZE + 5];
+    for (uint32_t i = 0; i < LOG_RING_SIZE + 5; i++) {
+        log.write(sites[i], LOG_LEVEL_INFO, "line %u", i);
+    }
+    TEST_ASSERT_EQUAL_UINT32(LOG_RING_SIZE, log.writtenCount());
+    TEST_ASSERT_EQUAL_UINT32(5, log.droppedCount());
+
+    log.drain();
+    uint32_t position = log.tailStart();
+    std::vector<std::string> printed = lines(readAll(log, position));
+    TEST_ASSERT_EQUAL_UINT32(LOG_RING_SIZE, printed.size());
+    for (uint32_t i = 0; i < LOG_RING_SIZE; i++) {
+        TEST_ASSERT_TRUE(printed[i].find("I line " + std::to_string(i)) != std::string::npos);
+    }
+
+    // Drained slots take lines again
+    log.write(sites[0], LOG_LEVEL_INFO, "after drain");
+    TEST_ASSERT_EQUAL_UINT32(5, log.droppedCount());
+}
+
+void test_concurrent_writers_within_capacity_lose_nothing() {
+    DeferredLog log;
+    static LogSite sites[WRITER_THREADS][LINES_PER_ROUND];
+    uint32_t position = 0;
+    nativeMillisFrozen = true;
+
+    for (uint32_t round = 0; round < WRITER_ROUNDS; round++) {
+        // A new window each round, so the sites are not rate limited
+        nativeMillisOverride = (round + 1) * LOG_SITE_WINDOW_MS;
+        std::vector<std::thread> writers;
+        for (uint32_t w = 0; w < WRITER_THREADS; w++) {
+            writers.emplace_back([&log, w, round]() {
+                for (uint32_t n = 0; n < LINES_PER_ROUND; n++) {
+                    log.write(sites[w][n], LOG_LEVEL_INFO, "w%u r%u n%u", w, round, n);
+                }
+            });
+        }
+        for (std::thread &writer : writers) {
+            writer.join();
+        }
+        log.drain();
+
+        bool seen[WRITER_THREADS][LINES_PER_ROUND] = {};
+        for (const std::string &line : lines(readAll(log, position))) {
+            unsigned w, r, n;
+            TEST_ASSERT_EQUAL_INT_MESSAGE(3, sscanf(line.c_str() + 12, "w%u r%u n%u", &w, &r, &n), line.c_str());
+            TEST_ASSERT_EQUAL_UINT32(round, r);
+            TEST_ASSERT_TRUE(w < WRITER_THREADS && n < LINES_PER_ROUND);
+            TEST_ASSERT_FALSE_MESSAGE(seen[w][n], line.c_str());
+            seen[w][n] = true;
+        }
+        for (uint32_t w = 0; w < WRITER_THREADS; w++) {
+            for (uint32_t n = 0; n < LINES_PER_ROUND; n++) {
+                TEST_ASSERT_TRUE(seen[w][n]);
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(WRITER_THREADS * LINES_PER_ROUND * WRITER_ROUNDS, log.writtenCount());
+    TEST_ASSERT_EQUAL_UINT32(0, log.droppedCount());
+}
+
+void test_concurrent_writers_and_drain_account_for_every_line() {
+    DeferredLog log;
+    static LogSite sites[WRITER_THREADS][STREAM_LINES];
+    std::atomic<bool> writing(true);
+    nativeMillisFrozen = true;
+    nativeMillisOverride = 1000;
+
+    std::thread drainer([&log, &writing]() {
+        while (writing.load()) {
+            log.drain();
+        }
+        log.drain();
+    });
+    std::vector<std::thread> writers;
+    for (uint32_t w = 0; w < WRITER_THREADS; w++) {
+        writers.emplace_back([&log, w]() {
+            for (uint32_t n = 0; n < STREAM_LINES; n++) {
+                log.write(sites[w][n], LOG_LEVEL_INFO, "w%u n%u", w, n);
+            }
+        });
+    }
+    for (std::thread &writer : writers) {
+        writer.join();
+    }
+    writing = false;
+    drainer.join();
+
+    TEST_ASSERT_EQUAL_UINT32(WRITER_THREADS * STREAM_LINES, log.writtenCount() + log.droppedCount());
+
+    // The tail keeps whole lines from each writer in the order written
+    uint32_t position = log.tailStart();
+    std::string text = readAll(log, position);
+    std::vector<std::string> printed = lines(text.substr(text.find('\n') + 1));
+    TEST_ASSERT_TRUE(printed.size() > 0);
+    long last[WRITER_THREADS];
+    for (uint32_t w = 0; w < WRITER_THREADS; w++) {
+        last[w] = -1;
+    }
+    for (const std::string &line : printed) {
+        unsigned w, n;
+        TEST_ASSERT_EQUAL_INT_MESSAGE(2, sscanf(line.c_str(), "[   1000] I w%u n%u", &w, &n), line.c_str());
+        TEST_ASSERT_TRUE(w < WRITER_THREADS);
+        TEST_ASSERT_TRUE_MESSAGE((long)n > last[w], line.c_str());
+        last[w] = n;
+    }
+}
+
+void test_tail_keeps_the_latest_output() {
+    DeferredLog log;
+    static LogSite sites[LOG_RING_SIZE];
+    uint32_t total = 0;
+    nativeMillisFrozen = true;
+    for (uint32_t lap = 0; total < 2 * LOG_TAIL_SIZE; lap++) {
+        nativeMillisOverride = (lap + 1) * LOG_SITE_WINDOW_MS;
+        for (uint32_t i = 0; i < LOG_RING_SIZE; i++) {
+            log.write(sites[i], LOG_LEVEL_INFO, "lap %u line %u", lap, i);
+        }
+        log.drain();
+        uint32_t position = log.tailStart();
+        readAll(log, position);
+        total = position;
+    }
+
+    // A reader behind the tail is moved up to the oldest byte kept
+    uint32_t position = 0;
+    std::string text = readAll(log, position);
+    TEST_ASSERT_EQUAL_UINT32(LOG_TAIL_SIZE, text.size());
+    TEST_ASSERT_EQUAL_UINT32(total, position);
+    TEST_ASSERT_TRUE(text.size() > 0 && text.back() == '\n');
+
+    char buffer[8];
+    TEST_ASSERT_EQUAL_UINT32(0, log.readTail(position, buffer, sizeof(buffer)));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_lines_are_printed_in_order_with_time_and_level);
+    RUN_TEST(test_level_filter_skips_lines_before_formatting);
+    RUN_TEST(test_call_site_is_limited_and_reports_skipped_lines);
+    RUN_TEST(test_full_ring_drops_and_counts_lines);
+    RUN_TEST(test_concurrent_writers_within_capacity_lose_nothing);
+    RUN_TEST(test_concurrent_writers_and_drain_account_for_every_line);
+    RUN_TEST(test_tail_keeps_the_latest_output);
+    return UNITY_END();
+}
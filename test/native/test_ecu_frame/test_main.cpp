@@ -0,0 +1,260 @@
+// test_main.cpp
+// Host tests of the ECU frame decoder (values, units, rejection, sequence
+// loss) and a benchmark of one frame against the 18 text topics it replaces
+
+#include <Arduino.h>
+#include <unity.h>
+#include <chrono>
+#include "EcuFrame.h"
+
+#define BENCH_SNAPSHOTS 20000
+
+// MQTT 3.1.1 PUBLISH at QoS 0: fixed header (payloads below 128 bytes) and topic length
+#define MQTT_PUBLISH_OVERHEAD 4
+
+// Defined in Main.cpp on the device
+char notAvailableMsg[] = "..N/A..";
+
+static const char FRAME_TOPIC[] = "/GOLF86/ECU/frame";
+static const char TIMER1_TOPIC[] = "/GOLF86/TM1/";
+static const char TIMER2_TOPIC[] = "/GOLF86/TM2/";
+static const char ALERT_TOPIC[] = "/GOLF86/ALERT";
+static const char DIAG_TOPIC[] = "/GOLF86/DIAG/";
+
+// A snapshot at part throttle, as sent in the frame (tenths for O2P, AFT, BAT, PW1, DWL)
+static const int16_t SNAPSHOT[ECU_CHANNEL_COUNT] = {
+    3450, 23, 65, 147, 145, 32, 88, 98, 138, 22, 34, 22, 35, 0, 101, 100, 0, 1};
+
+static bool isTenths(uint8_t index) {
+    return index == 3 || index == 4 || index == 8 || index == 10 || index == 12;
+}
+
+static EcuFrame makeFrame(uint16_t seq) {
+    EcuFrame frame;
+    frame.magic = ECU_FRAME_MAGIC;
+    frame.version = ECU_FRAME_VERSION;
+    frame.seq = seq;
+    memcpy(frame.values, SNAPSHOT, sizeof(frame.values));
+    return frame;
+}
+
+static bool decodeSeq(EcuFrameDecoder &decoder, uint16_t seq) {
+    EcuFrame frame = makeFrame(seq);
+    DisplaySample samples[ECU_CHANNEL_COUNT];
+    return decoder.decode((const char *)&frame, sizeof(frame), samples, 0);
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_decode_fills_every_channel_with_its_unit() {
+    EcuFrameDecoder decoder;
+    EcuFrame frame = makeFrame(7);
+    DisplaySample samples[ECU_CHANNEL_COUNT];
+    TEST_ASSERT_TRUE(decoder.decode((const char *)&frame, sizeof(frame), samples, 1234));
+    TEST_ASSERT_EQUAL_UINT32(1, decoder.receivedCount());
+
+    TEST_ASSERT_EQUAL_STRING("RPM", samples[0].code);
+    TEST_ASSERT_EQUAL_STRING("3450", samples[0].text);
+    TEST_ASSERT_EQUAL_STRING("23%", samples[1].text);
+    TEST_ASSERT_EQUAL_STRING("14.7", samples[3].text);
+    TEST_ASSERT_EQUAL_STRING("32C", samples[5].text);
+    TEST_ASSERT_EQUAL_STRING("BAT", samples[8].code);
+    TEST_ASSERT_EQUAL_STRING("13.8V", samples[8].text);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 13.8f, samples[8].value);
+    TEST_ASSERT_EQUAL_STRING("3.5ms", samples[12].text);
+    TEST_ASSERT_EQUAL_STRING("ENG", samples[17].code);
+    TEST_ASSERT_EQUAL_UINT32(1234, samples[17].receivedMicros);
+}
+
+void test_format_keeps_the_sign_of_small_negative_tenths() {
+    char text[CHANNEL_TEXT_SIZE];
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, -0.5f, EcuFrameDecoder::format(3, -5, text, sizeof(text)));
+    TEST_ASSERT_EQUAL_STRING("-0.5", text);
+    EcuFrameDecoder::format(3, -15, text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("-1.5", text);
+    EcuFrameDecoder::format(9, -4, text, sizeof(text));
+    TEST_ASSERT_EQUAL_STRING("-4", text);
+}
+
+void test_decode_rejects_wrong_length_magic_and_version() {
+    EcuFrameDecoder decoder;
+    EcuFrame frame = makeFrame(1);
+    DisplaySample samples[ECU_CHANNEL_COUNT];
+
+    TEST_ASSERT_FALSE(decoder.decode(nullptr, sizeof(frame), samples, 0));
+    TEST_ASSERT_FALSE(decoder.decode((const char *)&frame, sizeof(frame) - 1, samples, 0));
+    char longer[sizeof(frame) + 1] = {};
+    memcpy(longer, &frame, sizeof(frame));
+    TEST_ASSERT_FALSE(decoder.decode(longer, sizeof(longer), samples, 0));
+
+    frame.magic = ECU_FRAME_MAGIC + 1;
+    TEST_ASSERT_FALSE(decoder.decode((const char *)&frame, sizeof(frame), samples, 0));
+    frame.magic = ECU_FRAME_MAGIC;
+    frame.version = ECU_FRAME_VERSION + 1;
+    TEST_ASSERT_FALSE(decoder.decode((const char *)&frame, sizeof(frame), samples, 0));
+
+    TEST_ASSERT_EQUAL_UINT32(5, decoder.rejectedCount());
+    TEST_ASSERT_EQUAL_UINT32(0, decoder.receivedCount());
+}
+
+void test_sequence_gaps_are_counted_as_lost() {
+    EcuFrameDecoder decoder;
+    // The first frame may start anywhere
+    decodeSeq(decoder, 100);
+    decodeSeq(decoder, 101);
+    TEST_ASSERT_EQUAL_UINT32(0, decoder.lostCount());
+    decodeSeq(decoder, 105);
+    TEST_ASSERT_EQUAL_UINT32(3, decoder.lostCount());
+    TEST_ASSERT_EQUAL_UINT32(3, decoder.receivedCount());
+}
+
+void test_sequence_wrap_is_not_loss() {
+    EcuFrameDecoder decoder;
+    decodeSeq(decoder, 0xFFFE);
+    decodeSeq(decoder, 0xFFFF);
+    decodeSeq(decoder, 0);
+    TEST_ASSERT_EQUAL_UINT32(0, decoder.lostCount());
+    decodeSeq(decoder, 2);
+    TEST_ASSERT_EQUAL_UINT32(1, decoder.lostCount());
+
+    EcuFrameDecoder across;
+    decodeSeq(across, 0xFFFD);
+    decodeSeq(across, 1);
+    TEST_ASSERT_EQUAL_UINT32(3, across.lostCount());
+}
+
+void test_publisher_restart_and_repeats_are_not_loss() {
+    EcuFrameDecoder decoder;
+    decodeSeq(decoder, 5000);
+    decodeSeq(decoder, 3);
+    TEST_ASSERT_EQUAL_UINT32(0, decoder.lostCount());
+    decodeSeq(decoder, 3);
+    TEST_ASSERT_EQUAL_UINT32(0, decoder.lostCount());
+    decodeSeq(decoder, 5);
+    TEST_ASSERT_EQUAL_UINT32(1, decoder.lostCount());
+}
+
+void test_rejected_frames_do_not_move_the_sequence() {
+    EcuFrameDecoder decoder;
+    decodeSeq(decoder, 10);
+    EcuFrame frame = makeFrame(50);
+    frame.version = 0;
+    DisplaySample samples[ECU_CHANNEL_COUNT];
+    decoder.decode((const char *)&frame, sizeof(frame), samples, 0);
+    decodeSeq(decoder, 11);
+    TEST_ASSERT_EQUAL_UINT32(0, decoder.lostCount());
+}
+
+/**
+ * @brief Text topic path of MqttSetup::MqttMessageReceivedPrimary for one ECU value
+ *
+ * Same String operations in the same order, with the serial link checks left
+ * out (they read a flag) and the hand-off going to the given queues.
+ */
+static void textPath(IngestQueues &queues, const char *topicBytes, const char *payloadBytes) {
+    String topic(topicBytes);
+    String payload(payloadBytes);
+
+    int lastSlashIndex = topic.lastIndexOf('/');
+    if (lastSlashIndex == -1) {
+        return;
+    }
+    String lastSegment = topic.substring(lastSlashIndex + 1);
+    int secondLastSlashIndex = topic.lastIndexOf('/', lastSlashIndex - 1);
+    if (secondLastSlashIndex != -1) {
+        String secondLastSegment = topic.substring(secondLastSlashIndex + 1, lastSlashIndex);
+        if (secondLastSegment == "GPS" || secondLastSegment == "ECU") {
+            uint32_t receivedMicros = micros();
+            float value = payload.toFloat();
+            payload = payload + EcuFrameDecoder::unit(lastSegment.c_str());
+
+            DisplaySample sample;
+            strncpy(sample.code, lastSegment.c_str(), sizeof(sample.code) - 1);
+            sample.code[sizeof(sample.code) - 1] = '\0';
+            strncpy(sample.text, payload.c_str(), sizeof(sample.text) - 1);
+            sample.text[sizeof(sample.text) - 1] = '\0';
+            sample.value = value;
+            sample.receivedMicros = receivedMicros;
+            queues.pushSample(sample);
+        }
+    }
+
+    char timer1Topic[48], timer2Topic[48];
+    snprintf(timer1Topic, sizeof(timer1Topic), "%svalue", TIMER1_TOPIC);
+    snprintf(timer2Topic, sizeof(timer2Topic), "%svalue", TIMER2_TOPIC);
+    if (topic == timer1Topic || topic == timer2Topic || topic == ALERT_TOPIC) {
+        TEST_FAIL_MESSAGE("ECU topic taken for a critical topic");
+    } else if (topic.startsWith(DIAG_TOPIC)) {
+        TEST_FAIL_MESSAGE("ECU topic taken for a diagnostic topic");
+    }
+}
+
+void test_bench_frame_against_text_topics() {
+    IngestQueues queues;
+    TEST_ASSERT_TRUE(queues.beginQueues());
+
+    // What a bridge publishes per snapshot without the frame topic
+    char topics[ECU_CHANNEL_COUNT][24];
+    char payloads[ECU_CHANNEL_COUNT][12];
+    uint32_t textWireBytes = 0;
+    for (uint8_t i = 0; i < ECU_CHANNEL_COUNT; i++) {
+        snprintf(topics[i], sizeof(topics[i]), "/GOLF86/ECU/%s", ecuDataStrings[i]);
+        if (isTenths(i)) {
+            snprintf(payloads[i], sizeof(payloads[i]), "%d.%d", SNAPSHOT[i] / 10, SNAPSHOT[i] % 10);
+        } else {
+            snprintf(payloads[i], sizeof(payloads[i]), "%d", SNAPSHOT[i]);
+        }
+        textWireBytes += MQTT_PUBLISH_OVERHEAD + strlen(topics[i]) + strlen(payloads[i]);
+    }
+    uint32_t frameWireBytes = MQTT_PUBLISH_OVERHEAD + strlen(FRAME_TOPIC) + sizeof(EcuFrame);
+
+    EcuFrameDecoder decoder;
+    float checksum = 0.0f;
+    auto frameStart = std::chrono::steady_clock::now();
+    for (uint32_t n = 0; n < BENCH_SNAPSHOTS; n++) {
+        EcuFrame frame = makeFrame((uint16_t)n);
+        DisplaySample samples[ECU_CHANNEL_COUNT];
+        decoder.decode((const char *)&frame, sizeof(frame), samples, micros());
+        queues.pushSamples(samples, ECU_CHANNEL_COUNT);
+        checksum += samples[n % ECU_CHANNEL_COUNT].value;
+    }
+    auto frameEnd = std::chrono::steady_clock::now();
+
+    for (uint32_t n = 0; n < BENCH_SNAPSHOTS; n++) {
+        for (uint8_t i = 0; i < ECU_CHANNEL_COUNT; i++) {
+            textPath(queues, topics[i], payloads[i]);
+        }
+    }
+    auto textEnd = std::chrono::steady_clock::now();
+
+    double frameNs = std::chrono::duration<double, std::nano>(frameEnd - frameStart).count() / BENCH_SNAPSHOTS;
+    double textNs = std::chrono::duration<double, std::nano>(textEnd - frameEnd).count() / BENCH_SNAPSHOTS;
+
+    char line[160];
+    snprintf(line, sizeof(line), "wire bytes per snapshot: frame %u, text %u (%.1fx)", frameWireBytes,
+             textWireBytes, (double)textWireBytes / frameWireBytes);
+    TEST_MESSAGE(line);
+    snprintf(line, sizeof(line), "handler CPU per snapshot: frame %.0f ns, text %.0f ns (%.1fx), checksum %.0f",
+             frameNs, textNs, textNs / frameNs, checksum);
+    TEST_MESSAGE(line);
+
+    TEST_ASSERT_EQUAL_UINT32(BENCH_SNAPSHOTS, decoder.receivedCount());
+    TEST_ASSERT_EQUAL_UINT32(0, decoder.lostCount());
+    TEST_ASSERT_LESS_THAN(textWireBytes / 4, frameWireBytes);
+    TEST_ASSERT_TRUE(frameNs < textNs);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_decode_fills_every_channel_with_its_unit);
+    RUN_TEST(test_format_keeps_the_sign_of_small_negative_tenths);
+    RUN_TEST(test_decode_rejects_wrong_length_magic_and_version);
+    RUN_TEST(test_sequence_gaps_are_counted_as_lost);
+    RUN_TEST(test_sequence_wrap_is_not_loss);
+    RUN_TEST(test_publisher_restart_and_repeats_are_not_loss);
+    RUN_TEST(test_rejected_frames_do_not_move_the_sequence);
+    RUN_TEST(test_bench_frame_against_text_topics);
+    return UNITY_END();
+}
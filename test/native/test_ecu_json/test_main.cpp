@@ -0,0 +1,186 @@
+// test_main.cpp
+// Host tests of the ECU JSON batch parser (values, skipped keys, rejection of
+// malformed, nested and trailing input) and a throughput benchmark
+
+#include <Arduino.h>
+#include <unity.h>
+#include <chrono>
+#include "EcuJson.h"
+
+#define BENCH_MESSAGES 50000
+
+// Defined in Main.cpp on the device
+char notAvailableMsg[] = "..N/A..";
+
+static EcuJsonParser parser;
+static DisplaySample samples[ECU_CHANNEL_COUNT];
+
+static uint8_t parseText(const char *text) {
+    return parser.parse(text, strlen(text), samples, 42);
+}
+
+/**
+ * @brief Check that a payload is dropped as a whole
+ */
+static void assertRejected(const char *text) {
+    uint32_t before = parser.rejectedCount();
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(0, parseText(text), text);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(before + 1, parser.rejectedCount(), text);
+}
+
+void setUp(void) {
+    parser = EcuJsonParser();
+    memset(samples, 0, sizeof(samples));
+}
+
+void tearDown(void) {}
+
+void test_flat_object_is_shown_as_sent_with_units() {
+    TEST_ASSERT_EQUAL_UINT8(3, parseText("{\"RPM\":6250,\"TPS\":12.5,\"BAT\":\"13.8\"}"));
+    TEST_ASSERT_EQUAL_STRING("RPM", samples[0].code);
+    TEST_ASSERT_EQUAL_STRING("6250", samples[0].text);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 6250.0f, samples[0].value);
+    TEST_ASSERT_EQUAL_STRING("12.5%", samples[1].text);
+    TEST_ASSERT_EQUAL_STRING("BAT", samples[2].code);
+    TEST_ASSERT_EQUAL_STRING("13.8V", samples[2].text);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 13.8f, samples[2].value);
+    TEST_ASSERT_EQUAL_UINT32(42, samples[2].receivedMicros);
+    TEST_ASSERT_EQUAL_UINT32(1, parser.receivedCount());
+    TEST_ASSERT_EQUAL_UINT32(0, parser.rejectedCount());
+}
+
+void test_whitespace_and_client_terminator_are_accepted() {
+    TEST_ASSERT_EQUAL_UINT8(2, parseText(" \r\n{ \"MAT\" :\t-5 ,\n\"ADV\": 22 }\n"));
+    TEST_ASSERT_EQUAL_STRING("-5C", samples[0].text);
+    TEST_ASSERT_EQUAL_STRING("22", samples[1].text);
+
+    // The MQTT client passes the terminating zero byte in the length
+    const char text[] = "{\"RPM\":900}";
+    TEST_ASSERT_EQUAL_UINT8(1, parser.parse(text, sizeof(text), samples, 0));
+    TEST_ASSERT_EQUAL_UINT32(0, parser.rejectedCount());
+}
+
+void test_payload_is_read_only_up_to_its_length() {
+    const char text[] = "{\"RPM\":900}{\"TPS\":1}";
+    TEST_ASSERT_EQUAL_UINT8(1, parser.parse(text, 11, samples, 0));
+    TEST_ASSERT_EQUAL_STRING("900", samples[0].text);
+}
+
+void test_empty_object_has_no_samples_and_is_not_rejected() {
+    TEST_ASSERT_EQUAL_UINT8(0, parseText("{}"));
+    TEST_ASSERT_EQUAL_UINT8(0, parseText("{ }"));
+    TEST_ASSERT_EQUAL_UINT32(0, parser.rejectedCount());
+}
+
+void test_unknown_keys_and_literals_are_skipped() {
+    TEST_ASSERT_EQUAL_UINT8(2, parseText("{\"XYZ\":1,\"RPM\":800,\"rpm\":5,\"ENG\":null,\"TPS\":true,"
+                                         "\"BAR\":101,\"LONGKEY\":\"x\"}"));
+    TEST_ASSERT_EQUAL_STRING("RPM", samples[0].code);
+    TEST_ASSERT_EQUAL_STRING("BAR", samples[1].code);
+    TEST_ASSERT_EQUAL_UINT32(3, parser.unknownKeyCount());
+    TEST_ASSERT_EQUAL_UINT32(0, parser.rejectedCount());
+}
+
+void test_malformed_input_is_rejected() {
+    assertRejected("");
+    assertRejected("   ");
+    assertRejected("RPM=900");
+    assertRejected("[{\"RPM\":900}]");
+    assertRejected("{\"RPM\":900");
+    assertRejected("{\"RPM\":900,}");
+    assertRejected("{,\"RPM\":900}");
+    assertRejected("{\"RPM\" 900}");
+    assertRejected("{\"RPM\":}");
+    assertRejected("{\"RPM\":900 \"TPS\":12}");
+    assertRejected("{\"RPM:900}");
+    assertRejected("{\"RPM\":\"900}");
+    assertRejected("{RPM:900}");
+    assertRejected("{\"RPM\":abc}");
+    assertRejected("{\"RPM\":12.5.1}");
+    assertRejected("{\"RPM\":nil}");
+    assertRejected("{\"RPM\":truex}");
+    TEST_ASSERT_EQUAL_UINT32(17, parser.rejectedCount());
+
+    uint32_t before = parser.rejectedCount();
+    TEST_ASSERT_EQUAL_UINT8(0, parser.parse(nullptr, 10, samples, 0));
+    TEST_ASSERT_EQUAL_UINT32(before + 1, parser.rejectedCount());
+}
+
+void test_nested_values_are_rejected() {
+    assertRejected("{\"RPM\":900,\"GPS\":{\"SPD\":50}}");
+    assertRejected("{\"RPM\":[900,910]}");
+    assertRejected("{\"XYZ\":{},\"RPM\":900}");
+    assertRejected("{\"RPM\":{\"value\":900}}");
+}
+
+void test_trailing_garbage_is_rejected() {
+    assertRejected("{\"RPM\":900}x");
+    assertRejected("{\"RPM\":900} }");
+    assertRejected("{\"RPM\":900}{\"TPS\":12}");
+    assertRejected("{\"RPM\":900},");
+    const char zeroThenText[] = "{\"RPM\":900}\0x";
+    uint32_t before = parser.rejectedCount();
+    TEST_ASSERT_EQUAL_UINT8(1, parser.parse(zeroThenText, sizeof(zeroThenText), samples, 0));
+    TEST_ASSERT_EQUAL_UINT32(before, parser.rejectedCount());
+}
+
+void test_rejected_message_does_not_count_its_unknown_keys() {
+    assertRejected("{\"XYZ\":1,\"ABC\":2,\"RPM\":");
+    TEST_ASSERT_EQUAL_UINT32(0, parser.unknownKeyCount());
+}
+
+void test_long_values_are_truncated_to_the_display_text() {
+    TEST_ASSERT_EQUAL_UINT8(1, parseText("{\"BAT\":\"13.812345678901234567890\"}"));
+    TEST_ASSERT_EQUAL_UINT32(CHANNEL_TEXT_SIZE - 1, strlen(samples[0].text));
+}
+
+/**
+ * @brief Time the parser on one payload
+ * @param label Printed with the result
+ * @param text Payload
+ * @param expected Samples the payload must give
+ */
+static void benchPayload(const char *label, const char *text, uint8_t expected) {
+    int length = strlen(text);
+    uint32_t samplesOut = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t n = 0; n < BENCH_MESSAGES; n++) {
+        samplesOut += parser.parse(text, length, samples, n);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    double seconds = std::chrono::duration<double>(elapsed).count();
+
+    char line[160];
+    snprintf(line, sizeof(line), "%s: %d bytes, %.0f ns per message, %.1f MB/s", label, length,
+             seconds * 1e9 / BENCH_MESSAGES, (double)length * BENCH_MESSAGES / seconds / 1e6);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)expected * BENCH_MESSAGES, samplesOut);
+}
+
+void test_bench_parse_throughput() {
+    benchPayload("full snapshot",
+                 "{\"RPM\":3450,\"TPS\":23,\"VE1\":65,\"O2P\":14.7,\"AFT\":14.5,\"MAT\":32,\"CAD\":88,\"MAP\":98,"
+                 "\"BAT\":13.8,\"ADV\":22,\"PW1\":3.4,\"SPK\":22,\"DWL\":3.5,\"ILL\":0,\"BAR\":101,\"TAE\":100,"
+                 "\"NER\":0,\"ENG\":1}",
+                 ECU_CHANNEL_COUNT);
+    benchPayload("fast channels", "{\"RPM\":3450,\"TPS\":23,\"MAP\":98,\"ADV\":22}", 4);
+    benchPayload("rejected at the end",
+                 "{\"RPM\":3450,\"TPS\":23,\"VE1\":65,\"O2P\":14.7,\"AFT\":14.5,\"MAT\":32,\"CAD\":88,\"MAP\":98}x", 0);
+    TEST_ASSERT_EQUAL_UINT32(BENCH_MESSAGES, parser.rejectedCount());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_flat_object_is_shown_as_sent_with_units);
+    RUN_TEST(test_whitespace_and_client_terminator_are_accepted);
+    RUN_TEST(test_payload_is_read_only_up_to_its_length);
+    RUN_TEST(test_empty_object_has_no_samples_and_is_not_rejected);
+    RUN_TEST(test_unknown_keys_and_literals_are_skipped);
+    RUN_TEST(test_malformed_input_is_rejected);
+    RUN_TEST(test_nested_values_are_rejected);
+    RUN_TEST(test_trailing_garbage_is_rejected);
+    RUN_TEST(test_rejected_message_does_not_count_its_unknown_keys);
+    RUN_TEST(test_long_values_are_truncated_to_the_display_text);
+    RUN_TEST(test_bench_parse_throughput);
+    return UNITY_END();
+}
@@ -0,0 +1,375 @@
+// test_main.cpp
+// Host load test of the ingest queues: a network task thread pushes at 1x and
+// 10x the normal message rate while a main loop thread drains them with the
+// budgets of MqttSetup::processSamples()
+
+#include <Arduino.h>
+#include <unity.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <time.h>
+#include <vector>
+#include "IngestQueues.h"
+
+// Normal traffic: every channel and both timer values at 10 Hz, one diagnostic per second
+#define NORMAL_CHANNEL_HZ 10
+#define NORMAL_TIMER_HZ 10
+#define NORMAL_DIAGNOSTIC_HZ 1
+
+#define LOAD_ROUND_MS 10              // Producer pushes one round of traffic per interval
+#define LOAD_DURATION_MS 2000
+#define LOAD_LOOP_WORK_US 3000        // Display update and the rest of a main loop pass
+#define LOAD_SAMPLE_AGE_LIMIT_US 50000
+
+// Defined in Main.cpp on the device
+char notAvailableMsg[] = "..N/A..";
+
+/**
+ * @brief What the main loop side saw during one run
+ */
+struct LoadResult {
+    uint32_t pushed[INGEST_CLASS_COUNT];
+    uint32_t applied[INGEST_CLASS_COUNT];
+    bool criticalInOrder;
+    uint32_t lastValue[CHANNEL_COUNT];     // Last sequence applied per channel
+    uint32_t lastPushed[CHANNEL_COUNT];    // Last sequence pushed per channel
+    std::vector<uint32_t> drainMicros;     // processSamples() equivalent per pass
+    std::vector<uint32_t> drainCpuMicros;  // The same on the main loop thread's CPU clock
+    std::vector<uint32_t> passMicros;      // Start to start of main loop passes
+    std::vector<uint32_t> sampleAgeMicros; // Push to apply of channel values
+};
+
+/**
+ * @brief CPU time of the calling thread
+ *
+ * On the device the network task has its own core; on a host with fewer
+ * cores than threads the wall time of a drain also counts the producer's
+ * time slices, so the budget is checked against this clock.
+ */
+static uint32_t threadMicros() {
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return (uint32_t)(now.tv_sec * 1000000ULL + now.tv_nsec / 1000);
+}
+
+static uint32_t percentile(std::vector<uint32_t> values, uint8_t percent) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    return values[(values.size() - 1) * percent / 100];
+}
+
+/**
+ * @brief Messages of one kind due in a producer round
+ * @param round Round number
+ * @param hz Messages per second of the kind
+ * @return Count, spreading rates below one per round evenly
+ */
+static uint32_t dueInRound(uint32_t round, uint32_t hz) {
+    return (round + 1) * hz * LOAD_ROUND_MS / 1000 - round * hz * LOAD_ROUND_MS / 1000;
+}
+
+static const char *channelCode(uint8_t index) {
+    return index < ECU_CHANNEL_COUNT ? ecuDataStrings[index] : gpsDataStrings[index - ECU_CHANNEL_COUNT];
+}
+
+/**
+ * @brief Push paced traffic at factor times the normal rate and drain it like the main loop
+ * @param queues Fresh queues
+ * @param factor Rate multiplier
+ * @param result Filled with counts and timings
+ */
+static void runLoad(IngestQueues &queues, uint32_t factor, LoadResult &result) {
+    memset(result.pushed, 0, sizeof(result.pushed));
+    memset(result.applied, 0, sizeof(result.applied));
+    memset(result.lastValue, 0, sizeof(result.lastValue));
+    memset(result.lastPushed, 0, sizeof(result.lastPushed));
+    result.criticalInOrder = true;
+
+    std::atomic<bool> producing(true);
+
+    std::thread network([&]() {
+        uint32_t rounds = LOAD_DURATION_MS / LOAD_ROUND_MS;
+        uint32_t timerSequence = 0;
+        uint32_t channelSequence = 0;
+        auto next = std::chrono::steady_clock::now();
+        for (uint32_t round = 0; round < rounds; round++) {
+            for (uint32_t n = dueInRound(round, factor * NORMAL_CHANNEL_HZ); n > 0; n--) {
+                DisplaySample samples[CHANNEL_COUNT];
+                channelSequence++;
+                for (uint8_t c = 0; c < CHANNEL_COUNT; c++) {
+                    strcpy(samples[c].code, channelCode(c));
+                    snprintf(samples[c].text, sizeof(samples[c].text), "%lu", (unsigned long)channelSequence);
+                    samples[c].value = channelSequence;
+                    samples[c].receivedMicros = micros();
+                    result.lastPushed[c] = channelSequence;
+                }
+                queues.pushSamples(samples, CHANNEL_COUNT);
+                result.pushed[INGEST_DISPLAY] += CHANNEL_COUNT;
+            }
+            for (uint32_t n = dueInRound(round, factor * NORMAL_TIMER_HZ); n > 0; n--) {
+                for (uint8_t kind = CRITICAL_TIMER1_VALUE; kind <= CRITICAL_TIMER2_VALUE; kind++) {
+                    CriticalMessage message;
+                    message.kind = kind;
+                    snprintf(message.payload, sizeof(message.payload), "%lu", (unsigned long)++timerSequence);
+                    queues.pushCritical(message);
+                    result.pushed[INGEST_CRITICAL]++;
+                }
+            }
+            for (uint32_t n = dueInRound(round, factor * NORMAL_DIAGNOSTIC_HZ); n > 0; n--) {
+                DiagnosticMessage message;
+                strcpy(message.name, "heap");
+                snprintf(message.payload, sizeof(message.payload), "%lu", (unsigned long)round);
+                queues.pushDiagnostic(message);
+                result.pushed[INGEST_DIAGNOSTIC]++;
+            }
+            next += std::chrono::milliseconds(LOAD_ROUND_MS);
+            std::this_thread::sleep_until(next);
+        }
+        producing = false;
+    });
+
+    // Main loop: drain with the processSamples() budgets, then simulate the rest of the pass
+    uint32_t lastTimer = 0;
+    uint32_t lastPassStart = 0;
+    for (;;) {
+        bool done = !producing;
+        uint32_t applied = result.applied[INGEST_CRITICAL] + result.applied[INGEST_DISPLAY] +
+                           result.applied[INGEST_DIAGNOSTIC];
+        uint32_t passStart = micros();
+        uint32_t passCpuStart = threadMicros();
+        if (lastPassStart != 0) {
+            result.passMicros.push_back(passStart - lastPassStart);
+        }
+        lastPassStart = passStart;
+
+        CriticalMessage critical;
+        for (uint8_t i = 0; i < INGEST_CRITICAL_QUEUE_LENGTH && queues.popCritical(critical); i++) {
+            uint32_t value = strtoul(critical.payload, nullptr, 10);
+            if (value != lastTimer + 1) {
+                result.criticalInOrder = false;
+            }
+            lastTimer = value;
+            result.applied[INGEST_CRITICAL]++;
+        }
+        DisplaySample sample;
+        for (uint8_t i = 0; i < CHANNEL_COUNT && queues.popSample(sample); i++) {
+            int index = g_channels.indexOf(sample.code);
+            TEST_ASSERT_TRUE(index >= 0);
+            result.lastValue[index] = strtoul(sample.text, nullptr, 10);
+            result.sampleAgeMicros.push_back(micros() - sample.receivedMicros);
+            result.applied[INGEST_DISPLAY]++;
+        }
+        DiagnosticMessage diagnostic;
+        for (uint8_t i = 0; i < INGEST_DIAGNOSTIC_BUDGET && queues.popDiagnostic(diagnostic); i++) {
+            result.applied[INGEST_DIAGNOSTIC]++;
+        }
+        result.drainMicros.push_back(micros() - passStart);
+        result.drainCpuMicros.push_back(threadMicros() - passCpuStart);
+
+        // Done once the producer stopped before a pass that found nothing left
+        if (done && applied == result.applied[INGEST_CRITICAL] + result.applied[INGEST_DISPLAY] +
+                                   result.applied[INGEST_DIAGNOSTIC]) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(LOAD_LOOP_WORK_US));
+    }
+    network.join();
+}
+
+/**
+ * @brief Check the policies of a run and print its timings
+ */
+static void checkLoad(IngestQueues &queues, uint32_t factor, LoadResult &result) {
+    char line[200];
+    uint32_t seconds = LOAD_DURATION_MS / 1000;
+    snprintf(line, sizeof(line),
+             "%lux: %lu msg/s pushed; applied critical %lu/%lu, display %lu/%lu, diagnostic %lu/%lu",
+             (unsigned long)factor,
+             (unsigned long)((result.pushed[INGEST_CRITICAL] + result.pushed[INGEST_DISPLAY] +
+                              result.pushed[INGEST_DIAGNOSTIC]) / seconds),
+             (unsigned long)result.applied[INGEST_CRITICAL], (unsigned long)result.pushed[INGEST_CRITICAL],
+             (unsigned long)result.applied[INGEST_DISPLAY], (unsigned long)result.pushed[INGEST_DISPLAY],
+             (unsigned long)result.applied[INGEST_DIAGNOSTIC], (unsigned long)result.pushed[INGEST_DIAGNOSTIC]);
+    TEST_MESSAGE(line);
+    snprintf(line, sizeof(line),
+             "%lux: drain p50 %lu us p99 %lu us (CPU %lu us) max %lu us; pass p99 %lu us; sample age p99 %lu us; "
+             "high water critical %u display %u",
+             (unsigned long)factor, (unsigned long)percentile(result.drainMicros, 50),
+             (unsigned long)percentile(result.drainMicros, 99), (unsigned long)percentile(result.drainCpuMicros, 99),
+             (unsigned long)percentile(result.drainMicros, 100),
+             (unsigned long)percentile(result.passMicros, 99), (unsigned long)percentile(result.sampleAgeMicros, 99),
+             queues.stats(INGEST_CRITICAL).highWater, queues.stats(INGEST_DISPLAY).highWater);
+    TEST_MESSAGE(line);
+
+    // Critical: all delivered, in order
+    TEST_ASSERT_EQUAL_UINT32(result.pushed[INGEST_CRITICAL], result.applied[INGEST_CRITICAL]);
+    TEST_ASSERT_TRUE(result.criticalInOrder);
+    TEST_ASSERT_EQUAL_UINT32(0, queues.stats(INGEST_CRITICAL).dropped);
+
+    // Display: bounded backlog, every channel ends on its latest value
+    TEST_ASSERT_LESS_OR_EQUAL(CHANNEL_COUNT, queues.stats(INGEST_DISPLAY).highWater);
+    TEST_ASSERT_EQUAL_UINT32(result.pushed[INGEST_DISPLAY],
+                             result.applied[INGEST_DISPLAY] + queues.stats(INGEST_DISPLAY).dropped);
+    for (uint8_t c = 0; c < CHANNEL_COUNT; c++) {
+        TEST_ASSERT_EQUAL_UINT32(result.lastPushed[c], result.lastValue[c]);
+    }
+
+    // Main loop stays within its samples budget and sees fresh values
+    TEST_ASSERT_LESS_OR_EQUAL(LOOP_BUDGET_SAMPLES_US, percentile(result.drainCpuMicros, 99));
+    TEST_ASSERT_LESS_OR_EQUAL(LOAD_SAMPLE_AGE_LIMIT_US, percentile(result.sampleAgeMicros, 99));
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_load_normal_rate() {
+    IngestQueues queues;
+    TEST_ASSERT_TRUE(queues.beginQueues());
+    LoadResult result;
+    runLoad(queues, 1, result);
+    checkLoad(queues, 1, result);
+}
+
+void test_load_ten_times_normal_rate() {
+    IngestQueues queues;
+    TEST_ASSERT_TRUE(queues.beginQueues());
+    LoadResult result;
+    runLoad(queues, 10, result);
+    checkLoad(queues, 10, result);
+}
+
+void test_burst_sheds_diagnostics_first() {
+    IngestQueues queues;
+    TEST_ASSERT_TRUE(queues.beginQueues());
+
+    // More than half of the critical queue waiting: diagnostics are shed
+    CriticalMessage critical;
+    critical.kind = CRITICAL_ALERT;
+    for (uint8_t i = 0; i <= INGEST_CRITICAL_QUEUE_LENGTH / 2; i++) {
+        snprintf(critical.payload, sizeof(critical.payload), "%u", i);
+        TEST_ASSERT_TRUE(queues.pushCritical(critical));
+    }
+    DiagnosticMessage diagnostic;
+    strcpy(diagnostic.name, "heap");
+    strcpy(diagnostic.payload, "1");
+    TEST_ASSERT_FALSE(queues.pushDiagnostic(diagnostic));
+
+    // Drained: diagnostics queue again until their own queue is full
+    for (uint8_t i = 0; i <= INGEST_CRITICAL_QUEUE_LENGTH / 2; i++) {
+        TEST_ASSERT_TRUE(queues.popCritical(critical));
+    }
+    for (uint8_t i = 0; i < INGEST_DIAGNOSTIC_QUEUE_LENGTH; i++) {
+        TEST_ASSERT_TRUE(queues.pushDiagnostic(diagnostic));
+    }
+    TEST_ASSERT_FALSE(queues.pushDiagnostic(diagnostic));
+    TEST_ASSERT_EQUAL_UINT32(2, queues.stats(INGEST_DIAGNOSTIC).dropped);
+}
+
+void test_burst_critical_waits_instead_of_dropping() {
+    IngestQueues queues;
+    TEST_ASSERT_TRUE(queues.beginQueues());
+
+    // A replayed batch four times the queue length, the consumer starts late
+    const uint32_t batch = INGEST_CRITICAL_QUEUE_LENGTH * 4;
+    std::thread network([&]() {
+        CriticalMessage message;
+        message.kind = CRITICAL_TIMER1_VALUE;
+        for (uint32_t i = 1; i <= batch; i++) {
+            snprintf(message.payload, sizeof(message.payload), "%lu", (unsigned long)i);
+            queues.pushCritical(message);
+        }
+    });
+    delay(50);
+    TEST_ASSERT_EQUAL_UINT16(INGEST_CRITICAL_QUEUE_LENGTH, queues.stats(INGEST_CRITICAL).highWater);
+
+    uint32_t expected = 1;
+    unsigned long start = millis();
+    while (expected <= batch && millis() - start < 2000) {
+        CriticalMessage message;
+        if (queues.popCritical(message)) {
+            TEST_ASSERT_EQUAL_UINT32(expected, strtoul(message.payload, nullptr, 10));
+            expected++;
+        }
+    }
+    network.join();
+    TEST_ASSERT_EQUAL_UINT32(batch + 1, expected);
+    TEST_ASSERT_EQUAL_UINT32(0, queues.stats(INGEST_CRITICAL).dropped);
+}
+
+void test_stalled_main_loop_drops_critical_after_the_wait() {
+    IngestQueues queues;
+    TEST_ASSERT_TRUE(queues.beginQueues());
+
+    // Nothing drains: the queue fills, the next two wait their bound and are dropped
+    CriticalMessage message;
+    message.kind = CRITICAL_ALERT;
+    strcpy(message.payload, "x");
+    for (uint8_t i = 0; i < INGEST_CRITICAL_QUEUE_LENGTH; i++) {
+        TEST_ASSERT_TRUE(queues.pushCritical(message));
+    }
+    unsigned long start = millis();
+    TEST_ASSERT_FALSE(queues.pushCritical(message));
+    TEST_ASSERT_FALSE(queues.pushCritical(message));
+    unsigned long waited = millis() - start;
+
+    TEST_ASSERT_TRUE(waited >= 2 * INGEST_CRITICAL_WAIT_MS - 10);
+    TEST_ASSERT_TRUE(waited < 2 * INGEST_CRITICAL_WAIT_MS + 500);
+    IngestStats stats = queues.stats(INGEST_CRITICAL);
+    TEST_ASSERT_EQUAL_UINT32(INGEST_CRITICAL_QUEUE_LENGTH + 2, stats.received);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.dropped);
+
+    // Once the main loop drains again, messages get through
+    TEST_ASSERT_TRUE(queues.popCritical(message));
+    TEST_ASSERT_TRUE(queues.pushCritical(message));
+}
+
+void test_burst_display_backlog_is_bounded() {
+    IngestQueues queues;
+    TEST_ASSERT_TRUE(queues.beginQueues());
+
+    // 1000 values of one channel and one of another: two slots pending, latest wins
+    DisplaySample sample;
+    strcpy(sample.code, "RPM");
+    for (uint32_t i = 1; i <= 1000; i++) {
+        snprintf(sample.text, sizeof(sample.text), "%lu", (unsigned long)i);
+        queues.pushSample(sample);
+    }
+    strcpy(sample.code, "TPS");
+    strcpy(sample.text, "7");
+    queues.pushSample(sample);
+    strcpy(sample.code, "XXX");
+    TEST_ASSERT_FALSE(queues.pushSample(sample));
+
+    IngestStats stats = queues.stats(INGEST_DISPLAY);
+    TEST_ASSERT_EQUAL_UINT32(1001, stats.received);
+    TEST_ASSERT_EQUAL_UINT32(999, stats.dropped);
+    TEST_ASSERT_EQUAL_UINT16(2, stats.highWater);
+
+    bool seenRpm = false;
+    bool seenTps = false;
+    while (queues.popSample(sample)) {
+        if (strcmp(sample.code, "RPM") == 0) {
+            TEST_ASSERT_EQUAL_STRING("1000", sample.text);
+            seenRpm = true;
+        } else {
+            TEST_ASSERT_EQUAL_STRING("TPS", sample.code);
+            seenTps = true;
+        }
+    }
+    TEST_ASSERT_TRUE(seenRpm && seenTps);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_burst_sheds_diagnostics_first);
+    RUN_TEST(test_burst_critical_waits_instead_of_dropping);
+    RUN_TEST(test_stalled_main_loop_drops_critical_after_the_wait);
+    RUN_TEST(test_burst_display_backlog_is_bounded);
+    RUN_TEST(test_load_normal_rate);
+    RUN_TEST(test_load_ten_times_normal_rate);
+    return UNITY_END();
+}
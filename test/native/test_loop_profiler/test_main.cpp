@@ -0,0 +1,164 @@
+// test_main.cpp
+// Host tests of the main loop profiler: stage budgets and overruns, the log2
+// histogram of iteration times and the list of slowest iterations
+
+#include <Arduino.h>
+#include <unity.h>
+#include <string>
+#include "LoopProfiler.h"
+
+// Defined in Main.cpp on the device
+char notAvailableMsg[] = "..N/A..";
+
+static LoopProfiler profiler;
+
+/**
+ * @brief Run one iteration with the given stage durations
+ * @param start micros() at the start of the iteration
+ * @param stages Duration of each stage in microseconds
+ * @return Work time returned by finish()
+ */
+static uint32_t iteration(uint32_t start, const uint32_t (&stages)[LOOP_STAGE_COUNT]) {
+    uint32_t now = start;
+    profiler.start(now);
+    for (uint8_t stage = 0; stage < LOOP_STAGE_COUNT; stage++) {
+        now += stages[stage];
+        TEST_ASSERT_EQUAL_UINT32(stages[stage], profiler.mark(stage, now));
+    }
+    return profiler.finish(now);
+}
+
+/**
+ * @brief Run one iteration of a total time spent in the display stage
+ */
+static uint32_t iterationOf(uint32_t total) {
+    uint32_t stages[LOOP_STAGE_COUNT] = {};
+    stages[LOOP_STAGE_DISPLAY] = total;
+    return iteration(1000, stages);
+}
+
+void setUp(void) {
+    for (uint8_t stage = 0; stage <= LOOP_STAGE_TOTAL; stage++) {
+        profiler.setBudget(stage, 1000);
+    }
+    profiler.reset();
+}
+
+void tearDown(void) {}
+
+void test_stages_are_timed_and_checked_against_budgets() {
+    const uint32_t stages[LOOP_STAGE_COUNT] = {100, 1500, 300, 2000, 0, 50};
+    profiler.setBudget(LOOP_STAGE_TOTAL, 5000);
+    TEST_ASSERT_EQUAL_UINT32(3950, iteration(0xFFFFF000, stages));
+
+    TEST_ASSERT_EQUAL_UINT32(1, profiler.iterationCount());
+    TEST_ASSERT_EQUAL_UINT32(1500, profiler.lastMicros(LOOP_STAGE_SAMPLES));
+    TEST_ASSERT_EQUAL_UINT32(3950, profiler.lastMicros(LOOP_STAGE_TOTAL));
+    TEST_ASSERT_EQUAL_UINT32(1, profiler.overrunCount(LOOP_STAGE_SAMPLES));
+    TEST_ASSERT_EQUAL_UINT32(1, profiler.overrunCount(LOOP_STAGE_SWITCHES));
+    TEST_ASSERT_EQUAL_UINT32(0, profiler.overrunCount(LOOP_STAGE_DISPLAY));
+    TEST_ASSERT_EQUAL_UINT32(0, profiler.overrunCount(LOOP_STAGE_TOTAL));
+
+    // A stage at its budget is within it
+    const uint32_t atBudget[LOOP_STAGE_COUNT] = {1000, 0, 0, 0, 0, 0};
+    iteration(0, atBudget);
+    TEST_ASSERT_EQUAL_UINT32(0, profiler.overrunCount(LOOP_STAGE_WIFI));
+    TEST_ASSERT_EQUAL_UINT32(1500, profiler.maxMicros(LOOP_STAGE_SAMPLES));
+    TEST_ASSERT_EQUAL_UINT32(0, profiler.lastMicros(LOOP_STAGE_SAMPLES));
+    TEST_ASSERT_EQUAL_UINT32(3950, profiler.maxMicros(LOOP_STAGE_TOTAL));
+}
+
+void test_worst_stage_is_the_largest_overrun_or_the_longest() {
+    // switches is over by 1000, samples by 500 although it took longer in total
+    profiler.setBudget(LOOP_STAGE_SAMPLES, 3000);
+    const uint32_t overrun[LOOP_STAGE_COUNT] = {0, 3500, 0, 2000, 0, 0};
+    iteration(0, overrun);
+    TEST_ASSERT_EQUAL_UINT8(1, profiler.slowestCount());
+    TEST_ASSERT_EQUAL_UINT8(LOOP_STAGE_SWITCHES, profiler.slowest(0).worstStage);
+    TEST_ASSERT_EQUAL_UINT32(1000, profiler.slowest(0).overrunMicros);
+
+    profiler.reset();
+    const uint32_t within[LOOP_STAGE_COUNT] = {10, 900, 20, 30, 950, 0};
+    iteration(0, within);
+    TEST_ASSERT_EQUAL_UINT8(LOOP_STAGE_WEB, profiler.slowest(0).worstStage);
+    TEST_ASSERT_EQUAL_UINT32(0, profiler.slowest(0).overrunMicros);
+    TEST_ASSERT_EQUAL_UINT32(900, profiler.slowest(0).stageMicros[LOOP_STAGE_SAMPLES]);
+}
+
+void test_histogram_buckets_are_log2() {
+    // Bucket 0 is below 64 us, bucket n covers [32 << n, 64 << n), the last is open
+    const uint32_t totals[] = {0, 63, 64, 127, 128, 1000, 65535, 65536, 10000000};
+    const uint8_t buckets[] = {0, 0, 1, 1, 2, 4, 10, 11, 11};
+    for (uint8_t i = 0; i < sizeof(totals) / sizeof(totals[0]); i++) {
+        profiler.reset();
+        iterationOf(totals[i]);
+        for (uint8_t bucket = 0; bucket < LOOP_HISTOGRAM_BUCKETS; bucket++) {
+            TEST_ASSERT_EQUAL_UINT32_MESSAGE(bucket == buckets[i] ? 1 : 0, profiler.histogramCount(bucket),
+                                             std::to_string(totals[i]).c_str());
+        }
+    }
+
+    for (uint8_t bucket = 0; bucket < LOOP_HISTOGRAM_BUCKETS - 1; bucket++) {
+        TEST_ASSERT_EQUAL_UINT32((uint32_t)64 << bucket, LoopProfiler::bucketLimit(bucket));
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, LoopProfiler::bucketLimit(LOOP_HISTOGRAM_BUCKETS - 1));
+}
+
+void test_slowest_iterations_are_kept_slowest_first() {
+    // A shuffled sequence of distinct totals, more than are kept
+    const uint32_t count = 3 * LOOP_SLOWEST_COUNT;
+    for (uint32_t i = 0; i < count; i++) {
+        iterationOf(((i * 7) % count + 1) * 100);
+    }
+    TEST_ASSERT_EQUAL_UINT32(count, profiler.iterationCount());
+    TEST_ASSERT_EQUAL_UINT8(LOOP_SLOWEST_COUNT, profiler.slowestCount());
+    for (uint8_t i = 0; i < LOOP_SLOWEST_COUNT; i++) {
+        TEST_ASSERT_EQUAL_UINT32((count - i) * 100, profiler.slowest(i).totalMicros);
+        TEST_ASSERT_EQUAL_UINT32((count - i) * 100, profiler.slowest(i).stageMicros[LOOP_STAGE_DISPLAY]);
+    }
+
+    // Not slower than the fastest kept one: the list is unchanged
+    iterationOf((count - LOOP_SLOWEST_COUNT + 1) * 100);
+    TEST_ASSERT_EQUAL_UINT32((count - LOOP_SLOWEST_COUNT + 1) * 100,
+                             profiler.slowest(LOOP_SLOWEST_COUNT - 1).totalMicros);
+    iterationOf(count * 100 + 1);
+    TEST_ASSERT_EQUAL_UINT32(count * 100 + 1, profiler.slowest(0).totalMicros);
+    TEST_ASSERT_EQUAL_UINT32((count - LOOP_SLOWEST_COUNT + 2) * 100,
+                             profiler.slowest(LOOP_SLOWEST_COUNT - 1).totalMicros);
+}
+
+void test_reset_clears_everything_but_budgets() {
+    profiler.setBudget(LOOP_STAGE_WEB, 1234);
+    iterationOf(5000);
+    profiler.reset();
+    TEST_ASSERT_EQUAL_UINT32(0, profiler.iterationCount());
+    TEST_ASSERT_EQUAL_UINT8(0, profiler.slowestCount());
+    TEST_ASSERT_EQUAL_UINT32(0, profiler.maxMicros(LOOP_STAGE_TOTAL));
+    TEST_ASSERT_EQUAL_UINT32(0, profiler.overrunCount(LOOP_STAGE_DISPLAY));
+    TEST_ASSERT_EQUAL_UINT32(0, profiler.histogramCount(7));
+    TEST_ASSERT_EQUAL_UINT32(1234, profiler.budget(LOOP_STAGE_WEB));
+
+    // Out of range budgets are ignored
+    profiler.setBudget(LOOP_STAGE_TOTAL + 1, 1);
+    TEST_ASSERT_EQUAL_UINT32(1000, profiler.budget(LOOP_STAGE_TOTAL));
+}
+
+void test_stage_names_round_trip() {
+    for (uint8_t stage = 0; stage <= LOOP_STAGE_TOTAL; stage++) {
+        TEST_ASSERT_EQUAL_INT(stage, LoopProfiler::findStage(LoopProfiler::stageName(stage)));
+    }
+    TEST_ASSERT_EQUAL_STRING("total", LoopProfiler::stageName(LOOP_STAGE_TOTAL));
+    TEST_ASSERT_EQUAL_STRING("unknown", LoopProfiler::stageName(LOOP_STAGE_TOTAL + 1));
+    TEST_ASSERT_EQUAL_INT(-1, LoopProfiler::findStage("loop"));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_stages_are_timed_and_checked_against_budgets);
+    RUN_TEST(test_worst_stage_is_the_largest_overrun_or_the_longest);
+    RUN_TEST(test_histogram_buckets_are_log2);
+    RUN_TEST(test_slowest_iterations_are_kept_slowest_first);
+    RUN_TEST(test_reset_clears_everything_but_budgets);
+    RUN_TEST(test_stage_names_round_trip);
+    return UNITY_END();
+}
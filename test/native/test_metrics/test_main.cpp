@@ -0,0 +1,188 @@
+// test_main.cpp
+// Host tests of the metrics registry: the text exposition of each metric
+// type, histogram buckets, and exact totals under updates from several
+// threads
+
+#include <Arduino.h>
+#include <unity.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Metrics.h"
+
+#define UPDATE_THREADS 4
+#define UPDATES_PER_THREAD 100000
+
+// Defined in Main.cpp on the device
+char notAvailableMsg[] = "..N/A..";
+
+static uint32_t callbackValues[3] = {7, 0, 42};
+
+static MetricCounter testCounter("test_events_total", "Events counted by the test");
+static MetricChannelCounter testChannels("test_channel_values_total", "Values per channel");
+static MetricCallback testGauge(
+    "test_level", "Unlabelled gauge", METRIC_GAUGE,
+    [](uint8_t index, uint32_t &value) { value = callbackValues[0]; return true; });
+static MetricCallback testLabelled(
+    "test_slot_level", "Labelled gauge, slot 1 left out", METRIC_GAUGE,
+    [](uint8_t index, uint32_t &value) { value = callbackValues[index]; return index != 1; },
+    "slot", [](uint8_t index) { return index == 0 ? "a" : index == 1 ? "b" : "c"; }, 3);
+static MetricHistogram testDuration("test_duration_microseconds", "Durations recorded by the test");
+
+/**
+ * @brief Scrape all metrics
+ */
+static std::string scrape() {
+    String out;
+    Metric::writeAll(out);
+    return out.c_str();
+}
+
+/**
+ * @brief Read a sample from a scrape
+ * @param text Scrape output
+ * @param series Name with labels, e.g. test_slot_level{slot="a"}
+ * @param value Set to the sample value
+ * @return false if the series is not in the output
+ */
+static bool sample(const std::string &text, const std::string &series, uint32_t &value) {
+    std::string line = "\n" + series + " ";
+    size_t at = ("\n" + text).find(line);
+    if (at == std::string::npos) {
+        return false;
+    }
+    value = strtoul(text.c_str() + at + line.size() - 1, nullptr, 10);
+    return true;
+}
+
+static uint32_t sampleValue(const std::string &text, const std::string &series) {
+    uint32_t value = 0;
+    TEST_ASSERT_TRUE_MESSAGE(sample(text, series, value), series.c_str());
+    return value;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_counter_has_help_type_and_value() {
+    uint32_t before = sampleValue(scrape(), "test_events_total");
+    testCounter.add();
+    testCounter.add(4);
+    std::string text = scrape();
+    TEST_ASSERT_TRUE(text.find("# HELP test_events_total Events counted by the test\n"
+                               "# TYPE test_events_total counter\n"
+                               "test_events_total ") != std::string::npos);
+    TEST_ASSERT_EQUAL_UINT32(before + 5, sampleValue(text, "test_events_total"));
+}
+
+void test_channel_counter_labels_every_channel() {
+    int rpm = g_channels.indexOf("RPM");
+    testChannels.add(rpm, 3);
+    testChannels.add(-1);
+    testChannels.add(CHANNEL_COUNT);
+    std::string text = scrape();
+    TEST_ASSERT_EQUAL_UINT32(3, sampleValue(text, "test_channel_values_total{channel=\"RPM\"}"));
+    for (uint8_t i = 0; i < ECU_CHANNEL_COUNT; i++) {
+        std::string series = std::string("test_channel_values_total{channel=\"") + ecuDataStrings[i] + "\"}";
+        sampleValue(text, series);
+    }
+    for (uint8_t i = 0; i < GPS_CHANNEL_COUNT; i++) {
+        std::string series = std::string("test_channel_values_total{channel=\"") + gpsDataStrings[i] + "\"}";
+        sampleValue(text, series);
+    }
+}
+
+void test_callback_reads_at_scrape_and_can_leave_samples_out() {
+    callbackValues[0] = 7;
+    TEST_ASSERT_EQUAL_UINT32(7, sampleValue(scrape(), "test_level"));
+    callbackValues[0] = 8;
+    std::string text = scrape();
+    TEST_ASSERT_TRUE(text.find("# TYPE test_level gauge\n") != std::string::npos);
+    TEST_ASSERT_EQUAL_UINT32(8, sampleValue(text, "test_level"));
+
+    uint32_t value;
+    TEST_ASSERT_EQUAL_UINT32(8, sampleValue(text, "test_slot_level{slot=\"a\"}"));
+    TEST_ASSERT_FALSE(sample(text, "test_slot_level{slot=\"b\"}", value));
+    TEST_ASSERT_EQUAL_UINT32(42, sampleValue(text, "test_slot_level{slot=\"c\"}"));
+}
+
+void test_histogram_buckets_are_cumulative_with_sum_and_count() {
+    std::string before = scrape();
+    uint32_t le50 = sampleValue(before, "test_duration_microseconds_bucket{le=\"50\"}");
+    uint32_t le100 = sampleValue(before, "test_duration_microseconds_bucket{le=\"100\"}");
+    uint32_t le50000 = sampleValue(before, "test_duration_microseconds_bucket{le=\"50000\"}");
+    uint32_t inf = sampleValue(before, "test_duration_microseconds_bucket{le=\"+Inf\"}");
+    uint32_t sum = sampleValue(before, "test_duration_microseconds_sum");
+
+    // A bound is inclusive, 50001 only counts in +Inf
+    testDuration.record(0);
+    testDuration.record(50);
+    testDuration.record(51);
+    testDuration.record(50001);
+    std::string text = scrape();
+
+    TEST_ASSERT_TRUE(text.find("# TYPE test_duration_microseconds histogram\n") != std::string::npos);
+    TEST_ASSERT_EQUAL_UINT32(le50 + 2, sampleValue(text, "test_duration_microseconds_bucket{le=\"50\"}"));
+    TEST_ASSERT_EQUAL_UINT32(le100 + 3, sampleValue(text, "test_duration_microseconds_bucket{le=\"100\"}"));
+    TEST_ASSERT_EQUAL_UINT32(le50000 + 3, sampleValue(text, "test_duration_microseconds_bucket{le=\"50000\"}"));
+    TEST_ASSERT_EQUAL_UINT32(inf + 4, sampleValue(text, "test_duration_microseconds_bucket{le=\"+Inf\"}"));
+    TEST_ASSERT_EQUAL_UINT32(inf + 4, sampleValue(text, "test_duration_microseconds_count"));
+    TEST_ASSERT_EQUAL_UINT32(sum + 50102, sampleValue(text, "test_duration_microseconds_sum"));
+}
+
+void test_updates_from_several_threads_are_not_lost() {
+    std::string before = scrape();
+    uint32_t events = sampleValue(before, "test_events_total");
+    uint32_t count = sampleValue(before, "test_duration_microseconds_count");
+    uint32_t le250 = sampleValue(before, "test_duration_microseconds_bucket{le=\"250\"}");
+
+    std::vector<std::thread> threads;
+    for (uint8_t t = 0; t < UPDATE_THREADS; t++) {
+        threads.emplace_back([]() {
+            for (uint32_t n = 0; n < UPDATES_PER_THREAD; n++) {
+                testCounter.add();
+                testDuration.record(200);
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    std::string text = scrape();
+    const uint32_t total = UPDATE_THREADS * UPDATES_PER_THREAD;
+    TEST_ASSERT_EQUAL_UINT32(events + total, sampleValue(text, "test_events_total"));
+    TEST_ASSERT_EQUAL_UINT32(count + total, sampleValue(text, "test_duration_microseconds_count"));
+    TEST_ASSERT_EQUAL_UINT32(le250 + total, sampleValue(text, "test_duration_microseconds_bucket{le=\"250\"}"));
+}
+
+void test_every_line_is_a_comment_or_a_sample() {
+    std::string text = scrape();
+    TEST_ASSERT_TRUE(!text.empty() && text.back() == '\n');
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        std::string line = text.substr(start, end - start);
+        start = end + 1;
+        if (line.compare(0, 7, "# HELP ") == 0 || line.compare(0, 7, "# TYPE ") == 0) {
+            continue;
+        }
+        // name[{label="value"}] digits
+        size_t space = line.rfind(' ');
+        TEST_ASSERT_TRUE_MESSAGE(space != std::string::npos && space + 1 < line.size(), line.c_str());
+        TEST_ASSERT_TRUE_MESSAGE(line.find_first_not_of("0123456789", space + 1) == std::string::npos, line.c_str());
+        TEST_ASSERT_TRUE_MESSAGE(line.compare(0, 4, "g86_") == 0 || line.compare(0, 5, "test_") == 0, line.c_str());
+    }
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_counter_has_help_type_and_value);
+    RUN_TEST(test_channel_counter_labels_every_channel);
+    RUN_TEST(test_callback_reads_at_scrape_and_can_leave_samples_out);
+    RUN_TEST(test_histogram_buckets_are_cumulative_with_sum_and_count);
+    RUN_TEST(test_updates_from_several_threads_are_not_lost);
+    RUN_TEST(test_every_line_is_a_comment_or_a_sample);
+    return UNITY_END();
+}
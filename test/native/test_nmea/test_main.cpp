@@ -0,0 +1,257 @@
+// test_main.cpp
+// Host replay harness of the NMEA parser: the log in
+// test/native/data/drive_10hz.nmea is checked sentence by sentence, parsed at
+// full speed for throughput, and replayed at 115200 baud through a Linux
+// pseudo-terminal read the way GpsSerial::taskLoop() reads Serial1
+
+#include <Arduino.h>
+#include <unity.h>
+#include <algorithm>
+#include <atomic>
+#include <fcntl.h>
+#include <string>
+#include <termios.h>
+#include <unistd.h>
+#include <vector>
+#include "NmeaParser.h"
+
+#define LOG_PATH "test/native/data/drive_10hz.nmea"
+#define UART_BYTE_US 87          // 10 bits per byte at 115200 baud
+#define EPOCH_MS 100             // 10 Hz
+#define BENCH_PASSES 200
+
+// What the log holds (see the log description in test/README)
+#define LOG_SENTENCES 88         // RMC, GGA and VTG with a valid checksum
+#define LOG_CHECKSUM_ERRORS 1
+#define LOG_IGNORED 3            // TXT, GSV and the cut off GGA
+
+// Defined in Main.cpp on the device
+char notAvailableMsg[] = "..N/A..";
+
+static std::vector<std::string> lines;
+
+static void loadLog() {
+    lines.clear();
+    FILE *file = fopen(LOG_PATH, "r");
+    TEST_ASSERT_NOT_NULL_MESSAGE(file, LOG_PATH);
+    char line[128];
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        lines.push_back(line);
+    }
+    fclose(file);
+    TEST_ASSERT_GREATER_THAN(0, lines.size());
+}
+
+/**
+ * @brief Feed one line of the log
+ * @return true if it completed a sentence that updated the fix
+ */
+static bool feedLine(NmeaParser &parser, const std::string &line) {
+    bool updated = false;
+    for (char c : line) {
+        updated |= parser.feed(c);
+    }
+    return updated;
+}
+
+static uint32_t percentile(std::vector<uint32_t> values, uint8_t percent) {
+    std::sort(values.begin(), values.end());
+    return values[(values.size() - 1) * percent / 100];
+}
+
+void setUp(void) {
+    if (lines.empty()) {
+        loadLog();
+    }
+}
+
+void tearDown(void) {}
+
+void test_log_counts_every_kind_of_sentence() {
+    NmeaParser parser;
+    for (const std::string &line : lines) {
+        feedLine(parser, line);
+    }
+    TEST_ASSERT_EQUAL_UINT32(LOG_SENTENCES, parser.sentenceCount());
+    TEST_ASSERT_EQUAL_UINT32(LOG_CHECKSUM_ERRORS, parser.checksumErrorCount());
+    TEST_ASSERT_EQUAL_UINT32(LOG_IGNORED, parser.ignoredCount());
+}
+
+void test_log_ends_on_the_last_fix() {
+    NmeaParser parser;
+    for (const std::string &line : lines) {
+        feedLine(parser, line);
+    }
+    const GpsFix &fix = parser.fix();
+    TEST_ASSERT_EQUAL_UINT8(12, fix.hour);
+    TEST_ASSERT_EQUAL_UINT8(34, fix.minute);
+    TEST_ASSERT_EQUAL_UINT8(58, fix.second);
+    TEST_ASSERT_EQUAL_UINT8(18, fix.day);
+    TEST_ASSERT_EQUAL_UINT8(10, fix.month);
+    TEST_ASSERT_EQUAL_UINT16(2026, fix.year);
+    TEST_ASSERT_FLOAT_WITHIN(0.00001, 56.950042, fix.latitude);
+    TEST_ASSERT_FLOAT_WITHIN(0.00001, 24.106076, fix.longitude);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 90.0f, fix.speedKmh);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 50.0f, fix.course);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 15.2f, fix.altitude);
+    TEST_ASSERT_EQUAL_UINT8(1, fix.quality);
+    TEST_ASSERT_EQUAL_UINT8(11, fix.satellites);
+}
+
+void test_sentences_update_only_their_fields() {
+    NmeaParser parser;
+    const uint8_t rmc = GPS_FIELD_TIME | GPS_FIELD_DATE | GPS_FIELD_POSITION | GPS_FIELD_SPEED | GPS_FIELD_COURSE;
+    const uint8_t gga = GPS_FIELD_TIME | GPS_FIELD_POSITION | GPS_FIELD_QUALITY | GPS_FIELD_ALTITUDE;
+    const uint8_t vtg = GPS_FIELD_SPEED | GPS_FIELD_COURSE;
+    uint32_t checked = 0;
+
+    for (const std::string &line : lines) {
+        if (!feedLine(parser, line)) {
+            continue;
+        }
+        uint8_t updated = parser.fix().updated;
+        if (line.compare(3, 3, "RMC") == 0) {
+            // Without a fix (status V) only time and date are taken
+            bool active = line.compare(16, 3, ",A,") == 0;
+            TEST_ASSERT_EQUAL_UINT8(active ? rmc : (GPS_FIELD_TIME | GPS_FIELD_DATE), updated);
+        } else if (line.compare(3, 3, "GGA") == 0) {
+            bool fix = parser.fix().quality > 0;
+            TEST_ASSERT_EQUAL_UINT8(fix ? gga : (GPS_FIELD_TIME | GPS_FIELD_QUALITY), updated);
+        } else {
+            TEST_ASSERT_EQUAL_UINT8(vtg, updated);
+        }
+        checked++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(LOG_SENTENCES, checked);
+}
+
+void test_damaged_input_is_counted_and_recovered_from() {
+    NmeaParser parser;
+    const std::string good = lines[lines.size() - 1];
+
+    // Bad checksum digit, overlong line, a '$' restarting a cut off sentence
+    feedLine(parser, good.substr(0, good.find('*')) + "*G0\r\n");
+    feedLine(parser, "$GNTXT," + std::string(NMEA_MAX_SENTENCE, 'x') + "*00\r\n");
+    TEST_ASSERT_TRUE(feedLine(parser, good.substr(0, 20) + good));
+
+    TEST_ASSERT_EQUAL_UINT32(1, parser.checksumErrorCount());
+    TEST_ASSERT_EQUAL_UINT32(1, parser.ignoredCount());
+    TEST_ASSERT_EQUAL_UINT32(1, parser.sentenceCount());
+}
+
+void test_parse_throughput() {
+    NmeaParser parser;
+    std::vector<uint32_t> sentenceNanos;
+    size_t bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t pass = 0; pass < BENCH_PASSES; pass++) {
+        for (const std::string &line : lines) {
+            auto lineStart = std::chrono::steady_clock::now();
+            if (feedLine(parser, line)) {
+                sentenceNanos.push_back(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - lineStart)
+                        .count());
+            }
+            bytes += line.size();
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    char line[160];
+    snprintf(line, sizeof(line), "%.0f sentences/s, %.1f MB/s; parse per sentence p50 %u ns, p99 %u ns",
+             parser.sentenceCount() / seconds, bytes / seconds / 1e6, percentile(sentenceNanos, 50),
+             percentile(sentenceNanos, 99));
+    TEST_MESSAGE(line);
+    TEST_ASSERT_EQUAL_UINT32(LOG_SENTENCES * BENCH_PASSES, parser.sentenceCount());
+}
+
+void test_pty_replay_at_line_rate() {
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    TEST_ASSERT_TRUE(master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0);
+    int port = open(ptsname(master), O_RDWR | O_NOCTTY | O_NONBLOCK);
+    TEST_ASSERT_TRUE(port >= 0);
+    termios settings;
+    tcgetattr(port, &settings);
+    cfmakeraw(&settings);
+    tcsetattr(port, TCSANOW, &settings);
+
+    // Lines that complete a sentence, so a completion can be matched to its line
+    std::vector<size_t> completing;
+    for (size_t i = 0; i < lines.size(); i++) {
+        NmeaParser single;
+        if (feedLine(single, lines[i])) {
+            completing.push_back(i);
+        }
+    }
+    std::vector<std::atomic<uint32_t>> lastByteMicros(lines.size());
+    std::atomic<bool> sending(true);
+
+    // Receiver: each epoch starts with an RMC every EPOCH_MS, bytes follow at the baud rate
+    std::thread receiver([&]() {
+        auto epoch = std::chrono::steady_clock::now();
+        auto next = epoch;
+        bool started = false;
+        for (size_t i = 0; i < lines.size(); i++) {
+            if (lines[i].compare(3, 3, "RMC") == 0) {
+                if (started) {
+                    epoch += std::chrono::milliseconds(EPOCH_MS);
+                }
+                started = true;
+                next = std::max(next, epoch);
+            }
+            next += std::chrono::microseconds(lines[i].size() * UART_BYTE_US);
+            std::this_thread::sleep_until(next);
+            lastByteMicros[i] = micros();
+            if (write(master, lines[i].data(), lines[i].size()) != (ssize_t)lines[i].size()) {
+                break;
+            }
+        }
+        sending = false;
+    });
+
+    // GpsSerial::taskLoop(): drain what is available every GPS_READ_INTERVAL_MS
+    NmeaParser parser;
+    std::vector<uint32_t> latencies;
+    size_t completed = 0;
+    unsigned long start = millis();
+    for (bool last = false; !last;) {
+        last = !sending;
+        char buffer[256];
+        ssize_t length;
+        while ((length = read(port, buffer, sizeof(buffer))) > 0) {
+            for (ssize_t i = 0; i < length; i++) {
+                if (parser.feed(buffer[i]) && completed < completing.size()) {
+                    latencies.push_back(micros() - lastByteMicros[completing[completed++]]);
+                }
+            }
+        }
+        delay(GPS_READ_INTERVAL_MS);
+    }
+    unsigned long elapsed = millis() - start;
+    receiver.join();
+    close(port);
+    close(master);
+
+    char line[160];
+    snprintf(line, sizeof(line), "%u sentences in %lu ms (%.0f/s at %d Hz)", (unsigned)completed, elapsed,
+             completed * 1000.0 / elapsed, 1000 / EPOCH_MS);
+    TEST_MESSAGE(line);
+    snprintf(line, sizeof(line), "last byte to parsed: p50 %u us, p99 %u us, max %u us (read every %d ms)",
+             percentile(latencies, 50), percentile(latencies, 99), percentile(latencies, 100), GPS_READ_INTERVAL_MS);
+    TEST_MESSAGE(line);
+
+    TEST_ASSERT_EQUAL_UINT32(LOG_SENTENCES, completed);
+    TEST_ASSERT_EQUAL_UINT32(LOG_SENTENCES, parser.sentenceCount());
+    TEST_ASSERT_LESS_THAN(EPOCH_MS * 1000, percentile(latencies, 99));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_log_counts_every_kind_of_sentence);
+    RUN_TEST(test_log_ends_on_the_last_fix);
+    RUN_TEST(test_sentences_update_only_their_fields);
+    RUN_TEST(test_damaged_input_is_counted_and_recovered_from);
+    RUN_TEST(test_parse_throughput);
+    RUN_TEST(test_pty_replay_at_line_rate);
+    return UNITY_END();
+}
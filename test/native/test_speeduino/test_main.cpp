@@ -0,0 +1,373 @@
+// test_main.cpp
+// Host replay harness of the Speeduino parser: an ECU thread answers 'A' and
+// 'n' commands on a Linux pseudo-terminal with the replies in
+// test/native/data/speeduino_replies.hex, paced like the 115200 baud UART,
+// and the test polls it the way SpeeduinoSerial::poll() polls Serial2
+
+#include <Arduino.h>
+#include <unity.h>
+#include <algorithm>
+#include <atomic>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <vector>
+#include "SpeeduinoParser.h"
+
+#define REPLIES_PATH "test/native/data/speeduino_replies.hex"
+#define UART_BYTE_US 87              // 10 bits per byte at 115200 baud
+#define UART_CHUNK_BYTES 16          // Bytes written to the pty at a time
+#define TRUNCATED_REST_DELAY_MS 60   // Rest of a truncated reply arrives after the timeout
+#define BENCH_POLLS 200
+
+// Defined in Main.cpp on the device
+char notAvailableMsg[] = "..N/A..";
+
+// Every channel but NER
+static const uint32_t ALL_BUT_NER = ((1UL << ECU_CHANNEL_COUNT) - 1) & ~(1UL << 16);
+
+/**
+ * @brief One reply of the data file and the values it must give
+ */
+struct Reply {
+    char command;
+    std::vector<uint8_t> bytes;
+    int16_t expected[ECU_CHANNEL_COUNT];
+};
+
+static std::vector<Reply> replies;
+
+/**
+ * @brief Read the replies, "<command> <hex bytes>" each followed by "= <values>"
+ */
+static void loadReplies() {
+    replies.clear();
+    FILE *file = fopen(REPLIES_PATH, "r");
+    TEST_ASSERT_NOT_NULL_MESSAGE(file, REPLIES_PATH);
+
+    char line[1024];
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        if (line[0] == 'A' || line[0] == 'n') {
+            Reply reply;
+            reply.command = line[0];
+            char *p = line + 1;
+            char *next;
+            for (long byte = strtol(p, &next, 16); next != p; byte = strtol(p, &next, 16)) {
+                reply.bytes.push_back((uint8_t)byte);
+                p = next;
+            }
+            replies.push_back(reply);
+        } else if (line[0] == '=' && !replies.empty()) {
+            char *p = line + 1;
+            for (uint8_t i = 0; i < ECU_CHANNEL_COUNT; i++) {
+                replies.back().expected[i] = (int16_t)strtol(p, &p, 10);
+            }
+        }
+    }
+    fclose(file);
+    TEST_ASSERT_GREATER_THAN(0, replies.size());
+}
+
+/**
+ * @brief The ECU end of a pseudo-terminal, answering commands from the replies
+ */
+class PtyEcu {
+public:
+    PtyEcu() : master(-1), device(-1), stop(false), truncateNext(false), nextIndex{0, 0} {}
+
+    ~PtyEcu() { close(); }
+
+    /**
+     * @brief Open the pty pair and start answering
+     * @return true if the device end is open
+     */
+    bool open() {
+        master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+            return false;
+        }
+        device = ::open(ptsname(master), O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (device < 0) {
+            return false;
+        }
+        // Raw bytes, as on the UART: no echo, no line editing or CR/LF mapping
+        termios settings;
+        tcgetattr(device, &settings);
+        cfmakeraw(&settings);
+        tcsetattr(device, TCSANOW, &settings);
+
+        thread = std::thread(&PtyEcu::run, this);
+        return true;
+    }
+
+    void close() {
+        stop = true;
+        if (thread.joinable()) {
+            thread.join();
+        }
+        if (device >= 0) {
+            ::close(device);
+            device = -1;
+        }
+        if (master >= 0) {
+            ::close(master);
+            master = -1;
+        }
+    }
+
+    /** @brief File descriptor the display side reads and writes, like Serial2 */
+    int port() const { return device; }
+
+    /** @brief Send only the first half of the next reply, the rest after the timeout */
+    void truncate() { truncateNext = true; }
+
+private:
+    void run() {
+        while (!stop) {
+            pollfd waitFor = {master, POLLIN, 0};
+            uint8_t command;
+            if (poll(&waitFor, 1, 10) <= 0 || read(master, &command, 1) != 1) {
+                continue;
+            }
+            const Reply *reply = nextReply((char)command);
+            if (reply == nullptr) {
+                continue;
+            }
+            size_t split = truncateNext ? reply->bytes.size() / 2 : reply->bytes.size();
+            send(reply->bytes.data(), split);
+            if (split < reply->bytes.size()) {
+                truncateNext = false;
+                delay(TRUNCATED_REST_DELAY_MS);
+                send(reply->bytes.data() + split, reply->bytes.size() - split);
+            }
+        }
+    }
+
+    /**
+     * @brief Next reply to a command, in file order, starting over at the end
+     */
+    const Reply *nextReply(char command) {
+        uint8_t slot = command == 'A' ? 0 : 1;
+        for (size_t tried = 0; tried < replies.size(); tried++) {
+            const Reply &reply = replies[nextIndex[slot]];
+            nextIndex[slot] = (nextIndex[slot] + 1) % replies.size();
+            if (reply.command == command) {
+                return &reply;
+            }
+        }
+        return nullptr;
+    }
+
+    void send(const uint8_t *bytes, size_t length) {
+        for (size_t sent = 0; sent < length; sent += UART_CHUNK_BYTES) {
+            size_t chunk = std::min((size_t)UART_CHUNK_BYTES, length - sent);
+            if (write(master, bytes + sent, chunk) != (ssize_t)chunk) {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(chunk * UART_BYTE_US));
+        }
+    }
+
+    int master;
+    int device;
+    std::thread thread;
+    std::atomic<bool> stop;
+    std::atomic<bool> truncateNext;
+    size_t nextIndex[2];
+};
+
+/**
+ * @brief One request and its response, as SpeeduinoSerial::poll() does it
+ * @param port Device end of the pty
+ * @param parser Parser to feed
+ * @param command 'A' or 'n'
+ * @param responseMicros Output, command sent to response parsed
+ * @return true if a response was parsed within SPEEDUINO_RESPONSE_TIMEOUT_MS
+ */
+static bool pollOnce(int port, SpeeduinoParser &parser, char command, uint32_t *responseMicros) {
+    // Leftovers of a timed out response would be taken for the next one
+    uint8_t buffer[64];
+    while (read(port, buffer, sizeof(buffer)) > 0) {
+    }
+
+    parser.begin(command);
+    TEST_ASSERT_EQUAL_INT(1, (int)write(port, &command, 1));
+    uint32_t sentMicros = micros();
+    unsigned long sentMillis = millis();
+
+    while (millis() - sentMillis < SPEEDUINO_RESPONSE_TIMEOUT_MS) {
+        ssize_t length;
+        while ((length = read(port, buffer, sizeof(buffer))) > 0) {
+            for (ssize_t i = 0; i < length; i++) {
+                if (parser.feed(buffer[i])) {
+                    *responseMicros = micros() - sentMicros;
+                    return true;
+                }
+            }
+        }
+        delay(1);
+    }
+    return false;
+}
+
+static void assertValues(const Reply &reply, const SpeeduinoParser &parser) {
+    int16_t values[ECU_CHANNEL_COUNT];
+    TEST_ASSERT_EQUAL_UINT32(ALL_BUT_NER, parser.values(values));
+    for (uint8_t i = 0; i < ECU_CHANNEL_COUNT; i++) {
+        TEST_ASSERT_EQUAL_INT_MESSAGE(reply.expected[i], values[i], ecuDataStrings[i]);
+    }
+}
+
+static uint32_t percentile(std::vector<uint32_t> values, uint8_t percent) {
+    std::sort(values.begin(), values.end());
+    return values[(values.size() - 1) * percent / 100];
+}
+
+void setUp(void) {
+    if (replies.empty()) {
+        loadReplies();
+    }
+}
+
+void tearDown(void) {}
+
+void test_parser_reads_every_reply_of_the_file() {
+    for (const Reply &reply : replies) {
+        SpeeduinoParser parser;
+        parser.begin(reply.command);
+        for (size_t i = 0; i < reply.bytes.size(); i++) {
+            TEST_ASSERT_EQUAL(i + 1 == reply.bytes.size(), parser.feed(reply.bytes[i]));
+        }
+        TEST_ASSERT_TRUE(parser.complete());
+        assertValues(reply, parser);
+        TEST_ASSERT_EQUAL_UINT32(0, parser.junkCount());
+    }
+}
+
+void test_parser_skips_junk_before_the_echo() {
+    const Reply &reply = replies[0];
+    SpeeduinoParser parser;
+    parser.begin(reply.command);
+    parser.feed(0x00);
+    parser.feed(0xFF);
+    for (uint8_t byte : reply.bytes) {
+        parser.feed(byte);
+    }
+    TEST_ASSERT_TRUE(parser.complete());
+    TEST_ASSERT_EQUAL_UINT32(2, parser.junkCount());
+    assertValues(reply, parser);
+}
+
+void test_parser_drops_bad_n_headers() {
+    SpeeduinoParser parser;
+    parser.begin('n');
+    // Wrong packet type, then a length below the baro byte
+    const uint8_t bad[] = {'n', 0x31, 'n', 0x32, SPEEDUINO_MIN_PAYLOAD_SIZE - 1};
+    for (uint8_t byte : bad) {
+        TEST_ASSERT_FALSE(parser.feed(byte));
+    }
+    TEST_ASSERT_EQUAL_UINT32(2, parser.junkCount());
+    TEST_ASSERT_FALSE(parser.complete());
+
+    for (const Reply &reply : replies) {
+        if (reply.command == 'n') {
+            for (uint8_t byte : reply.bytes) {
+                parser.feed(byte);
+            }
+            assertValues(reply, parser);
+            break;
+        }
+    }
+}
+
+void test_parser_counts_bytes_after_the_response_as_junk() {
+    const Reply &reply = replies[0];
+    SpeeduinoParser parser;
+    int16_t values[ECU_CHANNEL_COUNT];
+    TEST_ASSERT_EQUAL_UINT32(0, parser.values(values));
+    parser.feed(0x41);
+    TEST_ASSERT_EQUAL_UINT32(1, parser.junkCount());
+
+    parser.begin(reply.command);
+    for (uint8_t byte : reply.bytes) {
+        parser.feed(byte);
+    }
+    parser.feed(0x41);
+    TEST_ASSERT_EQUAL_UINT32(2, parser.junkCount());
+    assertValues(reply, parser);
+}
+
+void test_pty_replays_every_reply() {
+    PtyEcu ecu;
+    TEST_ASSERT_TRUE(ecu.open());
+    SpeeduinoParser parser;
+    for (const Reply &reply : replies) {
+        uint32_t responseMicros = 0;
+        TEST_ASSERT_TRUE(pollOnce(ecu.port(), parser, reply.command, &responseMicros));
+        assertValues(reply, parser);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, parser.junkCount());
+}
+
+void test_pty_timeout_then_leftovers_are_flushed() {
+    PtyEcu ecu;
+    TEST_ASSERT_TRUE(ecu.open());
+    SpeeduinoParser parser;
+    uint32_t responseMicros = 0;
+
+    ecu.truncate();
+    TEST_ASSERT_FALSE(pollOnce(ecu.port(), parser, replies[0].command, &responseMicros));
+    TEST_ASSERT_FALSE(parser.complete());
+
+    // The rest arrives while nothing is pending; the next poll must not parse it
+    delay(TRUNCATED_REST_DELAY_MS);
+    TEST_ASSERT_TRUE(pollOnce(ecu.port(), parser, 'n', &responseMicros));
+    TEST_ASSERT_EQUAL_UINT32(0, parser.junkCount());
+}
+
+void test_pty_poll_rate_and_response_time() {
+    PtyEcu ecu;
+    TEST_ASSERT_TRUE(ecu.open());
+    SpeeduinoParser parser;
+    std::vector<uint32_t> responses;
+    uint32_t failed = 0;
+    size_t bytes = 0;
+
+    unsigned long start = millis();
+    for (uint32_t n = 0; n < BENCH_POLLS; n++) {
+        const Reply &reply = replies[n % replies.size()];
+        uint32_t responseMicros = 0;
+        if (pollOnce(ecu.port(), parser, reply.command, &responseMicros)) {
+            responses.push_back(responseMicros);
+            bytes += reply.bytes.size();
+        } else {
+            failed++;
+        }
+    }
+    unsigned long elapsed = millis() - start;
+
+    char line[160];
+    snprintf(line, sizeof(line), "%u polls in %lu ms (%.0f/s back to back, %u failed), %.0f bytes/s",
+             BENCH_POLLS, elapsed, BENCH_POLLS * 1000.0 / elapsed, failed, bytes * 1000.0 / elapsed);
+    TEST_MESSAGE(line);
+    snprintf(line, sizeof(line), "response p50 %u us, p99 %u us, max %u us (poll interval %d ms, timeout %d ms)",
+             percentile(responses, 50), percentile(responses, 99), percentile(responses, 100),
+             SPEEDUINO_POLL_INTERVAL_MS, SPEEDUINO_RESPONSE_TIMEOUT_MS);
+    TEST_MESSAGE(line);
+
+    TEST_ASSERT_EQUAL_UINT32(0, failed);
+    TEST_ASSERT_LESS_THAN(SPEEDUINO_POLL_INTERVAL_MS * 1000, percentile(responses, 99));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_parser_reads_every_reply_of_the_file);
+    RUN_TEST(test_parser_skips_junk_before_the_echo);
+    RUN_TEST(test_parser_drops_bad_n_headers);
+    RUN_TEST(test_parser_counts_bytes_after_the_response_as_junk);
+    RUN_TEST(test_pty_replays_every_reply);
+    RUN_TEST(test_pty_timeout_then_leftovers_are_flushed);
+    RUN_TEST(test_pty_poll_rate_and_response_time);
+    return UNITY_END();
+}
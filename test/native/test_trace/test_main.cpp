@@ -0,0 +1,135 @@
+// test_main.cpp
+// Host tests of the span ring: order and wrap, spans ending after stop(),
+// and a ring that stays unchanged while an export reads it under writers
+// on other threads
+
+#include <Arduino.h>
+#include <unity.h>
+#include <atomic>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include "Trace.h"
+
+#define WRITER_THREADS 3
+
+// Defined in Main.cpp on the device
+char notAvailableMsg[] = "..N/A..";
+
+static TraceRing ring;
+
+void setUp(void) {
+    ring.start();
+}
+
+void tearDown(void) {
+    ring.stop();
+}
+
+void test_spans_are_kept_oldest_first() {
+    for (uint32_t i = 1; i <= 3; i++) {
+        ring.record(TRACE_FORMAT, i * 100, i * 100 + i);
+    }
+    ring.stop();
+
+    TraceSnapshot snapshot = ring.snapshot();
+    TEST_ASSERT_EQUAL_UINT32(3, snapshot.count);
+    TEST_ASSERT_EQUAL_UINT32(0, snapshot.overwritten);
+    for (uint32_t i = 0; i < snapshot.count; i++) {
+        const TraceEvent &event = ring.at(snapshot, i);
+        TEST_ASSERT_EQUAL_UINT32((i + 1) * 100, event.startMicros);
+        TEST_ASSERT_EQUAL_UINT32(i + 1, event.durationMicros);
+        TEST_ASSERT_EQUAL_UINT8(TRACE_FORMAT, event.id);
+    }
+}
+
+void test_full_ring_keeps_the_latest_spans() {
+    const uint32_t total = TRACE_RING_SIZE * 2 + 5;
+    for (uint32_t i = 0; i < total; i++) {
+        ring.record(TRACE_QUEUE, i, i + 1);
+    }
+    ring.stop();
+
+    TraceSnapshot snapshot = ring.snapshot();
+    TEST_ASSERT_EQUAL_UINT32(TRACE_RING_SIZE, snapshot.count);
+    TEST_ASSERT_EQUAL_UINT32(total - TRACE_RING_SIZE, snapshot.overwritten);
+    TEST_ASSERT_EQUAL_UINT32(total - TRACE_RING_SIZE, ring.at(snapshot, 0).startMicros);
+    TEST_ASSERT_EQUAL_UINT32(total - 1, ring.at(snapshot, TRACE_RING_SIZE - 1).startMicros);
+}
+
+void test_spans_ending_after_stop_are_not_recorded() {
+    ring.record(TRACE_MQTT_RX, 10, 20);
+    ring.stop();
+    TEST_ASSERT_FALSE(ring.enabled());
+    ring.record(TRACE_MQTT_RX, 15, 30);
+    TEST_ASSERT_EQUAL_UINT32(1, ring.snapshot().count);
+
+    // start() clears what the last session kept
+    ring.start();
+    TEST_ASSERT_EQUAL_UINT32(0, ring.snapshot().count);
+}
+
+void test_ring_is_stable_after_stop_under_concurrent_writers() {
+    // Writers keep ending spans on other threads, before and after stop()
+    std::atomic<bool> running(true);
+    std::atomic<uint32_t> calls(0);
+    std::vector<std::thread> writers;
+    for (uint8_t w = 0; w < WRITER_THREADS; w++) {
+        writers.emplace_back([&, w]() {
+            for (uint32_t n = 0; running; n++) {
+                // Duration tied to the id, so a slot mixing two spans shows up
+                ring.record(w, n, n + w + 1);
+                calls.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    while (calls.load() < TRACE_RING_SIZE * 4) {
+        std::this_thread::yield();
+    }
+    ring.stop();
+    TraceSnapshot snapshot = ring.snapshot();
+    std::vector<TraceEvent> exported;
+    for (uint32_t i = 0; i < snapshot.count; i++) {
+        exported.push_back(ring.at(snapshot, i));
+    }
+
+    // The writers go on while the export would be streamed
+    uint32_t callsAtStop = calls.load();
+    while (calls.load() < callsAtStop + TRACE_RING_SIZE * 4) {
+        std::this_thread::yield();
+    }
+    running = false;
+    for (std::thread &writer : writers) {
+        writer.join();
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(TRACE_RING_SIZE, snapshot.count);
+    TraceSnapshot after = ring.snapshot();
+    TEST_ASSERT_EQUAL_UINT32(snapshot.count, after.count);
+    TEST_ASSERT_EQUAL_UINT32(snapshot.overwritten, after.overwritten);
+    for (uint32_t i = 0; i < snapshot.count; i++) {
+        const TraceEvent &event = ring.at(snapshot, i);
+        TEST_ASSERT_EQUAL_MEMORY(&exported[i], &event, sizeof(TraceEvent));
+        TEST_ASSERT_TRUE(event.id < WRITER_THREADS);
+        TEST_ASSERT_EQUAL_UINT32(event.id + 1, event.durationMicros);
+    }
+}
+
+void test_names_cover_every_id() {
+    for (uint8_t id = 0; id < TRACE_ID_COUNT; id++) {
+        TEST_ASSERT_TRUE(strcmp("unknown", TraceRing::name(id)) != 0);
+    }
+    TEST_ASSERT_EQUAL_STRING("udp_rx", TraceRing::name(TRACE_UDP_RX));
+    TEST_ASSERT_EQUAL_STRING("unknown", TraceRing::name(TRACE_ID_COUNT));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_spans_are_kept_oldest_first);
+    RUN_TEST(test_full_ring_keeps_the_latest_spans);
+    RUN_TEST(test_spans_ending_after_stop_are_not_recorded);
+    RUN_TEST(test_ring_is_stable_after_stop_under_concurrent_writers);
+    RUN_TEST(test_names_cover_every_id);
+    return UNITY_END();
+}
@@ -0,0 +1,327 @@
+// test_main.cpp
+// Host tests of the UDP datagram checks (header, sequence gaps, duplicates,
+// restart window, topic/payload pairs) and a loopback sender/receiver run
+// the way UdpListener polls its socket
+
+#include <Arduino.h>
+#include <unity.h>
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+#include "EcuFrame.h"
+#include "UdpIngest.h"
+
+#define LOOPBACK_DATAGRAMS 2000
+#define LOOPBACK_INTERVAL_US 500     // 2000 datagrams per second
+#define LOOPBACK_SKIP_EVERY 97       // Sender leaves out these sequence numbers
+#define LOOPBACK_PASS_US 1000        // Network task pass
+
+// Defined in Main.cpp on the device
+char notAvailableMsg[] = "..N/A..";
+
+static UdpIngest ingest;
+
+static std::vector<uint8_t> frameDatagram(uint16_t seq) {
+    EcuFrame frame = {};
+    frame.magic = ECU_FRAME_MAGIC;
+    frame.version = ECU_FRAME_VERSION;
+    frame.seq = seq;
+    const uint8_t *bytes = (const uint8_t *)&frame;
+    return std::vector<uint8_t>(bytes, bytes + sizeof(frame));
+}
+
+/**
+ * @brief Text datagram with "topic\0payload\0" pairs
+ * @param pairs Topics and payloads, alternating
+ */
+static std::vector<uint8_t> textDatagram(uint16_t seq, std::vector<std::string> pairs) {
+    UdpHeader header = {UDP_TEXT_MAGIC, UDP_TEXT_VERSION, seq};
+    std::vector<uint8_t> bytes((const uint8_t *)&header, (const uint8_t *)&header + sizeof(header));
+    for (const std::string &part : pairs) {
+        bytes.insert(bytes.end(), part.begin(), part.end());
+        bytes.push_back('\0');
+    }
+    return bytes;
+}
+
+static uint8_t acceptText(uint16_t seq) {
+    std::vector<uint8_t> bytes = textDatagram(seq, {"/GOLF86/ECU/RPM", "900"});
+    return ingest.accept(bytes.data(), bytes.size());
+}
+
+static uint8_t acceptFrame(uint16_t seq) {
+    std::vector<uint8_t> bytes = frameDatagram(seq);
+    return ingest.accept(bytes.data(), bytes.size());
+}
+
+void setUp(void) {
+    ingest = UdpIngest();
+}
+
+void tearDown(void) {}
+
+void test_header_selects_the_datagram_kind() {
+    TEST_ASSERT_EQUAL_UINT8(UDP_DATAGRAM_FRAME, acceptFrame(1));
+    TEST_ASSERT_EQUAL_UINT8(UDP_DATAGRAM_TEXT, acceptText(1));
+    TEST_ASSERT_EQUAL_UINT32(2, ingest.receivedCount());
+    TEST_ASSERT_EQUAL_UINT32(0, ingest.rejectedCount());
+}
+
+void test_bad_headers_and_sizes_are_rejected() {
+    std::vector<uint8_t> frame = frameDatagram(1);
+    TEST_ASSERT_EQUAL_UINT8(UDP_DATAGRAM_DROPPED, ingest.accept(frame.data(), 3));
+    TEST_ASSERT_EQUAL_UINT8(UDP_DATAGRAM_DROPPED, ingest.accept(frame.data(), frame.size() - 1));
+    frame[1] = ECU_FRAME_VERSION + 1;
+    TEST_ASSERT_EQUAL_UINT8(UDP_DATAGRAM_DROPPED, ingest.accept(frame.data(), frame.size()));
+
+    std::vector<uint8_t> text = textDatagram(1, {"/GOLF86/ECU/RPM", "900"});
+    text[0] = 0x42;
+    TEST_ASSERT_EQUAL_UINT8(UDP_DATAGRAM_DROPPED, ingest.accept(text.data(), text.size()));
+    text[0] = UDP_TEXT_MAGIC;
+    text[1] = UDP_TEXT_VERSION + 1;
+    TEST_ASSERT_EQUAL_UINT8(UDP_DATAGRAM_DROPPED, ingest.accept(text.data(), text.size()));
+    text[1] = UDP_TEXT_VERSION;
+    TEST_ASSERT_EQUAL_UINT8(UDP_DATAGRAM_DROPPED, ingest.accept(text.data(), UDP_MAX_DATAGRAM + 1));
+
+    TEST_ASSERT_EQUAL_UINT32(6, ingest.rejectedCount());
+    TEST_ASSERT_EQUAL_UINT32(0, ingest.lostCount());
+    TEST_ASSERT_EQUAL_UINT32(0, ingest.lateCount());
+
+    // Rejected datagrams do not start the sequence
+    TEST_ASSERT_EQUAL_UINT8(UDP_DATAGRAM_TEXT, acceptText(500));
+    TEST_ASSERT_EQUAL_UINT32(0, ingest.lostCount());
+}
+
+void test_sequence_gaps_are_counted_as_lost() {
+    TEST_ASSERT_EQUAL_UINT8(UDP_DATAGRAM_TEXT, acceptText(100));
+    acceptText(101);
+    TEST_ASSERT_EQUAL_UINT32(0, ingest.lostCount());
+    TEST_ASSERT_EQUAL_UINT8(UDP_DATAGRAM_TEXT, acceptText(104));
+    TEST_ASSERT_EQUAL_UINT32(2, ingest.lostCount());
+}
+
+void test_sequence_wraps_without_loss() {
+    acceptFrame(0xFFFE);
+    acceptFrame(0xFFFF);
+    TEST_ASSERT_EQUAL_UINT8(UDP_DATAGRAM_FRAME, acceptFrame(0));
+    TEST_ASSERT_EQUAL_UINT32(0, ingest.lostCount());
+    acceptFrame(3);
+    TEST_ASSERT_EQUAL_UINT32(2, ingest.lostCount());
+}
+
+void test_duplicates_and_older_datagrams_are_dropped_as_late() {
+    acceptText(10);
+    TEST_ASSERT_EQUAL_UINT8(UDP_DATAGRAM_DROPPED, acceptText(10));
+    TEST_ASSERT_EQUAL_UINT8(UDP_DATAGRAM_TEXT, acceptText(13));
+    TEST_ASSERT_EQUAL_UINT32(2, ingest.lostCount());
+
+    // 12 arrives after 13: a newer value is already shown
+    TEST_ASSERT_EQUAL_UINT8(UDP_DATAGRAM_DROPPED, acceptText(12));
+    TEST_ASSERT_EQUAL_UINT32(2, ingest.lateCount());
+    TEST_ASSERT_EQUAL_UINT32(0, ingest.rejectedCount());
+
+    // Older across the wrap
+    UdpIngest wrapped;
+    std::vector<uint8_t> bytes = textDatagram(1, {"/GOLF86/ECU/RPM", "900"});
+    wrapped.accept(bytes.data(), bytes.size());
+    bytes = textDatagram(0xFFFF, {"/GOLF86/ECU/RPM", "900"});
+    TEST_ASSERT_EQUAL_UINT8(UDP_DATAGRAM_DROPPED, wrapped.accept(bytes.data(), bytes.size()));
+    TEST_ASSERT_EQUAL_UINT32(1, wrapped.lateCount());
+}
+
+void test_jump_back_beyond_the_window_is_a_restart() {
+    acceptText(1000);
+    TEST_ASSERT_EQUAL_UINT8(UDP_DATAGRAM_DROPPED, acceptText(1000 - UDP_SEQ_RESTART_WINDOW));
+    TEST_ASSERT_EQUAL_UINT8(UDP_DATAGRAM_TEXT, acceptText(1000 - UDP_SEQ_RESTART_WINDOW - 1));
+    TEST_ASSERT_EQUAL_UINT32(1, ingest.lateCount());
+    TEST_ASSERT_EQUAL_UINT32(0, ingest.lostCount());
+
+    // The sender starts over from 0 and counts on from there
+    TEST_ASSERT_EQUAL_UINT8(UDP_DATAGRAM_TEXT, acceptText(0));
+    TEST_ASSERT_EQUAL_UINT8(UDP_DATAGRAM_TEXT, acceptText(1));
+    TEST_ASSERT_EQUAL_UINT32(0, ingest.lostCount());
+}
+
+void test_frame_and_text_sequences_are_separate() {
+    acceptFrame(50);
+    acceptText(7);
+    TEST_ASSERT_EQUAL_UINT8(UDP_DATAGRAM_FRAME, acceptFrame(51));
+    TEST_ASSERT_EQUAL_UINT8(UDP_DATAGRAM_TEXT, acceptText(8));
+    TEST_ASSERT_EQUAL_UINT32(0, ingest.lostCount());
+    TEST_ASSERT_EQUAL_UINT32(0, ingest.lateCount());
+}
+
+/**
+ * @brief Collect the pairs of a datagram the way UdpListener walks them
+ * @param bytes Datagram, terminated after length like the listener's buffer
+ */
+static std::vector<std::string> pairsOf(std::vector<uint8_t> bytes, int length) {
+    bytes.resize(length + 1);
+    bytes[length] = '\0';
+    std::vector<std::string> found;
+    const char *topic;
+    const char *payload;
+    int offset = sizeof(UdpHeader);
+    while ((offset = UdpIngest::nextPair((const char *)bytes.data(), length, offset, topic, payload)) >= 0) {
+        found.push_back(topic);
+        found.push_back(payload);
+    }
+    return found;
+}
+
+void test_next_pair_walks_every_pair() {
+    std::vector<uint8_t> bytes = textDatagram(1, {"/GOLF86/ECU/RPM", "6250", "/GOLF86/GPS/SPD", "87.5"});
+    std::vector<std::string> pairs = pairsOf(bytes, bytes.size());
+    TEST_ASSERT_EQUAL_UINT32(4, pairs.size());
+    TEST_ASSERT_EQUAL_STRING("/GOLF86/ECU/RPM", pairs[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("6250", pairs[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("/GOLF86/GPS/SPD", pairs[2].c_str());
+    TEST_ASSERT_EQUAL_STRING("87.5", pairs[3].c_str());
+}
+
+void test_next_pair_takes_a_last_payload_without_terminator() {
+    std::vector<uint8_t> bytes = textDatagram(1, {"/GOLF86/ECU/RPM", "6250"});
+    std::vector<std::string> pairs = pairsOf(bytes, bytes.size() - 1);
+    TEST_ASSERT_EQUAL_UINT32(2, pairs.size());
+    TEST_ASSERT_EQUAL_STRING("6250", pairs[1].c_str());
+}
+
+void test_next_pair_stops_at_empty_or_incomplete_pairs() {
+    TEST_ASSERT_EQUAL_UINT32(0, pairsOf(textDatagram(1, {}), sizeof(UdpHeader)).size());
+
+    // A topic cut off before its payload
+    std::vector<uint8_t> bytes = textDatagram(1, {"/GOLF86/ECU/RPM", "6250", "/GOLF86/ECU/TPS"});
+    std::vector<std::string> pairs = pairsOf(bytes, bytes.size() - 1);
+    TEST_ASSERT_EQUAL_UINT32(2, pairs.size());
+
+    // An empty topic ends the list
+    bytes = textDatagram(1, {"/GOLF86/ECU/RPM", "6250", "", "/GOLF86/ECU/TPS", "12"});
+    TEST_ASSERT_EQUAL_UINT32(2, pairsOf(bytes, bytes.size()).size());
+}
+
+static uint32_t percentile(std::vector<uint32_t> values, uint8_t percent) {
+    std::sort(values.begin(), values.end());
+    return values[(values.size() - 1) * percent / 100];
+}
+
+void test_loopback_sender_and_receiver() {
+    int receiver = socket(AF_INET, SOCK_DGRAM, 0);
+    TEST_ASSERT_TRUE(receiver >= 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    TEST_ASSERT_EQUAL_INT(0, bind(receiver, (sockaddr *)&address, sizeof(address)));
+    socklen_t addressLength = sizeof(address);
+    getsockname(receiver, (sockaddr *)&address, &addressLength);
+
+    // Sender: every other datagram a frame, the rest text with the send time as
+    // a diagnostic; some sequence numbers are left out, one text is sent twice
+    std::atomic<bool> sending(true);
+    std::atomic<uint32_t> skipped(0);
+    std::thread sender([&]() {
+        int socketFd = socket(AF_INET, SOCK_DGRAM, 0);
+        auto next = std::chrono::steady_clock::now();
+        uint16_t seq[2] = {0, 0};
+        for (uint32_t n = 0; n < LOOPBACK_DATAGRAMS; n++) {
+            bool frame = n % 2 == 0;
+            uint16_t &kindSeq = seq[frame ? 0 : 1];
+            if (n % LOOPBACK_SKIP_EVERY == LOOPBACK_SKIP_EVERY - 1) {
+                kindSeq++;
+                skipped++;
+            }
+            std::vector<uint8_t> bytes =
+                frame ? frameDatagram(kindSeq)
+                      : textDatagram(kindSeq, {"/GOLF86/ECU/RPM", std::to_string(n), "/GOLF86/DIAG/sent",
+                                               std::to_string((uint32_t)micros())});
+            sendto(socketFd, bytes.data(), bytes.size(), 0, (sockaddr *)&address, sizeof(address));
+            if (n == LOOPBACK_DATAGRAMS / 2 + 1) {
+                sendto(socketFd, bytes.data(), bytes.size(), 0, (sockaddr *)&address, sizeof(address));
+            }
+            kindSeq++;
+            next += std::chrono::microseconds(LOOPBACK_INTERVAL_US);
+            std::this_thread::sleep_until(next);
+        }
+        close(socketFd);
+        sending = false;
+    });
+
+    // Network task: up to UDP_POLL_BUDGET datagrams per pass, as UdpListener::poll()
+    char buffer[UDP_MAX_DATAGRAM + 1];
+    uint32_t frames = 0;
+    uint32_t texts = 0;
+    std::vector<uint32_t> latencies;
+    unsigned long start = millis();
+    for (;;) {
+        bool done = !sending;
+        uint8_t handled = 0;
+        for (; handled < UDP_POLL_BUDGET; handled++) {
+            ssize_t length = recv(receiver, buffer, UDP_MAX_DATAGRAM, MSG_DONTWAIT);
+            if (length <= 0) {
+                break;
+            }
+            uint32_t receivedMicros = micros();
+            buffer[length] = '\0';
+            uint8_t kind = ingest.accept((const uint8_t *)buffer, length);
+            if (kind == UDP_DATAGRAM_FRAME) {
+                frames++;
+            } else if (kind == UDP_DATAGRAM_TEXT) {
+                texts++;
+                const char *topic;
+                const char *payload;
+                int offset = sizeof(UdpHeader);
+                while ((offset = UdpIngest::nextPair(buffer, length, offset, topic, payload)) >= 0) {
+                    if (strcmp(topic, "/GOLF86/DIAG/sent") == 0) {
+                        latencies.push_back(receivedMicros - strtoul(payload, nullptr, 10));
+                    }
+                }
+            }
+        }
+        // Done once the sender stopped before a pass that emptied the socket
+        if (done && handled < UDP_POLL_BUDGET) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(LOOPBACK_PASS_US));
+    }
+    unsigned long elapsed = millis() - start;
+    sender.join();
+    close(receiver);
+
+    char line[160];
+    snprintf(line, sizeof(line), "%lu datagrams in %lu ms (%.0f/s): %lu frames, %lu texts, lost %lu, late %lu",
+             (unsigned long)ingest.receivedCount(), elapsed, ingest.receivedCount() * 1000.0 / elapsed,
+             (unsigned long)frames, (unsigned long)texts, (unsigned long)ingest.lostCount(),
+             (unsigned long)ingest.lateCount());
+    TEST_MESSAGE(line);
+    snprintf(line, sizeof(line), "send to accept: p50 %u us, p99 %u us, max %u us (pass every %d us)",
+             percentile(latencies, 50), percentile(latencies, 99), percentile(latencies, 100), LOOPBACK_PASS_US);
+    TEST_MESSAGE(line);
+
+    // Nothing is lost on loopback, so the counters show exactly what the sender did
+    TEST_ASSERT_EQUAL_UINT32(LOOPBACK_DATAGRAMS + 1, ingest.receivedCount());
+    TEST_ASSERT_EQUAL_UINT32(LOOPBACK_DATAGRAMS, frames + texts);
+    TEST_ASSERT_EQUAL_UINT32(skipped.load(), ingest.lostCount());
+    TEST_ASSERT_EQUAL_UINT32(1, ingest.lateCount());
+    TEST_ASSERT_EQUAL_UINT32(0, ingest.rejectedCount());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_header_selects_the_datagram_kind);
+    RUN_TEST(test_bad_headers_and_sizes_are_rejected);
+    RUN_TEST(test_sequence_gaps_are_counted_as_lost);
+    RUN_TEST(test_sequence_wraps_without_loss);
+    RUN_TEST(test_duplicates_and_older_datagrams_are_dropped_as_late);
+    RUN_TEST(test_jump_back_beyond_the_window_is_a_restart);
+    RUN_TEST(test_frame_and_text_sequences_are_separate);
+    RUN_TEST(test_next_pair_walks_every_pair);
+    RUN_TEST(test_next_pair_takes_a_last_payload_without_terminator);
+    RUN_TEST(test_next_pair_stops_at_empty_or_incomplete_pairs);
+    RUN_TEST(test_loopback_sender_and_receiver);
+    return UNITY_END();
+}